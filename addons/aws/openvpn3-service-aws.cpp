@@ -16,6 +16,7 @@
 #include <sstream>
 #include <exception>
 #include <set>
+#include <vector>
 #include <glib-unix.h>
 
 // Needs to be included before openvpn3-core library
@@ -141,12 +142,16 @@ class AWSObject : public DBus::Object::Base
 
         log->LogInfo("Running on instance " + route_context->instance_id() + ", route table " + config.route_table_id);
 
-        subscr_mgr->Subscribe(signals_target, "NetworkChange", [this](DBus::Signals::Event::Ptr &event)
+        subscr_mgr->Subscribe(signals_target, "NetworkChanges", [this](DBus::Signals::Event::Ptr &event)
                               {
                                   this->process_network_change(event);
                               });
 
-        netcfg_mgr->NotificationSubscribe(NetCfgChangeType::ROUTE_ADDED | NetCfgChangeType::ROUTE_REMOVED);
+        // All the route changes of a VPN session arrives in a single
+        // NetworkChanges signal, so the VPC is updated once per batch
+        netcfg_mgr->NotificationSubscribe(NetCfgChangeType::ROUTE_ADDED
+                                          | NetCfgChangeType::ROUTE_REMOVED
+                                          | NetCfgChangeType::BATCHED_SIGNALS);
 
         // We will act upon route changes caused by VPN sessions,
         // notifications which are sent by the net.openvpn.v3.netcfg service
@@ -192,57 +197,77 @@ class AWSObject : public DBus::Object::Base
      */
     void process_network_change(DBus::Signals::Event::Ptr &event)
     {
-        if (event->signal_name != "NetworkChange")
+        if (event->signal_name != "NetworkChanges")
         {
             return;
         }
 
-        // Parse the network change event, only consider route changes
-        NetCfgChangeEvent ev(event->params);
-        if ((ev.type != NetCfgChangeType::ROUTE_ADDED)
-            && (ev.type != NetCfgChangeType::ROUTE_REMOVED))
+        // Parse the network change events, only consider route changes
+        std::vector<NetCfgChangeEvent> route_changes;
+        for (const auto &ev : NetCfgChangeEvent::ParseBatch(event->params))
+        {
+            if ((ev.type == NetCfgChangeType::ROUTE_ADDED)
+                || (ev.type == NetCfgChangeType::ROUTE_REMOVED))
+            {
+                route_changes.push_back(ev);
+            }
+        }
+        if (route_changes.empty())
         {
             return;
         }
 
+        std::unique_ptr<AWS::Route::Context> route_context;
         try
         {
-            const std::string cidr = ev.details["subnet"] + "/" + ev.details["prefix_size"];
-            const bool ipv6 = ev.details["ip_version"] == "6";
-            auto route_context = prepare_route_context(config.role_name);
+            route_context = prepare_route_context(config.role_name);
+        }
+        catch (const std::exception &ex)
+        {
+            log->LogError("Error updating VPC routing: " + std::string(ex.what()));
+            return;
+        }
 
-            if (ev.type == NetCfgChangeType::ROUTE_ADDED)
+        for (auto &ev : route_changes)
+        {
+            try
             {
-                AWS::Route::replace_create_route(*route_context,
-                                                 config.route_table_id,
-                                                 cidr,
-                                                 AWS::Route::RouteTargetType::INSTANCE_ID,
-                                                 route_context->instance_id(),
-                                                 ipv6);
+                const std::string cidr = ev.details["subnet"] + "/" + ev.details["prefix_size"];
+                const bool ipv6 = ev.details["ip_version"] == "6";
 
-                vpc_routes.emplace(cidr, ipv6);
+                if (ev.type == NetCfgChangeType::ROUTE_ADDED)
+                {
+                    AWS::Route::replace_create_route(*route_context,
+                                                     config.route_table_id,
+                                                     cidr,
+                                                     AWS::Route::RouteTargetType::INSTANCE_ID,
+                                                     route_context->instance_id(),
+                                                     ipv6);
 
-                log->LogInfo("Added route " + cidr);
-            }
-            else
-            {
-                AWS::Route::delete_route(*route_context,
-                                         config.route_table_id,
-                                         cidr,
-                                         ipv6);
+                    vpc_routes.emplace(cidr, ipv6);
 
-                auto it = vpc_routes.find(VpcRoute(cidr, ipv6));
-                if (it != vpc_routes.end())
+                    log->LogInfo("Added route " + cidr);
+                }
+                else
                 {
-                    vpc_routes.erase(it);
+                    AWS::Route::delete_route(*route_context,
+                                             config.route_table_id,
+                                             cidr,
+                                             ipv6);
+
+                    auto it = vpc_routes.find(VpcRoute(cidr, ipv6));
+                    if (it != vpc_routes.end())
+                    {
+                        vpc_routes.erase(it);
+                    }
+
+                    log->LogInfo("Removed route " + cidr);
                 }
-
-                log->LogInfo("Removed route " + cidr);
             }
-        }
-        catch (const std::exception &ex)
-        {
-            log->LogError("Error updating VPC routing: " + std::string(ex.what()));
+            catch (const std::exception &ex)
+            {
+                log->LogError("Error updating VPC routing: " + std::string(ex.what()));
+            }
         }
     }
 
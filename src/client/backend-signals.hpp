@@ -26,6 +26,7 @@
 
 #include "dbus/constants.hpp"
 #include "dbus/signals/attention-required.hpp"
+#include "dbus/signals/statistics-update.hpp"
 #include "dbus/signals/statuschange.hpp"
 #include "log/dbus-log.hpp"
 #include "log/logwriter.hpp"
@@ -116,6 +117,10 @@ class BackendSignals : public LogSender
         GroupCreate("sessionmgr");
         GroupAddTarget("sessionmgr", sessmgr_busn);
         sig_regreq = GroupCreateSignal<Backend::Signals::RegistrationRequest>("sessionmgr");
+
+        // The StatisticsUpdate signals are also only sent to the
+        // Session Manager, which forwards them to its own subscribers
+        sig_statsupd = GroupCreateSignal<::Signals::StatisticsUpdate>("sessionmgr");
     }
 
     ~BackendSignals() noexcept
@@ -154,6 +159,20 @@ class BackendSignals : public LogSender
     }
 
 
+    /**
+     *  Sends the changed connection statistics counters to the
+     *  session manager
+     *
+     * @param sequence  uint64_t with the update sequence number
+     * @param changes   ConnectionStatsDelta::ChangeList with the changes
+     */
+    void StatisticsUpdate(const uint64_t sequence,
+                          const ConnectionStatsDelta::ChangeList &changes)
+    {
+        sig_statsupd->Send(sequence, changes);
+    }
+
+
     void StatusChange(const Events::Status &statusev)
     {
         sig_statuschg->Send(statusev);
@@ -263,6 +282,7 @@ class BackendSignals : public LogSender
     ::Signals::AttentionRequired::Ptr sig_attreq = nullptr;
     ::Signals::StatusChange::Ptr sig_statuschg = nullptr;
     Backend::Signals::RegistrationRequest::Ptr sig_regreq = nullptr;
+    ::Signals::StatisticsUpdate::Ptr sig_statsupd = nullptr;
     DBus::MainLoop::Ptr mainloop = nullptr;
     std::unique_ptr<std::thread> delayed_shutdown;
 };
@@ -0,0 +1,49 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   backendstart-configfile.hpp
+ *
+ * @brief  Configuration of the JSON configuration file to be used by
+ *         openvpn3-service-backendstart.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "common/configfileparser.hpp"
+
+using namespace Configuration;
+
+
+class BackendStartConfigFile : public virtual Configuration::File
+{
+  public:
+    typedef std::shared_ptr<Configuration::File> Ptr;
+
+    BackendStartConfigFile(const std::string &statedir)
+        : Configuration::File(statedir + "/" + "backendstart.json")
+    {
+    }
+
+  protected:
+    Configuration::OptionMap ConfigureMapping()
+    {
+        return {
+            // clang-format off
+            OptionMapEntry{"log-level", "log_level",
+                           "Log level", OptionValueType::Int},
+            OptionMapEntry{"idle-exit", "idle_exit",
+                           "Idle-Exit timer", OptionValueType::Int},
+            OptionMapEntry{"pool-size", "pool_size",
+                           "Standby client processes", OptionValueType::Int},
+            // clang-format on
+        };
+    }
+};
@@ -22,6 +22,7 @@
 
 #include "build-config.h"
 
+#include <cstdint>
 #include <fmt/compile.h>
 #include <fmt/format.h>
 
@@ -113,32 +114,23 @@ class NetCfgTunBuilder : public T
     {
         // Cleanup the old things
         tun_builder_teardown(true);
-        networks.clear();
+        devconfig.clear();
 
         return create_device();
     }
 
 
+    /*
+     *  The tun_builder_* settings methods below only collect the settings.
+     *  They are all sent to the netcfg service in a single
+     *  ApplyConfiguration call when the device is established, to
+     *  avoid a D-Bus round trip per setting.
+     */
+
     bool tun_builder_set_remote_address(const std::string &address, bool ipv6) override
     {
-        if (!device)
-        {
-            throw NetCfgProxyException(__func__, "Lost link to device interface");
-        }
-        try
-        {
-            device->SetRemoteAddress(address, ipv6);
-            return true;
-        }
-        catch (const DBus::Proxy::Exception &excp)
-        {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed saving remote address: "
-                << excp.GetRawError();
-            signals->LogError(msg.str());
-            return false;
-        }
+        devconfig.remote = NetCfgDeviceConfig::RemoteAddress{address, ipv6};
+        return true;
     }
 
 
@@ -149,72 +141,42 @@ class NetCfgTunBuilder : public T
                                  bool net30) override
     {
         /* We ignore net30 and gateway here for now */
-        try
+        if (prefix_length < 0)
         {
-            if (!device)
-            {
-                throw NetCfgProxyException(__func__, "Lost link to device interface");
-            }
-            device->AddIPAddress(address, (unsigned int)prefix_length, gateway, ipv6);
-            return true;
-        }
-        catch (const DBus::Proxy::Exception &e)
-        {
-            std::stringstream err;
-            err << "Error adding IP address " << address
-                << "/" << std::to_string(prefix_length)
-                << " to " << (device ? device->GetDeviceName() : "[unknown]")
-                << ": " << std::string(e.what());
-            signals->LogError(err.str());
+            signals->LogError(fmt::format("Error adding IP address {}/{}: "
+                                          "Invalid prefix length",
+                                          address,
+                                          prefix_length));
             return false;
         }
+        devconfig.ip_addresses.push_back(
+            NetCfgDeviceConfig::IPAddress{address,
+                                          static_cast<uint32_t>(prefix_length),
+                                          gateway,
+                                          ipv6});
+        return true;
     }
 
 
     bool tun_builder_set_layer(int layer) override
     {
-        if (!device)
-        {
-            throw NetCfgProxyException(__func__, "Lost link to device interface");
-        }
-        try
-        {
-            device->SetLayer(layer);
-            return true;
-        }
-        catch (const DBus::Proxy::Exception &excp)
-        {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed setting tunnel layer: "
-                << excp.GetRawError();
-            signals->LogCritical(msg.str());
-            return false;
-        }
+        devconfig.layer = static_cast<uint32_t>(layer);
+        return true;
     }
 
 
     bool tun_builder_set_mtu(int mtu) override
     {
-        if (!device)
-        {
-            throw NetCfgProxyException(__func__, "Lost link to device interface");
-        }
-
-        try
-        {
-            device->SetMtu(mtu);
-            return true;
-        }
-        catch (const DBus::Proxy::Exception &excp)
+        // Same range as accepted by the net.openvpn.v3.netcfg service
+        if (mtu < 68 || mtu > UINT16_MAX)
         {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed setting tunnel MTU: "
-                << excp.GetRawError();
-            signals->LogCritical(msg.str());
+            signals->LogError(fmt::format("Error setting tunnel MTU {}: "
+                                          "Invalid MTU",
+                                          mtu));
             return false;
         }
+        devconfig.mtu = static_cast<uint16_t>(mtu);
+        return true;
     }
 
 
@@ -222,41 +184,21 @@ class NetCfgTunBuilder : public T
                                 bool ipv6,
                                 unsigned int flags) override
     {
-        const std::vector<NetCfgProxy::Network> defaultRoutes;
-
-        if (!device)
-        {
-            throw NetCfgProxyException(__func__, "Lost link to device interface");
-        }
-
         /*
          * We add default routes and let the other side figure
          * out the details how to implement this
          * flags are only EmulateExcludeRoutes so far which is not
          * needed on Linux
          */
-
-        try
+        if (ipv4)
         {
-            if (ipv4)
-            {
-                device->SetRerouteGw(false, true);
-            }
-            if (ipv6)
-            {
-                device->SetRerouteGw(true, true);
-            }
-            return true;
+            devconfig.reroute_ipv4 = true;
         }
-        catch (const DBus::Proxy::Exception &excp)
+        if (ipv6)
         {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed setting gateway re-route flag: "
-                << excp.GetRawError();
-            signals->LogCritical(msg.str());
-            return false;
+            devconfig.reroute_ipv6 = true;
         }
+        return true;
     }
 
 
@@ -265,11 +207,12 @@ class NetCfgTunBuilder : public T
                                int metric,
                                bool ipv6) override
     {
-        /* We ignore metric */
-        /* Instead calling the proxy for each network individually we collect them
-         * to save context switching/rpc overhead */
-        networks.push_back(
-            NetCfgProxy::Network::IncludeRoute(address, prefix_length, metric, ipv6));
+        devconfig.networks.push_back(
+            NetCfgDeviceConfig::Route{address,
+                                      static_cast<uint32_t>(prefix_length),
+                                      metric,
+                                      ipv6,
+                                      false});
         return true;
     }
 
@@ -279,8 +222,12 @@ class NetCfgTunBuilder : public T
                                    int metric,
                                    bool ipv6) override
     {
-        networks.push_back(
-            NetCfgProxy::Network::ExcludeRoute(address, prefix_length, metric, ipv6));
+        devconfig.networks.push_back(
+            NetCfgDeviceConfig::Route{address,
+                                      static_cast<uint32_t>(prefix_length),
+                                      metric,
+                                      ipv6,
+                                      true});
         return true;
     }
 
@@ -293,7 +240,7 @@ class NetCfgTunBuilder : public T
             return true;
         }
 
-        return device->AddDnsOptions(signals, dns);
+        return NetCfgProxy::Device::PrepareDnsOptions(signals, dns, devconfig);
     }
 
 
@@ -304,23 +251,9 @@ class NetCfgTunBuilder : public T
             throw NetCfgProxyException(__func__, "Lost link to device interface");
         }
 
-        // Set all routes in one go to avoid calling the function multiple
-        // times
-        try
-        {
-            device->AddNetworks(networks);
-        }
-        catch (const DBus::Proxy::Exception &excp)
-        {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed adding networks: "
-                << excp.GetRawError();
-            signals->LogCritical(msg.str());
-        }
-
         try
         {
+            device->ApplyConfiguration(devconfig);
             virtual_interface_fd_ = device->Establish();
             signals->Debug(fmt::format("Opened new virtual interface fd {}", virtual_interface_fd_));
             return virtual_interface_fd_;
@@ -328,7 +261,7 @@ class NetCfgTunBuilder : public T
         catch (const DBus::Exception &excp)
         {
             signals->StatusChange(Events::Status(StatusMajor::CONNECTION, StatusMinor::CONN_FAILED));
-            signals->LogFATAL("Error calling NetCfgDevice::Establish(): "
+            signals->LogFATAL("Error establishing the virtual interface: "
                               + std::string(excp.what()));
             try
             {
@@ -544,17 +477,24 @@ class NetCfgTunBuilder : public T
 
         try
         {
-            device->AddNetworks(networks);
+            device->ApplyConfiguration(devconfig);
         }
-        catch (const DBus::Proxy::Exception &excp)
+        catch (const DBus::Exception &excp)
         {
-            std::ostringstream msg;
-            msg << "[" << device->GetDeviceName() << "] "
-                << "Failed adding networks: "
-                << excp.GetRawError();
-            signals->LogCritical(msg.str());
+            signals->StatusChange(Events::Status(StatusMajor::CONNECTION, StatusMinor::CONN_FAILED));
+            signals->LogFATAL("Error configuring the virtual interface: "
+                              + std::string(excp.what()));
+            try
+            {
+                tun_builder_teardown(true);
+            }
+            catch (...)
+            {
+            }
+            // There is no return value to signal the failure with,
+            // so the connection attempt is aborted by the exception
+            throw;
         }
-
         device->EstablishDCO();
     }
 
@@ -638,7 +578,7 @@ class NetCfgTunBuilder : public T
         return false;
     }
 
-    std::vector<NetCfgProxy::Network> networks;
+    NetCfgDeviceConfig devconfig;
     NetCfgProxy::Device::Ptr device;
 #ifdef ENABLE_OVPNDCO
     NetCfgProxy::DCO::Ptr dco;
@@ -19,18 +19,31 @@
  *         service is supposed to be automatically started by D-Bus, with
  *         root privileges.  This ensures the client process this service
  *         starts also runs with the appropriate privileges.
+ *
+ *         Optionally, a pool of standby client processes can be kept
+ *         ready.  These processes are started and initialised in advance
+ *         and are handed a session token when StartClient is called,
+ *         which avoids the process start-up time when starting sessions.
  */
 
+#include <csignal>
+#include <deque>
+#include <fcntl.h>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/service.hpp>
 
 #include "build-config.h"
+#include "backendstart-configfile.hpp"
 #include "common/cmdargparser.hpp"
 #include "dbus/constants.hpp"
+#include "dbus/credentials-cache.hpp"
 #include "dbus/signals/statuschange.hpp"
 #include "log/dbus-log.hpp"
 #include "log/proxy-log.hpp"
@@ -40,6 +53,12 @@
 #define BACKEND_CLIENT_BIN "openvpn3-service-client"
 #endif
 
+/**
+ *  Upper limit of the --pool-size option.  Each standby process is a
+ *  complete openvpn3-service-client process waiting for a session.
+ */
+static const unsigned long MAX_POOL_SIZE = 16;
+
 /**
  * Helper class to tackle signals sent by the backend starter process
  *
@@ -138,18 +157,22 @@ class BackendStarterHandler : public DBus::Object::Base
      * @param client_envvars  Additional environment variables set when starting
      *                        the binary
      * @param log_level       Log verbosity level this service uses
+     * @param pool_size       Number of standby client processes to keep
+     *                        ready.  0 disables the standby pool.
      */
     BackendStarterHandler(DBus::Connection::Ptr dbuscon_,
                           const std::vector<std::string> client_args,
                           const std::vector<std::string> client_envvars,
-                          unsigned int log_level)
+                          unsigned int log_level,
+                          unsigned int pool_size)
         : DBus::Object::Base(Constants::GenPath("backends"),
                              Constants::GenInterface("backends")),
           dbuscon(std::move(dbuscon_)),
-          creds(DBus::Credentials::Query::Create(dbuscon)),
+          creds(GDBusPP::Credentials::Cache::Create(dbuscon)),
           client_args(client_args),
           client_envvars(client_envvars),
-          process_uid(geteuid())
+          process_uid(geteuid()),
+          pool_size(pool_size)
     {
         DisableIdleDetector(true);
 
@@ -163,24 +186,74 @@ class BackendStarterHandler : public DBus::Object::Base
         RegisterSignals(be_signals);
 
         AddProperty("version", version, false);
+        AddPropertyBySpec(
+            "pool_size",
+            glib2::DataType::DBus<uint32_t>(),
+            [this](const DBus::Object::Property::BySpec &prop) -> GVariant *
+            {
+                return glib2::Value::Create(this->pool_size);
+            });
+        AddPropertyBySpec(
+            "pool_available",
+            glib2::DataType::DBus<uint32_t>(),
+            [this](const DBus::Object::Property::BySpec &prop) -> GVariant *
+            {
+                std::lock_guard<std::mutex> guard(pool_mtx);
+                return glib2::Value::Create(static_cast<uint32_t>(pool.size()));
+            });
+        AddPropertyBySpec(
+            "pool_hits",
+            glib2::DataType::DBus<uint64_t>(),
+            [this](const DBus::Object::Property::BySpec &prop) -> GVariant *
+            {
+                std::lock_guard<std::mutex> guard(pool_mtx);
+                return glib2::Value::Create(pool_hits);
+            });
+        AddPropertyBySpec(
+            "pool_misses",
+            glib2::DataType::DBus<uint64_t>(),
+            [this](const DBus::Object::Property::BySpec &prop) -> GVariant *
+            {
+                std::lock_guard<std::mutex> guard(pool_mtx);
+                return glib2::Value::Create(pool_misses);
+            });
 
         auto args = AddMethod("StartClient",
                               [this](DBus::Object::Method::Arguments::Ptr args)
                               {
                                   GVariant *parms = args->GetMethodParameters();
                                   std::string token = glib2::Value::Extract<std::string>(parms, 0);
-                                  auto be_pid = static_cast<uint32_t>(this->start_backend_process(token.c_str()));
+                                  pid_t pid = this->assign_standby_process(token);
+                                  if (pid < 0)
+                                  {
+                                      pid = this->start_backend_process(token.c_str());
+                                  }
+                                  auto be_pid = static_cast<uint32_t>(pid);
                                   args->SetMethodReturn(glib2::Value::CreateTupleWrapped(be_pid));
                               });
         args->AddInput("token", glib2::DataType::DBus<std::string>());
         args->AddOutput("pid", glib2::DataType::DBus<uint32_t>());
 
         be_signals->Debug("BackendStarterObject registered");
+
+        if (pool_size > 0)
+        {
+            be_signals->LogVerb1("Standby client process pool size: "
+                                 + std::to_string(pool_size));
+            fill_pool();
+        }
     }
 
 
     ~BackendStarterHandler()
     {
+        // Closing the token pipes makes the standby processes exit
+        std::lock_guard<std::mutex> guard(pool_mtx);
+        for (const auto &sp : pool)
+        {
+            close(sp.token_fd);
+        }
+        pool.clear();
         be_signals->LogInfo("openvpn3-service-backendstart: Shutting down");
     }
 
@@ -204,26 +277,167 @@ class BackendStarterHandler : public DBus::Object::Base
 
 
   private:
+    /**
+     *  A started openvpn3-service-client process waiting for a
+     *  session token
+     */
+    struct StandbyProcess
+    {
+        /** Initial process ID of the standby process */
+        pid_t pid;
+
+        /** Write end of the pipe the session token is sent through */
+        int token_fd;
+    };
+
     DBus::Connection::Ptr dbuscon{nullptr};
-    DBus::Credentials::Query::Ptr creds{nullptr};
+    GDBusPP::Credentials::Cache::Ptr creds{nullptr};
     const std::vector<std::string> client_args;
     const std::vector<std::string> client_envvars;
     const uid_t process_uid;
+    const uint32_t pool_size;
     BackendStarterSignals::Ptr be_signals{nullptr};
     ::Signals::StatusChange::Ptr sig_statuschg{nullptr};
     std::string version{get_package_version()};
 
+    std::mutex pool_mtx;
+    std::deque<StandbyProcess> pool{};
+    uint64_t pool_hits = 0;
+    uint64_t pool_misses = 0;
+
+
+    /**
+     *  Hands out a standby process from the pool to a new session,
+     *  by sending it the session token.
+     *
+     * @param token  std::string with the session token
+     * @return The initial process ID of the standby process which got
+     *         the token, or -1 if no standby process was available.
+     */
+    pid_t assign_standby_process(const std::string &token)
+    {
+        if (0 == pool_size)
+        {
+            return -1;
+        }
+
+        pid_t pid = -1;
+        {
+            std::lock_guard<std::mutex> guard(pool_mtx);
+            const std::string data = token + "\n";
+            while (!pool.empty() && pid < 0)
+            {
+                StandbyProcess sp = pool.front();
+                pool.pop_front();
+
+                // If the standby process has died, the write fails
+                // with EPIPE; then try the next one
+                ssize_t r = write(sp.token_fd, data.c_str(), data.size());
+                close(sp.token_fd);
+                if (r == static_cast<ssize_t>(data.size()))
+                {
+                    pid = sp.pid;
+                }
+                else
+                {
+                    be_signals->LogWarn("Standby client process (pid "
+                                        + std::to_string(sp.pid)
+                                        + ") is not available");
+                }
+            }
+            if (pid > 0)
+            {
+                ++pool_hits;
+            }
+            else
+            {
+                ++pool_misses;
+            }
+        }
+
+        if (pid > 0)
+        {
+            be_signals->LogVerb2("Assigned standby client process (pid "
+                                 + std::to_string(pid) + ") to " + token);
+        }
+        else
+        {
+            be_signals->LogVerb1("No standby client process available");
+        }
+
+        // Start replacements from the main loop, after this call
+        // has been completed
+        g_idle_add(refill_pool, this);
+        return pid;
+    }
+
+
+    /**
+     *  Starts standby processes until the pool has the configured size
+     */
+    void fill_pool()
+    {
+        size_t missing = 0;
+        {
+            std::lock_guard<std::mutex> guard(pool_mtx);
+            missing = (pool.size() < pool_size ? pool_size - pool.size() : 0);
+        }
+
+        // The processes are started without holding the lock, to not
+        // hold back StartClient calls meanwhile
+        for (size_t i = 0; i < missing; ++i)
+        {
+            int token_fd = -1;
+            pid_t pid = start_backend_process(nullptr, &token_fd);
+            if (pid < 0)
+            {
+                break;
+            }
+            std::lock_guard<std::mutex> guard(pool_mtx);
+            pool.push_back({pid, token_fd});
+        }
+    }
+
+
+    static int refill_pool(void *data)
+    {
+        auto handler = static_cast<BackendStarterHandler *>(data);
+        try
+        {
+            handler->fill_pool();
+        }
+        catch (const std::exception &excp)
+        {
+            handler->be_signals->LogError("Failed starting standby client process: "
+                                          + std::string(excp.what()));
+        }
+        return G_SOURCE_REMOVE;
+    }
+
 
     /**
      * Forks out a child thread which starts the openvpn3-service-client
      * process with the provided backend start token.
      *
-     * @param token  String containing the start token identifying the session
-     *               object this process is tied to.
+     * If no token is provided, the client process is started in standby
+     * mode.  The token is then sent later on via a pipe connected to the
+     * stdin of the client process.
+     *
+     * @param token     String containing the start token identifying the
+     *                  session object this process is tied to.  nullptr
+     *                  for a standby process.
+     * @param token_fd  Pointer to an int where the write end of the token
+     *                  pipe is stored, for standby processes.
      * @return Returns the process ID (pid) of the child process.
      */
-    pid_t start_backend_process(const char *token)
+    pid_t start_backend_process(const char *token, int *token_fd = nullptr)
     {
+        int token_pipe[2] = {-1, -1};
+        if (!token && -1 == pipe2(token_pipe, O_CLOEXEC))
+        {
+            throw std::runtime_error("Failed to create the standby process token pipe");
+        }
+
         pid_t backend_pid = fork();
         if (0 == backend_pid)
         {
@@ -247,9 +461,23 @@ class BackendStarterHandler : public DBus::Object::Base
             {
                 args[i++] = (char *)strdup(arg.c_str());
             }
-            args[i++] = token;
+            if (token)
+            {
+                args[i++] = token;
+            }
+            else
+            {
+                // The read end of the token pipe becomes stdin; dup2()
+                // clears the close-on-exec flag for the new descriptor
+                args[i++] = "--standby";
+                dup2(token_pipe[0], STDIN_FILENO);
+            }
             args[i++] = nullptr;
 
+            // The service ignores SIGPIPE, which would otherwise be
+            // inherited by the client process
+            signal(SIGPIPE, SIG_DFL);
+
 #ifdef OPENVPN_DEBUG
             std::cerr << "[openvpn3-service-backend] {" << getpid() << "} "
                       << "Command line to be started: ";
@@ -294,13 +522,19 @@ class BackendStarterHandler : public DBus::Object::Base
         else if (backend_pid > 0)
         {
             // Parent
+            if (!token)
+            {
+                close(token_pipe[0]);
+                *token_fd = token_pipe[1];
+            }
+
             std::stringstream cmdline;
             cmdline << "Command line used {" << getpid() << "}: ";
             for (auto const &c : client_args)
             {
                 cmdline << c << " ";
             }
-            cmdline << token;
+            cmdline << (token ? token : "--standby");
             be_signals->LogVerb2(cmdline.str());
 
             // Wait for the child process to exit, as the client process will fork again
@@ -309,15 +543,24 @@ class BackendStarterHandler : public DBus::Object::Base
             if (-1 == w)
             {
                 std::stringstream msg;
-                msg << "Child process (" << token
+                msg << "Child process (" << (token ? token : "standby")
                     << ") - pid " << backend_pid
                     << " failed to start as expected (exit code: "
                     << std::to_string(rc) << ")";
                 be_signals->LogError(msg.str());
+                if (!token)
+                {
+                    close(token_pipe[1]);
+                }
                 return -1;
             }
             return backend_pid;
         }
+        if (!token)
+        {
+            close(token_pipe[0]);
+            close(token_pipe[1]);
+        }
         throw std::runtime_error("Failed to fork() backend client process");
     }
 };
@@ -340,10 +583,12 @@ class BackendStarterSrv : public DBus::Service
 
     BackendStarterSrv(DBus::Connection::Ptr conn,
                       const std::vector<std::string> &cliargs,
-                      unsigned int log_level)
+                      unsigned int log_level,
+                      unsigned int pool_size)
         : DBus::Service(std::move(conn), Constants::GenServiceName("backends")),
           client_args(cliargs),
-          log_level(log_level) {};
+          log_level(log_level),
+          pool_size(pool_size) {};
 
     ~BackendStarterSrv()
     {
@@ -373,7 +618,8 @@ class BackendStarterSrv : public DBus::Service
         CreateServiceHandler<BackendStarterHandler>(GetConnection(),
                                                     client_args,
                                                     client_envvars,
-                                                    log_level);
+                                                    log_level,
+                                                    pool_size);
     };
 
 
@@ -389,6 +635,7 @@ class BackendStarterSrv : public DBus::Service
     BackendStarterHandler::Ptr mainobj{nullptr};
     std::vector<std::string> client_args{};
     unsigned int log_level{3};
+    unsigned int pool_size{0};
     LogServiceProxy::Ptr logsrvprx;
     std::vector<std::string> client_envvars{};
 };
@@ -399,6 +646,21 @@ int backend_starter(ParsedArgs::Ptr args)
 {
     std::cout << get_program_version(args->GetArgv0()) << std::endl;
 
+    if (args->Present("state-dir"))
+    {
+        BackendStartConfigFile::Ptr config;
+        config.reset(new BackendStartConfigFile(args->GetLastValue("state-dir")));
+        try
+        {
+            config->Load();
+            args->ImportConfigFile(config);
+        }
+        catch (const ConfigFileException &)
+        {
+            // Ignore load errors; the file might be missing - which is fine.
+        }
+    }
+
     std::vector<std::string> client_args;
 #ifdef OPENVPN_DEBUG
     if (args->Present("run-via"))
@@ -454,17 +716,39 @@ int backend_starter(ParsedArgs::Ptr args)
     unsigned int log_level = 3;
     if (args->Present("log-level"))
     {
-        log_level = std::atoi(args->GetValue("log-level", 0).c_str());
+        log_level = std::atoi(args->GetLastValue("log-level").c_str());
+    }
+
+    unsigned int pool_size = 0;
+    if (args->Present("pool-size"))
+    {
+        pool_size = static_cast<unsigned int>(
+            parse_option_number("openvpn3-service-backendstart",
+                                args,
+                                "pool-size",
+                                0,
+                                MAX_POOL_SIZE));
     }
 
+    // Writing a session token to a standby process which has exited
+    // must not stop this service
+    signal(SIGPIPE, SIG_IGN);
+
     auto dbus = DBus::Connection::Create(DBus::BusType::SYSTEM);
     auto backstart = DBus::Service::Create<BackendStarterSrv>(dbus,
                                                               client_args,
-                                                              log_level);
+                                                              log_level,
+                                                              pool_size);
     unsigned int idle_wait_sec = 30;
     if (args->Present("idle-exit"))
     {
-        idle_wait_sec = std::atoi(args->GetValue("idle-exit", 0).c_str());
+        idle_wait_sec = std::atoi(args->GetLastValue("idle-exit").c_str());
+    }
+    if (pool_size > 0)
+    {
+        // The standby processes are stopped when this service exits;
+        // the pool is only useful while this service keeps running
+        idle_wait_sec = 0;
     }
 
     backstart->PrepareIdleDetector(std::chrono::seconds(idle_wait_sec));
@@ -508,6 +792,16 @@ int main(int argc, char **argv)
                   true,
                   "How long to wait before exiting if being idle. "
                   "0 disables it (Default: 30 seconds)");
+    cmd.AddOption("pool-size",
+                  "NUM",
+                  true,
+                  "Number of standby client processes to keep ready, "
+                  "at most 16. 0 disables the standby pool (Default: 0)");
+    cmd.AddOption("state-dir",
+                  0,
+                  "DIRECTORY",
+                  true,
+                  "Directory where the backendstart.json configuration file is found");
 #ifdef OPENVPN_DEBUG
     cmd.AddOption("run-via",
                   0,
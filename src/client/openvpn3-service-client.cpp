@@ -25,7 +25,9 @@
  *         connection.
  */
 
+#include <algorithm>
 #include <exception>
+#include <mutex>
 #include <sstream>
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/exceptions.hpp>
@@ -216,6 +218,22 @@ class BackendClientObject : public DBus::Object::Base
                       args->SetMethodReturn(nullptr);
                   });
 
+        auto stats_subscr = AddMethod("StatisticsSubscribe",
+                                      [this](DBus::Object::Method::Arguments::Ptr args)
+                                      {
+                                          GVariant *ret = this->cb_statistics_subscribe(args->GetMethodParameters());
+                                          args->SetMethodReturn(ret);
+                                      });
+        stats_subscr->AddInput("interval", glib2::DataType::DBus<uint32_t>());
+        stats_subscr->AddOutput("names", "as");
+
+        AddMethod("StatisticsUnsubscribe",
+                  [this](DBus::Object::Method::Arguments::Ptr args)
+                  {
+                      this->stop_statistics_updates();
+                      args->SetMethodReturn(nullptr);
+                  });
+
         userinputq->QueueSetup(this,
                                "UserInputQueueGetTypeGroup",
                                "UserInputQueueFetch",
@@ -370,6 +388,34 @@ class BackendClientObject : public DBus::Object::Base
         };
         AddPropertyBySpec("statistics", "a{sx}", prop_statistics);
 
+        // The statistics counters in a fixed order, with the names in the
+        // separate statistics_names property.  This avoids building a
+        // string key for each counter on every read.
+        static_assert(sizeof(long long) == sizeof(gint64),
+                      "stats_bundle() values must match the D-Bus int64 type");
+        auto prop_stats_counters = [this](const DBus::Object::Property::BySpec &prop)
+        {
+            std::vector<long long> counters = (this->vpnclient
+                                                   ? this->vpnclient->stats_bundle()
+                                                   : std::vector<long long>(CoreVPNClient::stats_n(), 0));
+            return g_variant_new_fixed_array(G_VARIANT_TYPE_INT64,
+                                             counters.data(),
+                                             counters.size(),
+                                             sizeof(gint64));
+        };
+        AddPropertyBySpec("statistics_counters", "ax", prop_stats_counters);
+
+        auto prop_stats_names = [](const DBus::Object::Property::BySpec &prop)
+        {
+            GVariantBuilder *names = glib2::Builder::Create("as");
+            for (int i = 0; i < CoreVPNClient::stats_n(); ++i)
+            {
+                glib2::Builder::Add(names, CoreVPNClient::stats_name(i));
+            }
+            return glib2::Builder::Finish(names);
+        };
+        AddPropertyBySpec("statistics_names", "as", prop_stats_names);
+
         auto prop_status = [this](const DBus::Object::Property::BySpec &prop)
         {
             return this->signal->GetLastStatusChange();
@@ -394,6 +440,7 @@ class BackendClientObject : public DBus::Object::Base
 
     ~BackendClientObject()
     {
+        stop_statistics_updates();
         if (client_thread && client_thread->joinable())
         {
             try
@@ -556,6 +603,7 @@ class BackendClientObject : public DBus::Object::Base
     DBus::Object::Path session_path = "/__unknown";
     const std::vector<std::string> restricted_acl_prop_get{
         "net.openvpn.v3.backends.statistics",
+        "net.openvpn.v3.backends.statistics_counters",
         "net.openvpn.v3.backends.stats",
         "net.openvpn.v3.backends.device_name",
         "net.openvpn.v3.backends.session_name",
@@ -565,6 +613,15 @@ class BackendClientObject : public DBus::Object::Base
         "net.openvpn.v3.backends.dco"};
     std::string enterprise_id;
     std::string automatic_restart;
+    /// Protects stats_timer and stats_delta.  The D-Bus methods run in
+    /// worker threads, while the timer runs in the GLib main loop.
+    std::mutex stats_mtx{};
+    guint stats_timer = 0; ///< GLib timer source sending StatisticsUpdate signals
+    ConnectionStatsDelta stats_delta{};
+
+    /// Allowed range of the StatisticsUpdate interval, in milliseconds
+    static constexpr uint32_t STATS_INTERVAL_MIN = 500;
+    static constexpr uint32_t STATS_INTERVAL_MAX = 3600 * 1000;
 
 
     /**
@@ -875,6 +932,98 @@ class BackendClientObject : public DBus::Object::Base
     }
 
 
+    /**
+     *  Called by the session manager to enable sending the connection
+     *  statistics counters via StatisticsUpdate signals.  Calling it again
+     *  changes the interval and restarts the delta encoding, which means
+     *  the next update will contain all counters again.
+     *
+     * @param params  GVariant with the requested interval in milliseconds.
+     *                It is adjusted to the STATS_INTERVAL_MIN and
+     *                STATS_INTERVAL_MAX range.
+     *
+     * @return GVariant with the names of all the statistics counters.  The
+     *         counters in the StatisticsUpdate signal refers to the index
+     *         of this list.
+     */
+    GVariant *cb_statistics_subscribe(GVariant *params)
+    {
+        glib2::Utils::checkParams(__func__, params, "(u)", 1);
+        const uint32_t interval = std::clamp(glib2::Value::Extract<uint32_t>(params, 0),
+                                             STATS_INTERVAL_MIN,
+                                             STATS_INTERVAL_MAX);
+
+        {
+            std::lock_guard<std::mutex> guard(stats_mtx);
+            remove_stats_timer();
+            stats_delta.Reset();
+            stats_timer = g_timeout_add(interval, send_statistics_update, this);
+        }
+        signal->LogVerb2("Statistics updates enabled, interval "
+                         + std::to_string(interval) + "ms");
+
+        GVariantBuilder *names = glib2::Builder::Create("as");
+        for (int i = 0; i < CoreVPNClient::stats_n(); ++i)
+        {
+            glib2::Builder::Add(names, CoreVPNClient::stats_name(i));
+        }
+        return glib2::Builder::FinishWrapped(names);
+    }
+
+
+    void stop_statistics_updates()
+    {
+        std::lock_guard<std::mutex> guard(stats_mtx);
+        remove_stats_timer();
+    }
+
+
+    /**
+     *  Removes the StatisticsUpdate timer.  Must be called with
+     *  stats_mtx locked.
+     */
+    void remove_stats_timer()
+    {
+        if (stats_timer > 0)
+        {
+            g_source_remove(stats_timer);
+            stats_timer = 0;
+        }
+    }
+
+
+    /**
+     *  GLib timer callback, sending the statistics counters which changed
+     *  since the previous update.  Nothing is sent if no counters changed.
+     *
+     * @param data  Pointer to the BackendClientObject
+     * @return Returns G_SOURCE_CONTINUE, to keep the timer running
+     */
+    static gboolean send_statistics_update(gpointer data)
+    {
+        auto self = static_cast<BackendClientObject *>(data);
+        std::lock_guard<std::mutex> guard(self->stats_mtx);
+
+        // The timer might have been replaced or removed while this
+        // call was waiting for the lock
+        if (g_source_get_id(g_main_current_source()) != self->stats_timer)
+        {
+            return G_SOURCE_REMOVE;
+        }
+        if (!self->vpnclient)
+        {
+            return G_SOURCE_CONTINUE;
+        }
+
+        auto changes = self->stats_delta.Update(self->vpnclient->stats_bundle());
+        if (!changes.empty())
+        {
+            self->signal->StatisticsUpdate(self->stats_delta.GetSequence(), changes);
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+
     /**
      *  Starts a new POSIX thread which will run the
      *  VPN client (CoreVPNClient)
@@ -1584,11 +1733,16 @@ class ClientService : public DBus::Service
 /**
  *  Main Backend Client D-Bus service.  This registers this client process
  *  as a separate and unique D-Bus service
+ *
+ *  If no session token is provided, this process is a standby process in
+ *  the openvpn3-service-backendstart warm pool.  The process is then
+ *  initialised as far as possible without the session token, before it
+ *  waits for the session token to be provided via stdin.
  */
 
 void start_client_thread(pid_t start_pid,
                          const std::string argv0,
-                         const std::string sesstoken,
+                         std::string sesstoken,
                          bool disable_socket_protect,
                          int32_t log_level,
                          LogWriter *logwr)
@@ -1600,6 +1754,20 @@ void start_client_thread(pid_t start_pid,
     {
         auto dbuscon = DBus::Connection::Create(DBus::BusType::SYSTEM);
         auto mainloop = DBus::MainLoop::Create();
+
+        if (sesstoken.empty())
+        {
+            // Wait for the backend starter to hand out this process.  If
+            // stdin is closed before a token arrives, the backend starter
+            // has discarded this standby process.
+            if (!std::getline(std::cin, sesstoken) || sesstoken.empty())
+            {
+                return;
+            }
+            std::cout << "Standby process pid " << std::to_string(getpid())
+                      << " assigned to a new session" << std::endl;
+        }
+
         auto clientsrv = DBus::Service::Create<ClientService>(start_pid,
                                                               mainloop,
                                                               dbuscon,
@@ -1634,6 +1802,12 @@ void start_client_thread(pid_t start_pid,
 int client_service(ParsedArgs::Ptr args)
 {
     auto extra = args->GetAllExtraArgs();
+    if (args->Present("standby") && extra.empty())
+    {
+        // The session token is read from stdin once this process is
+        // taken into use; see start_client_thread()
+        extra.push_back("");
+    }
     if (extra.size() != 1)
     {
         std::cout << "** ERROR ** Invalid usage: " << args->GetArgv0()
@@ -1775,6 +1949,10 @@ int main(int argc, char **argv)
                         0,
                         "Disable the socket protect call on the UDP/TCP socket. "
                         "This is needed on systems not supporting this feature");
+    argparser.AddOption("standby",
+                        0,
+                        "Start as a standby process, waiting for the session "
+                        "registration token on stdin");
 #ifdef OPENVPN_DEBUG
     argparser.AddOption("no-fork",
                         0,
@@ -32,6 +32,7 @@ using XmlDocPtr = std::shared_ptr<openvpn::Xml::Document>;
 #endif
 
 #include "dbus/requiresqueue-proxy.hpp"
+#include "dbus/support-functions.hpp"
 #include "statistics.hpp"
 #include "common/utils.hpp"
 #include "events/status.hpp"
@@ -143,6 +144,7 @@ class Handler
   private:
     DBus::Proxy::Client::Ptr proxy;
     DBus::Proxy::TargetPreset::Ptr target;
+    GDBusPP::Proxy::Utils::ObjectPresence::Ptr presence;
 
     Handler(DBus::Connection::Ptr conn)
     {
@@ -156,19 +158,12 @@ class Handler
             prxqry->CheckServiceAvail(Constants::GenServiceName("devposture"));
 
             // Delay the return up to 750ms, to ensure we have a valid
-            // Device Posture service object available
-            auto prxchk = DBus::Proxy::Utils::Query::Create(proxy);
-
-            for (uint8_t i = 5; i > 0; i--)
-            {
-                if (prxchk->CheckObjectExists(target->object_path,
-                                              target->interface))
-                {
-                    break;
-                }
-
-                usleep(150000);
-            }
+            // Device Posture service object available.  The presence
+            // cache is shared with other proxies on the same connection.
+            presence = GDBusPP::Proxy::Utils::ObjectPresence::Create(
+                conn, Constants::GenServiceName("devposture"));
+            (void)presence->WaitForObject(target->object_path,
+                                          std::chrono::milliseconds(750));
         }
         catch (const DBus::Proxy::Exception &excp)
         {
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -42,3 +46,376 @@ struct ConnectionStatDetails
  *  This data type will contain a full set of connection statistics
  */
 using ConnectionStats = std::vector<ConnectionStatDetails>;
+
+
+/**
+ *  Delta encoder for the connection statistics counters pushed via the
+ *  StatisticsUpdate D-Bus signal.
+ *
+ *  The counters are identified by their index in the statistics names
+ *  table, which is sent only once - when subscribing to the updates.  Each
+ *  update only carries the counters which changed since the previous
+ *  update, with the difference from the previous value.
+ *
+ *  The first update after Reset() has sequence number 0 and carries all
+ *  counters which are not zero, relative to zero, which means the
+ *  receiver must discard any previously accumulated values.  For each
+ *  following update carrying changes, the sequence number is increased
+ *  by one.  A gap in the sequence numbers indicates the receiver has
+ *  lost an update.
+ */
+class ConnectionStatsDelta
+{
+  public:
+    /**
+     *  A single changed counter; the index in the statistics names table
+     *  and the difference since the previous update
+     */
+    using Change = std::pair<uint32_t, int64_t>;
+    using ChangeList = std::vector<Change>;
+
+    /**
+     *  Restart the encoding.  The next update will report all counters
+     *  which are not zero, with sequence number 0.
+     */
+    void Reset() noexcept
+    {
+        previous.clear();
+        sequence = 0;
+        restarted = true;
+    }
+
+
+    /**
+     *  Calculates the changes since the previous call
+     *
+     * @param counters  std::vector<long long> with the current value of all
+     *                  counters, indexed by the statistics names table
+     *
+     * @return ChangeList with the changed counters.  If it is empty, no
+     *         update should be sent and the sequence number is unchanged.
+     */
+    ChangeList Update(const std::vector<long long> &counters)
+    {
+        if (previous.size() != counters.size())
+        {
+            previous.resize(counters.size(), 0);
+        }
+
+        ChangeList changes;
+        for (uint32_t i = 0; i < counters.size(); ++i)
+        {
+            if (counters[i] != previous[i])
+            {
+                changes.emplace_back(i, counters[i] - previous[i]);
+                previous[i] = counters[i];
+            }
+        }
+
+        if (changes.empty())
+        {
+            return changes;
+        }
+
+        if (restarted)
+        {
+            restarted = false;
+        }
+        else
+        {
+            ++sequence;
+        }
+        return changes;
+    }
+
+
+    /**
+     * @return uint64_t with the sequence number of the last update
+     */
+    uint64_t GetSequence() const noexcept
+    {
+        return sequence;
+    }
+
+
+    /**
+     *  Applies a received update to the accumulated counter values
+     *
+     * @param totals    std::vector<int64_t> with the accumulated counter
+     *                  values, resized to fit the counter indexes
+     * @param sequence  uint64_t with the sequence number of the update
+     * @param changes   ChangeList with the received changes
+     */
+    static void Apply(std::vector<int64_t> &totals,
+                      const uint64_t sequence,
+                      const ChangeList &changes)
+    {
+        if (0 == sequence)
+        {
+            totals.assign(totals.size(), 0);
+        }
+        for (const auto &[idx, delta] : changes)
+        {
+            if (idx >= totals.size())
+            {
+                totals.resize(idx + 1, 0);
+            }
+            totals[idx] += delta;
+        }
+    }
+
+
+  private:
+    std::vector<long long> previous{};
+    uint64_t sequence = 0;
+    bool restarted = true;
+};
+
+
+/**
+ *  Names of the connection statistics counters.  The index of each name
+ *  is the index of the counter value in a ConnectionStatsSnapshot.
+ *
+ *  The names are provided by the OpenVPN 3 Core library and does not
+ *  change while the VPN client is running; this only needs to be
+ *  retrieved once and can be shared by all the snapshots.
+ */
+class ConnectionStatsSchema
+{
+  public:
+    using Ptr = std::shared_ptr<const ConnectionStatsSchema>;
+
+    /// Index used when a counter name is not found in the schema
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    [[nodiscard]] static Ptr Create(std::vector<std::string> names)
+    {
+        return Ptr(new ConnectionStatsSchema(std::move(names)));
+    }
+
+
+    size_t size() const noexcept
+    {
+        return names.size();
+    }
+
+
+    /**
+     * @param idx  size_t with the counter index
+     * @return const std::string reference to the counter name
+     */
+    const std::string &Name(const size_t idx) const
+    {
+        return names.at(idx);
+    }
+
+
+    /**
+     * @param name  std::string with the counter name to look up
+     * @return size_t with the counter index, or NOT_FOUND
+     */
+    size_t Index(const std::string &name) const noexcept
+    {
+        return find(names, name);
+    }
+
+
+    /**
+     *  Indexes of the traffic counters, looked up when the
+     *  schema is created
+     */
+    const size_t bytes_in;
+    const size_t bytes_out;
+    const size_t packets_in;
+    const size_t packets_out;
+
+
+  private:
+    const std::vector<std::string> names;
+
+    ConnectionStatsSchema(std::vector<std::string> names_)
+        : bytes_in(find(names_, "BYTES_IN")),
+          bytes_out(find(names_, "BYTES_OUT")),
+          packets_in(find(names_, "PACKETS_IN")),
+          packets_out(find(names_, "PACKETS_OUT")),
+          names(std::move(names_))
+    {
+    }
+
+    static size_t find(const std::vector<std::string> &names,
+                       const std::string &name) noexcept
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (names[i] == name)
+            {
+                return i;
+            }
+        }
+        return NOT_FOUND;
+    }
+};
+
+
+/**
+ *  Traffic rates calculated from two ConnectionStatsSnapshot objects,
+ *  all values are per second
+ */
+struct ConnectionStatsRates
+{
+    double bytes_in = 0.0;
+    double bytes_out = 0.0;
+    double packets_in = 0.0;
+    double packets_out = 0.0;
+};
+
+
+/**
+ *  The values of all the connection statistics counters at a given time.
+ *  The values are stored in the order given by the ConnectionStatsSchema,
+ *  which is the same order used in the statistics_counters D-Bus property.
+ */
+class ConnectionStatsSnapshot
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    ConnectionStatsSnapshot() = default;
+
+    /**
+     * @param schema_  ConnectionStatsSchema with the counter names
+     * @param values_  std::vector<int64_t> with all the counter values
+     * @param ts       Clock::time_point when the values were retrieved
+     */
+    ConnectionStatsSnapshot(ConnectionStatsSchema::Ptr schema_,
+                            std::vector<int64_t> values_,
+                            const Clock::time_point ts = Clock::now())
+        : schema(std::move(schema_)), values(std::move(values_)), timestamp(ts)
+    {
+    }
+
+
+    ConnectionStatsSchema::Ptr GetSchema() const noexcept
+    {
+        return schema;
+    }
+
+
+    const std::vector<int64_t> &GetValues() const noexcept
+    {
+        return values;
+    }
+
+
+    Clock::time_point GetTimestamp() const noexcept
+    {
+        return timestamp;
+    }
+
+
+    /**
+     * @param idx  size_t with the counter index
+     * @return int64_t with the counter value, 0 if the index is unknown
+     */
+    int64_t Get(const size_t idx) const noexcept
+    {
+        return (idx < values.size() ? values[idx] : 0);
+    }
+
+
+    int64_t Get(const std::string &name) const noexcept
+    {
+        return (schema ? Get(schema->Index(name)) : 0);
+    }
+
+
+    /**
+     *  Applies a StatisticsUpdate signal to this snapshot
+     *
+     * @param sequence  uint64_t with the update sequence number
+     * @param changes   ConnectionStatsDelta::ChangeList with the changes
+     * @param ts        Clock::time_point when the update was received
+     */
+    void Apply(const uint64_t sequence,
+               const ConnectionStatsDelta::ChangeList &changes,
+               const Clock::time_point ts = Clock::now())
+    {
+        ConnectionStatsDelta::Apply(values, sequence, changes);
+        timestamp = ts;
+    }
+
+
+    /**
+     *  Calculates the per second change of a counter since a previous
+     *  snapshot.  If the counter has decreased, it is considered to have
+     *  been reset to zero in between.
+     *
+     * @param previous  ConnectionStatsSnapshot taken earlier
+     * @param idx       size_t with the counter index
+     * @return double with the change per second
+     */
+    double Rate(const ConnectionStatsSnapshot &previous, const size_t idx) const noexcept
+    {
+        const std::chrono::duration<double> elapsed = timestamp - previous.timestamp;
+        if (elapsed.count() <= 0.0 || idx >= values.size())
+        {
+            return 0.0;
+        }
+        const int64_t prev = previous.Get(idx);
+        const int64_t diff = (values[idx] >= prev ? values[idx] - prev : values[idx]);
+        return diff / elapsed.count();
+    }
+
+
+    double Rate(const ConnectionStatsSnapshot &previous, const std::string &name) const noexcept
+    {
+        return (schema ? Rate(previous, schema->Index(name)) : 0.0);
+    }
+
+
+    /**
+     * @param previous  ConnectionStatsSnapshot taken earlier
+     * @return ConnectionStatsRates with the traffic rates since the
+     *         previous snapshot
+     */
+    ConnectionStatsRates GetTrafficRates(const ConnectionStatsSnapshot &previous) const noexcept
+    {
+        ConnectionStatsRates r;
+        if (schema)
+        {
+            r.bytes_in = Rate(previous, schema->bytes_in);
+            r.bytes_out = Rate(previous, schema->bytes_out);
+            r.packets_in = Rate(previous, schema->packets_in);
+            r.packets_out = Rate(previous, schema->packets_out);
+        }
+        return r;
+    }
+
+
+    /**
+     * @return ConnectionStats with the name and value of all counters
+     *         which are not zero
+     */
+    ConnectionStats GetConnectionStats() const
+    {
+        ConnectionStats ret;
+        if (!schema)
+        {
+            return ret;
+        }
+        for (size_t i = 0; i < values.size() && i < schema->size(); ++i)
+        {
+            if (values[i])
+            {
+                ret.emplace_back(schema->Name(i), values[i]);
+            }
+        }
+        return ret;
+    }
+
+
+  private:
+    ConnectionStatsSchema::Ptr schema = nullptr;
+    std::vector<int64_t> values{};
+    Clock::time_point timestamp{};
+};
@@ -13,11 +13,13 @@
  */
 
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <cstdlib>
@@ -297,6 +299,39 @@ void ParsedArgs::remove_arg(const std::string &opt)
 }
 
 
+unsigned long parse_option_number(const std::string &command,
+                                  ParsedArgs::Ptr args,
+                                  const std::string &opt,
+                                  const unsigned long min,
+                                  const unsigned long max)
+{
+    const std::string val = args->GetLastValue(opt);
+    try
+    {
+        // std::stoul() silently accepts negative values and skips
+        // leading white space
+        if (val.empty() || !std::isdigit(static_cast<unsigned char>(val[0])))
+        {
+            throw std::invalid_argument(val);
+        }
+        size_t end = 0;
+        unsigned long ret = std::stoul(val, &end);
+        if (end != val.size() || ret < min || ret > max)
+        {
+            throw std::out_of_range(val);
+        }
+        return ret;
+    }
+    catch (const std::logic_error &)
+    {
+        throw CommandException(command,
+                               "--" + opt + " must be between "
+                                   + std::to_string(min) + " and "
+                                   + std::to_string(max));
+    }
+}
+
+
 
 //
 //  RegisterParsedArgs implementation
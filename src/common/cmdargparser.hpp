@@ -318,6 +318,27 @@ class ParsedArgs
     void remove_arg(const std::string &opt);
 };
 
+
+/**
+ *  Parses the numeric value of a command line option, which must be
+ *  within a given range.  The last value given to the option is used.
+ *
+ * @param command  std::string with the command name used in the exception
+ * @param args     ParsedArgs::Ptr with the command line options
+ * @param opt      std::string with the option name
+ * @param min      unsigned long with the lowest valid value
+ * @param max      unsigned long with the highest valid value
+ *
+ * @return unsigned long with the parsed value
+ *
+ * @throws CommandException if the value is not a number in the range
+ */
+unsigned long parse_option_number(const std::string &command,
+                                  ParsedArgs::Ptr args,
+                                  const std::string &opt,
+                                  const unsigned long min,
+                                  const unsigned long max);
+
 /**
  *  Simplistic internal specification of callback function APIs
  */
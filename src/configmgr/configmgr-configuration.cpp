@@ -14,6 +14,7 @@
 #include <cstdio>
 #include <ctime>
 #include <set>
+#include <sstream>
 #include <fmt/ranges.h>
 
 #include "common/lookup.hpp"
@@ -27,8 +28,9 @@ namespace ConfigManager {
 
 Configuration::Configuration(DBus::Connection::Ptr dbuscon,
                              DBus::Object::Manager::Ptr object_manager,
-                             DBus::Credentials::Query::Ptr creds_qry,
+                             GDBusPP::Credentials::Cache::Ptr creds_qry,
                              ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr,
+                             PersistentStorage::Ptr storage,
                              const DBus::Object::Path &config_path,
                              const std::string &state_dir,
                              const std::string &name,
@@ -40,7 +42,8 @@ Configuration::Configuration(DBus::Connection::Ptr dbuscon,
                              LogWriter::Ptr logwr)
     : DBus::Object::Base(config_path, INTERFACE_CONFIGMGR),
       object_manager_(std::move(object_manager)), creds_qry_(std::move(creds_qry)),
-      sig_configmgr_(std::move(sig_configmgr)), state_dir_(state_dir),
+      sig_configmgr_(std::move(sig_configmgr)), storage_(std::move(storage)),
+      state_dir_(state_dir),
       prop_name_(filter_ctrl_chars(name, true)),
       prop_persistent_(persistent), prop_single_use_(single_use),
       prop_import_timestamp_(std::time(nullptr))
@@ -90,15 +93,17 @@ Configuration::Configuration(DBus::Connection::Ptr dbuscon,
 
 Configuration::Configuration(DBus::Connection::Ptr dbuscon,
                              DBus::Object::Manager::Ptr object_manager,
-                             DBus::Credentials::Query::Ptr creds_qry,
+                             GDBusPP::Credentials::Cache::Ptr creds_qry,
                              ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr,
+                             PersistentStorage::Ptr storage,
                              const std::string &filename,
                              Json::Value profile,
                              uint8_t loglevel,
                              LogWriter::Ptr logwr)
     : DBus::Object::Base(profile["object_path"].asString(), INTERFACE_CONFIGMGR),
       object_manager_(std::move(object_manager)), creds_qry_(std::move(creds_qry)),
-      sig_configmgr_(std::move(sig_configmgr)), persistent_file_(filename)
+      sig_configmgr_(std::move(sig_configmgr)), storage_(std::move(storage)),
+      persistent_file_(filename)
 {
     prop_persistent_ = !persistent_file_.empty();
 
@@ -172,9 +177,21 @@ Configuration::Configuration(DBus::Connection::Ptr dbuscon,
         }
     }
 
-    // Parse the options from the imported configuration
-    options_.json_import(profile["profile"]);
-    validate_profile();
+    // The profile content is parsed on the first access to it.  This
+    // speeds up the service start-up with many persistent profiles.  The
+    // 'valid' flag from the file is used until the profile is parsed;
+    // older files without this flag are parsed right away.
+    if (profile.isMember("valid"))
+    {
+        unparsed_profile_ = std::move(profile["profile"]);
+    }
+    else
+    {
+        unparsed_profile_ = std::move(profile["profile"]);
+        options_.json_import(get_unparsed_profile());
+        unparsed_profile_.reset();
+        validate_profile();
+    }
 
     add_methods();
     add_properties();
@@ -331,6 +348,7 @@ void Configuration::add_methods()
         "Validate",
         [&](DBus::Object::Method::Arguments::Ptr args)
         {
+            load_profile_options();
             std::string validation = validate_profile();
             if (!validation.empty())
             {
@@ -410,7 +428,7 @@ void Configuration::add_methods()
 
                 prop_used_count_++;
                 prop_last_used_timestamp_ = std::time(nullptr);
-                update_persistent_file();
+                update_persistent_usage();
             }
         });
 
@@ -583,6 +601,42 @@ void Configuration::add_properties()
  *         configuration profile
  */
 Json::Value Configuration::Export() const
+{
+    Json::Value ret = export_properties();
+    ret["profile"] = (unparsed_profile_ ? get_unparsed_profile() : options_.json_export());
+    return ret;
+}
+
+
+std::string Configuration::ExportJSON() const
+{
+    if (!unparsed_profile_ || !unparsed_profile_->isString())
+    {
+        std::ostringstream data;
+        data << Export();
+        return data.str();
+    }
+
+    // Profiles loaded from the state snapshot carry the profile content
+    // as JSON text.  Write it back as-is instead of parsing it only to
+    // serialize it again.
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string data = Json::writeString(builder, export_properties());
+
+    const char *content = nullptr;
+    const char *content_end = nullptr;
+    unparsed_profile_->getString(&content, &content_end);
+
+    data.pop_back(); // Closing '}' of the properties object
+    data += ",\"profile\":";
+    data.append(content, content_end - content);
+    data += "}";
+    return data;
+}
+
+
+Json::Value Configuration::export_properties() const
 {
     Json::Value ret;
 
@@ -606,7 +660,6 @@ Json::Value Configuration::Export() const
     ret["single_use"] = prop_single_use_;
     ret["used_count"] = prop_used_count_;
     ret["valid"] = prop_valid_;
-    ret["profile"] = options_.json_export();
     ret["dco"] = prop_dco_;
 
     ret["public_access"] = object_acl_->GetPublicAccess();
@@ -642,6 +695,7 @@ void Configuration::TransferOwnership(uid_t new_owner_uid)
         lookup_username(old_owner_uid),
         lookup_username(new_owner_uid)
     ));
+    update_index();
     update_persistent_file();
 }
 
@@ -657,6 +711,15 @@ bool Configuration::CheckACL(const std::string &caller, bool grant_root) const n
 }
 
 
+void Configuration::update_index()
+{
+    if (index_)
+    {
+        index_->Update(GetPath(), prop_name_, GetOwnerUID(), prop_tags_);
+    }
+}
+
+
 void Configuration::update_persistent_file()
 {
     if (persistent_file_.empty())
@@ -666,13 +729,81 @@ void Configuration::update_persistent_file()
         return;
     }
 
-    std::ofstream state(persistent_file_);
-    state << Export();
+    if (storage_)
+    {
+        storage_->SaveProfile(persistent_file_, ExportJSON());
+    }
+    else
+    {
+        std::ofstream state(persistent_file_);
+        state << ExportJSON();
+    }
 
     signals_->LogVerb2("Updated persistent config: " + persistent_file_);
 }
 
 
+void Configuration::update_persistent_usage()
+{
+    if (persistent_file_.empty())
+    {
+        return;
+    }
+
+    if (!storage_ || !storage_->IsWriteBehind())
+    {
+        // Without the storage engine, the usage counters can only be
+        // saved as part of the complete profile.  Without write-behind,
+        // the profile is written the same way as before the .usage
+        // side-car file existed.
+        update_persistent_file();
+        return;
+    }
+
+    storage_->SaveUsage(persistent_file_,
+                        {prop_used_count_, prop_last_used_timestamp_});
+    signals_->Debug("Updated usage counters for persistent config: " + persistent_file_);
+}
+
+
+void Configuration::load_profile_options()
+{
+    if (!unparsed_profile_)
+    {
+        return;
+    }
+
+    try
+    {
+        options_.json_import(get_unparsed_profile());
+    }
+    catch (const std::exception &excp)
+    {
+        options_.clear();
+        signals_->LogCritical("Could not parse configuration profile "
+                              + persistent_file_ + ": " + excp.what());
+        throw DBus::Object::Method::Exception("Invalid configuration profile");
+    }
+    unparsed_profile_.reset();
+    validate_profile();
+    signals_->Debug("Parsed persistent configuration profile content");
+}
+
+
+Json::Value Configuration::get_unparsed_profile() const
+{
+    if (!unparsed_profile_->isString())
+    {
+        return *unparsed_profile_;
+    }
+
+    Json::Value profile;
+    std::istringstream content(unparsed_profile_->asString());
+    content >> profile;
+    return profile;
+}
+
+
 std::string Configuration::validate_profile() noexcept
 {
     bool client_configured = false;
@@ -751,6 +882,8 @@ std::string Configuration::validate_profile() noexcept
 
 void Configuration::method_fetch(DBus::Object::Method::Arguments::Ptr args, bool json)
 {
+    load_profile_options();
+
     std::stringstream config;
 
     if (json)
@@ -788,6 +921,7 @@ void Configuration::method_add_tag(DBus::Object::Method::Arguments::Ptr args)
     }
 
     prop_tags_.push_back(std::move(tag));
+    update_index();
     update_persistent_file();
 }
 
@@ -816,6 +950,7 @@ void Configuration::method_remove_tag(DBus::Object::Method::Arguments::Ptr args)
     }
 
     prop_tags_.erase(it);
+    update_index();
     update_persistent_file();
 }
 
@@ -915,6 +1050,7 @@ void Configuration::method_access_revoke(DBus::Object::Method::Arguments::Ptr ar
 
 void Configuration::method_seal()
 {
+    load_profile_options();
     if (!prop_valid_)
         throw DBus::Object::Method::Exception("Configuration is not currently valid");
 
@@ -925,11 +1061,20 @@ void Configuration::method_seal()
 
 void Configuration::method_remove()
 {
+    if (index_)
+    {
+        index_->Remove(GetPath());
+    }
     object_manager_->RemoveObject(GetPath());
 
     if (!persistent_file_.empty())
     {
-        if (std::remove(persistent_file_.c_str()) != 0)
+        if (storage_)
+        {
+            // Errors are reported via the PersistentStorage error handler
+            storage_->Remove(persistent_file_);
+        }
+        else if (std::remove(persistent_file_.c_str()) != 0)
         {
             signals_->LogError("Failed to delete profile file: " + std::string(::strerror(errno)));
         };
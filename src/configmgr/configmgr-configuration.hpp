@@ -12,18 +12,21 @@
 #pragma once
 
 #include <ctime>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
 #include <gdbuspp/authz-request.hpp>
 #include <gdbuspp/service.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/base.hpp>
 
+#include "dbus/credentials-cache.hpp"
 #include "log/core-dbus-logger.hpp"
 #include "common/core-extensions.hpp"
 #include "dbus/object-ownership.hpp"
 #include "log/logwriter.hpp"
+#include "configmgr-index.hpp"
+#include "configmgr-persistence.hpp"
 #include "configmgr-signals.hpp"
 #include "overrides.hpp"
 
@@ -42,6 +45,7 @@ class Configuration : public DBus::Object::Base
 {
   public:
     using Ptr = std::shared_ptr<Configuration>;
+    using Index = ConfigurationIndex<Configuration>;
 
   public:
     /**
@@ -52,6 +56,8 @@ class Configuration : public DBus::Object::Base
      *                       when the Remove() method is called
      * @param creds_qry Used to retrieve method caller information
      * @param sig_configmgr Needed to signal CFG_{CREATED, DESTROYED} events
+     * @param storage PersistentStorage engine used to write persistent
+     *                configurations to disk
      * @param config_path D-Bus path for this object
      * @param state_dir Directory used to store persistent configurations in
      * @param name User-friendly name for the configuration
@@ -67,8 +73,9 @@ class Configuration : public DBus::Object::Base
      */
     Configuration(DBus::Connection::Ptr dbuscon,
                   DBus::Object::Manager::Ptr object_manager,
-                  DBus::Credentials::Query::Ptr creds_qry,
+                  GDBusPP::Credentials::Cache::Ptr creds_qry,
                   ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr,
+                  PersistentStorage::Ptr storage,
                   const DBus::Object::Path &config_path,
                   const std::string &state_dir,
                   const std::string &name,
@@ -87,6 +94,8 @@ class Configuration : public DBus::Object::Base
      *                       when the Remove() method is called
      * @param creds_qry Used to retrieve method caller information
      * @param sig_configmgr Needed to signal CFG_{CREATED, DESTROYED} events
+     * @param storage PersistentStorage engine used to write persistent
+     *                configurations to disk
      * @param filename File to save the configuration to on updates (if this
      *                 configuration is persistent)
      * @param profile JSON representation of the configuration settings
@@ -95,8 +104,9 @@ class Configuration : public DBus::Object::Base
      */
     Configuration(DBus::Connection::Ptr dbuscon,
                   DBus::Object::Manager::Ptr object_manager,
-                  DBus::Credentials::Query::Ptr creds_qry,
+                  GDBusPP::Credentials::Cache::Ptr creds_qry,
                   ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr,
+                  PersistentStorage::Ptr storage,
                   const std::string &filename,
                   Json::Value profile,
                   uint8_t loglevel,
@@ -124,6 +134,15 @@ class Configuration : public DBus::Object::Base
      */
     Json::Value Export() const;
 
+    /**
+     *  Exports the configuration in the same way as Export(), serialized
+     *  as JSON text.  A profile not yet parsed since it was loaded from
+     *  the state snapshot is not parsed by this method.
+     *
+     * @return std::string with the JSON text of the configuration profile
+     */
+    std::string ExportJSON() const;
+
     /**
      *   Transfer ownership of this configuration object
      *
@@ -154,6 +173,17 @@ class Configuration : public DBus::Object::Base
         return std::find(prop_tags_.begin(), prop_tags_.end(), tag) != prop_tags_.end();
     }
 
+    /**
+     *  Retrieve all tags assigned to this configuration
+     *
+     * @return Returns a const reference to a std::vector<std::string>
+     *         with all the tags
+     */
+    const std::vector<std::string> &GetTags() const noexcept
+    {
+        return prop_tags_;
+    }
+
     /**
      *  Retrieve the configuration name
      *
@@ -174,11 +204,61 @@ class Configuration : public DBus::Object::Base
      */
     bool CheckACL(const std::string &caller, bool grant_root = false) const noexcept;
 
+    /**
+     *  Assign the lookup index this object must keep updated when the
+     *  name, tags or owner changes.  The object must already have been
+     *  added to the index.
+     *
+     * @param index  Configuration::Index::Ptr to the lookup index
+     */
+    void SetIndex(Index::Ptr index) noexcept
+    {
+        index_ = std::move(index);
+    }
+
   private:
     void add_methods();
     void add_properties();
     void update_persistent_file();
 
+    /**
+     *  Refresh the lookup index entry of this object after the name,
+     *  tags or owner has changed
+     */
+    void update_index();
+
+    /**
+     *  Only saves the usage counters (used_count, last_used_timestamp)
+     *  of a persistent configuration.  This avoids rewriting the complete
+     *  profile each time it is fetched by a VPN backend client.
+     */
+    void update_persistent_usage();
+
+    /**
+     *  Persistent configurations loaded from disk only carries the
+     *  JSON representation of the profile until it is needed.  This
+     *  parses the profile into options_ and validates it, if not already
+     *  done.
+     */
+    void load_profile_options();
+
+    /**
+     *  Retrieve the JSON representation of a profile not yet parsed
+     *  into options_.  Profiles loaded from the state snapshot carry
+     *  the profile as JSON text, which is parsed here.
+     *
+     * @return Json::Value with the profile options
+     */
+    Json::Value get_unparsed_profile() const;
+
+    /**
+     *  Exports all the configuration object properties, except the
+     *  profile content itself.  See Export().
+     *
+     * @return Json::Value
+     */
+    Json::Value export_properties() const;
+
     /**
      *  Very simple validation of the configuration profile.
      *  Currently only checks if --dev, --remote, --ca and
@@ -280,6 +360,7 @@ class Configuration : public DBus::Object::Base
                     << " - Property " << prop.GetName()
                     << " changed to '" << property_var << "'";
                 signals_->LogVerb2(msg.str());
+                update_index();
                 update_persistent_file();
 
                 return upd;
@@ -288,8 +369,10 @@ class Configuration : public DBus::Object::Base
 
   private:
     DBus::Object::Manager::Ptr object_manager_;
-    DBus::Credentials::Query::Ptr creds_qry_;
+    GDBusPP::Credentials::Cache::Ptr creds_qry_;
     ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr_;
+    PersistentStorage::Ptr storage_;
+    Index::Ptr index_;
     ConfigManager::Log::Ptr signals_;
     GDBusPP::Object::Extension::ACL::Ptr object_acl_;
     std::string state_dir_;
@@ -307,6 +390,14 @@ class Configuration : public DBus::Object::Base
     bool prop_valid_{false};
     std::string persistent_file_;
     openvpn::OptionListJSON options_;
+
+    /**
+     *  JSON representation of the profile not yet parsed into options_,
+     *  either as a JSON object or as a string with the JSON text.
+     *  See load_profile_options()
+     */
+    std::optional<Json::Value> unparsed_profile_;
+
     std::vector<Override> override_list_;
 
     /**
@@ -0,0 +1,284 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file configmgr-index.hpp
+ *
+ * @brief  Secondary lookup indexes for configuration profile objects,
+ *         used by the LookupConfigName, SearchByTag and SearchByOwner
+ *         methods to avoid scanning all configuration objects.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+
+namespace ConfigManager {
+
+/**
+ *  Keeps track of configuration profile objects by their D-Bus path,
+ *  with secondary indexes on the configuration name, tags and owner UID.
+ *
+ *  The index only keeps weak references to the objects; the object
+ *  lifetime is managed by the D-Bus object manager.  Objects must be
+ *  removed from the index when they are removed from the D-Bus.
+ *
+ *  The object type T must provide these methods:
+ *    - GetPath()      - D-Bus object path
+ *    - GetName()      - configuration profile name
+ *    - GetOwnerUID()  - UID of the profile owner
+ *    - GetTags()      - std::vector<std::string> of all assigned tags
+ *
+ * @tparam T  Object type being indexed
+ */
+template <typename T>
+class ConfigurationIndex
+{
+  public:
+    using Ptr = std::shared_ptr<ConfigurationIndex<T>>;
+    using ObjectList = std::vector<std::shared_ptr<T>>;
+
+    [[nodiscard]] static Ptr Create()
+    {
+        return Ptr(new ConfigurationIndex<T>());
+    }
+
+
+    /**
+     *  Add a new object to the index
+     *
+     * @param obj  std::shared_ptr<T> to the object
+     */
+    void Add(std::shared_ptr<T> obj)
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+
+        const std::string path = obj->GetPath();
+        remove_secondary(path);
+
+        Record &rec = records_[path];
+        rec.object = obj;
+        rec.name = obj->GetName();
+        rec.owner = obj->GetOwnerUID();
+        rec.tags = std::set<std::string>(obj->GetTags().begin(),
+                                         obj->GetTags().end());
+        add_secondary(path, rec);
+    }
+
+
+    /**
+     *  Update the indexed values of an object already in the index.
+     *  Unknown paths are ignored.
+     *
+     * @param path   std::string with the D-Bus path of the object
+     * @param name   std::string with the current configuration name
+     * @param owner  uid_t of the current owner
+     * @param tags   std::vector<std::string> of all current tags
+     */
+    void Update(const std::string &path,
+                const std::string &name,
+                uid_t owner,
+                const std::vector<std::string> &tags)
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+
+        auto it = records_.find(path);
+        if (records_.end() == it)
+        {
+            return;
+        }
+
+        remove_secondary(path);
+        it->second.name = name;
+        it->second.owner = owner;
+        it->second.tags = std::set<std::string>(tags.begin(), tags.end());
+        add_secondary(path, it->second);
+    }
+
+
+    /**
+     *  Remove an object from the index
+     *
+     * @param path  std::string with the D-Bus path of the object
+     */
+    void Remove(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        remove_secondary(path);
+        records_.erase(path);
+    }
+
+
+    /**
+     *  Retrieve an object by its D-Bus path
+     *
+     * @param path  std::string with the D-Bus path to look up
+     *
+     * @return std::shared_ptr<T> to the object, nullptr if not found
+     */
+    std::shared_ptr<T> Get(const std::string &path) const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        auto it = records_.find(path);
+        return (records_.end() != it ? it->second.object.lock() : nullptr);
+    }
+
+
+    /**
+     *  Retrieve all objects with the given configuration name
+     *
+     * @param name  std::string with the configuration name
+     * @return ObjectList of all matching objects
+     */
+    ObjectList LookupName(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        return resolve(by_name_, name);
+    }
+
+
+    /**
+     *  Retrieve all objects tagged with the given tag
+     *
+     * @param tag  std::string with the tag to look for
+     * @return ObjectList of all matching objects
+     */
+    ObjectList LookupTag(const std::string &tag) const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        return resolve(by_tag_, tag);
+    }
+
+
+    /**
+     *  Retrieve all objects owned by the given user
+     *
+     * @param owner  uid_t of the owner
+     * @return ObjectList of all matching objects
+     */
+    ObjectList LookupOwner(uid_t owner) const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        return resolve(by_owner_, owner);
+    }
+
+
+    /**
+     *  Retrieve the number of objects in the index
+     *
+     * @return size_t
+     */
+    size_t Size() const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        return records_.size();
+    }
+
+
+  private:
+    struct Record
+    {
+        std::weak_ptr<T> object;
+        std::string name;
+        uid_t owner;
+        std::set<std::string> tags;
+    };
+
+    /**
+     *  Objects matching a single secondary index key, ordered by the
+     *  D-Bus path.  The weak reference is kept here as well, so a lookup
+     *  does not need to go via the records_ map.
+     */
+    using PathSet = std::map<std::string, std::weak_ptr<T>>;
+
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, Record> records_;
+    std::unordered_map<std::string, PathSet> by_name_;
+    std::unordered_map<std::string, PathSet> by_tag_;
+    std::map<uid_t, PathSet> by_owner_;
+
+    ConfigurationIndex() = default;
+
+
+    void add_secondary(const std::string &path, const Record &rec)
+    {
+        by_name_[rec.name].emplace(path, rec.object);
+        by_owner_[rec.owner].emplace(path, rec.object);
+        for (const auto &tag : rec.tags)
+        {
+            by_tag_[tag].emplace(path, rec.object);
+        }
+    }
+
+
+    void remove_secondary(const std::string &path)
+    {
+        auto it = records_.find(path);
+        if (records_.end() == it)
+        {
+            return;
+        }
+
+        const Record &rec = it->second;
+        erase_path(by_name_, rec.name, path);
+        erase_path(by_owner_, rec.owner, path);
+        for (const auto &tag : rec.tags)
+        {
+            erase_path(by_tag_, tag, path);
+        }
+    }
+
+
+    template <typename MAP, typename KEY>
+    static void erase_path(MAP &index, const KEY &key, const std::string &path)
+    {
+        auto it = index.find(key);
+        if (index.end() == it)
+        {
+            return;
+        }
+        it->second.erase(path);
+        if (it->second.empty())
+        {
+            index.erase(it);
+        }
+    }
+
+
+    template <typename MAP, typename KEY>
+    ObjectList resolve(const MAP &index, const KEY &key) const
+    {
+        ObjectList result;
+
+        auto it = index.find(key);
+        if (index.end() == it)
+        {
+            return result;
+        }
+
+        result.reserve(it->second.size());
+        for (const auto &[path, object] : it->second)
+        {
+            if (auto obj = object.lock())
+            {
+                result.push_back(std::move(obj));
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace ConfigManager
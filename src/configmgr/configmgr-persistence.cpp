@@ -0,0 +1,462 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file configmgr-persistence.cpp
+ *
+ * @brief  Implementation of the write-behind storage engine for persistent
+ *         configuration profiles
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "configmgr-exceptions.hpp"
+#include "configmgr-persistence.hpp"
+
+
+namespace ConfigManager {
+
+PersistentStorage::Ptr PersistentStorage::Create(ErrorHandler errhandler,
+                                                 std::chrono::milliseconds flush_delay,
+                                                 size_t flush_threshold)
+{
+    return PersistentStorage::Ptr(new PersistentStorage(std::move(errhandler),
+                                                        flush_delay,
+                                                        flush_threshold));
+}
+
+
+PersistentStorage::PersistentStorage(ErrorHandler errhandler,
+                                     std::chrono::milliseconds flush_delay,
+                                     size_t flush_threshold)
+    : errhandler_(std::move(errhandler)),
+      flush_delay_(flush_delay),
+      flush_threshold_(std::max<size_t>(1, flush_threshold))
+{
+    if (flush_delay_.count() > 0)
+    {
+        async_worker_ = std::async(std::launch::async,
+                                   [this]()
+                                   {
+                                       worker();
+                                   });
+    }
+}
+
+
+PersistentStorage::~PersistentStorage() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lg(pending_mtx_);
+        shutdown_ = true;
+    }
+    pending_cv_.notify_all();
+
+    if (async_worker_.valid())
+    {
+        async_worker_.wait();
+    }
+
+    // Catch anything queued after the worker thread completed
+    try
+    {
+        flush_pending();
+    }
+    catch (...)
+    {
+    }
+}
+
+
+void PersistentStorage::SaveProfile(const std::string &filename, const Json::Value &profile)
+{
+    std::ostringstream data;
+    data << profile;
+    SaveProfile(filename, data.str());
+}
+
+
+void PersistentStorage::SaveProfile(const std::string &filename, std::string profile)
+{
+    enqueue(filename,
+            [profile = std::move(profile)](PendingWrite &entry) mutable
+            {
+                entry.profile = std::move(profile);
+
+                // The profile carries the current usage counters as well
+                entry.usage.reset();
+            });
+}
+
+
+void PersistentStorage::SaveUsage(const std::string &filename, const UsageCounters &usage)
+{
+    enqueue(filename,
+            [usage](PendingWrite &entry)
+            {
+                entry.usage = usage;
+            });
+}
+
+
+bool PersistentStorage::Remove(const std::string &filename)
+{
+    std::lock_guard<std::mutex> io_lock(io_mtx_);
+    {
+        std::lock_guard<std::mutex> lg(pending_mtx_);
+        pending_.erase(filename);
+    }
+
+    // The usage file might not exist; that is not an error
+    std::remove(GetUsageFilename(filename).c_str());
+
+    if (std::remove(filename.c_str()) != 0)
+    {
+        report_error("Failed to delete profile file: " + std::system_category().message(errno));
+        return false;
+    }
+    return true;
+}
+
+
+void PersistentStorage::Flush()
+{
+    flush_pending();
+}
+
+
+size_t PersistentStorage::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lg(pending_mtx_);
+    return pending_.size();
+}
+
+
+std::string PersistentStorage::GetUsageFilename(const std::string &profile_file)
+{
+    // <uuid>.json => <uuid>.usage
+    static const std::string json_ext{".json"};
+    if (profile_file.size() > json_ext.size()
+        && 0 == profile_file.compare(profile_file.size() - json_ext.size(), json_ext.size(), json_ext))
+    {
+        return profile_file.substr(0, profile_file.size() - json_ext.size()) + ".usage";
+    }
+    return profile_file + ".usage";
+}
+
+
+bool PersistentStorage::LoadUsage(const std::string &profile_file, Json::Value &profile)
+{
+    std::ifstream usagefile(GetUsageFilename(profile_file), std::ifstream::binary);
+    if (!usagefile.is_open())
+    {
+        return false;
+    }
+
+    Json::Value usage;
+    try
+    {
+        usagefile >> usage;
+    }
+    catch (const Json::Exception &)
+    {
+        // A broken usage file is not fatal; the profile has the
+        // counters from the last time it was written.
+        return false;
+    }
+
+    if (!usage.isObject()
+        || !usage["used_count"].isUInt()
+        || !usage["last_used_timestamp"].isUInt64())
+    {
+        return false;
+    }
+
+    profile["used_count"] = usage["used_count"];
+    profile["last_used_timestamp"] = usage["last_used_timestamp"];
+    return true;
+}
+
+
+std::vector<LoadedProfile> PersistentStorage::LoadProfiles(const std::vector<std::string> &files,
+                                                           unsigned int threads,
+                                                           ProfileSnapshot::Ptr snapshot)
+{
+    std::vector<LoadedProfile> result(files.size());
+    if (files.empty())
+    {
+        return result;
+    }
+
+    if (0 == threads)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<size_t>(threads, files.size());
+
+    // Each worker processes every n-th file; each result slot is only
+    // touched by a single worker thread
+    auto load_worker = [&files, &result, &snapshot, threads](unsigned int first)
+    {
+        for (size_t idx = first; idx < files.size(); idx += threads)
+        {
+            LoadedProfile &entry = result[idx];
+            entry.filename = files[idx];
+            try
+            {
+                struct stat st;
+                if (::stat(entry.filename.c_str(), &st) != 0)
+                {
+                    entry.error = "Could not open file: " + std::system_category().message(errno);
+                    continue;
+                }
+                entry.stamp = ProfileSnapshot::SourceStamp::FromStat(st);
+
+                if (snapshot)
+                {
+                    const std::string &fname = entry.filename;
+                    auto sep = fname.rfind('/');
+                    std::string_view file_id(fname);
+                    file_id.remove_prefix(std::string::npos == sep ? 0 : sep + 1);
+
+                    if (snapshot->Lookup(file_id, entry.stamp, entry.profile))
+                    {
+                        entry.from_snapshot = true;
+                        LoadUsage(entry.filename, entry.profile);
+                        continue;
+                    }
+                }
+
+                std::ifstream statefile(entry.filename, std::ifstream::binary);
+                if (!statefile.is_open())
+                {
+                    entry.error = "Could not open file: " + std::system_category().message(errno);
+                    continue;
+                }
+                statefile >> entry.profile;
+                LoadUsage(entry.filename, entry.profile);
+            }
+            catch (const std::exception &excp)
+            {
+                entry.error = excp.what();
+            }
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (unsigned int worker = 1; worker < threads; ++worker)
+    {
+        workers.push_back(std::async(std::launch::async, load_worker, worker));
+    }
+    load_worker(0);
+
+    for (auto &w : workers)
+    {
+        w.wait();
+    }
+    return result;
+}
+
+
+void PersistentStorage::WriteFileAtomic(const std::string &filename,
+                                        const std::string &content)
+{
+    const std::string tmpfile = filename + ".tmp";
+
+    int fd = ::open(tmpfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        throw ConfigManager::Exception("Could not open '" + tmpfile + "': "
+                                       + std::system_category().message(errno));
+    }
+
+    const char *buf = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0)
+    {
+        ssize_t ret = ::write(fd, buf, remaining);
+        if (ret < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            int err = errno;
+            ::close(fd);
+            std::remove(tmpfile.c_str());
+            throw ConfigManager::Exception("Could not write '" + tmpfile + "': "
+                                           + std::system_category().message(err));
+        }
+        buf += ret;
+        remaining -= static_cast<size_t>(ret);
+    }
+
+    if (::fsync(fd) != 0 || ::close(fd) != 0)
+    {
+        int err = errno;
+        std::remove(tmpfile.c_str());
+        throw ConfigManager::Exception("Could not complete writing '" + tmpfile + "': "
+                                       + std::system_category().message(err));
+    }
+
+    if (::rename(tmpfile.c_str(), filename.c_str()) != 0)
+    {
+        int err = errno;
+        std::remove(tmpfile.c_str());
+        throw ConfigManager::Exception("Could not rename '" + tmpfile + "' to '"
+                                       + filename + "': " + std::system_category().message(err));
+    }
+}
+
+
+void PersistentStorage::worker()
+{
+    std::unique_lock<std::mutex> lock(pending_mtx_);
+    while (!shutdown_)
+    {
+        if (pending_.empty())
+        {
+            pending_cv_.wait(lock);
+            continue;
+        }
+
+        // Wait until the oldest pending change has been kept long
+        // enough or the threshold of pending profiles is reached
+        if (pending_.size() < flush_threshold_
+            && pending_cv_.wait_until(lock, oldest_pending_ + flush_delay_)
+                   == std::cv_status::no_timeout)
+        {
+            // Woken up by a new change, shutdown or a spurious wakeup;
+            // re-evaluate the situation
+            continue;
+        }
+
+        lock.unlock();
+        flush_pending();
+        lock.lock();
+    }
+    lock.unlock();
+
+    flush_pending();
+}
+
+
+void PersistentStorage::enqueue(const std::string &filename,
+                                std::function<void(PendingWrite &)> update)
+{
+    if (!async_worker_.valid())
+    {
+        // No write-behind; write it out immediately
+        PendingWrite entry;
+        update(entry);
+
+        std::lock_guard<std::mutex> io_lock(io_mtx_);
+        write_entry(filename, entry);
+        return;
+    }
+
+    bool wakeup = false;
+    {
+        std::lock_guard<std::mutex> lg(pending_mtx_);
+        if (pending_.empty())
+        {
+            oldest_pending_ = std::chrono::steady_clock::now();
+            wakeup = true;
+        }
+        update(pending_[filename]);
+        wakeup |= (pending_.size() >= flush_threshold_);
+    }
+
+    if (wakeup)
+    {
+        pending_cv_.notify_one();
+    }
+}
+
+
+void PersistentStorage::flush_pending()
+{
+    std::lock_guard<std::mutex> io_lock(io_mtx_);
+
+    PendingQueue queue;
+    {
+        std::lock_guard<std::mutex> lg(pending_mtx_);
+        queue.swap(pending_);
+    }
+
+    for (const auto &[filename, entry] : queue)
+    {
+        write_entry(filename, entry);
+    }
+}
+
+
+void PersistentStorage::write_entry(const std::string &filename,
+                                    const PendingWrite &entry)
+{
+    try
+    {
+        if (entry.profile)
+        {
+            WriteFileAtomic(filename, *entry.profile);
+
+            if (!entry.usage)
+            {
+                // The profile now contains the most recent usage
+                // counters, the side-car file is no longer needed
+                std::remove(GetUsageFilename(filename).c_str());
+            }
+        }
+
+        if (entry.usage)
+        {
+            Json::Value usage;
+            usage["used_count"] = entry.usage->used_count;
+            usage["last_used_timestamp"] = (Json::Value::UInt64)entry.usage->last_used_timestamp;
+
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            WriteFileAtomic(GetUsageFilename(filename),
+                            Json::writeString(builder, usage));
+        }
+    }
+    catch (const std::exception &excp)
+    {
+        report_error("Failed to update persistent config " + filename
+                     + ": " + std::string(excp.what()));
+    }
+}
+
+
+void PersistentStorage::report_error(const std::string &msg) const noexcept
+{
+    if (!errhandler_)
+    {
+        return;
+    }
+
+    try
+    {
+        errhandler_(msg);
+    }
+    catch (...)
+    {
+    }
+}
+
+} // namespace ConfigManager
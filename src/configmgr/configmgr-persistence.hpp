@@ -0,0 +1,313 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file configmgr-persistence.hpp
+ *
+ * @brief  Write-behind storage engine for persistent configuration profiles.
+ *
+ *         Changes to persistent configuration profiles are queued and
+ *         coalesced per file, and written to disk by a background worker
+ *         thread after a bounded delay or when enough profiles are pending.
+ *         Frequently changing usage counters (used_count,
+ *         last_used_timestamp) are kept in a small side-car file next to
+ *         the profile, so a Fetch() call does not require rewriting the
+ *         complete profile.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+#include "configmgr-snapshot.hpp"
+
+
+namespace ConfigManager {
+
+/**
+ *  Volatile usage information of a configuration profile.  This is
+ *  updated each time a VPN backend client fetches the profile.
+ */
+struct UsageCounters
+{
+    unsigned int used_count = 0;
+    std::time_t last_used_timestamp = 0;
+};
+
+
+
+/**
+ *  A persistent configuration profile file loaded from the state directory
+ */
+struct LoadedProfile
+{
+    /// Filename of the loaded profile
+    std::string filename;
+
+    /// The parsed profile, including the usage counters from the
+    /// usage side-car file
+    Json::Value profile;
+
+    /// If the file could not be loaded, the reason is found here
+    std::string error;
+
+    /// Time stamp and size of the profile file when it was loaded
+    ProfileSnapshot::SourceStamp stamp;
+
+    /// Set if the profile was retrieved from the snapshot file instead
+    /// of being parsed from the JSON file
+    bool from_snapshot = false;
+};
+
+
+
+/**
+ *  Handles all writes of persistent configuration profiles to the
+ *  state directory.
+ *
+ *  All file updates are done with a write to a temporary file which is
+ *  renamed over the destination file, ensuring a profile file is never
+ *  left half-written.
+ */
+class PersistentStorage
+{
+  public:
+    using Ptr = std::shared_ptr<PersistentStorage>;
+
+    /**
+     *  Callback used to report errors which happens in the background
+     *  worker thread.
+     */
+    using ErrorHandler = std::function<void(const std::string &)>;
+
+    /**
+     *  Default max time a change can stay in the queue before it is
+     *  written to disk
+     */
+    static constexpr std::chrono::milliseconds DEFAULT_FLUSH_DELAY{5000};
+
+    /**
+     *  Default number of pending profiles triggering an immediate flush
+     */
+    static constexpr size_t DEFAULT_FLUSH_THRESHOLD = 64;
+
+    /**
+     *  Creates a new PersistentStorage engine.
+     *
+     *  If the flush_delay is 0, no worker thread is started and all
+     *  changes are written to disk immediately in the calling thread.
+     *
+     * @param errhandler       ErrorHandler callback used to report I/O errors
+     * @param flush_delay      std::chrono::milliseconds of the longest time
+     *                         a change may be kept in memory
+     * @param flush_threshold  size_t with the number of pending profiles
+     *                         which will trigger a flush before the
+     *                         flush_delay has passed
+     *
+     * @return PersistentStorage::Ptr to the new engine
+     */
+    [[nodiscard]] static Ptr Create(ErrorHandler errhandler,
+                                    std::chrono::milliseconds flush_delay = DEFAULT_FLUSH_DELAY,
+                                    size_t flush_threshold = DEFAULT_FLUSH_THRESHOLD);
+
+    /**
+     *  Flushes all pending changes before the worker thread is stopped
+     */
+    ~PersistentStorage() noexcept;
+
+    PersistentStorage(const PersistentStorage &) = delete;
+    PersistentStorage &operator=(const PersistentStorage &) = delete;
+
+    /**
+     *  Queue a complete configuration profile to be written to disk.
+     *
+     *  The profile is expected to contain the current usage counters as
+     *  well, so any pending usage counter update for the same file is
+     *  superseded by this call.  Any existing usage side-car file is
+     *  removed once the profile has been written.
+     *
+     * @param filename  std::string with the profile filename
+     * @param profile   Json::Value of the complete exported profile
+     */
+    void SaveProfile(const std::string &filename, const Json::Value &profile);
+
+    /**
+     *  Queue a complete configuration profile, already serialized as
+     *  JSON text, to be written to disk.  See SaveProfile() above.
+     *
+     * @param filename  std::string with the profile filename
+     * @param profile   std::string with the JSON text of the profile
+     */
+    void SaveProfile(const std::string &filename, std::string profile);
+
+    /**
+     *  Queue an update of the usage counters of a configuration profile.
+     *  This only updates the side-car usage file, not the profile itself.
+     *
+     * @param filename  std::string with the profile filename
+     * @param usage     UsageCounters with the current values
+     */
+    void SaveUsage(const std::string &filename, const UsageCounters &usage);
+
+    /**
+     *  Remove a configuration profile and its usage side-car file from
+     *  disk.  Any pending changes for this file are discarded.  This
+     *  operation is done immediately in the calling thread.
+     *
+     * @param filename  std::string with the profile filename
+     *
+     * @return true if the profile file was removed, otherwise false.  The
+     *         reason is reported via the ErrorHandler.
+     */
+    bool Remove(const std::string &filename);
+
+    /**
+     *  Write all pending changes to disk before returning.
+     */
+    void Flush();
+
+    /**
+     *  Retrieve the number of profiles with changes not yet written to disk
+     *
+     * @return size_t
+     */
+    size_t GetPendingCount() const;
+
+    /**
+     *  Checks if changes are kept in memory before being written to disk
+     *
+     * @return bool, false if all changes are written immediately
+     */
+    bool IsWriteBehind() const noexcept
+    {
+        return flush_delay_.count() > 0;
+    }
+
+    /**
+     *  Retrieve the filename of the usage side-car file for a profile
+     *
+     * @param profile_file  std::string with the profile filename
+     *
+     * @return std::string with the usage side-car filename
+     */
+    static std::string GetUsageFilename(const std::string &profile_file);
+
+    /**
+     *  Merge the usage counters from the side-car file of a profile
+     *  into a loaded profile.  If no side-car file exists, the profile
+     *  is left unmodified.
+     *
+     * @param profile_file  std::string with the profile filename
+     * @param profile       Json::Value of the loaded profile to update
+     *
+     * @return true if the profile was updated from a usage side-car file
+     */
+    static bool LoadUsage(const std::string &profile_file, Json::Value &profile);
+
+    /**
+     *  Reads and parses a list of persistent configuration profile files
+     *  in parallel.  The result is returned in the same order as the
+     *  file list.  Files failing to load are reported with the error
+     *  field set in the LoadedProfile record.
+     *
+     *  If a snapshot is provided, profiles where the JSON file has not
+     *  changed since the snapshot was written are taken from the snapshot
+     *  instead of parsing the JSON file.
+     *
+     * @param files     std::vector<std::string> of the files to load
+     * @param threads   unsigned int of the max number of worker threads
+     *                  to use.  0 uses one thread per available CPU.
+     * @param snapshot  ProfileSnapshot::Ptr to an optional snapshot
+     *
+     * @return std::vector<LoadedProfile>
+     */
+    static std::vector<LoadedProfile> LoadProfiles(const std::vector<std::string> &files,
+                                                   unsigned int threads = 0,
+                                                   ProfileSnapshot::Ptr snapshot = nullptr);
+
+    /**
+     *  Write data to a file by writing it to a temporary file first which
+     *  is synced to disk and then renamed to the final filename.
+     *
+     * @param filename  std::string with the destination filename
+     * @param content   std::string with the new file content
+     *
+     * @throws ConfigManager::Exception on errors
+     */
+    static void WriteFileAtomic(const std::string &filename,
+                                const std::string &content);
+
+
+  private:
+    /**
+     *  Changes waiting to be written for a single profile file
+     */
+    struct PendingWrite
+    {
+        std::optional<std::string> profile;
+        std::optional<UsageCounters> usage;
+    };
+
+    using PendingQueue = std::map<std::string, PendingWrite>;
+
+    ErrorHandler errhandler_;
+    const std::chrono::milliseconds flush_delay_;
+    const size_t flush_threshold_;
+
+    /// Protects pending_, oldest_pending_ and shutdown_
+    mutable std::mutex pending_mtx_;
+    std::condition_variable pending_cv_;
+    PendingQueue pending_;
+    std::chrono::steady_clock::time_point oldest_pending_;
+    bool shutdown_ = false;
+
+    /// Serializes all file system operations in the state directory
+    std::mutex io_mtx_;
+
+    std::future<void> async_worker_;
+
+    PersistentStorage(ErrorHandler errhandler,
+                      std::chrono::milliseconds flush_delay,
+                      size_t flush_threshold);
+
+    /**
+     *  The background worker thread waiting for pending changes
+     */
+    void worker();
+
+    /**
+     *  Queues a change and wakes up the worker if needed.  If there is no
+     *  worker thread, the change is written to disk immediately.
+     */
+    void enqueue(const std::string &filename,
+                 std::function<void(PendingWrite &)> update);
+
+    /**
+     *  Takes all pending changes out of the queue and writes them to disk.
+     *  The io_mtx_ is held while doing this, ensuring an older change
+     *  cannot overwrite a newer one.  Must not be called with pending_mtx_
+     *  held.
+     */
+    void flush_pending();
+
+    void write_entry(const std::string &filename, const PendingWrite &entry);
+    void report_error(const std::string &msg) const noexcept;
+};
+
+} // namespace ConfigManager
@@ -35,7 +35,8 @@ ConfigHandler::ConfigHandler(DBus::Connection::Ptr dbuscon,
                              LogWriter::Ptr logwr)
     : DBus::Object::Base(PATH_CONFIGMGR, INTERFACE_CONFIGMGR),
       dbuscon_(dbuscon), object_manager_(std::move(object_manager)),
-      creds_qry_(DBus::Credentials::Query::Create(dbuscon)),
+      creds_qry_(GDBusPP::Credentials::Cache::Create(dbuscon)),
+      config_index_(Configuration::Index::Create()),
       logwr_(logwr)
 {
     DisableIdleDetector(true);
@@ -118,22 +119,74 @@ const bool ConfigHandler::Authorize(const DBus::Authz::Request::Ptr authzreq)
 }
 
 
-void ConfigHandler::SetStateDirectory(const std::string &state_dir)
+void ConfigHandler::SetStateDirectory(const std::string &state_dir,
+                                      std::chrono::milliseconds flush_delay,
+                                      unsigned int import_threads,
+                                      bool use_snapshot)
 {
+    using namespace std::chrono;
+
     if (!state_dir_.empty())
     {
         throw ConfigManager::Exception("State directory already set");
     }
 
     state_dir_ = state_dir;
+    storage_ = PersistentStorage::Create(
+        [log = signals_](const std::string &errmsg)
+        {
+            log->LogError(errmsg);
+        },
+        flush_delay);
 
     // Load all the already saved persistent configurations before
-    // continuing.
-    for (const auto &fname : get_persistent_config_file_list(state_dir_))
+    // continuing.  The files are read and parsed in parallel, while the
+    // D-Bus objects are created in this thread afterwards.  The
+    // configuration profile content itself is not processed before it
+    // is needed.  With the snapshot enabled, profiles not changed since
+    // the snapshot was written are retrieved from it without any parsing.
+    const auto start = steady_clock::now();
+    auto files = get_persistent_config_file_list(state_dir_);
+
+    const std::string snapshot_file = state_dir_ + "/" + ProfileSnapshot::DEFAULT_FILENAME;
+    ProfileSnapshot::Ptr snapshot = nullptr;
+    if (use_snapshot)
+    {
+        try
+        {
+            snapshot = ProfileSnapshot::Open(snapshot_file);
+        }
+        catch (const ConfigManager::Exception &excp)
+        {
+            signals_->LogError("Ignoring configuration snapshot: "
+                               + std::string(excp.what()));
+        }
+    }
+
+    auto loaded = PersistentStorage::LoadProfiles(files, import_threads, snapshot);
+    const auto parsed = steady_clock::now();
+
+    if (use_snapshot)
+    {
+        refresh_snapshot(snapshot_file, snapshot, loaded);
+        snapshot.reset();
+    }
+
+    size_t imported = 0;
+    for (auto &entry : loaded)
     {
+        const std::string &fname = entry.filename;
+        if (!entry.error.empty())
+        {
+            signals_->LogCritical("Invalid persistent configuration file " + fname
+                                  + ": " + entry.error);
+            continue;
+        }
+
         try
         {
-            import_persistent_configuration(fname);
+            import_persistent_configuration(fname, std::move(entry.profile));
+            ++imported;
         }
         catch (const openvpn::option_error &e)
         {
@@ -159,6 +212,90 @@ void ConfigHandler::SetStateDirectory(const std::string &state_dir)
                                   + ": " + e.what());
         }
     }
+    const auto done = steady_clock::now();
+
+    signals_->LogInfo(fmt::format(
+        "Loaded {} of {} persistent configuration profiles in {} ms "
+        "(parsing: {} ms, D-Bus registration: {} ms)",
+        imported,
+        files.size(),
+        duration_cast<milliseconds>(done - start).count(),
+        duration_cast<milliseconds>(parsed - start).count(),
+        duration_cast<milliseconds>(done - parsed).count()));
+}
+
+
+void ConfigHandler::refresh_snapshot(const std::string &snapshot_file,
+                                     ProfileSnapshot::Ptr current,
+                                     const std::vector<LoadedProfile> &loaded)
+{
+    size_t valid = 0;
+    size_t from_snapshot = 0;
+    for (const auto &entry : loaded)
+    {
+        if (entry.error.empty())
+        {
+            ++valid;
+            from_snapshot += (entry.from_snapshot ? 1 : 0);
+        }
+    }
+
+    // Only copy the profiles if the snapshot needs to be rewritten
+    if (current
+        && from_snapshot == valid
+        && current->GetEntryCount() == valid)
+    {
+        signals_->LogVerb2(fmt::format("Loaded {} profiles from the configuration snapshot",
+                                       from_snapshot));
+        return;
+    }
+
+    std::vector<ProfileSnapshot::Entry> entries;
+    entries.reserve(valid);
+    for (const auto &entry : loaded)
+    {
+        if (!entry.error.empty())
+        {
+            continue;
+        }
+
+        auto sep = entry.filename.rfind('/');
+        entries.push_back({entry.filename.substr(sep + 1),
+                           entry.stamp,
+                           entry.profile});
+    }
+
+    try
+    {
+        ProfileSnapshot::Write(snapshot_file, entries);
+        signals_->LogVerb1(fmt::format("Configuration snapshot updated: {} profiles, "
+                                       "{} reused, {} parsed from JSON",
+                                       entries.size(),
+                                       from_snapshot,
+                                       entries.size() - from_snapshot));
+    }
+    catch (const ConfigManager::Exception &excp)
+    {
+        signals_->LogError("Could not write configuration snapshot: "
+                           + std::string(excp.what()));
+    }
+}
+
+
+void ConfigHandler::FlushPersistentStorage()
+{
+    if (!storage_)
+    {
+        return;
+    }
+
+    size_t pending = storage_->GetPendingCount();
+    storage_->Flush();
+    if (pending > 0)
+    {
+        signals_->LogVerb2("Flushed " + std::to_string(pending)
+                           + " pending persistent configuration update(s)");
+    }
 }
 
 
@@ -227,22 +364,20 @@ std::vector<std::string> ConfigHandler::get_persistent_config_file_list(const st
 }
 
 
-void ConfigHandler::import_persistent_configuration(const std::string &fname)
+void ConfigHandler::import_persistent_configuration(const std::string &fname,
+                                                    Json::Value data)
 {
-    // Load the JSON file and parse it
-    signals_->Debug("Parsing persistent configuration: " + fname);
-    std::ifstream statefile(fname, std::ifstream::binary);
-    Json::Value data;
-    statefile >> data;
-
+    signals_->Debug("Importing persistent configuration: " + fname);
     auto cfgobj = object_manager_->CreateObject<Configuration>(dbuscon_,
                                                                object_manager_,
                                                                creds_qry_,
                                                                sig_configmgr_event_,
+                                                               storage_,
                                                                fname,
-                                                               data,
+                                                               std::move(data),
                                                                signals_->GetLogLevel(),
                                                                logwr_);
+    register_configuration(cfgobj);
     signals_->LogVerb1(fmt::format(
         "Loaded persistent configuration '{}', profile name: '{}', owner: {}",
         fname,
@@ -270,19 +405,21 @@ void ConfigHandler::method_import(DBus::Object::Method::Arguments::Ptr args)
         const std::string caller = args->GetCallerBusName();
         uid_t owner = creds_qry_->GetUID(caller);
 
-        object_manager_->CreateObject<Configuration>(dbuscon_,
-                                                     object_manager_,
-                                                     creds_qry_,
-                                                     sig_configmgr_event_,
-                                                     config_path,
-                                                     state_dir_,
-                                                     name,
-                                                     config_str,
-                                                     single_use,
-                                                     persistent,
-                                                     owner,
-                                                     signals_->GetLogLevel(),
-                                                     logwr_);
+        auto cfgobj = object_manager_->CreateObject<Configuration>(dbuscon_,
+                                                                   object_manager_,
+                                                                   creds_qry_,
+                                                                   sig_configmgr_event_,
+                                                                   storage_,
+                                                                   config_path,
+                                                                   state_dir_,
+                                                                   name,
+                                                                   config_str,
+                                                                   single_use,
+                                                                   persistent,
+                                                                   owner,
+                                                                   signals_->GetLogLevel(),
+                                                                   logwr_);
+        register_configuration(cfgobj);
 
         sig_configmgr_event_->Send(config_path, EventType::CFG_CREATED, owner);
 
@@ -326,19 +463,8 @@ void ConfigHandler::method_lookup_config_name(DBus::Object::Method::Arguments::P
 
     auto config_name = glib2::Value::Extract<std::string>(params, 0);
 
-    auto configs = helper_retrieve_configs(args->GetCallerBusName(),
-                                           [&config_name](Configuration::Ptr obj)
-                                           {
-                                               return obj->GetName() == config_name;
-                                           });
-
-    std::vector<DBus::Object::Path> paths;
-
-    for (auto &config : configs)
-    {
-        paths.push_back(config->GetPath());
-    }
-
+    auto paths = helper_filter_indexed(args->GetCallerBusName(),
+                                       config_index_->LookupName(config_name));
     args->SetMethodReturn(glib2::Value::CreateTupleWrapped(paths));
 }
 
@@ -349,19 +475,8 @@ void ConfigHandler::method_search_by_tag(DBus::Object::Method::Arguments::Ptr ar
 
     auto tag = glib2::Value::Extract<std::string>(params, 0);
 
-    auto configs = helper_retrieve_configs(args->GetCallerBusName(),
-                                           [&tag](Configuration::Ptr obj)
-                                           {
-                                               return obj->CheckForTag(tag);
-                                           });
-
-    std::vector<DBus::Object::Path> paths;
-
-    for (auto &config : configs)
-    {
-        paths.push_back(config->GetPath());
-    }
-
+    auto paths = helper_filter_indexed(args->GetCallerBusName(),
+                                       config_index_->LookupTag(tag));
     args->SetMethodReturn(glib2::Value::CreateTupleWrapped(paths));
 }
 
@@ -373,19 +488,8 @@ void ConfigHandler::method_search_by_owner(DBus::Object::Method::Arguments::Ptr
     auto str_owner = glib2::Value::Extract<std::string>(params, 0);
     uid_t owner = get_userid(std::move(str_owner));
 
-    auto configs = helper_retrieve_configs(args->GetCallerBusName(),
-                                           [&owner](Configuration::Ptr obj)
-                                           {
-                                               return obj->GetOwnerUID() == owner;
-                                           });
-
-    std::vector<DBus::Object::Path> paths;
-
-    for (auto &config : configs)
-    {
-        paths.push_back(config->GetPath());
-    }
-
+    auto paths = helper_filter_indexed(args->GetCallerBusName(),
+                                       config_index_->LookupOwner(owner));
     args->SetMethodReturn(glib2::Value::CreateTupleWrapped(paths));
 }
 
@@ -397,19 +501,41 @@ void ConfigHandler::method_transfer_ownership(DBus::Object::Method::Arguments::P
     auto path = glib2::Value::Extract<DBus::Object::Path>(params, 0);
     uid_t new_owner_uid = glib2::Value::Extract<uid_t>(params, 1);
 
-    auto configs = helper_retrieve_configs(args->GetCallerBusName(), [&path](Configuration::Ptr obj)
-                                           {
-                                               return obj->GetPath() == path;
-                                           },
-                                           true);
-
-    for (auto &config : configs)
+    auto config = config_index_->Get(path);
+    if (config && config->CheckACL(args->GetCallerBusName(), true))
     {
         config->TransferOwnership(new_owner_uid);
     }
 }
 
 
+std::vector<DBus::Object::Path> ConfigHandler::helper_filter_indexed(const std::string &caller,
+                                                                     const Configuration::Index::ObjectList &candidates,
+                                                                     bool grant_root) const
+{
+    std::vector<DBus::Object::Path> paths;
+    paths.reserve(candidates.size());
+
+    for (const auto &config : candidates)
+    {
+        // If the caller is empty, we don't do any ACL checks
+        if (caller.empty() || config->CheckACL(caller, grant_root))
+        {
+            paths.push_back(config->GetPath());
+        }
+    }
+
+    return paths;
+}
+
+
+void ConfigHandler::register_configuration(Configuration::Ptr cfgobj)
+{
+    config_index_->Add(cfgobj);
+    cfgobj->SetIndex(config_index_);
+}
+
+
 ConfigHandler::ConfigCollection ConfigHandler::helper_retrieve_configs(const std::string &caller,
                                                                        fn_search_filter &&filter_fn,
                                                                        bool grant_root) const
@@ -486,9 +612,21 @@ void Service::BusNameLost(const std::string &busname)
 }
 
 
-void Service::SetStateDirectory(const std::string &stdir)
+void Service::SetStateDirectory(const std::string &stdir,
+                                std::chrono::milliseconds flush_delay,
+                                unsigned int import_threads,
+                                bool use_snapshot)
 {
-    config_handler_->SetStateDirectory(stdir);
+    config_handler_->SetStateDirectory(stdir, flush_delay, import_threads, use_snapshot);
+}
+
+
+void Service::FlushPersistentStorage()
+{
+    if (config_handler_)
+    {
+        config_handler_->FlushPersistentStorage();
+    }
 }
 
 
@@ -17,17 +17,19 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/base.hpp>
 #include <gdbuspp/service.hpp>
 
+#include "dbus/credentials-cache.hpp"
 #include "log/logwriter.hpp"
 #include "log/proxy-log.hpp"
 #include "common/utils.hpp"
 #include "configmgr-configuration.hpp"
+#include "configmgr-persistence.hpp"
 #include "configmgr-signals.hpp"
 
 
@@ -82,12 +84,35 @@ class ConfigHandler : public DBus::Object::Base
      *  persistent configuration profiles.
      *
      *  When calling this function, all already saved configuration files
-     *  will be imported and registered before continuing.
+     *  will be imported and registered before continuing.  The files are
+     *  parsed in parallel, and the configuration profile content itself
+     *  is only processed when it is first needed.
      *
-     * @param state_dir  std::string containing the file system directory
-     *                   for the persistent configuration profile storage
+     * @param state_dir       std::string containing the file system
+     *                        directory for the persistent configuration
+     *                        profile storage
+     * @param flush_delay     std::chrono::milliseconds of how long changes
+     *                        to persistent profiles may be kept in memory
+     *                        before being written to disk.  0 disables the
+     *                        write-behind queue.
+     * @param import_threads  unsigned int of the number of threads used to
+     *                        parse the profile files.  0 uses one thread
+     *                        per available CPU.
+     * @param use_snapshot    bool, if true profiles are loaded from the
+     *                        binary snapshot file when the JSON file has
+     *                        not changed, and the snapshot is refreshed
+     *                        when needed.
      */
-    void SetStateDirectory(const std::string &state_dir);
+    void SetStateDirectory(const std::string &state_dir,
+                           std::chrono::milliseconds flush_delay = PersistentStorage::DEFAULT_FLUSH_DELAY,
+                           unsigned int import_threads = 0,
+                           bool use_snapshot = false);
+
+    /**
+     *  Writes all pending changes of persistent configuration profiles
+     *  to disk.  This must be called before the service stops.
+     */
+    void FlushPersistentStorage();
 
   private:
     /**
@@ -109,16 +134,31 @@ class ConfigHandler : public DBus::Object::Base
     std::vector<std::string> get_persistent_config_file_list(const std::string &directory);
 
     /**
-     *  Loads a persistent configuration file from the file system.  It
-     *  will register the configuration with the D-Bus path provided in
+     *  Registers a persistent configuration loaded from the file system.
+     *  It will register the configuration with the D-Bus path provided in
      *  the file.
      *
      *  The file must be a JSON formatted text file based on the file
      *  format generated by @ConfigurationObject::Export()
      *
-     * @param fname  std::string with the filename to import
+     * @param fname  std::string with the filename the profile was loaded from
+     * @param data   Json::Value with the parsed file content
      */
-    void import_persistent_configuration(const std::string &fname);
+    void import_persistent_configuration(const std::string &fname, Json::Value data);
+
+    /**
+     *  Writes a new profile snapshot file if the current one is missing
+     *  or does not cover all the loaded profiles any more.
+     *
+     * @param snapshot_file  std::string with the snapshot filename
+     * @param current        ProfileSnapshot::Ptr to the snapshot used when
+     *                       loading the profiles; may be nullptr
+     * @param loaded         std::vector<LoadedProfile> of all the profiles
+     *                       loaded from the state directory
+     */
+    void refresh_snapshot(const std::string &snapshot_file,
+                          ProfileSnapshot::Ptr current,
+                          const std::vector<LoadedProfile> &loaded);
 
     void method_import(DBus::Object::Method::Arguments::Ptr args);
     void method_fetch_available_configs(DBus::Object::Method::Arguments::Ptr args);
@@ -142,14 +182,38 @@ class ConfigHandler : public DBus::Object::Base
                                              fn_search_filter &&filter_fn,
                                              bool grant_root = false) const;
 
+    /**
+     *  Returns only those configurations from a lookup index result
+     *  which are accessible by the caller.
+     *
+     * @param caller      D-Bus object caller ID
+     * @param candidates  Configuration::Index::ObjectList from an index lookup
+     * @param grant_root  Don't filter out root (uid 0) in the ACL check
+     *                    if it is the caller
+     *
+     * @return A (possibly empty) std::vector of the accessible D-Bus paths
+     */
+    std::vector<DBus::Object::Path> helper_filter_indexed(const std::string &caller,
+                                                          const Configuration::Index::ObjectList &candidates,
+                                                          bool grant_root = false) const;
+
+    /**
+     *  Adds a newly created configuration object to the lookup index
+     *
+     * @param cfgobj  Configuration::Ptr of the new object
+     */
+    void register_configuration(Configuration::Ptr cfgobj);
+
   private:
     DBus::Connection::Ptr dbuscon_;
     DBus::Object::Manager::Ptr object_manager_;
-    DBus::Credentials::Query::Ptr creds_qry_;
+    GDBusPP::Credentials::Cache::Ptr creds_qry_;
     std::string prop_version_{get_package_version()};
     ConfigManager::Log::Ptr signals_;
     ::Signals::ConfigurationManagerEvent::Ptr sig_configmgr_event_;
     std::string state_dir_;
+    PersistentStorage::Ptr storage_;
+    Configuration::Index::Ptr config_index_;
     LogWriter::Ptr logwr_;
 };
 
@@ -171,10 +235,27 @@ class Service : public DBus::Service
      *  method will also trigger loading configuration profiles already stored
      *  in this directory.
      *
-     * @param stdir  std::string containing the directory where to load and
-     *               save persistent configuration profiles.
+     * @param stdir           std::string containing the directory where to
+     *                        load and save persistent configuration
+     *                        profiles.
+     * @param flush_delay     std::chrono::milliseconds of how long changes
+     *                        may be kept in memory before being written
+     *                        to disk
+     * @param import_threads  unsigned int of the number of threads used
+     *                        to parse the profiles at start-up
+     * @param use_snapshot    bool, use the binary profile snapshot to
+     *                        speed up the start-up
+     */
+    void SetStateDirectory(const std::string &stdir,
+                           std::chrono::milliseconds flush_delay = PersistentStorage::DEFAULT_FLUSH_DELAY,
+                           unsigned int import_threads = 0,
+                           bool use_snapshot = false);
+
+    /**
+     *  Ensures all changes to persistent configuration profiles are
+     *  written to disk.  Called when the service is shutting down.
      */
-    void SetStateDirectory(const std::string &stdir);
+    void FlushPersistentStorage();
 
   private:
     DBus::Connection::Ptr con_;
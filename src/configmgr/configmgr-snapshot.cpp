@@ -0,0 +1,572 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file configmgr-snapshot.cpp
+ *
+ * @brief  Implementation of the binary snapshot of persistent
+ *         configuration profiles
+ */
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "configmgr-exceptions.hpp"
+#include "configmgr-persistence.hpp"
+#include "configmgr-snapshot.hpp"
+
+
+namespace ConfigManager {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'O', 'V', 'P', 'N', '3', 'C', 'F', 'G'};
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t entry_count;
+    uint32_t index_crc;
+    uint64_t index_offset;
+};
+static_assert(sizeof(SnapshotHeader) == 32);
+
+
+/**
+ *  Bits used in the flags field of a profile record
+ */
+constexpr uint32_t LOCKED_DOWN = 1 << 0;
+constexpr uint32_t TRANSFER_OWNER_SESSION = 1 << 1;
+constexpr uint32_t READONLY = 1 << 2;
+constexpr uint32_t SINGLE_USE = 1 << 3;
+constexpr uint32_t VALID = 1 << 4;
+constexpr uint32_t HAS_VALID = 1 << 5;
+constexpr uint32_t DCO = 1 << 6;
+constexpr uint32_t PUBLIC_ACCESS = 1 << 7;
+
+enum class OverrideType : uint8_t
+{
+    BOOL = 0,
+    STRING = 1
+};
+
+
+/**
+ *  Appends fixed size integers and length prefixed strings to a
+ *  binary record
+ */
+class RecordWriter
+{
+  public:
+    template <typename T>
+    void Put(T value)
+    {
+        buffer_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void PutString(std::string_view str)
+    {
+        Put<uint32_t>(static_cast<uint32_t>(str.size()));
+        buffer_.append(str.data(), str.size());
+    }
+
+    std::string &Buffer()
+    {
+        return buffer_;
+    }
+
+  private:
+    std::string buffer_;
+};
+
+
+/**
+ *  Extracts the values written by RecordWriter, with bounds checking
+ */
+class RecordReader
+{
+  public:
+    RecordReader(std::string_view data)
+        : data_(data)
+    {
+    }
+
+    template <typename T>
+    T Get()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string GetString()
+    {
+        return std::string(GetStringView());
+    }
+
+    /// The returned value points into the record being read
+    std::string_view GetStringView()
+    {
+        uint32_t len = Get<uint32_t>();
+        return std::string_view(take(len), len);
+    }
+
+  private:
+    std::string_view data_;
+    size_t pos_ = 0;
+
+    const char *take(size_t len)
+    {
+        if (len > data_.size() - pos_)
+        {
+            throw ConfigManager::Exception("Truncated configuration snapshot record");
+        }
+        const char *ret = data_.data() + pos_;
+        pos_ += len;
+        return ret;
+    }
+};
+
+
+/**
+ *  Build the CRC32 lookup table at compile time
+ */
+constexpr std::array<uint32_t, 256> crc32_table()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+} // anonymous namespace
+
+
+
+struct ProfileSnapshot::IndexEntry
+{
+    char file_id[48];
+    int64_t source_mtime_ns;
+    uint64_t source_size;
+    uint64_t record_offset;
+    uint32_t record_length;
+    uint32_t record_crc;
+};
+
+
+
+ProfileSnapshot::SourceStamp ProfileSnapshot::SourceStamp::FromStat(const struct stat &st) noexcept
+{
+    SourceStamp ret;
+    ret.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000
+                   + st.st_mtim.tv_nsec;
+    ret.size = static_cast<uint64_t>(st.st_size);
+    return ret;
+}
+
+
+ProfileSnapshot::Ptr ProfileSnapshot::Open(const std::string &filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (ENOENT == errno)
+        {
+            return nullptr;
+        }
+        throw ConfigManager::Exception("Could not open '" + filename + "': "
+                                       + std::system_category().message(errno));
+    }
+
+    Ptr snapshot(new ProfileSnapshot(filename));
+    try
+    {
+        snapshot->map_file(fd);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return snapshot;
+}
+
+
+ProfileSnapshot::ProfileSnapshot(const std::string &filename)
+    : filename_(filename)
+{
+}
+
+
+ProfileSnapshot::~ProfileSnapshot() noexcept
+{
+    if (map_)
+    {
+        ::munmap(const_cast<char *>(map_), map_size_);
+    }
+}
+
+
+bool ProfileSnapshot::Lookup(std::string_view file_id,
+                             const SourceStamp &stamp,
+                             Json::Value &profile) const
+{
+    auto it = lookup_.find(file_id);
+    if (lookup_.end() == it)
+    {
+        return false;
+    }
+
+    const IndexEntry *entry = it->second;
+    if (entry->source_mtime_ns != stamp.mtime_ns
+        || entry->source_size != stamp.size)
+    {
+        return false;
+    }
+
+    std::string_view record = get_record(entry);
+    if (CRC32(record) != entry->record_crc)
+    {
+        return false;
+    }
+
+    try
+    {
+        profile = DecodeRecord(record);
+    }
+    catch (const ConfigManager::Exception &)
+    {
+        return false;
+    }
+    return true;
+}
+
+
+std::vector<ProfileSnapshot::Entry> ProfileSnapshot::GetAllEntries() const
+{
+    std::vector<Entry> ret;
+    for (uint32_t i = 0; i < entry_count_; ++i)
+    {
+        const IndexEntry *entry = &index_[i];
+        std::string_view record = get_record(entry);
+        if (CRC32(record) != entry->record_crc)
+        {
+            continue;
+        }
+
+        try
+        {
+            Entry e;
+            e.file_id = std::string(entry->file_id);
+            e.stamp.mtime_ns = entry->source_mtime_ns;
+            e.stamp.size = entry->source_size;
+            e.profile = DecodeRecord(record);
+            ret.push_back(std::move(e));
+        }
+        catch (const ConfigManager::Exception &)
+        {
+        }
+    }
+    return ret;
+}
+
+
+size_t ProfileSnapshot::GetEntryCount() const noexcept
+{
+    return entry_count_;
+}
+
+
+void ProfileSnapshot::Write(const std::string &filename,
+                            const std::vector<Entry> &entries)
+{
+    static_assert(sizeof(IndexEntry) == 80);
+
+    std::string data(sizeof(SnapshotHeader), '\0');
+    std::vector<IndexEntry> index;
+    index.reserve(entries.size());
+
+    for (const auto &e : entries)
+    {
+        if (e.file_id.empty() || e.file_id.size() >= sizeof(IndexEntry::file_id))
+        {
+            throw ConfigManager::Exception("Invalid snapshot file id: " + e.file_id);
+        }
+
+        std::string record = EncodeRecord(e.profile);
+
+        IndexEntry entry{};
+        std::memcpy(entry.file_id, e.file_id.data(), e.file_id.size());
+        entry.source_mtime_ns = e.stamp.mtime_ns;
+        entry.source_size = e.stamp.size;
+        entry.record_offset = data.size();
+        entry.record_length = static_cast<uint32_t>(record.size());
+        entry.record_crc = CRC32(record);
+        index.push_back(entry);
+
+        data += record;
+    }
+
+    // Keep the index aligned, it is accessed directly in the mapped file
+    data.resize((data.size() + 7) & ~static_cast<size_t>(7), '\0');
+
+    SnapshotHeader hdr{};
+    std::memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic));
+    hdr.version = FORMAT_VERSION;
+    hdr.byte_order = SNAPSHOT_BYTE_ORDER;
+    hdr.entry_count = static_cast<uint32_t>(index.size());
+    hdr.index_offset = data.size();
+
+    std::string_view index_data(reinterpret_cast<const char *>(index.data()),
+                                index.size() * sizeof(IndexEntry));
+    hdr.index_crc = CRC32(index_data);
+    data.append(index_data.data(), index_data.size());
+    std::memcpy(data.data(), &hdr, sizeof(hdr));
+
+    PersistentStorage::WriteFileAtomic(filename, data);
+}
+
+
+std::string ProfileSnapshot::EncodeRecord(const Json::Value &profile)
+{
+    uint32_t flags = 0;
+    flags |= (profile["locked_down"].asBool() ? LOCKED_DOWN : 0);
+    flags |= (profile["transfer_owner_session"].asBool() ? TRANSFER_OWNER_SESSION : 0);
+    flags |= (profile["readonly"].asBool() ? READONLY : 0);
+    flags |= (profile["single_use"].asBool() ? SINGLE_USE : 0);
+    flags |= (profile.isMember("valid") ? HAS_VALID : 0);
+    flags |= (profile["valid"].asBool() ? VALID : 0);
+    flags |= (profile["dco"].asBool() ? DCO : 0);
+    flags |= (profile["public_access"].asBool() ? PUBLIC_ACCESS : 0);
+
+    RecordWriter rec;
+    rec.Put<uint32_t>(profile["owner"].asUInt());
+    rec.Put<uint64_t>(profile["import_timestamp"].asUInt64());
+    rec.Put<uint64_t>(profile["last_used_timestamp"].asUInt64());
+    rec.Put<uint32_t>(profile["used_count"].asUInt());
+    rec.Put<uint32_t>(flags);
+    rec.PutString(profile["object_path"].asString());
+    rec.PutString(profile["name"].asString());
+
+    const Json::Value &tags = profile["tags"];
+    rec.Put<uint32_t>(tags.size());
+    for (const auto &tag : tags)
+    {
+        rec.PutString(tag.asString());
+    }
+
+    const Json::Value &acl = profile["acl"];
+    rec.Put<uint32_t>(acl.size());
+    for (const auto &uid : acl)
+    {
+        rec.Put<uint32_t>(uid.asUInt());
+    }
+
+    const Json::Value &overrides = profile["overrides"];
+    rec.Put<uint32_t>(overrides.size());
+    for (const auto &key : overrides.getMemberNames())
+    {
+        const Json::Value &ov = overrides[key];
+        rec.PutString(key);
+        if (ov.isBool())
+        {
+            rec.Put<OverrideType>(OverrideType::BOOL);
+            rec.Put<uint8_t>(ov.asBool() ? 1 : 0);
+        }
+        else
+        {
+            rec.Put<OverrideType>(OverrideType::STRING);
+            rec.PutString(ov.asString());
+        }
+    }
+
+    // The profile content is kept as JSON text, which is only parsed
+    // when the profile is being used
+    const Json::Value &content = profile["profile"];
+    if (content.isString())
+    {
+        rec.PutString(content.asString());
+    }
+    else
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        rec.PutString(Json::writeString(builder, content));
+    }
+
+    return std::move(rec.Buffer());
+}
+
+
+Json::Value ProfileSnapshot::DecodeRecord(std::string_view record)
+{
+    RecordReader rec(record);
+    Json::Value ret;
+
+    ret["owner"] = rec.Get<uint32_t>();
+    ret["import_timestamp"] = static_cast<Json::Value::UInt64>(rec.Get<uint64_t>());
+    ret["last_used_timestamp"] = static_cast<Json::Value::UInt64>(rec.Get<uint64_t>());
+    ret["used_count"] = rec.Get<uint32_t>();
+    uint32_t flags = rec.Get<uint32_t>();
+    ret["object_path"] = rec.GetString();
+    ret["name"] = rec.GetString();
+
+    for (uint32_t n = rec.Get<uint32_t>(); n > 0; --n)
+    {
+        ret["tags"].append(rec.GetString());
+    }
+
+    for (uint32_t n = rec.Get<uint32_t>(); n > 0; --n)
+    {
+        ret["acl"].append(rec.Get<uint32_t>());
+    }
+
+    for (uint32_t n = rec.Get<uint32_t>(); n > 0; --n)
+    {
+        std::string key = rec.GetString();
+        switch (rec.Get<OverrideType>())
+        {
+        case OverrideType::BOOL:
+            ret["overrides"][key] = (rec.Get<uint8_t>() != 0);
+            break;
+        case OverrideType::STRING:
+            ret["overrides"][key] = rec.GetString();
+            break;
+        default:
+            throw ConfigManager::Exception("Invalid override type in configuration snapshot record");
+        }
+    }
+    // The profile content is copied straight from the record into the
+    // Json::Value string; it stays JSON text until it is used
+    std::string_view content = rec.GetStringView();
+    ret["profile"] = Json::Value(content.data(), content.data() + content.size());
+
+    ret["locked_down"] = (0 != (flags & LOCKED_DOWN));
+    ret["transfer_owner_session"] = (0 != (flags & TRANSFER_OWNER_SESSION));
+    ret["readonly"] = (0 != (flags & READONLY));
+    ret["single_use"] = (0 != (flags & SINGLE_USE));
+    if (flags & HAS_VALID)
+    {
+        ret["valid"] = (0 != (flags & VALID));
+    }
+    ret["dco"] = (0 != (flags & DCO));
+    ret["public_access"] = (0 != (flags & PUBLIC_ACCESS));
+
+    return ret;
+}
+
+
+uint32_t ProfileSnapshot::CRC32(std::string_view data) noexcept
+{
+    static constexpr auto table = crc32_table();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : data)
+    {
+        crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+
+void ProfileSnapshot::map_file(int fd)
+{
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        throw ConfigManager::Exception("Could not stat '" + filename_ + "': "
+                                       + std::system_category().message(errno));
+    }
+    if (static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader))
+    {
+        throw ConfigManager::Exception("Configuration snapshot '" + filename_
+                                       + "' is truncated");
+    }
+
+    void *map = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == map)
+    {
+        throw ConfigManager::Exception("Could not map '" + filename_ + "': "
+                                       + std::system_category().message(errno));
+    }
+    map_ = static_cast<const char *>(map);
+    map_size_ = st.st_size;
+
+    SnapshotHeader hdr;
+    std::memcpy(&hdr, map_, sizeof(hdr));
+    if (0 != std::memcmp(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic))
+        || SNAPSHOT_BYTE_ORDER != hdr.byte_order)
+    {
+        throw ConfigManager::Exception("'" + filename_
+                                       + "' is not a configuration snapshot");
+    }
+    if (FORMAT_VERSION != hdr.version)
+    {
+        throw ConfigManager::Exception("Unsupported configuration snapshot version "
+                                       + std::to_string(hdr.version));
+    }
+
+    const uint64_t index_size = static_cast<uint64_t>(hdr.entry_count) * sizeof(IndexEntry);
+    if (hdr.index_offset < sizeof(SnapshotHeader)
+        || 0 != (hdr.index_offset % alignof(IndexEntry))
+        || hdr.index_offset > map_size_
+        || index_size != map_size_ - hdr.index_offset)
+    {
+        throw ConfigManager::Exception("Configuration snapshot '" + filename_
+                                       + "' has an invalid index");
+    }
+
+    std::string_view index_data(map_ + hdr.index_offset, index_size);
+    if (CRC32(index_data) != hdr.index_crc)
+    {
+        throw ConfigManager::Exception("Configuration snapshot '" + filename_
+                                       + "' has an invalid index checksum");
+    }
+
+    index_ = reinterpret_cast<const IndexEntry *>(index_data.data());
+    entry_count_ = hdr.entry_count;
+    lookup_.reserve(entry_count_);
+    for (uint32_t i = 0; i < entry_count_; ++i)
+    {
+        const IndexEntry *entry = &index_[i];
+        size_t id_len = ::strnlen(entry->file_id, sizeof(entry->file_id));
+        if (sizeof(entry->file_id) == id_len
+            || entry->record_offset < sizeof(SnapshotHeader)
+            || entry->record_offset > hdr.index_offset
+            || entry->record_length > hdr.index_offset - entry->record_offset)
+        {
+            throw ConfigManager::Exception("Configuration snapshot '" + filename_
+                                           + "' has an invalid index entry");
+        }
+        lookup_[std::string_view(entry->file_id, id_len)] = entry;
+    }
+}
+
+
+std::string_view ProfileSnapshot::get_record(const IndexEntry *entry) const
+{
+    return std::string_view(map_ + entry->record_offset, entry->record_length);
+}
+
+} // namespace ConfigManager
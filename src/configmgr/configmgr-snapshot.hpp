@@ -0,0 +1,196 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file configmgr-snapshot.hpp
+ *
+ * @brief  Compact binary snapshot of all persistent configuration profiles
+ *         in the state directory.
+ *
+ *         The per-profile JSON files are still the authoritative storage
+ *         format.  The snapshot is a start-up cache which is memory mapped
+ *         and where profiles with an unchanged JSON file can be loaded
+ *         without parsing any JSON.
+ *
+ *  File layout (native byte order, verified by a byte order marker):
+ *
+ *    Header     - magic, format version, byte order marker,
+ *                 number of entries, CRC32 of the index and index offset
+ *    Records    - one binary encoded record per profile
+ *    Index      - one fixed size IndexEntry per profile, with the file name
+ *                 and time stamp/size of the JSON source file and the
+ *                 offset, length and CRC32 of the record
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <json/json.h>
+
+
+namespace ConfigManager {
+
+class ProfileSnapshot
+{
+  public:
+    using Ptr = std::shared_ptr<ProfileSnapshot>;
+
+    /// Default snapshot filename inside the state directory
+    static constexpr char DEFAULT_FILENAME[] = "profiles.snapshot";
+
+    /// Current snapshot format version
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     *  Identifies the version of the JSON source file a snapshot record
+     *  was created from.  If the JSON file changes, the record is
+     *  considered stale.
+     */
+    struct SourceStamp
+    {
+        int64_t mtime_ns = 0;
+        uint64_t size = 0;
+
+        static SourceStamp FromStat(const struct stat &st) noexcept;
+
+        bool operator==(const SourceStamp &other) const noexcept
+        {
+            return mtime_ns == other.mtime_ns && size == other.size;
+        }
+    };
+
+    /**
+     *  A single profile to be written to a snapshot file
+     */
+    struct Entry
+    {
+        /// Filename of the JSON source file, without the directory
+        std::string file_id;
+
+        /// Time stamp and size of the JSON source file
+        SourceStamp stamp;
+
+        /// Profile in the ConfigManager::Configuration::Export() format.
+        /// The "profile" member may be either the JSON object or a string
+        /// containing the JSON text of it.
+        Json::Value profile;
+    };
+
+    /**
+     *  Opens and memory maps a snapshot file.  The header and index are
+     *  validated, the records are only validated when they are looked up.
+     *
+     * @param filename  std::string with the snapshot filename
+     *
+     * @return ProfileSnapshot::Ptr, nullptr if the file does not exist
+     *
+     * @throws ConfigManager::Exception if the file is not a valid snapshot
+     */
+    [[nodiscard]] static Ptr Open(const std::string &filename);
+
+    ~ProfileSnapshot() noexcept;
+
+    ProfileSnapshot(const ProfileSnapshot &) = delete;
+    ProfileSnapshot &operator=(const ProfileSnapshot &) = delete;
+
+    /**
+     *  Retrieve a profile from the snapshot, if the snapshot record
+     *  was created from the same version of the JSON source file.
+     *
+     *  The "profile" member of the returned profile will contain the
+     *  JSON text of the configuration profile content as a string, which
+     *  is expected to be parsed when needed.
+     *
+     *  This method is thread-safe.
+     *
+     * @param file_id  std::string_view with the filename of the JSON file,
+     *                 without the directory
+     * @param stamp    SourceStamp of the current JSON file
+     * @param profile  Json::Value where the profile will be stored
+     *
+     * @return true if the profile was found and valid, otherwise false
+     */
+    bool Lookup(std::string_view file_id,
+                const SourceStamp &stamp,
+                Json::Value &profile) const;
+
+    /**
+     *  Retrieve all the profiles in the snapshot, regardless of the state
+     *  of the JSON source files.  Records failing the checksum are skipped.
+     *
+     * @return std::vector<Entry>
+     */
+    std::vector<Entry> GetAllEntries() const;
+
+    /**
+     *  Retrieve the number of profiles in the snapshot
+     *
+     * @return size_t
+     */
+    size_t GetEntryCount() const noexcept;
+
+    /**
+     *  Create a new snapshot file.  The file is written atomically.
+     *
+     * @param filename  std::string with the snapshot filename
+     * @param entries   std::vector<Entry> of all profiles to include
+     *
+     * @throws ConfigManager::Exception on errors
+     */
+    static void Write(const std::string &filename,
+                      const std::vector<Entry> &entries);
+
+    /**
+     *  Encode a single profile into the binary record format
+     *
+     * @param profile  Json::Value of the profile, see Entry::profile
+     * @return std::string with the binary record
+     */
+    static std::string EncodeRecord(const Json::Value &profile);
+
+    /**
+     *  Decode a single binary profile record
+     *
+     * @param record  std::string_view of the binary record
+     * @return Json::Value of the profile, see Lookup()
+     *
+     * @throws ConfigManager::Exception if the record is truncated
+     */
+    static Json::Value DecodeRecord(std::string_view record);
+
+    /**
+     *  Calculate the CRC32 (IEEE 802.3) checksum of a data buffer
+     *
+     * @param data  std::string_view of the data
+     * @return uint32_t with the checksum
+     */
+    static uint32_t CRC32(std::string_view data) noexcept;
+
+
+  private:
+    struct IndexEntry;
+
+    std::string filename_;
+    const char *map_ = nullptr;
+    size_t map_size_ = 0;
+    const IndexEntry *index_ = nullptr;
+    uint32_t entry_count_ = 0;
+    std::unordered_map<std::string_view, const IndexEntry *> lookup_;
+
+    ProfileSnapshot(const std::string &filename);
+    void map_file(int fd);
+    std::string_view get_record(const IndexEntry *entry) const;
+};
+
+} // namespace ConfigManager
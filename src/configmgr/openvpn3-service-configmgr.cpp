@@ -9,6 +9,7 @@
 //
 
 #include "build-config.h"
+#include <string>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <gdbuspp/connection.hpp>
@@ -25,6 +26,18 @@
 
 using namespace openvpn;
 
+/**
+ *  Upper limit of --persist-delay, in seconds.  Changes kept longer
+ *  than this in memory are too likely to be lost.
+ */
+static const unsigned long MAX_PERSIST_DELAY = 3600;
+
+/**
+ *  Upper limit of --import-threads.  Loading the profiles does not
+ *  gain anything from more threads than this.
+ */
+static const unsigned long MAX_IMPORT_THREADS = 64;
+
 
 static int config_manager(ParsedArgs::Ptr args)
 {
@@ -87,11 +100,39 @@ static int config_manager(ParsedArgs::Ptr args)
 
     if (args->Present("state-dir"))
     {
-        configmgr_srv->SetStateDirectory(args->GetValue("state-dir", 0));
+        // How long changes to persistent configuration profiles can be
+        // kept in memory before being written to disk.
+        unsigned long persist_delay = 5;
+        if (args->Present("persist-delay"))
+        {
+            persist_delay = parse_option_number("openvpn3-service-configmgr",
+                                                args,
+                                                "persist-delay",
+                                                0,
+                                                MAX_PERSIST_DELAY);
+        }
+
+        // Number of threads parsing the persistent configuration
+        // profiles at start-up; 0 uses one thread per CPU
+        unsigned long import_threads = 0;
+        if (args->Present("import-threads"))
+        {
+            import_threads = parse_option_number("openvpn3-service-configmgr",
+                                                 args,
+                                                 "import-threads",
+                                                 0,
+                                                 MAX_IMPORT_THREADS);
+        }
+
+        configmgr_srv->SetStateDirectory(args->GetValue("state-dir", 0),
+                                         std::chrono::seconds(persist_delay),
+                                         static_cast<unsigned int>(import_threads),
+                                         args->Present("state-snapshot"));
         umask(077);
     }
 
     configmgr_srv->Run();
+    configmgr_srv->FlushPersistentStorage();
 
     return 0;
 }
@@ -121,6 +162,21 @@ int main(int argc, char **argv)
                         "DIRECTORY",
                         true,
                         "Directory where to save persistent data");
+    argparser.AddOption("persist-delay",
+                        "SECONDS",
+                        true,
+                        "How long changes to persistent configuration profiles "
+                        "may be kept in memory before written to disk. "
+                        "0 writes changes immediately (Default: 5 seconds)");
+    argparser.AddOption("import-threads",
+                        "NUM",
+                        true,
+                        "Number of threads used to load persistent configuration "
+                        "profiles at start-up (Default: one per CPU)");
+    argparser.AddOption("state-snapshot",
+                        0,
+                        "Use a binary snapshot of the persistent configuration "
+                        "profiles to speed up the start-up");
 #ifdef OPENVPN_DEBUG
     argparser.AddOption("use-session-bus",
                         "Debug: Starts the configmgr service on the session bus");
@@ -0,0 +1,231 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file credentials-cache.cpp
+ *
+ * @brief Implementation of GDBusPP::Credentials::Cache
+ */
+
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include "credentials-cache.hpp"
+
+
+namespace GDBusPP::Credentials {
+
+/**
+ *  Upper limit of cached bus names.  A name which disappears while it
+ *  is being looked up may miss its NameOwnerChanged invalidation; this
+ *  ensures such entries cannot pile up forever.
+ */
+static const size_t max_entries = 4096;
+
+
+/**
+ *  Only unique bus names (":1.42") are cached, these are never reused
+ *  by the bus daemon.
+ */
+static inline bool is_unique_busname(const std::string &busname)
+{
+    return !busname.empty() && ':' == busname[0];
+}
+
+
+Cache::Ptr Cache::Create(DBus::Connection::Ptr conn)
+{
+    static std::mutex registry_mtx;
+    static std::map<DBus::Connection *, std::weak_ptr<Cache>> registry;
+
+    std::lock_guard<std::mutex> lg(registry_mtx);
+    for (auto it = registry.begin(); it != registry.end();)
+    {
+        it = (it->second.expired() ? registry.erase(it) : std::next(it));
+    }
+
+    auto found = registry.find(conn.get());
+    if (registry.end() != found)
+    {
+        if (auto cache = found->second.lock())
+        {
+            return cache;
+        }
+    }
+
+    auto cache = Ptr(new Cache(conn));
+    registry[conn.get()] = cache;
+    return cache;
+}
+
+
+Cache::Ptr Cache::Create(Lookup lookup)
+{
+    return Ptr(new Cache(std::move(lookup)));
+}
+
+
+Cache::Cache(DBus::Connection::Ptr conn)
+{
+    auto query = DBus::Credentials::Query::Create(conn);
+    backend.uid = [query](const std::string &busname)
+    {
+        return query->GetUID(busname);
+    };
+    backend.pid = [query](const std::string &busname)
+    {
+        return query->GetPID(busname);
+    };
+    backend.unique_busname = [query](const std::string &busname)
+    {
+        return query->GetUniqueBusName(busname);
+    };
+
+    subscr = DBus::Signals::SubscriptionManager::Create(conn);
+    owner_tgt = DBus::Signals::Target::Create("org.freedesktop.DBus",
+                                              "/org/freedesktop/DBus",
+                                              "org.freedesktop.DBus");
+    subscr->Subscribe(owner_tgt,
+                      "NameOwnerChanged",
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          Invalidate(glib2::Value::Extract<std::string>(event->params, 0));
+                      });
+}
+
+
+Cache::Cache(Lookup lookup)
+    : backend(std::move(lookup))
+{
+}
+
+
+Cache::~Cache() noexcept
+{
+    if (!subscr)
+    {
+        return;
+    }
+    try
+    {
+        subscr->Unsubscribe(owner_tgt, "NameOwnerChanged");
+    }
+    catch (...)
+    {
+        // Ignore errors during shutdown
+    }
+}
+
+
+uid_t Cache::GetUID(const std::string &busname)
+{
+    if (!is_unique_busname(busname))
+    {
+        return backend.uid(busname);
+    }
+
+    auto cached = lookup(busname);
+    if (cached && cached->uid)
+    {
+        ++hits;
+        return *cached->uid;
+    }
+    ++misses;
+
+    Entry update;
+    update.uid = backend.uid(busname);
+    store(busname, update);
+    return *update.uid;
+}
+
+
+pid_t Cache::GetPID(const std::string &busname)
+{
+    if (!is_unique_busname(busname))
+    {
+        return backend.pid(busname);
+    }
+
+    auto cached = lookup(busname);
+    if (cached && cached->pid)
+    {
+        ++hits;
+        return *cached->pid;
+    }
+    ++misses;
+
+    Entry update;
+    update.pid = backend.pid(busname);
+    store(busname, update);
+    return *update.pid;
+}
+
+
+std::string Cache::GetUniqueBusName(const std::string &busname) const
+{
+    return backend.unique_busname(busname);
+}
+
+
+void Cache::Invalidate(const std::string &busname)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    if (entries.erase(busname) > 0)
+    {
+        ++invalidations;
+    }
+}
+
+
+Cache::Stats Cache::GetStats() const
+{
+    Stats ret;
+    ret.hits = hits;
+    ret.misses = misses;
+    ret.invalidations = invalidations;
+    std::lock_guard<std::mutex> lg(mtx);
+    ret.entries = entries.size();
+    return ret;
+}
+
+
+std::optional<Cache::Entry> Cache::lookup(const std::string &busname)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    auto it = entries.find(busname);
+    if (entries.end() == it)
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+
+void Cache::store(const std::string &busname, const Entry &update)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    if (entries.size() >= max_entries && entries.find(busname) == entries.end())
+    {
+        entries.clear();
+    }
+
+    Entry &e = entries[busname];
+    if (update.uid)
+    {
+        e.uid = update.uid;
+    }
+    if (update.pid)
+    {
+        e.pid = update.pid;
+    }
+}
+
+} // namespace GDBusPP::Credentials
@@ -0,0 +1,163 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file credentials-cache.hpp
+ *
+ * @brief Caches the credentials (uid, pid) of D-Bus callers, to avoid
+ *        a bus daemon round-trip for each authorization check
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <sys/types.h>
+#include <gdbuspp/connection.hpp>
+#include <gdbuspp/credentials/query.hpp>
+#include <gdbuspp/signals/subscriptionmgr.hpp>
+
+
+namespace GDBusPP::Credentials {
+
+/**
+ *  Drop-in replacement for DBus::Credentials::Query, which remembers
+ *  the uid and pid of the unique bus names it has looked up.
+ *
+ *  A unique bus name is never reused by the bus daemon, so the cached
+ *  credentials stay valid until the name disappears from the bus.  This
+ *  is detected via the NameOwnerChanged signal, which removes the name
+ *  from the cache.  Well-known bus names may change owner at any time
+ *  and are always looked up via the bus daemon.
+ *
+ *  All services on the same D-Bus connection share a single cache
+ *  instance; Create() returns the existing cache for the connection
+ *  if there is one.
+ */
+class Cache
+{
+  public:
+    using Ptr = std::shared_ptr<Cache>;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+    };
+
+    /**
+     *  Functions retrieving the credentials of a bus name from the
+     *  bus daemon
+     */
+    struct Lookup
+    {
+        std::function<uid_t(const std::string &)> uid;
+        std::function<pid_t(const std::string &)> pid;
+        std::function<std::string(const std::string &)> unique_busname;
+    };
+
+    /**
+     *  Retrieve the credentials cache for a D-Bus connection
+     *
+     * @param conn  DBus::Connection::Ptr used for the lookups
+     * @return Cache::Ptr
+     */
+    [[nodiscard]] static Ptr Create(DBus::Connection::Ptr conn);
+
+    /**
+     *  Create a separate cache using the given lookup functions
+     *  instead of a D-Bus connection.  Bus names leaving the bus are
+     *  not tracked; they are only removed via Invalidate().  This is
+     *  used by the unit tests.
+     *
+     * @param lookup  Lookup functions used on cache misses
+     * @return Cache::Ptr
+     */
+    [[nodiscard]] static Ptr Create(Lookup lookup);
+    ~Cache() noexcept;
+
+    /**
+     *  Retrieve the uid of the process owning a bus name
+     *
+     * @param busname  std::string with the bus name to look up
+     * @return uid_t
+     *
+     * @throws DBus::Credentials::Exception if the lookup fails
+     */
+    uid_t GetUID(const std::string &busname);
+
+    /**
+     *  Retrieve the pid of the process owning a bus name
+     *
+     * @param busname  std::string with the bus name to look up
+     * @return pid_t
+     *
+     * @throws DBus::Credentials::Exception if the lookup fails
+     */
+    pid_t GetPID(const std::string &busname);
+
+    /**
+     *  Retrieve the unique bus name owning a bus name.  This is never
+     *  cached, which makes it useful to check if a unique bus name is
+     *  still present on the bus.
+     *
+     * @param busname  std::string with the well-known bus name
+     * @return std::string with the unique bus name
+     *
+     * @throws DBus::Credentials::Exception if the lookup fails
+     */
+    std::string GetUniqueBusName(const std::string &busname) const;
+
+    /**
+     *  Removes a bus name from the cache
+     *
+     * @param busname  std::string with the bus name to remove
+     */
+    void Invalidate(const std::string &busname);
+
+    /**
+     *  Retrieve the cache hit/miss counters
+     *
+     * @return Cache::Stats
+     */
+    Stats GetStats() const;
+
+
+  private:
+    struct Entry
+    {
+        std::optional<uid_t> uid;
+        std::optional<pid_t> pid;
+    };
+
+    Lookup backend;
+    DBus::Signals::SubscriptionManager::Ptr subscr = nullptr;
+    DBus::Signals::Target::Ptr owner_tgt = nullptr;
+
+    mutable std::mutex mtx;
+    std::unordered_map<std::string, Entry> entries;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> invalidations{0};
+
+    Cache(DBus::Connection::Ptr conn);
+    Cache(Lookup lookup);
+
+    std::optional<Entry> lookup(const std::string &busname);
+    void store(const std::string &busname, const Entry &update);
+};
+
+} // namespace GDBusPP::Credentials
@@ -134,7 +134,7 @@ const bool ACL::CheckOwnerAccess(const std::string &caller) const
 ACL::ACL(DBus::Connection::Ptr conn, const uid_t owner_)
     : owner(owner_)
 {
-    creds_qry = DBus::Credentials::Query::Create(std::move(conn));
+    creds_qry = GDBusPP::Credentials::Cache::Create(std::move(conn));
 }
 
 } // namespace GDBusPP::Object::Extension
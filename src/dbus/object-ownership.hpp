@@ -18,7 +18,8 @@
 #include <string>
 #include <sys/types.h>
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
+
+#include "credentials-cache.hpp"
 
 
 namespace GDBusPP::Object::Extension {
@@ -148,7 +149,7 @@ class ACL
     uid_t owner;
     bool acl_public = false;
     ACLList acl_list{};
-    DBus::Credentials::Query::Ptr creds_qry = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_qry = nullptr;
 
     ACL(DBus::Connection::Ptr conn, const uid_t owner_);
 };
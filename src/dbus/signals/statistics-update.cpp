@@ -0,0 +1,122 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file dbus/signals/statistics-update.cpp
+ *
+ * @brief C++ class used to send and proxy StatisticsUpdate signals
+ *
+ */
+
+#include <iostream>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include "statistics-update.hpp"
+
+
+namespace Signals {
+
+StatisticsUpdate::StatisticsUpdate(DBus::Signals::Emit::Ptr emitter,
+                                   DBus::Signals::SubscriptionManager::Ptr subscr,
+                                   DBus::Signals::Target::Ptr subscr_tgt)
+    : DBus::Signals::Signal(emitter, "StatisticsUpdate"),
+      subscr_mgr(subscr), target(subscr_tgt)
+{
+    SetArguments(SignalDeclaration());
+    Subscribe(subscr_tgt);
+}
+
+
+DBus::Signals::SignalArgList StatisticsUpdate::SignalDeclaration() noexcept
+{
+    return {{"sequence", glib2::DataType::DBus<uint64_t>()},
+            {"counters", "a(ux)"}};
+}
+
+
+void StatisticsUpdate::Subscribe(DBus::Signals::Target::Ptr subscr_tgt)
+{
+    // If a SubscriptionManager and Signals::Target object is provided,
+    // prepare proxying incoming StatisticsUpdate signals from that target
+    if (subscr_mgr && subscr_tgt)
+    {
+        if (target)
+        {
+            subscr_mgr->Unsubscribe(target, "StatisticsUpdate");
+        }
+
+        subscr_mgr->Subscribe(subscr_tgt,
+                              "StatisticsUpdate",
+                              [this](DBus::Signals::Event::Ptr event)
+                              {
+                                  try
+                                  {
+                                      uint64_t seq = 0;
+                                      auto changes = Parse(event->params, seq);
+                                      (void)Send(seq, changes);
+                                  }
+                                  catch (const DBus::Exception &ex)
+                                  {
+                                      std::cerr << "StatisticsUpdate EXCEPTION:"
+                                                << ex.what() << std::endl;
+                                  }
+                              });
+
+        target = subscr_tgt;
+    }
+}
+
+
+bool StatisticsUpdate::Send(const uint64_t sequence,
+                            const ConnectionStatsDelta::ChangeList &changes) const
+{
+    GVariantBuilder *counters = glib2::Builder::Create("a(ux)");
+    for (const auto &[idx, delta] : changes)
+    {
+        g_variant_builder_add(counters, "(ux)", idx, static_cast<gint64>(delta));
+    }
+
+    GVariantBuilder *b = glib2::Builder::Create("(ta(ux))");
+    glib2::Builder::Add(b, sequence);
+    glib2::Builder::Add(b, glib2::Builder::Finish(counters));
+
+    try
+    {
+        return EmitSignal(glib2::Builder::Finish(b));
+    }
+    catch (const DBus::Signals::Exception &ex)
+    {
+        std::cerr << "StatisticsUpdate::Send() EXCEPTION:"
+                  << ex.what() << std::endl;
+    }
+    return false;
+}
+
+
+ConnectionStatsDelta::ChangeList StatisticsUpdate::Parse(GVariant *params,
+                                                         uint64_t &sequence)
+{
+    glib2::Utils::checkParams(__func__, params, "(ta(ux))", 2);
+    sequence = glib2::Value::Extract<uint64_t>(params, 0);
+
+    ConnectionStatsDelta::ChangeList changes;
+    GVariantIter *counters = nullptr;
+    g_variant_get_child(params, 1, "a(ux)", &counters);
+    changes.reserve(g_variant_iter_n_children(counters));
+
+    guint32 idx = 0;
+    gint64 delta = 0;
+    while (g_variant_iter_next(counters, "(ux)", &idx, &delta))
+    {
+        changes.emplace_back(idx, delta);
+    }
+    g_variant_iter_free(counters);
+    return changes;
+}
+
+} // namespace Signals
@@ -0,0 +1,86 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file dbus/signals/statistics-update.hpp
+ *
+ * @brief C++ class used to send and proxy StatisticsUpdate signals
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <gdbuspp/signals/signal.hpp>
+#include <gdbuspp/signals/subscriptionmgr.hpp>
+
+#include "client/statistics.hpp"
+
+
+namespace Signals {
+
+/**
+ *  Provides an implementation to send and proxy the
+ *  net.openvpn.v3.*.StatisticsUpdate signal.
+ *
+ *  This signal carries the delta encoded connection statistics counters
+ *  of a VPN session; see ConnectionStatsDelta for details.  It is only
+ *  sent by the net.openvpn.v3.backends.be* client backend service when
+ *  the session manager has subscribed to the statistics updates.
+ *
+ *  If a SubscriptionManager and Signals::Target object is provided, the
+ *  same signal from the backend service will be forwarded to the
+ *  targets of the signal group this signal belongs to.
+ */
+class StatisticsUpdate : public DBus::Signals::Signal
+{
+  public:
+    using Ptr = std::shared_ptr<StatisticsUpdate>;
+
+    /**
+     *  Prepare the StatisticsUpdate signal emitter class
+     *
+     * @param emitter     DBus::Signals::Emit object used to emit D-Bus signals
+     * @param subscr      (optional) DBus::Signals::SubscriptionManager object
+     *                    handling D-Bus signal subscriptions. Needed when
+     *                    listening for incoming StatisticsUpdate signals
+     *                    needed to be proxied further
+     * @param subscr_tgt  (optional) DBus::Signals::Target object with the
+     *                    containing StatisticsUpdate subscription details.
+     *                    Used to listen for signals from specific sender
+     *                    targets.
+     */
+    StatisticsUpdate(DBus::Signals::Emit::Ptr emitter,
+                     DBus::Signals::SubscriptionManager::Ptr subscr = nullptr,
+                     DBus::Signals::Target::Ptr subscr_tgt = nullptr);
+    ~StatisticsUpdate() noexcept = default;
+
+    static DBus::Signals::SignalArgList SignalDeclaration() noexcept;
+
+    void Subscribe(DBus::Signals::Target::Ptr subscr_tgt);
+
+    bool Send(const uint64_t sequence,
+              const ConnectionStatsDelta::ChangeList &changes) const;
+
+    /**
+     *  Parses the parameters of a received StatisticsUpdate signal
+     *
+     * @param params    GVariant pointer to the signal parameters
+     * @param sequence  uint64_t receiving the update sequence number
+     *
+     * @return ConnectionStatsDelta::ChangeList with the changed counters
+     */
+    static ConnectionStatsDelta::ChangeList Parse(GVariant *params,
+                                                  uint64_t &sequence);
+
+  private:
+    DBus::Signals::SubscriptionManager::Ptr subscr_mgr;
+    DBus::Signals::Target::Ptr target;
+};
+
+} // namespace Signals
@@ -14,21 +14,34 @@
  *
  */
 
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <string>
-#include <regex>
-#include <fmt/compile.h>
-#include <fmt/format.h>
+#include <utility>
+#include <gdbuspp/glib2/utils.hpp>
 #include <gdbuspp/proxy.hpp>
 #include <gdbuspp/proxy/utils.hpp>
 
+#include "support-functions.hpp"
 
-namespace GDBusPP::Proxy::Utils {
 
+namespace GDBusPP::Proxy::Utils {
 
-bool LookupObject(DBus::Proxy::Client::Ptr proxy, const DBus::Object::Path &path)
+/**
+ *  Splits a D-Bus object path into the parent object path and the
+ *  name of the final path element
+ *
+ * @param path    DBus::Object::Path to split
+ * @param parent  DBus::Object::Path to store the parent object path
+ * @param child   std::string to store the final path element
+ *
+ * @throws DBus::Proxy::Exception if the object path is invalid
+ */
+static void split_object_path(const DBus::Object::Path &path,
+                              DBus::Object::Path &parent,
+                              std::string &child)
 {
-    DBus::Object::Path parent_object_path;
-    std::string child_object;
     auto split_point = path.find_last_of("/");
     if (split_point == std::string::npos)
     {
@@ -37,52 +50,279 @@ bool LookupObject(DBus::Proxy::Client::Ptr proxy, const DBus::Object::Path &path
 
     // Split up the D-Bus object path into the parent object path
     // of the requested path, and preserve the final
-    parent_object_path = {path.substr(0, split_point)};
-    child_object = {path.substr(split_point + 1)};
+    parent = {path.substr(0, split_point)};
+    child = {path.substr(split_point + 1)};
 
-    if (!parent_object_path.empty() && child_object.empty())
+    if (!parent.empty() && child.empty())
     {
         throw DBus::Proxy::Exception("Invalid D-Bus path - no trailing slash (/) allowed");
     }
 
-    if (parent_object_path.empty())
+    if (parent.empty())
     {
-        parent_object_path = "/";
+        parent = "/";
     }
+}
 
-    auto prxqry = DBus::Proxy::Utils::Query::Create(std::move(proxy));
-    std::string introsp;
-    for (uint8_t attempts = 3; attempts > 0; attempts--)
+
+std::vector<std::string> ParseIntrospectionNodes(const std::string &introspection)
+{
+    static const std::string node_start{"<node name=\""};
+
+    std::vector<std::string> nodes;
+    for (auto pos = introspection.find(node_start);
+         pos != std::string::npos;
+         pos = introspection.find(node_start, pos))
     {
-        introsp = prxqry->Introspect(parent_object_path);
-        if (introsp.length() > 218)
+        pos += node_start.length();
+        auto end = introspection.find('"', pos);
+        if (end == std::string::npos)
         {
             break;
         }
-        usleep(100000);
+
+        // The root element may carry the full object path as its name;
+        // only the relative child node names are of interest
+        std::string name = introspection.substr(pos, end - pos);
+        if (!name.empty() && name.find('/') == std::string::npos)
+        {
+            nodes.push_back(std::move(name));
+        }
+        pos = end;
     }
+    return nodes;
+}
+
+
+bool LookupObject(DBus::Proxy::Client::Ptr proxy, const DBus::Object::Path &path)
+{
+    DBus::Object::Path parent_object_path;
+    std::string child_object;
+    split_object_path(path, parent_object_path, child_object);
+
+    auto prxqry = DBus::Proxy::Utils::Query::Create(std::move(proxy));
+    const std::string introsp = prxqry->Introspect(parent_object_path);
 
-    if (introsp.length() > 218 && child_object.empty() && "/" == parent_object_path)
+    if (child_object.empty() && "/" == parent_object_path)
     {
         // This is a special case for checking the root (/) object
-        // If the introspection didn't fail, the object exists.
-        return true;
+        // If it provides any interfaces, the object exists.
+        return introsp.find("<interface") != std::string::npos;
+    }
+
+    const auto nodes = ParseIntrospectionNodes(introsp);
+    return std::find(nodes.begin(), nodes.end(), child_object) != nodes.end();
+}
+
+
+
+//
+//  class ObjectPresence
+//
+
+ObjectPresence::Ptr ObjectPresence::Create(DBus::Connection::Ptr conn,
+                                           const std::string &service)
+{
+    using RegistryKey = std::pair<DBus::Connection *, std::string>;
+    static std::mutex registry_mtx;
+    static std::map<RegistryKey, std::weak_ptr<ObjectPresence>> registry;
+
+    std::lock_guard<std::mutex> lg(registry_mtx);
+    for (auto it = registry.begin(); it != registry.end();)
+    {
+        it = (it->second.expired() ? registry.erase(it) : std::next(it));
+    }
+
+    const RegistryKey key{conn.get(), service};
+    auto found = registry.find(key);
+    if (registry.end() != found)
+    {
+        if (auto presence = found->second.lock())
+        {
+            return presence;
+        }
+    }
+
+    auto presence = Ptr(new ObjectPresence(conn, service));
+    registry[key] = presence;
+    return presence;
+}
+
+
+ObjectPresence::ObjectPresence(DBus::Connection::Ptr conn,
+                               const std::string &service_)
+    : service(service_)
+{
+    proxy = DBus::Proxy::Client::Create(conn, service);
+    prxqry = DBus::Proxy::Utils::Query::Create(proxy);
+
+    subscr = DBus::Signals::SubscriptionManager::Create(conn);
+
+    // Any objects known to exist are lost when the service restarts
+    owner_tgt = DBus::Signals::Target::Create("org.freedesktop.DBus",
+                                              "/org/freedesktop/DBus",
+                                              "org.freedesktop.DBus");
+    subscr->Subscribe(owner_tgt,
+                      "NameOwnerChanged",
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          auto name = glib2::Value::Extract<std::string>(event->params, 0);
+                          if (name == service)
+                          {
+                              owner_changed();
+                          }
+                      });
+
+    // Only services implementing the ObjectManager interface send these
+    objmgr_tgt = DBus::Signals::Target::Create(service,
+                                               "",
+                                               "org.freedesktop.DBus.ObjectManager");
+    subscr->Subscribe(objmgr_tgt,
+                      "InterfacesAdded",
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          add(glib2::Value::Extract<DBus::Object::Path>(event->params, 0));
+                      });
+    subscr->Subscribe(objmgr_tgt,
+                      "InterfacesRemoved",
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          remove(glib2::Value::Extract<DBus::Object::Path>(event->params, 0));
+                      });
+}
+
+
+ObjectPresence::~ObjectPresence() noexcept
+{
+    try
+    {
+        subscr->Unsubscribe(owner_tgt, "NameOwnerChanged");
+        subscr->Unsubscribe(objmgr_tgt, "InterfacesAdded");
+        subscr->Unsubscribe(objmgr_tgt, "InterfacesRemoved");
+    }
+    catch (...)
+    {
+        // Ignore errors during shutdown
+    }
+}
+
+
+bool ObjectPresence::Exists(const DBus::Object::Path &path)
+{
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        if (objects.find(path) != objects.end())
+        {
+            return true;
+        }
+    }
+    return refresh(path);
+}
+
+
+bool ObjectPresence::WaitForObject(const DBus::Object::Path &path,
+                                   const std::chrono::milliseconds timeout)
+{
+    using namespace std::chrono_literals;
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::chrono::milliseconds recheck = 10ms;
+    while (!Exists(path))
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        // Wait until the object is added or the service owner changes,
+        // or re-check the introspection data with an increasing
+        // interval.  The signals might be processed by the same thread
+        // calling this method.
+        std::unique_lock<std::mutex> lock(mtx);
+        const uint64_t owner_gen = owner_changes;
+        if (cv.wait_until(lock,
+                          std::min(now + recheck, deadline),
+                          [this, &path, owner_gen]()
+                          {
+                              return objects.find(path) != objects.end()
+                                     || owner_gen != owner_changes;
+                          }))
+        {
+            if (objects.find(path) != objects.end())
+            {
+                return true;
+            }
+            // A new service owner; check the service right away
+            recheck = 10ms;
+            continue;
+        }
+        recheck = std::min(recheck * 2, std::chrono::milliseconds(250));
+    }
+    return true;
+}
+
+
+void ObjectPresence::add(const DBus::Object::Path &path)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    objects.insert(path);
+    cv.notify_all();
+}
+
+
+void ObjectPresence::remove(const DBus::Object::Path &path)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    objects.erase(path);
+}
+
+
+void ObjectPresence::owner_changed()
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    objects.clear();
+    ++owner_changes;
+    cv.notify_all();
+}
+
+
+bool ObjectPresence::refresh(const DBus::Object::Path &path)
+{
+    DBus::Object::Path parent;
+    std::string child;
+    split_object_path(path, parent, child);
+
+    std::string introsp;
+    try
+    {
+        introsp = prxqry->Introspect(parent);
+    }
+    catch (const DBus::Exception &)
+    {
+        // The service is not available (yet)
+        return false;
     }
 
-    const std::regex lookup_expr{fmt::format(FMT_COMPILE("\\<node name=\"({})\"/\\>"),
-                                             child_object)};
-    std::smatch m;
-    if (std::regex_search(introsp, m, lookup_expr))
+    std::lock_guard<std::mutex> lg(mtx);
+    if (child.empty())
+    {
+        if (introsp.find("<interface") == std::string::npos)
+        {
+            return false;
+        }
+        objects.insert(path);
+    }
+    for (const auto &node : ParseIntrospectionNodes(introsp))
+    {
+        objects.insert(("/" == parent ? "/" : parent + "/") + node);
+    }
+    if (objects.find(path) == objects.end())
     {
-        // If a <node name="$child_object"/> element is found in the
-        // introspection, only a single such node is expected.  The
-        // check for m.size() == 2 is due to m[0] holding the whole regex
-        // match, while m[1] holds just the content of the 'name' attribute.
-        // The content of the 'name' attribute must match the requested
-        // child_object.
-        return (m.size() == 2 && m[1] == child_object);
+        return false;
     }
-    return false;
+    cv.notify_all();
+    return true;
 }
 
-} // namespace GDBusPP::Proxy::Utils
\ No newline at end of file
+} // namespace GDBusPP::Proxy::Utils
@@ -15,7 +15,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <gdbuspp/connection.hpp>
 #include <gdbuspp/proxy.hpp>
+#include <gdbuspp/proxy/utils.hpp>
+#include <gdbuspp/signals/subscriptionmgr.hpp>
 
 /**
  *  Support function for features lacking in GDBus++ v3 and older
@@ -39,4 +50,106 @@ namespace GDBusPP::Proxy::Utils {
 
 bool LookupObject(DBus::Proxy::Client::Ptr proxy, const DBus::Object::Path &path);
 
-}
\ No newline at end of file
+
+/**
+ *  Extracts the names of all the child nodes found in D-Bus
+ *  introspection data, the name attribute of all <node name="..."/>
+ *  elements.
+ *
+ * @param introspection  std::string with the introspection XML data
+ * @return std::vector<std::string> of the child node names
+ */
+std::vector<std::string> ParseIntrospectionNodes(const std::string &introspection);
+
+
+
+/**
+ *  Keeps track of which D-Bus objects are known to exist in a
+ *  specific D-Bus service.
+ *
+ *  Objects are looked up via the introspection data of the parent
+ *  object the first time, and all the child nodes found are cached.
+ *  Later checks for the same objects are then just a local lookup.
+ *
+ *  The cache is kept up-to-date via signals:
+ *
+ *    - NameOwnerChanged from the D-Bus daemon clears the cache when
+ *      the service stops or restarts.  A new service owner also wakes
+ *      up WaitForObject() callers, which then check the service at once.
+ *    - InterfacesAdded and InterfacesRemoved from the service, if it
+ *      implements the org.freedesktop.DBus.ObjectManager interface.
+ *
+ *  Objects which may disappear without such notifications should
+ *  not be checked with this cache; use LookupObject() instead.
+ *
+ *  All callers on the same D-Bus connection share the same object for
+ *  a service.  The object is kept as long as any caller holds on to the
+ *  returned pointer, so callers should keep it for their own lifetime.
+ */
+class ObjectPresence
+{
+  public:
+    using Ptr = std::shared_ptr<ObjectPresence>;
+
+    /**
+     *  Retrieve the ObjectPresence object of a D-Bus service
+     *
+     * @param conn     DBus::Connection::Ptr to use for the service
+     * @param service  std::string with the well-known bus name of the
+     *                 service
+     * @return ObjectPresence::Ptr
+     */
+    [[nodiscard]] static Ptr Create(DBus::Connection::Ptr conn,
+                                    const std::string &service);
+    ~ObjectPresence() noexcept;
+
+    /**
+     *  Checks if an object exists in the service.  The introspection
+     *  data of the parent object is only retrieved if the object
+     *  is not already known.
+     *
+     * @param path   DBus::Object::Path of the object to check for
+     * @return true if the object exists, otherwise false
+     */
+    bool Exists(const DBus::Object::Path &path);
+
+    /**
+     *  Waits for an object to appear in the service.  This returns as
+     *  soon as the object is known to exist, either via the
+     *  InterfacesAdded signal or the introspection data.  The
+     *  introspection data is checked when the service gets a new owner,
+     *  and otherwise with an increasing interval.
+     *
+     * @param path     DBus::Object::Path of the object to wait for
+     * @param timeout  Maximum time to wait for the object
+     * @return true if the object exists, false if it did not appear
+     *         before the timeout
+     */
+    bool WaitForObject(const DBus::Object::Path &path,
+                       const std::chrono::milliseconds timeout);
+
+
+  private:
+    const std::string service;
+    DBus::Proxy::Client::Ptr proxy = nullptr;
+    DBus::Proxy::Utils::Query::Ptr prxqry = nullptr;
+    DBus::Signals::SubscriptionManager::Ptr subscr = nullptr;
+    DBus::Signals::Target::Ptr owner_tgt = nullptr;
+    DBus::Signals::Target::Ptr objmgr_tgt = nullptr;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::unordered_set<std::string> objects;
+
+    /// Increased each time the service owner changes
+    uint64_t owner_changes = 0;
+
+    ObjectPresence(DBus::Connection::Ptr conn, const std::string &service_);
+
+    void add(const DBus::Object::Path &path);
+    void remove(const DBus::Object::Path &path);
+    void owner_changed();
+    bool refresh(const DBus::Object::Path &path);
+};
+
+} // namespace GDBusPP::Proxy::Utils
@@ -0,0 +1,186 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   consumer-loglevel.cpp
+ *
+ * @brief  Implementation of Log::ConsumerLogLevel
+ */
+
+#include <iterator>
+#include <gdbuspp/glib2/utils.hpp>
+#include <gdbuspp/proxy/utils.hpp>
+
+#include "dbus/constants.hpp"
+#include "consumer-loglevel.hpp"
+
+
+namespace Log {
+
+ConsumerLogLevel::Ptr ConsumerLogLevel::Create(DBus::Connection::Ptr conn)
+{
+    static std::mutex registry_mtx;
+    static std::map<DBus::Connection *, std::weak_ptr<ConsumerLogLevel>> registry;
+
+    std::lock_guard<std::mutex> lg(registry_mtx);
+    for (auto it = registry.begin(); it != registry.end();)
+    {
+        it = (it->second.expired() ? registry.erase(it) : std::next(it));
+    }
+
+    auto found = registry.find(conn.get());
+    if (registry.end() != found)
+    {
+        if (auto cll = found->second.lock())
+        {
+            return cll;
+        }
+    }
+
+    auto cll = Ptr(new ConsumerLogLevel(conn));
+    registry[conn.get()] = cll;
+    return cll;
+}
+
+
+ConsumerLogLevel::ConsumerLogLevel(DBus::Connection::Ptr conn)
+    : log_service(Constants::GenServiceName("log"))
+{
+    subscr = DBus::Signals::SubscriptionManager::Create(conn);
+
+    // The sender is verified in process_loglevel(), as the log service
+    // might not be running yet
+    loglevel_tgt = DBus::Signals::Target::Create("",
+                                                 Constants::GenPath("log"),
+                                                 Constants::GenInterface("log"));
+    subscr->Subscribe(loglevel_tgt,
+                      SIGNAL_NAME,
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          process_loglevel(event);
+                      });
+
+    owner_tgt = DBus::Signals::Target::Create("org.freedesktop.DBus",
+                                              "/org/freedesktop/DBus",
+                                              "org.freedesktop.DBus");
+    subscr->Subscribe(owner_tgt,
+                      "NameOwnerChanged",
+                      [this](DBus::Signals::Event::Ptr event)
+                      {
+                          process_owner_change(event);
+                      });
+
+    // Look up the current log service owner once; any later change is
+    // tracked via the NameOwnerChanged signal.  The signal subscription
+    // is done first, to not miss a change happening in between.
+    std::string owner{};
+    try
+    {
+        auto srvqry = DBus::Proxy::Utils::DBusServiceQuery::Create(conn);
+        owner = srvqry->GetNameOwner(log_service);
+    }
+    catch (const DBus::Exception &)
+    {
+        // The log service is not running (yet)
+    }
+
+    std::lock_guard<std::mutex> lg(mtx);
+    if (!owner_changed)
+    {
+        log_busname = owner;
+    }
+}
+
+
+ConsumerLogLevel::~ConsumerLogLevel() noexcept
+{
+    try
+    {
+        subscr->Unsubscribe(loglevel_tgt, SIGNAL_NAME);
+        subscr->Unsubscribe(owner_tgt, "NameOwnerChanged");
+    }
+    catch (...)
+    {
+        // Ignore errors during shutdown
+    }
+}
+
+
+DBus::Signals::SignalArgList ConsumerLogLevel::SignalDeclaration() noexcept
+{
+    return {{"interface", glib2::DataType::DBus<std::string>()},
+            {"log_level", glib2::DataType::DBus<uint32_t>()}};
+}
+
+
+GVariant *ConsumerLogLevel::GetGVariant(const std::string &interface,
+                                        const uint32_t loglev)
+{
+    return g_variant_new("(su)", interface.c_str(), loglev);
+}
+
+
+ConsumerLogLevel::Level ConsumerLogLevel::GetLevel(const std::string &interface)
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    return get_level_locked(interface);
+}
+
+
+void ConsumerLogLevel::process_loglevel(DBus::Signals::Event::Ptr event)
+{
+    try
+    {
+        glib2::Utils::checkParams(__func__, event->params, "(su)", 2);
+        auto interface = glib2::Value::Extract<std::string>(event->params, 0);
+        auto loglev = glib2::Value::Extract<uint32_t>(event->params, 1);
+
+        std::lock_guard<std::mutex> lg(mtx);
+        if (log_busname.empty() || event->sender != log_busname)
+        {
+            // Only the log service may change what is being sent
+            return;
+        }
+        get_level_locked(interface)->store(loglev > 6 ? 6 : static_cast<int32_t>(loglev));
+    }
+    catch (const DBus::Exception &)
+    {
+        // Ignore invalid signals and signals received while the
+        // log service is not available
+    }
+}
+
+
+void ConsumerLogLevel::process_owner_change(DBus::Signals::Event::Ptr event)
+{
+    if (glib2::Value::Extract<std::string>(event->params, 0) != log_service)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lg(mtx);
+    log_busname = glib2::Value::Extract<std::string>(event->params, 2);
+    owner_changed = true;
+    for (auto &[interface, level] : levels)
+    {
+        level->store(NOT_NEGOTIATED);
+    }
+}
+
+
+std::shared_ptr<std::atomic<int32_t>> ConsumerLogLevel::get_level_locked(const std::string &interface)
+{
+    auto &level = levels[interface];
+    if (!level)
+    {
+        level = std::make_shared<std::atomic<int32_t>>(NOT_NEGOTIATED);
+    }
+    return level;
+}
+
+} // namespace Log
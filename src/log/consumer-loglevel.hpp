@@ -0,0 +1,138 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   consumer-loglevel.hpp
+ *
+ * @brief  Keeps track of the log level the net.openvpn.v3.log service
+ *         needs from the log senders in this process
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <gdbuspp/connection.hpp>
+#include <gdbuspp/signals/signal.hpp>
+#include <gdbuspp/signals/subscriptionmgr.hpp>
+
+
+namespace Log {
+
+/**
+ *  The log service computes the highest log level any consumer of the
+ *  Log signals from an attached service needs; its own log level and
+ *  the log level of each active log proxy (ProxyLogEvents).  This level
+ *  is sent to the attached service with the ConsumerLogLevel signal
+ *  each time it changes.
+ *
+ *  This object receives the ConsumerLogLevel signals on behalf of all
+ *  the LogSender objects in the process.  The LogSender objects use the
+ *  log level to avoid sending Log signals nobody will make use of.
+ *
+ *  If the log service has not sent any log level for an interface, or
+ *  the log service disappears from the bus, the log level is
+ *  NOT_NEGOTIATED and the LogSender only filters on its own log level.
+ */
+class ConsumerLogLevel
+{
+  public:
+    using Ptr = std::shared_ptr<ConsumerLogLevel>;
+
+    /// Shared log level value for a specific D-Bus interface
+    using Level = std::shared_ptr<const std::atomic<int32_t>>;
+
+    /// Log level used when the log service has not provided one
+    static constexpr int32_t NOT_NEGOTIATED = -1;
+
+    /// Name of the D-Bus signal carrying the log level
+    static constexpr const char *SIGNAL_NAME = "ConsumerLogLevel";
+
+
+    /**
+     *  Retrieve the ConsumerLogLevel object for a D-Bus connection.  All
+     *  LogSender objects on the same connection share the same object.
+     *
+     * @param conn  DBus::Connection::Ptr where the signals are received
+     * @return ConsumerLogLevel::Ptr
+     */
+    [[nodiscard]] static Ptr Create(DBus::Connection::Ptr conn);
+    ~ConsumerLogLevel() noexcept;
+
+    /**
+     *  Signal declaration of the net.openvpn.v3.log.ConsumerLogLevel signal
+     *
+     * @return DBus::Signals::SignalArgList
+     */
+    static DBus::Signals::SignalArgList SignalDeclaration() noexcept;
+
+    /**
+     *  Prepares the ConsumerLogLevel signal parameters
+     *
+     * @param interface  std::string with the D-Bus interface of the log
+     *                   sender the log level applies to
+     * @param loglev     uint32_t with the log level
+     *
+     * @return GVariant * tuple with the signal parameters
+     */
+    static GVariant *GetGVariant(const std::string &interface,
+                                 const uint32_t loglev);
+
+    /**
+     *  Retrieve the consumer log level for Log signals sent with a
+     *  specific D-Bus interface.  The returned value is updated each
+     *  time the log service sends a new log level.
+     *
+     * @param interface  std::string with the D-Bus interface of the Log
+     *                   signals
+     *
+     * @return ConsumerLogLevel::Level
+     */
+    Level GetLevel(const std::string &interface);
+
+
+  private:
+    DBus::Signals::SubscriptionManager::Ptr subscr = nullptr;
+    DBus::Signals::Target::Ptr loglevel_tgt = nullptr;
+    DBus::Signals::Target::Ptr owner_tgt = nullptr;
+    const std::string log_service;
+
+    std::mutex mtx;
+
+    /// Unique bus name of the log service, empty if it is not running
+    std::string log_busname{};
+
+    /// Set when log_busname has been updated by a NameOwnerChanged signal
+    bool owner_changed = false;
+
+    std::map<std::string, std::shared_ptr<std::atomic<int32_t>>> levels{};
+
+    ConsumerLogLevel(DBus::Connection::Ptr conn);
+
+    /**
+     *  Called for each received ConsumerLogLevel signal.  Only signals
+     *  sent by the log service are considered.  This does not do any
+     *  D-Bus calls, the log service owner is already known.
+     */
+    void process_loglevel(DBus::Signals::Event::Ptr event);
+
+    /**
+     *  Called when the log service bus name changes owner.  All the log
+     *  levels are reset, as a new log service needs to provide them again.
+     */
+    void process_owner_change(DBus::Signals::Event::Ptr event);
+
+    std::shared_ptr<std::atomic<int32_t>> get_level_locked(const std::string &interface);
+};
+
+} // namespace Log
@@ -80,6 +80,12 @@ class DBusLogger
 
     void log(const std::string &prefix, const std::string &str) const noexcept
     {
+        // Skip preparing log events nobody will see
+        if (!logger->LogWanted(LogCategory::DEBUG))
+        {
+            return;
+        }
+
         std::string l(str);
         try
         {
@@ -36,6 +36,9 @@ LogSender::LogSender(DBus::Connection::Ptr dbuscon,
 {
     RegisterSignal("Log",
                    Events::Log::SignalDeclaration(session_token));
+
+    consumer = Log::ConsumerLogLevel::Create(dbuscon);
+    consumer_level = consumer->GetLevel(interf);
 }
 
 
@@ -45,6 +48,12 @@ const LogGroup LogSender::GetLogGroup() const
 }
 
 
+bool LogSender::LogWanted(const LogCategory catg) const noexcept
+{
+    return EventFilter::Allow(catg) && (logwr || consumer_allow(catg));
+}
+
+
 void LogSender::Log(const Events::Log &logev, const bool duplicate_check, const std::string &target)
 {
     // Don't log an empty messages or if log level filtering allows it
@@ -69,42 +78,70 @@ void LogSender::Log(const Events::Log &logev, const bool duplicate_check, const
         logwr->Write(logev);
     }
 
-    SendGVariant("Log", logev.GetGVariantTuple());
+    // Don't send Log signals the log service will throw away
+    if (consumer_allow(logev.category))
+    {
+        SendGVariant("Log", logev.GetGVariantTuple());
+    }
 }
 
 
 void LogSender::Debug(const std::string &msg, const bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::DEBUG))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::DEBUG, msg), duplicate_check);
 }
 
 void LogSender::Debug_wnl(const std::string &msg, const bool duplicate_check)
 {
     // Variant of Debug() (with newline) which will not filter out newline (\n)
+    if (!LogWanted(LogCategory::DEBUG))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::DEBUG, msg, false), duplicate_check);
 }
 
 
 void LogSender::LogVerb2(const std::string &msg, const bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::VERB2))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::VERB2, msg), duplicate_check);
 }
 
 
 void LogSender::LogVerb1(const std::string &msg, const bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::VERB1))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::VERB1, msg), duplicate_check);
 }
 
 
 void LogSender::LogInfo(const std::string &msg, const bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::INFO))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::INFO, msg), duplicate_check);
 }
 
 
 void LogSender::LogWarn(const std::string &msg, const bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::WARN))
+    {
+        return;
+    }
     Log(Events::Log(log_group, LogCategory::WARN, msg), duplicate_check);
 }
 
@@ -140,3 +177,12 @@ LogWriter *LogSender::GetLogWriter()
 {
     return logwr;
 }
+
+
+bool LogSender::consumer_allow(const LogCategory catg) const noexcept
+{
+    // Without any log level from the log service, everything passing
+    // the local log level filter is sent
+    const int32_t level = (consumer_level ? consumer_level->load() : Log::ConsumerLogLevel::NOT_NEGOTIATED);
+    return level < 0 || EventFilter::AllowLevel(level, catg);
+}
@@ -19,6 +19,7 @@
 #include <gdbuspp/signals/subscriptionmgr.hpp>
 
 #include "events/status.hpp"
+#include "consumer-loglevel.hpp"
 #include "logfilter.hpp"
 #include "logwriter.hpp"
 
@@ -39,6 +40,19 @@ class LogSender : public DBus::Signals::Group,
 
     const LogGroup GetLogGroup() const;
 
+    /**
+     *  Checks if a log event of a specific LogCategory would be processed
+     *  at all.  This considers both the local log level and the log level
+     *  the log service has reported it needs; see Log::ConsumerLogLevel.
+     *
+     *  This can be used to avoid preparing log messages which would be
+     *  thrown away anyway.
+     *
+     * @param catg  LogCategory of the log event
+     * @return bool, true if the log event would be written or sent
+     */
+    bool LogWanted(const LogCategory catg) const noexcept;
+
     virtual void Log(const Events::Log &logev, const bool duplicate_check = false, const std::string &target = "");
     virtual void Debug(const std::string &msg, const bool duplicate_check = false);
     virtual void Debug_wnl(const std::string &msg, const bool duplicate_check = false);
@@ -61,4 +75,11 @@ class LogSender : public DBus::Signals::Group,
 
   private:
     Events::Log last_logevent;
+    Log::ConsumerLogLevel::Ptr consumer = nullptr;
+    Log::ConsumerLogLevel::Level consumer_level = nullptr;
+
+    /**
+     *  Checks if the log service needs log events of this LogCategory
+     */
+    bool consumer_allow(const LogCategory catg) const noexcept;
 };
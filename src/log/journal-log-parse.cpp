@@ -18,6 +18,8 @@
 #ifdef HAVE_SYSTEMD
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <ctime>
@@ -34,19 +36,22 @@ namespace Journald {
 //  Log::Journald::LogEntry
 //
 
-LogEntry::LogEntry(sd_journal *journal)
+LogEntry::LogEntry(sd_journal *journal, const Detail detail)
 {
     realtime = extract_journal_tstamp(journal);
     timestamp = timestamp_to_str(realtime);
-    sender = extract_journal_field(journal, "O3_SENDER");
-    sender_pid = extract_journal_field(journal, "O3_SENDER_PID");
-    interface = extract_journal_field(journal, "O3_INTERFACE");
-    method = extract_journal_field(journal, "O3_METHOD");
-    property = extract_journal_field(journal, "O3_PROPERTY");
-    object_path = extract_journal_field(journal, "O3_OBJECT_PATH");
-    int_method = extract_journal_field(journal, "O3_INTERNAL_METHOD");
     logtag = extract_journal_field(journal, "O3_LOGTAG");
-    pid = extract_journal_field(journal, "_PID");
+    if (Detail::FULL == detail)
+    {
+        sender = extract_journal_field(journal, "O3_SENDER");
+        sender_pid = extract_journal_field(journal, "O3_SENDER_PID");
+        interface = extract_journal_field(journal, "O3_INTERFACE");
+        method = extract_journal_field(journal, "O3_METHOD");
+        property = extract_journal_field(journal, "O3_PROPERTY");
+        object_path = extract_journal_field(journal, "O3_OBJECT_PATH");
+        int_method = extract_journal_field(journal, "O3_INTERNAL_METHOD");
+        pid = extract_journal_field(journal, "_PID");
+    }
 
     std::string msg = extract_journal_field(journal, "MESSAGE");
     event = Events::ParseLog(extract_journal_field(journal, "O3_LOG_GROUP"),
@@ -167,7 +172,10 @@ uint64_t LogEntry::extract_journal_tstamp(sd_journal *journal) const
     std::string tstamp = extract_journal_field(journal, "_SOURCE_REALTIME_TIMESTAMP");
     if (tstamp.empty())
     {
-        return -1;
+        // Not all entries carry the timestamp of the source; fall back
+        // to when the journal received it
+        uint64_t rt = 0;
+        return (sd_journal_get_realtime_usec(journal, &rt) < 0 ? -1 : rt);
     };
 
     return ::atol(tstamp.c_str());
@@ -178,11 +186,17 @@ const std::string LogEntry::timestamp_to_str(uint64_t tstmp) const
 {
     // The timestamp granularity in the journal is microseconds.
     // We don't need that kind of granularity and it is easier to
-    // just use the normal time_t type
+    // just use the normal time_t type.  The format is the same as
+    // std::ctime() uses, without its static buffer.
     ::time_t t = tstmp / 1000000;
-    std::string ret(std::ctime(&t));
-    ret.erase(ret.find_last_not_of("\n") + 1);
-    return ret;
+    std::tm tm = {};
+    char buf[64] = {};
+    if (!::localtime_r(&t, &tm)
+        || 0 == std::strftime(buf, sizeof(buf), "%a %b %e %H:%M:%S %Y", &tm))
+    {
+        return std::string();
+    }
+    return std::string(buf);
 }
 
 
@@ -300,10 +314,9 @@ Parse::~Parse() noexcept
 }
 
 
-void Parse::AddFilter(const FilterType ft, const std::string &fval) const
+void Parse::AddFilter(const FilterType ft, const std::string &fval)
 {
     std::stringstream match;
-    int r = 0;
     switch (ft)
     {
     case FilterType::TIMESTAMP:
@@ -343,20 +356,11 @@ void Parse::AddFilter(const FilterType ft, const std::string &fval) const
             {
                 throw FilterException("Date/timestamp value could not be computed");
             }
-            uint64_t seek_point =  mkt * 1000000;
-            r = sd_journal_seek_realtime_usec(journal, seek_point);
-            if (r < 0)
-            {
-                throw FilterException(ft, fval);
-            }
-            if (sd_journal_next(journal) < 0)
-            {
-                throw FilterException("sd_journal_next() failed");
-            }
+            since_usec = mkt * 1000000;
         }
         // The timestamp based filtering is not an ordinary match,
-        // as we just fast-forward in the journald log to the right
-        // point in time.
+        // Stream() will seek to the right point in time in the journal
+        // and stop when passing it when traversing it backwards.
         return;
 
     case FilterType::LOGTAG:
@@ -390,9 +394,141 @@ void Parse::AddFilter(const FilterType ft, const std::string &fval) const
 }
 
 
+size_t Parse::Stream(const EntryHandler &handler, const StreamOptions &opts)
+{
+    if (opts.reverse && opts.follow)
+    {
+        throw Exception("Following new log entries requires forward traversal");
+    }
+    add_default_matches();
+
+    const char *cursor = opts.after_cursor.c_str();
+    size_t count = 0;
+    bool positioned = false;
+    if (opts.reverse || opts.limit > 0)
+    {
+        // Start from the newest entry and walk backwards until the limit,
+        // the start time or the start cursor is reached
+        if (sd_journal_seek_tail(journal) < 0)
+        {
+            throw Exception("Error seeking to the end of the journal");
+        }
+        while (true)
+        {
+            if (sd_journal_previous(journal) <= 0)
+            {
+                // Reached the oldest entry in the journal, which is
+                // where the journal is still positioned
+                positioned = (count > 0);
+                break;
+            }
+            if (!in_range(opts))
+            {
+                break;
+            }
+            ++count;
+
+            // In reverse mode, the newest entries are processed first,
+            // so they are processed while walking
+            if (opts.reverse && !process_entry(handler, opts))
+            {
+                return count;
+            }
+            if (opts.limit > 0 && count >= opts.limit)
+            {
+                positioned = true;
+                break;
+            }
+        }
+        if (opts.reverse)
+        {
+            return count;
+        }
+        count = 0;
+    }
+    else if (!opts.after_cursor.empty())
+    {
+        if (sd_journal_seek_cursor(journal, cursor) < 0)
+        {
+            throw Exception("Invalid journal cursor: " + opts.after_cursor);
+        }
+    }
+    else if (since_usec > 0)
+    {
+        if (sd_journal_seek_realtime_usec(journal, since_usec) < 0)
+        {
+            throw Exception("Error seeking to the start time in the journal");
+        }
+    }
+    else if (sd_journal_seek_head(journal) < 0)
+    {
+        throw Exception("Error seeking to the start of the journal");
+    }
+
+    // Process the entries oldest first.  If the journal is already
+    // positioned on the first entry to process, that one is handled
+    // before moving forward.
+    while (positioned || sd_journal_next(journal) > 0)
+    {
+        positioned = false;
+        if (!in_range(opts))
+        {
+            // Skips the entry a cursor points at, as well as entries
+            // older than the start time when starting from a cursor
+            continue;
+        }
+        ++count;
+        if (!process_entry(handler, opts))
+        {
+            return count;
+        }
+    }
+
+    while (opts.follow)
+    {
+        int r = sd_journal_wait(journal, (uint64_t)-1);
+        if (r < 0)
+        {
+            throw Exception("Error waiting for new journal entries");
+        }
+        while (sd_journal_next(journal) > 0)
+        {
+            ++count;
+            if (!process_entry(handler, opts))
+            {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+
 LogEntries Parse::Retrieve()
 {
     LogEntries ret = {};
+    Stream([&ret](const LogEntry &entry)
+           {
+               ret.push_back(entry);
+               return true;
+           },
+           StreamOptions{});
+    return ret;
+}
+
+
+std::string Parse::GetCursor() const
+{
+    return last_cursor;
+}
+
+
+void Parse::add_default_matches()
+{
+    if (default_matches)
+    {
+        return;
+    }
 
     //  These are the common identifiers OpenVPN 3 Linux logger service
     //  identifiers on Linux
@@ -405,12 +541,38 @@ LogEntries Parse::Retrieve()
     sd_journal_add_match(journal, "SYSLOG_IDENTIFIER=openvpn3-service-logger", 0);
     sd_journal_add_disjunction(journal);
     sd_journal_add_match(journal, "SYSLOG_IDENTIFIER=openvpn3-service-log-dev", 0);
+    default_matches = true;
+}
+
 
-    while (sd_journal_next(journal) > 0)
+bool Parse::in_range(const StreamOptions &opts) const
+{
+    if (since_usec > 0)
     {
-        ret.push_back(LogEntry(journal));
+        uint64_t rt = 0;
+        if (sd_journal_get_realtime_usec(journal, &rt) >= 0 && rt < since_usec)
+        {
+            return false;
+        }
     }
-    return ret;
+    if (!opts.after_cursor.empty()
+        && sd_journal_test_cursor(journal, opts.after_cursor.c_str()) > 0)
+    {
+        return false;
+    }
+    return true;
+}
+
+
+bool Parse::process_entry(const EntryHandler &handler, const StreamOptions &opts)
+{
+    char *cursor = nullptr;
+    if (sd_journal_get_cursor(journal, &cursor) >= 0 && cursor)
+    {
+        last_cursor = cursor;
+        free(cursor);
+    }
+    return handler(LogEntry(journal, opts.detail));
 }
 
 } // namespace Journald
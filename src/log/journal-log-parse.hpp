@@ -16,6 +16,8 @@
 #pragma once
 
 #ifdef HAVE_SYSTEMD
+#include <functional>
+#include <string>
 #include <systemd/sd-journal.h>
 #include <json/json.h>
 
@@ -31,12 +33,22 @@ namespace Journald {
  */
 struct LogEntry
 {
+    /**
+     *  Amount of details to extract from the journal for a log entry
+     */
+    enum class Detail : uint8_t
+    {
+        TEXT, //<  Only the fields used by the plain text output
+        FULL  //<  All fields, as used by GetJSON()
+    };
+
     /**
      * Construct a new LogEntry object
      *
      * @param journal  sd_journal pointer to the log event to parse
+     * @param detail   Detail level of fields to extract (default FULL)
      */
-    LogEntry(sd_journal *journal);
+    LogEntry(sd_journal *journal, const Detail detail = Detail::FULL);
     virtual ~LogEntry() noexcept = default;
 
 
@@ -233,7 +245,50 @@ class Parse
      * @param ft     FilterType of value to filter
      * @param fval   std::string value to match against
      */
-    void AddFilter(const FilterType ft, const std::string &fval) const;
+    void AddFilter(const FilterType ft, const std::string &fval);
+
+
+    /**
+     *  Options controlling how @Stream() traverses the journal
+     */
+    struct StreamOptions
+    {
+        /// Fields to extract for each log entry
+        LogEntry::Detail detail = LogEntry::Detail::FULL;
+
+        /// Max number of log entries to process; 0 means no limit.  In
+        /// forward mode, this will process the N newest entries, oldest
+        /// first.
+        size_t limit = 0;
+
+        /// Process the newest log entries first
+        bool reverse = false;
+
+        /// Keep waiting for new log entries after the last one
+        bool follow = false;
+
+        /// Only process log entries after this journal cursor
+        std::string after_cursor = {};
+    };
+
+    /**
+     *  Called for each log entry found by @Stream().  If it returns
+     *  false, no more log entries will be processed.
+     */
+    using EntryHandler = std::function<bool(const LogEntry &)>;
+
+
+    /**
+     *  Processes all the matching log entries related to OpenVPN 3 Linux,
+     *  one at a time.  Log entries are only parsed when reached, and no
+     *  more than one log entry is kept in memory at any time.
+     *
+     * @param handler  EntryHandler called for each log entry
+     * @param opts     StreamOptions controlling the traversal
+     * @return size_t with the number of log entries processed
+     * @throws Parse::Exception on journal errors or invalid options
+     */
+    size_t Stream(const EntryHandler &handler, const StreamOptions &opts);
 
 
     /**
@@ -245,8 +300,25 @@ class Parse
      */
     LogEntries Retrieve();
 
+
+    /**
+     *  Retrieve the journal cursor of the last log entry processed by
+     *  @Stream().  This can be given to StreamOptions::after_cursor to
+     *  resume a query later on.
+     *
+     * @return std::string with the cursor, empty if no entry was processed
+     */
+    std::string GetCursor() const;
+
   private:
     sd_journal *journal = nullptr;
+    uint64_t since_usec = 0;
+    bool default_matches = false;
+    std::string last_cursor = {};
+
+    void add_default_matches();
+    bool in_range(const StreamOptions &opts) const;
+    bool process_entry(const EntryHandler &handler, const StreamOptions &opts);
 };
 
 
@@ -0,0 +1,308 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file log-eventqueue.hpp
+ *
+ * @brief  Bounded multi-producer/single-consumer queue used by the
+ *         net.openvpn.v3.log service to decouple the reception of Log
+ *         signals from writing them to the log destination.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace LogService {
+
+/**
+ *  Counters describing the activity of an EventQueue
+ */
+struct EventQueueStatistics
+{
+    /// Number of items accepted into the queue
+    uint64_t enqueued = 0;
+
+    /// Number of items processed by the batch handler without errors
+    uint64_t processed = 0;
+
+    /// Number of items in batches where the batch handler failed
+    uint64_t failed = 0;
+
+    /// Number of items discarded because the queue was full
+    uint64_t dropped = 0;
+
+    /// Number of times a producer had to wait for free space
+    uint64_t blocked = 0;
+
+    /// Number of batches handed over to the batch handler
+    uint64_t batches = 0;
+
+    /// Number of items currently waiting in the queue
+    size_t depth = 0;
+
+    /// Highest number of items seen waiting in the queue
+    size_t high_watermark = 0;
+};
+
+
+/**
+ *  A bounded queue where items are pushed by any thread and processed
+ *  in batches by a dedicated worker thread.
+ *
+ *  When the queue is full, ordinary items are dropped right away, while
+ *  items flagged as important makes the producer wait up to a bounded
+ *  time for the worker thread to catch up (backpressure) before they are
+ *  dropped as well.  All of this is accounted for in the statistics.
+ *
+ * @tparam T  Item type kept in the queue
+ */
+template <typename T>
+class EventQueue
+{
+  public:
+    using Ptr = std::shared_ptr<EventQueue<T>>;
+    using Batch = std::vector<T>;
+
+    /**
+     *  Called by the worker thread with the next batch of items.  No
+     *  locks are held while this is called.
+     */
+    using BatchHandler = std::function<void(Batch &)>;
+
+    /// Default max number of items waiting in the queue
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    /// Default max time an important item may wait for free space
+    static constexpr std::chrono::milliseconds DEFAULT_MAX_BLOCK{100};
+
+    /// Max number of items handed over to the batch handler at once
+    static constexpr size_t MAX_BATCH_SIZE = 256;
+
+
+    /**
+     *  Create a new queue and start the worker thread
+     *
+     * @param handler    BatchHandler processing the queued items
+     * @param capacity   size_t with the max number of items waiting
+     * @param max_block  std::chrono::milliseconds of how long an important
+     *                   item may wait for free space in the queue
+     *
+     * @return EventQueue<T>::Ptr
+     */
+    [[nodiscard]] static Ptr Create(BatchHandler handler,
+                                    size_t capacity = DEFAULT_CAPACITY,
+                                    std::chrono::milliseconds max_block = DEFAULT_MAX_BLOCK)
+    {
+        return Ptr(new EventQueue<T>(std::move(handler), capacity, max_block));
+    }
+
+
+    /**
+     *  Stops the worker thread.  All items already in the queue are
+     *  processed before this returns.
+     */
+    ~EventQueue() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lg(mtx_);
+            shutdown_ = true;
+        }
+        consumer_cv_.notify_all();
+        producer_cv_.notify_all();
+
+        if (worker_.valid())
+        {
+            worker_.wait();
+        }
+    }
+
+
+    /**
+     *  Add a new item to the queue
+     *
+     * @param item       T item to add
+     * @param important  bool, if true the caller may be blocked for a
+     *                   short while if the queue is full
+     *
+     * @return true if the item was queued, false if it was dropped
+     */
+    bool Push(T &&item, bool important = false)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (queue_.size() >= capacity_)
+        {
+            bool space = false;
+            if (important && !shutdown_)
+            {
+                ++stats_.blocked;
+                space = producer_cv_.wait_for(lock,
+                                              max_block_,
+                                              [this]()
+                                              {
+                                                  return shutdown_ || queue_.size() < capacity_;
+                                              });
+                space &= !shutdown_;
+            }
+            if (!space)
+            {
+                ++stats_.dropped;
+                return false;
+            }
+        }
+
+        bool wakeup = queue_.empty();
+        queue_.push_back(std::move(item));
+        ++stats_.enqueued;
+        if (queue_.size() > stats_.high_watermark)
+        {
+            stats_.high_watermark = queue_.size();
+        }
+        lock.unlock();
+
+        if (wakeup)
+        {
+            consumer_cv_.notify_one();
+        }
+        return true;
+    }
+
+
+    /**
+     *  Wait until all items queued before this call have been processed
+     */
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        const uint64_t target = stats_.enqueued;
+        idle_cv_.wait(lock,
+                      [this, target]()
+                      {
+                          return shutdown_
+                                 || stats_.processed + stats_.failed >= target;
+                      });
+    }
+
+
+    /**
+     *  Retrieve the current queue statistics
+     *
+     * @return EventQueueStatistics
+     */
+    EventQueueStatistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lg(mtx_);
+        EventQueueStatistics ret = stats_;
+        ret.depth = queue_.size();
+        return ret;
+    }
+
+
+    /**
+     *  Retrieve the max number of items which can wait in the queue
+     *
+     * @return size_t
+     */
+    size_t GetCapacity() const noexcept
+    {
+        return capacity_;
+    }
+
+
+  private:
+    BatchHandler handler_;
+    const size_t capacity_;
+    const std::chrono::milliseconds max_block_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable consumer_cv_;
+    std::condition_variable producer_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<T> queue_;
+    EventQueueStatistics stats_;
+    bool shutdown_ = false;
+    std::future<void> worker_;
+
+
+    EventQueue(BatchHandler handler,
+               size_t capacity,
+               std::chrono::milliseconds max_block)
+        : handler_(std::move(handler)),
+          capacity_(capacity > 0 ? capacity : 1),
+          max_block_(max_block)
+    {
+        worker_ = std::async(std::launch::async,
+                             [this]()
+                             {
+                                 worker();
+                             });
+    }
+
+
+    void worker()
+    {
+        Batch batch;
+        batch.reserve(std::min(capacity_, MAX_BATCH_SIZE));
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (true)
+        {
+            consumer_cv_.wait(lock,
+                              [this]()
+                              {
+                                  return shutdown_ || !queue_.empty();
+                              });
+            if (queue_.empty())
+            {
+                // Only reached on shutdown with nothing left to process
+                break;
+            }
+
+            // Take out the oldest items, up to the max batch size
+            const size_t count = std::min(queue_.size(), MAX_BATCH_SIZE);
+            for (size_t i = 0; i < count; ++i)
+            {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+            lock.unlock();
+            producer_cv_.notify_all();
+
+            bool failed = false;
+            try
+            {
+                handler_(batch);
+            }
+            catch (...)
+            {
+                // The handler is responsible for its own error reporting;
+                // the worker must continue regardless
+                failed = true;
+            }
+            batch.clear();
+
+            lock.lock();
+            (failed ? stats_.failed : stats_.processed) += count;
+            ++stats_.batches;
+            idle_cv_.notify_all();
+        }
+        idle_cv_.notify_all();
+    }
+};
+
+} // namespace LogService
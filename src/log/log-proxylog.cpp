@@ -45,16 +45,18 @@ ProxyLogEvents::ProxyLogEvents(DBus::Connection::Ptr connection_,
                                const std::string &recv_tgt,
                                const DBus::Object::Path &session_objpath,
                                const std::string &session_interf,
-                               const uint32_t init_loglev)
+                               const uint32_t init_loglev,
+                               ChangeCallback changed_cb)
     : DBus::Object::Base(generate_path_uuid(Constants::GenPath("log/proxy"), 'l'),
                          Constants::GenInterface("log")),
       connection(connection_), object_mgr(obj_mgr), log(log_),
       filter(Log::EventFilter::Create(init_loglev)),
       session_path(session_objpath),
-      receiver_target(recv_tgt)
+      receiver_target(recv_tgt),
+      changed_callback(std::move(changed_cb))
 
 {
-    credsqry = DBus::Credentials::Query::Create(connection);
+    credsqry = GDBusPP::Credentials::Cache::Create(connection);
     target_uid = credsqry->GetUID(recv_tgt);
     signal_proxy = DBus::Signals::Group::Create<ProxyLogSignals>(connection_,
                                                                  session_objpath,
@@ -64,7 +66,12 @@ ProxyLogEvents::ProxyLogEvents(DBus::Connection::Ptr connection_,
     AddMethod("Remove",
               [this](DBus::Object::Method::Arguments::Ptr args)
               {
+                  removed = true;
                   object_mgr->RemoveObject(GetPath());
+                  if (changed_callback)
+                  {
+                      changed_callback();
+                  }
                   args->SetMethodReturn(nullptr);
               });
 
@@ -79,6 +86,10 @@ ProxyLogEvents::ProxyLogEvents(DBus::Connection::Ptr connection_,
             -> DBus::Object::Property::Update::Ptr
         {
             filter->SetLogLevel(glib2::Value::Get<uint32_t>(value));
+            if (changed_callback)
+            {
+                changed_callback();
+            }
             auto upd = prop.PrepareUpdate();
             upd->AddValue(filter->GetLogLevel());
             return upd;
@@ -147,9 +158,21 @@ std::string ProxyLogEvents::GetReceiverTarget() const noexcept
 }
 
 
+uint32_t ProxyLogEvents::GetLogLevel() const noexcept
+{
+    return filter->GetLogLevel();
+}
+
+
+bool ProxyLogEvents::IsRemoved() const noexcept
+{
+    return removed;
+}
+
+
 void ProxyLogEvents::SendLog(const Events::Log &logev) const
 {
-    if (filter->Allow(logev))
+    if (!removed && filter->Allow(logev))
     {
         signal_proxy->SendLog(logev);
     }
@@ -159,6 +182,10 @@ void ProxyLogEvents::SendLog(const Events::Log &logev) const
 void ProxyLogEvents::SendStatusChange(const DBus::Object::Path &path,
                                       const Events::Status &stchgev) const
 {
+    if (removed)
+    {
+        return;
+    }
     signal_proxy->SendStatusChange(stchgev);
 }
 
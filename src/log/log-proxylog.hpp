@@ -15,12 +15,14 @@
 
 #pragma once
 
-#include <gdbuspp/credentials/query.hpp>
+#include <atomic>
+#include <functional>
 #include <gdbuspp/object/manager.hpp>
 #include <gdbuspp/signals/group.hpp>
 #include <gdbuspp/signals/target.hpp>
 
 #include "dbus/constants.hpp"
+#include "dbus/credentials-cache.hpp"
 #include "dbus/path.hpp"
 #include "dbus/signals/log.hpp"
 #include "dbus/signals/statuschange.hpp"
@@ -63,16 +65,29 @@ class ProxyLogEvents : public DBus::Object::Base
   public:
     // using Ptr = std::shared_ptr<ProxyLogEvents>;
 
+    /// Called when the log level is changed or the proxy is removed
+    using ChangeCallback = std::function<void()>;
+
     ProxyLogEvents(DBus::Connection::Ptr connection_,
                    DBus::Object::Manager::Ptr obj_mgr,
                    LogService::Logger::Ptr log_,
                    const std::string &recv_tgt,
                    const DBus::Object::Path &session_objpath,
                    const std::string &session_interf,
-                   const uint32_t init_loglev);
+                   const uint32_t init_loglev,
+                   ChangeCallback changed_cb = nullptr);
     virtual ~ProxyLogEvents() noexcept;
 
     std::string GetReceiverTarget() const noexcept;
+    uint32_t GetLogLevel() const noexcept;
+
+    /**
+     *  Checks if the receiver has removed this proxy via the Remove
+     *  D-Bus method.  Removed proxies do not forward anything.
+     *
+     * @return bool, true if the proxy has been removed
+     */
+    bool IsRemoved() const noexcept;
 
     void SendLog(const Events::Log &logev) const;
     void SendStatusChange(const DBus::Object::Path &path,
@@ -89,8 +104,10 @@ class ProxyLogEvents : public DBus::Object::Base
     DBus::Object::Path session_path = {};
     const std::string receiver_target;
     uid_t target_uid;
-    DBus::Credentials::Query::Ptr credsqry = nullptr;
+    GDBusPP::Credentials::Cache::Ptr credsqry = nullptr;
     ProxyLogSignals::Ptr signal_proxy = nullptr;
+    ChangeCallback changed_callback = nullptr;
+    std::atomic<bool> removed{false};
 };
 
 } // namespace LogService
@@ -12,6 +12,8 @@
  *  @brief Implements the basic net.openvpn.v3.log service handler
  */
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 
 #include "build-config.h"
@@ -35,6 +37,35 @@ class MethodError : public DBus::Object::Method::Exception
 
 
 
+//
+//
+//  LogService::ConsumerLogLevelSignal
+//
+//
+
+
+
+ConsumerLogLevelSignal::ConsumerLogLevelSignal(DBus::Connection::Ptr conn,
+                                               const std::string &busname)
+    : DBus::Signals::Group(conn,
+                           Constants::GenPath("log"),
+                           Constants::GenInterface("log"))
+{
+    RegisterSignal(Log::ConsumerLogLevel::SIGNAL_NAME,
+                   Log::ConsumerLogLevel::SignalDeclaration());
+    AddTarget(busname);
+}
+
+
+void ConsumerLogLevelSignal::Send(const std::string &interface,
+                                  const uint32_t loglev)
+{
+    SendGVariant(Log::ConsumerLogLevel::SIGNAL_NAME,
+                 Log::ConsumerLogLevel::GetGVariant(interface, loglev));
+}
+
+
+
 //
 //
 //  LogService::AttachedService
@@ -47,6 +78,8 @@ AttachedService::Ptr AttachedService::Create(
     DBus::Connection::Ptr conn,
     DBus::Object::Manager::Ptr object_mgr,
     LogService::Logger::Ptr log,
+    Log::EventFilter::Ptr filter,
+    LogEventQueue::Ptr queue,
     DBus::Signals::SubscriptionManager::Ptr submgr,
     LogTag::Ptr tag,
     const std::string &busname,
@@ -55,6 +88,8 @@ AttachedService::Ptr AttachedService::Create(
     return Ptr(new AttachedService(conn,
                                    object_mgr,
                                    log,
+                                   filter,
+                                   queue,
                                    submgr,
                                    tag,
                                    busname,
@@ -65,15 +100,20 @@ AttachedService::Ptr AttachedService::Create(
 AttachedService::AttachedService(DBus::Connection::Ptr conn,
                                  DBus::Object::Manager::Ptr obj_mgr,
                                  LogService::Logger::Ptr logr,
+                                 Log::EventFilter::Ptr filter,
+                                 LogEventQueue::Ptr queue,
                                  DBus::Signals::SubscriptionManager::Ptr submgr,
                                  LogTag::Ptr tag,
                                  const std::string &busname,
                                  const std::string &interface)
     : logtag(tag),
       src_target(DBus::Signals::Target::Create(busname, "", interface)),
-      connection(conn), object_mgr(obj_mgr), log(logr)
+      connection(conn), object_mgr(obj_mgr), log(logr),
+      logfilter(filter), event_queue(queue),
+      sender_details(SenderDetails::Create())
 {
-    creds_query = DBus::Credentials::Query::Create(connection);
+    consumer_signal = DBus::Signals::Group::Create<ConsumerLogLevelSignal>(conn, busname);
+
     log_handler = Signals::ReceiveLog::Create(
         submgr,
         src_target,
@@ -110,6 +150,13 @@ AttachedService::~AttachedService() noexcept
 DBus::Object::Path AttachedService::AddProxyTarget(const std::string &recv_tgt,
                                                    const DBus::Object::Path &session_path)
 {
+    // Proxies removed by the receiver are not in use any more
+    for (auto it = proxies.begin(); it != proxies.end();)
+    {
+        it = (it->second->IsRemoved() ? proxies.erase(it) : std::next(it));
+    }
+
+    std::weak_ptr<AttachedService> self = weak_from_this();
     auto proxy_obj = object_mgr->CreateObject<ProxyLogEvents>(
         connection,
         object_mgr,
@@ -117,74 +164,87 @@ DBus::Object::Path AttachedService::AddProxyTarget(const std::string &recv_tgt,
         recv_tgt,
         session_path,
         src_target->object_interface,
-        6);
+        6,
+        [self]()
+        {
+            if (auto attached = self.lock())
+            {
+                attached->UpdateConsumerLogLevel();
+            }
+        });
 
     proxies[proxy_obj->GetPath()] = proxy_obj;
     log->LogVerb1("Log proxy configured for " + session_path
                   + " on " + proxy_obj->GetPath()
                   + " sending to " + recv_tgt);
+    UpdateConsumerLogLevel();
     return proxy_obj->GetPath();
 }
 
 
 void AttachedService::OverrideObjectPath(const DBus::Object::Path &new_path)
 {
-    override_obj_path = new_path;
+    sender_details->SetOverridePath(new_path);
 }
 
 
-void AttachedService::process_log_event(const Events::Log &logevent)
+void AttachedService::UpdateConsumerLogLevel()
 {
-    auto meta = LogMetaData::Create();
-    meta->AddMeta("sender", logevent.sender->busname);
-    if (!override_obj_path.empty())
+    uint32_t level = (logfilter ? logfilter->GetLogLevel() : 6);
+    for (const auto &[proxy_path, proxy] : proxies)
     {
-        meta->AddMeta("object_path", override_obj_path);
-        meta->AddMeta("sender_object_path", logevent.sender->object_path);
+        if (!proxy->IsRemoved())
+        {
+            level = std::max(level, proxy->GetLogLevel());
+        }
     }
-    else
+
+    std::lock_guard<std::mutex> lg(consumer_mtx);
+    if (static_cast<int32_t>(level) == consumer_level)
     {
-        meta->AddMeta("object_path", logevent.sender->object_path);
+        return;
     }
-    meta->AddMeta("interface", logevent.sender->object_interface);
 
     try
     {
-        // Lookup the sender bus name from a lookup cache, to reduce
-        // the mount of D-Bus calls
-        pid_t sender_pid = 0;
-        auto node = busname_pid_map.extract(logevent.sender->busname);
-        if (node.empty())
-        {
-            // If the sender PID was not cached, look it up and store it
-            sender_pid = creds_query->GetPID(logevent.sender->busname);
-            busname_pid_map[logevent.sender->busname] = sender_pid;
-        }
-        else
-        {
-            sender_pid = node.mapped();
-        }
-        if (sender_pid > 0)
-        {
-            meta->AddMeta("sender_pid", sender_pid);
-        }
+        consumer_signal->Send(src_target->object_interface, level);
+        consumer_level = static_cast<int32_t>(level);
+        log->Debug("Consumer log level for " + logtag->str()
+                   + " changed to " + std::to_string(level));
     }
-    catch (const DBus::Exception &)
+    catch (const DBus::Signals::Exception &excp)
     {
-        // Ignore if this lookup fails; it's not critical and just
-        // useful additional info if available
+        log->LogWarn("Could not send consumer log level to "
+                     + logtag->str() + ": " + excp.what());
     }
+}
 
-    Events::Log local_event(logevent);
-    local_event.AddLogTag(logtag);
-    log->Log(local_event, meta);
 
-    for (const auto &[proxy_tgt, sig_proxy] : proxies)
+void AttachedService::process_log_event(const Events::Log &logevent)
+{
+    if (!proxies.empty())
     {
         Events::Log ev(logevent);
         ev.RemoveToken();
-        sig_proxy->SendLog(ev);
+        for (const auto &[proxy_tgt, sig_proxy] : proxies)
+        {
+            sig_proxy->SendLog(ev);
+        }
     }
+
+    // Events which will be filtered out by the logger anyhow
+    // are not queued at all
+    if (logfilter && !logfilter->Allow(logevent))
+    {
+        return;
+    }
+
+    // Preparing the meta data and writing the log event is done by
+    // the log event queue worker thread.  If the queue is full, only
+    // warnings and more severe events may hold back the caller.
+    QueuedLogEvent queued{logevent, sender_details};
+    queued.event.AddLogTag(logtag);
+    event_queue->Push(std::move(queued), logevent.category >= LogCategory::WARN);
 }
 
 
@@ -213,13 +273,18 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
     : DBus::Object::Base(Constants::GenPath("log"),
                          Constants::GenInterface("log")),
       connection(connection_), object_mgr(obj_mgr), config(cfgobj),
-      logwr(cfgobj.servicelog->GetLogWriter()),
       log(cfgobj.servicelog),
       logfilter(cfgobj.logfilter)
 {
     DisableIdleDetector(true);
-    dbuscreds = DBus::Credentials::Query::Create(connection);
+    dbuscreds = GDBusPP::Credentials::Cache::Create(connection);
     subscrmgr = DBus::Signals::SubscriptionManager::Create(connection);
+    event_queue = LogEventQueue::Create(
+        [this](LogEventQueue::Batch &batch)
+        {
+            process_log_batch(batch);
+        },
+        config.queue_size);
 
     auto meth_attach = AddMethod(
         "Attach",
@@ -283,12 +348,12 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
         glib2::DataType::DBus<bool>(),
         [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
         {
-            return glib2::Value::Create(logwr->LogMetaEnabled());
+            return glib2::Value::Create(log->LogMetaEnabled());
         },
         [&](const DBus::Object::Property::BySpec &prop, GVariant *value) -> DBus::Object::Property::Update::Ptr
         {
-            logwr->EnableLogMeta(glib2::Value::Get<bool>(value));
-            return save_property(prop, "service-log-dbus-details", logwr->LogMetaEnabled());
+            log->EnableLogMeta(glib2::Value::Get<bool>(value));
+            return save_property(prop, "service-log-dbus-details", log->LogMetaEnabled());
         });
 
     AddPropertyBySpec(
@@ -296,12 +361,12 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
         glib2::DataType::DBus<bool>(),
         [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
         {
-            return glib2::Value::Create(logwr->MessagePrependEnabled());
+            return glib2::Value::Create(log->MessagePrependEnabled());
         },
         [&](const DBus::Object::Property::BySpec &prop, GVariant *value) -> DBus::Object::Property::Update::Ptr
         {
-            logwr->EnableMessagePrepend(glib2::Value::Get<bool>(value));
-            return save_property(prop, "no-logtag-prefix", !logwr->MessagePrependEnabled());
+            log->EnableMessagePrepend(glib2::Value::Get<bool>(value));
+            return save_property(prop, "no-logtag-prefix", !log->MessagePrependEnabled());
         });
 
     AddPropertyBySpec(
@@ -309,12 +374,12 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
         glib2::DataType::DBus<bool>(),
         [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
         {
-            return glib2::Value::Create(logwr->TimestampEnabled());
+            return glib2::Value::Create(log->TimestampEnabled());
         },
         [&](const DBus::Object::Property::BySpec &prop, GVariant *value) -> DBus::Object::Property::Update::Ptr
         {
-            logwr->EnableTimestamp(glib2::Value::Get<bool>(value));
-            return save_property(prop, "timestamp", logwr->TimestampEnabled());
+            log->EnableTimestamp(glib2::Value::Get<bool>(value));
+            return save_property(prop, "timestamp", log->TimestampEnabled());
         });
 
 
@@ -328,6 +393,14 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
         [&](const DBus::Object::Property::BySpec &prop, GVariant *value) -> DBus::Object::Property::Update::Ptr
         {
             logfilter->SetLogLevel(glib2::Value::Get<uint32_t>(value));
+            {
+                // The attached services may need to send more or less
+                std::lock_guard<std::mutex> guard(attachmap_mtx);
+                for (const auto &[tag, attached] : log_attach_subscr)
+                {
+                    attached->UpdateConsumerLogLevel();
+                }
+            }
             return save_property(prop, "log-level", static_cast<int>(logfilter->GetLogLevel()));
         });
 
@@ -351,6 +424,90 @@ ServiceHandler::ServiceHandler(DBus::Connection::Ptr connection_,
         {
             return glib2::Value::Create<uint32_t>(log_attach_subscr.size());
         });
+
+    AddPropertyBySpec(
+        "queue_capacity",
+        glib2::DataType::DBus<uint32_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint32_t>(event_queue->GetCapacity());
+        });
+
+    AddPropertyBySpec(
+        "queue_depth",
+        glib2::DataType::DBus<uint32_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint32_t>(event_queue->GetStatistics().depth);
+        });
+
+    AddPropertyBySpec(
+        "queue_high_watermark",
+        glib2::DataType::DBus<uint32_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint32_t>(event_queue->GetStatistics().high_watermark);
+        });
+
+    AddPropertyBySpec(
+        "queue_events_written",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(event_queue->GetStatistics().processed);
+        });
+
+    AddPropertyBySpec(
+        "queue_events_failed",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(event_queue->GetStatistics().failed);
+        });
+
+    AddPropertyBySpec(
+        "queue_events_dropped",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(event_queue->GetStatistics().dropped);
+        });
+
+    AddPropertyBySpec(
+        "queue_events_blocked",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(event_queue->GetStatistics().blocked);
+        });
+
+    AddPropertyBySpec(
+        "credentials_cache_hits",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(dbuscreds->GetStats().hits);
+        });
+
+    AddPropertyBySpec(
+        "credentials_cache_misses",
+        glib2::DataType::DBus<uint64_t>(),
+        [&](const DBus::Object::Property::BySpec &prop) -> GVariant *
+        {
+            return glib2::Value::Create<uint64_t>(dbuscreds->GetStats().misses);
+        });
+}
+
+
+ServiceHandler::~ServiceHandler() noexcept
+{
+    // Stop receiving new log events before the queue worker thread
+    // completes writing the already queued events
+    {
+        std::lock_guard<std::mutex> guard(attachmap_mtx);
+        log_attach_subscr.clear();
+    }
+    event_queue.reset();
 }
 
 
@@ -419,10 +576,13 @@ void ServiceHandler::method_attach(DBus::Object::Method::Arguments::Ptr args)
     log_attach_subscr[tag->hash] = AttachedService::Create(connection,
                                                            object_mgr,
                                                            log,
+                                                           logfilter,
+                                                           event_queue,
                                                            subscrmgr,
                                                            tag,
                                                            args->GetCallerBusName(),
                                                            interface);
+    log_attach_subscr[tag->hash]->UpdateConsumerLogLevel();
     std::ostringstream msg;
     msg << "Attached: " << *tag << "  " << tag->tag
         << ", pid " << std::to_string(caller_pid);
@@ -553,6 +713,70 @@ void ServiceHandler::method_proxy_log_events(DBus::Object::Method::Arguments::Pt
 // LogService::ServiceHandler - Misc private methods
 
 
+void ServiceHandler::process_log_batch(LogEventQueue::Batch &batch)
+{
+    log->BeginBatch();
+    try
+    {
+        for (auto &queued : batch)
+        {
+            write_queued_event(queued);
+        }
+    }
+    catch (...)
+    {
+        log->EndBatch();
+        throw;
+    }
+    log->EndBatch();
+}
+
+
+void ServiceHandler::write_queued_event(const QueuedLogEvent &queued)
+{
+    const Events::Log &logevent = queued.event;
+    SenderDetails::Ptr sender = queued.sender;
+
+    // Kept on the stack; see LogMetaData for the inline storage limits
+    LogMetaData meta;
+    meta.AddMeta(LogMetaData::Label::SENDER, logevent.sender->busname);
+    const DBus::Object::Path override_path = sender->GetOverridePath();
+    if (!override_path.empty())
+    {
+        meta.AddMeta(LogMetaData::Label::OBJECT_PATH, override_path);
+        meta.AddMeta(LogMetaData::Label::SENDER_OBJECT_PATH, logevent.sender->object_path);
+    }
+    else
+    {
+        meta.AddMeta(LogMetaData::Label::OBJECT_PATH, logevent.sender->object_path);
+    }
+    meta.AddMeta(LogMetaData::Label::INTERFACE, logevent.sender->object_interface);
+
+    // The PID of the sender is only looked up once per attached
+    // service, to reduce the amount of D-Bus calls
+    if (!sender->pid_resolved)
+    {
+        try
+        {
+            sender->pid = dbuscreds->GetPID(logevent.sender->busname);
+        }
+        catch (const DBus::Exception &)
+        {
+            // Ignore if this lookup fails; it's not critical and just
+            // useful additional info if available
+        }
+        sender->pid_resolved = true;
+    }
+    if (sender->pid > 0)
+    {
+        meta.AddMeta(LogMetaData::Label::SENDER_PID, sender->pid);
+    }
+
+    log->Log(logevent, meta);
+}
+
+
+
 const bool ServiceHandler::check_busname_vpn_client(const std::string &caller) const
 {
     pid_t c_pid = dbuscreds->GetPID(caller);
@@ -693,15 +917,18 @@ void ServiceHandler::cleanup_service_subscriptions()
         {
             if (sub && sub->src_target && !sub->src_target->busname.empty())
             {
-                (void)dbuscreds->GetPID(sub->src_target->busname);
+                // The cached credentials might outlive the bus name;
+                // the bus daemon must be asked directly
+                (void)dbuscreds->GetUniqueBusName(sub->src_target->busname);
             }
         }
         catch (const DBus::Credentials::Exception &)
         {
-            // If the PID lookup for a busname failed - there are no
+            // If the bus name lookup failed - there are no
             // process owning that busname any more
             if (sub)
             {
+                dbuscreds->Invalidate(sub->src_target->busname);
                 remove_list.push_back(sub->logtag);
             }
         }
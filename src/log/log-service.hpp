@@ -24,13 +24,16 @@
 
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/object/base.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/service.hpp>
+#include <gdbuspp/signals/group.hpp>
 
 #include "dbus/constants.hpp"
+#include "dbus/credentials-cache.hpp"
 #include "dbus/signals/log.hpp"
 #include "dbus/signals/statuschange.hpp"
 #include "common/utils.hpp"
+#include "consumer-loglevel.hpp"
+#include "log-eventqueue.hpp"
 #include "log-proxylog.hpp"
 #include "logwriter.hpp"
 #include "service-configfile.hpp"
@@ -39,6 +42,59 @@
 
 namespace LogService {
 
+/**
+ *  Details about the D-Bus service behind an AttachedService object,
+ *  shared with all the log events queued for this service.
+ */
+class SenderDetails
+{
+  public:
+    using Ptr = std::shared_ptr<SenderDetails>;
+
+    /**
+     *  PID of the sender.  Only accessed by the log event queue worker
+     *  thread, which looks it up on the first log event being written.
+     */
+    pid_t pid = 0;
+    bool pid_resolved = false;
+
+    [[nodiscard]] static Ptr Create()
+    {
+        return Ptr(new SenderDetails());
+    }
+
+    void SetOverridePath(const DBus::Object::Path &path)
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        override_path = path;
+    }
+
+    DBus::Object::Path GetOverridePath() const
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        return override_path;
+    }
+
+  private:
+    mutable std::mutex mtx;
+    DBus::Object::Path override_path{};
+
+    SenderDetails() = default;
+};
+
+
+/**
+ *  A received log event waiting to be written to the log destination
+ */
+struct QueuedLogEvent
+{
+    Events::Log event;
+    SenderDetails::Ptr sender;
+};
+
+using LogEventQueue = EventQueue<QueuedLogEvent>;
+
+
 /**
  *  Initial configuration for the net.openvpn.v3.log service.  This
  *  is being populated after the command line arguments and optionally
@@ -55,15 +111,35 @@ struct Configuration
     LogService::Logger::Ptr servicelog = nullptr;
     Log::EventFilter::Ptr logfilter = nullptr;
     std::string log_file = "";
+    size_t log_file_max_size = 0;
+    unsigned int log_file_keep = 5;
     std::string log_method = "";
     int32_t syslog_facility = LOG_DAEMON;
     bool log_dbus_details = false;
     bool log_prefix_logtag = true;
     bool log_timestamp = true;
     bool log_colour = false;
+    size_t queue_size = LogEventQueue::DEFAULT_CAPACITY;
+};
+
+/**
+ *  Sends the ConsumerLogLevel signal to an attached service, telling
+ *  it which log level the log service and the log proxies needs.
+ *  See Log::ConsumerLogLevel for the receiving side.
+ */
+class ConsumerLogLevelSignal : public DBus::Signals::Group
+{
+  public:
+    using Ptr = std::shared_ptr<ConsumerLogLevelSignal>;
+
+    ConsumerLogLevelSignal(DBus::Connection::Ptr conn,
+                           const std::string &busname);
+
+    void Send(const std::string &interface, const uint32_t loglev);
 };
 
-class AttachedService
+
+class AttachedService : public std::enable_shared_from_this<AttachedService>
 {
   public:
     using Ptr = std::shared_ptr<AttachedService>;
@@ -74,6 +150,8 @@ class AttachedService
         DBus::Connection::Ptr connection,
         DBus::Object::Manager::Ptr obj_mgr,
         LogService::Logger::Ptr log,
+        Log::EventFilter::Ptr filter,
+        LogEventQueue::Ptr queue,
         DBus::Signals::SubscriptionManager::Ptr submgr,
         LogTag::Ptr tag,
         const std::string &busname,
@@ -85,25 +163,44 @@ class AttachedService
 
     void OverrideObjectPath(const DBus::Object::Path &new_path);
 
+    /**
+     *  Calculates the highest log level needed by the log service
+     *  and the active log proxies for this service.  If this has
+     *  changed, the new log level is sent to the attached service.
+     */
+    void UpdateConsumerLogLevel();
+
   private:
     DBus::Connection::Ptr connection = nullptr;
     DBus::Object::Manager::Ptr object_mgr = nullptr;
-    DBus::Credentials::Query::Ptr creds_query = nullptr;
-    std::unordered_map<std::string, pid_t> busname_pid_map;
     LogService::Logger::Ptr log = nullptr;
+    Log::EventFilter::Ptr logfilter = nullptr;
+    LogEventQueue::Ptr event_queue = nullptr;
+    SenderDetails::Ptr sender_details = nullptr;
     Signals::ReceiveLog::Ptr log_handler = nullptr;
     Signals::ReceiveStatusChange::Ptr status_handler = nullptr;
     std::map<DBus::Object::Path, std::shared_ptr<ProxyLogEvents>> proxies = {};
-    DBus::Object::Path override_obj_path{};
+    ConsumerLogLevelSignal::Ptr consumer_signal = nullptr;
+    std::mutex consumer_mtx{};
+    int32_t consumer_level = Log::ConsumerLogLevel::NOT_NEGOTIATED;
 
     AttachedService(DBus::Connection::Ptr conn,
                     DBus::Object::Manager::Ptr obj_mgr,
                     LogService::Logger::Ptr log,
+                    Log::EventFilter::Ptr filter,
+                    LogEventQueue::Ptr queue,
                     DBus::Signals::SubscriptionManager::Ptr submgr,
                     LogTag::Ptr tag,
                     const std::string &busname,
                     const std::string &interface);
 
+    /**
+     *  Called for each received Log signal.  The log event is forwarded
+     *  to all the log proxies and queued for the log event queue worker
+     *  thread, which writes it to the log destination.
+     *
+     * @param logevent  Events::Log with the received log event
+     */
     void process_log_event(const Events::Log &logevent);
     void process_statuschg_event(const std::string &sender,
                                  const DBus::Object::Path &path,
@@ -117,6 +214,7 @@ class ServiceHandler : public DBus::Object::Base
     ServiceHandler(DBus::Connection::Ptr connection,
                    DBus::Object::Manager::Ptr obj_mgr,
                    Configuration &&cfgobj);
+    ~ServiceHandler() noexcept;
 
     const bool Authorize(const DBus::Authz::Request::Ptr req) override;
 
@@ -125,13 +223,16 @@ class ServiceHandler : public DBus::Object::Base
     DBus::Connection::Ptr connection = nullptr;
     DBus::Object::Manager::Ptr object_mgr = nullptr;
     Configuration config{};
-    LogWriter::Ptr logwr = nullptr;
     LogService::Logger::Ptr log = nullptr;
     Log::EventFilter::Ptr logfilter = nullptr;
-    DBus::Credentials::Query::Ptr dbuscreds = nullptr;
+    GDBusPP::Credentials::Cache::Ptr dbuscreds = nullptr;
     DBus::Signals::SubscriptionManager::Ptr subscrmgr = nullptr;
     std::string version = get_package_version();
 
+    // Received log events are written by the worker thread of this queue.
+    // This must be declared after all the members the worker uses.
+    LogEventQueue::Ptr event_queue = nullptr;
+
     // Log subscription related to D-Bus service subscription attachments
     using AttachMap = std::map<size_t, AttachedService::Ptr>;
     AttachMap log_attach_subscr{};
@@ -247,6 +348,22 @@ class ServiceHandler : public DBus::Object::Base
     // Internal methods
     //
 
+    /**
+     *  Writes a batch of received log events to the log destination.
+     *  This is called by the log event queue worker thread.
+     *
+     * @param batch  LogEventQueue::Batch with the log events to write
+     */
+    void process_log_batch(LogEventQueue::Batch &batch);
+
+    /**
+     *  Adds the sender details as meta data to a queued log event and
+     *  writes it to the log destination
+     *
+     * @param queued  QueuedLogEvent to write
+     */
+    void write_queued_event(const QueuedLogEvent &queued);
+
     const bool check_busname_vpn_client(const std::string &caller) const;
     const bool check_busname_service_name(const std::string &caller,
                                           const std::string &busname) const;
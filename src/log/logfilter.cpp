@@ -55,21 +55,27 @@ bool EventFilter::Allow(const Events::Log &logev) const noexcept
 
 
 bool EventFilter::Allow(const LogCategory catg) const noexcept
+{
+    return AllowLevel(log_level, catg);
+}
+
+
+bool EventFilter::AllowLevel(const uint32_t loglev, const LogCategory catg) noexcept
 {
     switch (catg)
     {
     case LogCategory::DEBUG:
-        return log_level >= 6;
+        return loglev >= 6;
     case LogCategory::VERB2:
-        return log_level >= 5;
+        return loglev >= 5;
     case LogCategory::VERB1:
-        return log_level >= 4;
+        return loglev >= 4;
     case LogCategory::INFO:
-        return log_level >= 3;
+        return loglev >= 3;
     case LogCategory::WARN:
-        return log_level >= 2;
+        return loglev >= 2;
     case LogCategory::ERROR:
-        return log_level >= 1;
+        return loglev >= 1;
     default:
         return true;
     }
@@ -94,6 +94,18 @@ class EventFilter
      */
     bool Allow(const LogCategory catg) const noexcept;
 
+    /**
+     *  Checks if the LogCategory is allowed by a specific log level.
+     *  This is the filter logic used by the other Allow() methods.
+     *
+     * @param loglev  uint32_t with the log level to check against
+     * @param catg    LogCategory to check
+     *
+     * @return  Returns true if log events of this category should be
+     *          logged at the given log level
+     */
+    static bool AllowLevel(const uint32_t loglev, const LogCategory catg) noexcept;
+
     /**
      *  Checks if the path is on the path list configured via @AddPathFilter.
      *
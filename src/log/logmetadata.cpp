@@ -13,6 +13,7 @@
  */
 
 #include <algorithm>
+#include <charconv>
 #include <fstream>
 #include <exception>
 #include <string>
@@ -81,21 +82,84 @@ std::string LogMetaDataValue::GetValue(const bool logtag_encaps) const
 //  LogMetaData  -  implementation
 //
 
+LogMetaData::Label LogMetaData::LookupLabel(std::string_view name) noexcept
+{
+    for (size_t i = 1; i < label_names.size(); ++i)
+    {
+        if (label_names[i] == name)
+        {
+            return static_cast<Label>(i);
+        }
+    }
+    return Label::CUSTOM;
+}
+
+
+void LogMetaData::AddMeta(const Label id, std::string_view v, bool skip)
+{
+    add_record(id, v, skip);
+}
+
+
+void LogMetaData::AddMeta(const Label id, const int32_t v, bool skip)
+{
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    add_record(id, std::string_view(buf, res.ptr - buf), skip);
+}
+
+
+void LogMetaData::AddMeta(const Label id, const uint32_t v, bool skip)
+{
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    add_record(id, std::string_view(buf, res.ptr - buf), skip);
+}
+
+
+void LogMetaData::AddMeta(const Label id, const LogTag::Ptr v, bool skip)
+{
+    if (!v)
+    {
+        add_record(id, "[INVALID-LOGTAG]", skip);
+        return;
+    }
+
+    // Store the encapsulated variant; the plain hash value is
+    // extracted from it when needed.  See LogTag::str()
+    char buf[32] = "{tag:";
+    auto res = std::to_chars(buf + 5, buf + sizeof(buf) - 1, v->hash);
+    *res.ptr = '}';
+    add_record(id, std::string_view(buf, res.ptr + 1 - buf), skip, true, v->encaps);
+}
+
+
+std::string_view LogMetaData::GetValue(const Label id,
+                                       const bool encaps_logtag) const noexcept
+{
+    const Record *rec = find_record(id, LabelName(id));
+    return (rec ? make_entry(*rec).GetValue(encaps_logtag) : std::string_view{});
+}
+
+
+std::string_view LogMetaData::GetValue(std::string_view l,
+                                       const bool encaps_logtag) const noexcept
+{
+    const Record *rec = find_record(LookupLabel(l), l);
+    return (rec ? make_entry(*rec).GetValue(encaps_logtag) : std::string_view{});
+}
+
+
 std::string LogMetaData::GetMetaValue(const std::string l,
                                       const bool encaps_logtag,
                                       const std::string postfix) const
 {
-    auto it = std::find_if(metadata.begin(),
-                           metadata.end(),
-                           [l](LogMetaDataValue::Ptr e)
-                           {
-                               return l == e->label;
-                           });
-    if (metadata.end() == it)
+    const Record *rec = find_record(LookupLabel(l), l);
+    if (!rec)
     {
         return "";
     }
-    return (*it)->GetValue(encaps_logtag) + postfix;
+    return std::string(make_entry(*rec).GetValue(encaps_logtag)) + postfix;
 }
 
 
@@ -103,54 +167,142 @@ LogMetaData::Records LogMetaData::GetMetaDataRecords(const bool upcase_label,
                                                      const bool logtag_encaps) const
 {
     Records ret;
-    for (const auto &mdc : metadata)
-    {
-        std::string label = mdc->label;
-        if (upcase_label)
-        {
-            std::transform(label.begin(),
-                           label.end(),
-                           label.begin(),
-                           [](unsigned char c)
-                           {
-                               return std::toupper(c);
-                           });
-        }
-        if (LogMetaDataValue::Type::LOGMETA_LOGTAG == mdc->type)
+    ret.reserve(record_count);
+    ForEach(
+        [&ret, upcase_label, logtag_encaps](const Entry &e)
         {
-            ret.push_back(label + "=" + mdc->GetValue(logtag_encaps));
-        }
-        else
-        {
-            ret.push_back(label + "=" + mdc->GetValue());
-        }
-    }
+            std::string label(e.label);
+            if (upcase_label)
+            {
+                std::transform(label.begin(),
+                               label.end(),
+                               label.begin(),
+                               [](unsigned char c)
+                               {
+                                   return std::toupper(c);
+                               });
+            }
+            ret.push_back(label + "=" + std::string(e.GetValue(logtag_encaps)));
+        });
     return ret;
 }
 
 
 size_t LogMetaData::size() const
 {
-    return metadata.size();
+    return record_count;
 }
 
 
 bool LogMetaData::empty() const
 {
-    return metadata.empty();
+    return 0 == record_count;
 }
 
 
 void LogMetaData::clear()
 {
-    metadata.clear();
+    record_count = 0;
+    spilled_records.clear();
+    buffer_used = 0;
+    spilled_buffer.clear();
 }
 
 
-LogMetaData::LogMetaData(const LogMetaData &src)
+uint32_t LogMetaData::store_text(std::string_view txt)
 {
-    for (const auto &e : src.metadata)
+    const size_t offset = buffer_used;
+    if (spilled_buffer.empty() && (buffer_used + txt.size()) <= INLINE_BUFFER_SIZE)
+    {
+        std::copy(txt.begin(), txt.end(), inline_buffer.begin() + buffer_used);
+    }
+    else
     {
-        metadata.push_back(e);
+        if (spilled_buffer.empty())
+        {
+            spilled_buffer.assign(inline_buffer.data(), buffer_used);
+        }
+        spilled_buffer.append(txt);
+    }
+    buffer_used += txt.size();
+    return static_cast<uint32_t>(offset);
+}
+
+
+void LogMetaData::add_record(const Label id,
+                             std::string_view value,
+                             const bool skip,
+                             const bool logtag,
+                             const bool logtag_encaps)
+{
+    Record rec{id,
+               skip,
+               logtag,
+               logtag_encaps,
+               0,
+               0,
+               store_text(value),
+               static_cast<uint32_t>(value.size())};
+
+    if (spilled_records.empty() && record_count < INLINE_RECORDS)
+    {
+        inline_records[record_count] = rec;
+    }
+    else
+    {
+        if (spilled_records.empty())
+        {
+            spilled_records.assign(inline_records.begin(),
+                                   inline_records.begin() + record_count);
+        }
+        spilled_records.push_back(rec);
     }
+    ++record_count;
+}
+
+
+void LogMetaData::set_custom_label(std::string_view l)
+{
+    Record &rec = (spilled_records.empty()
+                       ? inline_records[record_count - 1]
+                       : spilled_records.back());
+    rec.label_offset = store_text(l);
+    rec.label_length = static_cast<uint32_t>(l.size());
+}
+
+
+const LogMetaData::Record *LogMetaData::find_record(const Label id,
+                                                    std::string_view l) const noexcept
+{
+    const Record *recs = records();
+    const char *buf = buffer();
+    for (size_t i = 0; i < record_count; ++i)
+    {
+        if (id != recs[i].id)
+        {
+            continue;
+        }
+        if (Label::CUSTOM != id
+            || l == std::string_view(buf + recs[i].label_offset, recs[i].label_length))
+        {
+            return &recs[i];
+        }
+    }
+    return nullptr;
+}
+
+
+LogMetaData::Entry LogMetaData::make_entry(const Record &rec) const noexcept
+{
+    const char *buf = buffer();
+    Entry e;
+    e.id = rec.id;
+    e.label = (Label::CUSTOM == rec.id
+                   ? std::string_view(buf + rec.label_offset, rec.label_length)
+                   : LabelName(rec.id));
+    e.skip = rec.skip;
+    e.value = std::string_view(buf + rec.value_offset, rec.value_length);
+    e.logtag = rec.logtag;
+    e.logtag_encaps = rec.logtag_encaps;
+    return e;
 }
@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <sstream>
+#include <string>
+#include <string_view>
 
 #include "logtag.hpp"
 
@@ -99,7 +102,20 @@ struct LogMetaDataValue
 
 
 /**
- *  The LogMetaData class is a container for LogMetaDataValue objects
+ *  The LogMetaData class is a container for labelled meta data values
+ *  attached to a log event.
+ *
+ *  The labels used by the log service itself are interned as
+ *  LogMetaData::Label values, other labels are stored as text.  All
+ *  labels and values are kept in fixed-capacity storage inside the
+ *  object.  Heap memory is only used when a LogMetaData object grows
+ *  beyond INLINE_RECORDS records or INLINE_BUFFER_SIZE bytes of text.
+ *  This allows a log event to be annotated and passed to a LogWriter
+ *  without any memory allocations, by keeping the LogMetaData object
+ *  on the stack.
+ *
+ *  All std::string_view values returned are valid until the LogMetaData
+ *  object is modified or destroyed.
  */
 class LogMetaData
 {
@@ -107,6 +123,73 @@ class LogMetaData
     using Ptr = std::shared_ptr<LogMetaData>;
     using Records = std::vector<std::string>;
 
+    /**
+     *  Meta data labels known at compile time
+     */
+    enum class Label : uint8_t
+    {
+        CUSTOM, /**< Label is not interned, the text is stored with the value */
+        SENDER,
+        SENDER_PID,
+        OBJECT_PATH,
+        SENDER_OBJECT_PATH,
+        INTERFACE,
+        METHOD,
+        INTERNAL_METHOD
+    };
+
+    /// Number of records kept inside the object
+    static constexpr size_t INLINE_RECORDS = 8;
+
+    /// Number of bytes of label and value text kept inside the object
+    static constexpr size_t INLINE_BUFFER_SIZE = 512;
+
+
+    /**
+     *  A read-only view of a single meta data record
+     */
+    struct Entry
+    {
+        Label id;
+        std::string_view label;
+        bool skip;
+
+        /**
+         *  Retrieve the value of this record
+         *
+         * @param logtag_encaps  If this record carries a LogTag value,
+         *                       setting this to true will encapsulate the
+         *                       tag hash value with "{tag:......}"
+         * @return std::string_view of the value
+         */
+        std::string_view GetValue(const bool logtag_encaps = true) const noexcept
+        {
+            if (!logtag || logtag_encaps)
+            {
+                return value;
+            }
+            // Strip the "{tag:" prefix and the "}" postfix
+            return value.substr(5, value.size() - 6);
+        }
+
+        /**
+         *  Retrieve the value formatted the way the LogTag it was
+         *  created from defaults to.  For other values this is the
+         *  same as GetValue().
+         */
+        std::string_view GetDefaultValue() const noexcept
+        {
+            return GetValue(logtag_encaps);
+        }
+
+      private:
+        friend class LogMetaData;
+        std::string_view value;
+        bool logtag;
+        bool logtag_encaps;
+    };
+
+
     /**
      *  Create a new LogMetaData container for LogMetaDataValue objects
      *
@@ -117,44 +200,100 @@ class LogMetaData
         return LogMetaData::Ptr(new LogMetaData);
     }
 
+    /**
+     *  Create an empty LogMetaData container directly, typically on the
+     *  stack, where no heap allocation is wanted
+     */
+    LogMetaData() = default;
+    LogMetaData(const LogMetaData &src) = default;
+    LogMetaData &operator=(const LogMetaData &src) = default;
+    ~LogMetaData() noexcept = default;
+
     /**
      *  Create a duplicate (copy) of this LogMetaData container
      *
-     *  NOTE: This will not duplicate the LogMetaDataValue records
-     *        stored in this LogMetaData container, they will be
-     *        shared between the source and the copy.
-     *
-     *        However, any modifications (adding new values, clearing
-     *        all values) to either source or copy
-     *        will be local to the modified object
+     *  Any modifications (adding new values, clearing all values) to
+     *  either source or copy will be local to the modified object
      *
      * @return LogMetaData::Ptr to the new LogMetaData container with the
-     *         same LogMetaDataValue elements as this container has.
+     *         same meta data records as this container has.
      */
-    LogMetaData::Ptr Duplicate()
+    LogMetaData::Ptr Duplicate() const
     {
         return LogMetaData::Ptr(new LogMetaData(*this));
     }
 
-    ~LogMetaData() noexcept = default;
+
+    /**
+     *  Retrieve the text of an interned meta data label
+     *
+     * @param id  Label to look up
+     * @return std::string_view of the label text, empty for Label::CUSTOM
+     */
+    static constexpr std::string_view LabelName(const Label id) noexcept
+    {
+        return label_names[static_cast<size_t>(id)];
+    }
+
+
+    /**
+     *  Look up the interned Label of a meta data label text
+     *
+     * @param name  std::string_view of the label text
+     * @return Label, Label::CUSTOM if the label is not interned
+     */
+    static Label LookupLabel(std::string_view name) noexcept;
+
 
     /**
      *  Adds a new key/value based meta data to the LogMetaData container
      *
-     * @tparam T   The type must be either std::string or LogTag
-     * @param  l   std::string of the label (key) of this meta data value
-     * @param  v   std::string or LogTag object carrying the meta data value
-     * @param  s   bool flag to indicate if this value should be skipped when
-     *             the LogMetaData::operator<<() is used.
+     * @param  id    Label of this meta data value
+     * @param  v     std::string_view, int32_t, uint32_t or LogTag::Ptr
+     *               carrying the meta data value
+     * @param  skip  bool flag to indicate if this value should be skipped
+     *               when the LogMetaData::operator<<() is used.
+     */
+    void AddMeta(const Label id, std::string_view v, bool skip = false);
+    void AddMeta(const Label id, const int32_t v, bool skip = false);
+    void AddMeta(const Label id, const uint32_t v, bool skip = false);
+    void AddMeta(const Label id, const LogTag::Ptr v, bool skip = false);
+
+    /**
+     *  Adds a new key/value based meta data to the LogMetaData container.
+     *  Labels known as a LogMetaData::Label are stored as such.
+     *
+     * @param  l     std::string_view of the label (key) of this meta data value
+     * @param  v     std::string_view, int32_t, uint32_t or LogTag::Ptr
+     *               carrying the meta data value
+     * @param  skip  bool flag to indicate if this value should be skipped
+     *               when the LogMetaData::operator<<() is used.
      */
     template <typename T>
-    void AddMeta(const std::string &l, const T &v, bool skip = false)
+    void AddMeta(std::string_view l, const T &v, bool skip = false)
     {
-        auto mdv = LogMetaDataValue::Create(l, v, skip);
-        metadata.push_back(mdv);
+        const Label id = LookupLabel(l);
+        AddMeta(id, v, skip);
+        if (Label::CUSTOM == id)
+        {
+            set_custom_label(l);
+        }
     }
 
 
+    /**
+     *  Retrieve the meta data value for a specific label, without
+     *  copying it
+     *
+     * @param id             Label to look up
+     * @param encaps_logtag  If it is a LogTag value, if set to true the
+     *                       value will be encapsulated with '{tag:......}'
+     * @return std::string_view of the value, empty if not found
+     */
+    std::string_view GetValue(const Label id, const bool encaps_logtag = true) const noexcept;
+    std::string_view GetValue(std::string_view l, const bool encaps_logtag = true) const noexcept;
+
+
     /**
      *   Retrieve the meta data value as a string for a specific meta data
      *   label (key).
@@ -170,9 +309,29 @@ class LogMetaData
     std::string GetMetaValue(const std::string l, const bool encaps_logtag = true, const std::string postfix = " ") const;
 
 
+    /**
+     *  Calls a function for each meta data record, in the order they
+     *  were added.
+     *
+     * @param fn  Callable taking a const LogMetaData::Entry &
+     */
+    template <typename Fn>
+    void ForEach(Fn &&fn) const
+    {
+        const Record *recs = records();
+        for (size_t i = 0; i < record_count; ++i)
+        {
+            fn(make_entry(recs[i]));
+        }
+    }
+
+
     /**
      *  Retrieve all collected meta data values, formatted as "key=value" pairs
      *
+     *  NOTE: This allocates a new std::string per record; use ForEach()
+     *        in code paths sensitive to memory allocations.
+     *
      * @param upcase_label   bool flag to upper case the label/key value
      * @param logtag_encaps  bool flag to enable encapsulation of LogTag values
      *                        with '{tag:......'}
@@ -196,47 +355,89 @@ class LogMetaData
 
 
     /**
-     *  Clear all collected meta data values
+     *  Clear all collected meta data values.  New values are stored in
+     *  the inline storage again.  The capacity of the heap storage used
+     *  by values which did not fit the inline storage is kept, and is
+     *  reused if the inline storage overflows again.
      */
     void clear();
 
 
-    friend std::ostream &operator<<(std::ostream &os, const LogMetaData::Ptr mdc)
+    friend std::ostream &operator<<(std::ostream &os, const LogMetaData &mdc)
     {
         bool first = true;
-        for (const auto &mdv : mdc->metadata)
-        {
-            if (mdv->skip)
-            {
-                continue;
-            }
-            os << (!first ? ", " : "") << mdv;
-            if (first)
+        mdc.ForEach(
+            [&os, &first](const Entry &e)
             {
+                if (e.skip)
+                {
+                    return;
+                }
+                os << (!first ? ", " : "") << e.label << "=" << e.GetDefaultValue();
                 first = false;
-            }
-        }
+            });
         return os;
     }
 
+    friend std::ostream &operator<<(std::ostream &os, const LogMetaData::Ptr mdc)
+    {
+        return os << *mdc;
+    }
 
-  private:
-    std::vector<LogMetaDataValue::Ptr> metadata = {};
 
-    LogMetaData() = default;
+  private:
+    static constexpr std::array<std::string_view, 8> label_names = {
+        "",
+        "sender",
+        "sender_pid",
+        "object_path",
+        "sender_object_path",
+        "interface",
+        "method",
+        "internal_method"};
 
     /**
-     *  Private copy constructor
-     *
-     *  NOTE: This will not duplicate the LogMetaDataValue records
-     *        stored in this LogMetaData container, they will be
-     *        shared between the source and the copy.
-     *
-     *        However, any modifications (adding new values, clearing
-     *        all values) to either source or copy
-     *        will be local to the modified object
-     *
-     * @param src  Source LogMetaData object to copy elements from
+     *  A single meta data record.  Custom labels and all values are
+     *  stored as offsets into the text buffer, since the buffer may move
+     *  when it grows beyond the inline storage.
      */
-    LogMetaData(const LogMetaData &src);
+    struct Record
+    {
+        Label id;
+        bool skip;
+        bool logtag;
+        bool logtag_encaps;
+        uint32_t label_offset;
+        uint32_t label_length;
+        uint32_t value_offset;
+        uint32_t value_length;
+    };
+
+    std::array<Record, INLINE_RECORDS> inline_records{};
+    std::vector<Record> spilled_records{};
+    size_t record_count = 0;
+
+    std::array<char, INLINE_BUFFER_SIZE> inline_buffer{};
+    std::string spilled_buffer{};
+    size_t buffer_used = 0;
+
+    const Record *records() const noexcept
+    {
+        return spilled_records.empty() ? inline_records.data() : spilled_records.data();
+    }
+
+    const char *buffer() const noexcept
+    {
+        return spilled_buffer.empty() ? inline_buffer.data() : spilled_buffer.data();
+    }
+
+    uint32_t store_text(std::string_view txt);
+    void add_record(const Label id,
+                    std::string_view value,
+                    const bool skip,
+                    const bool logtag = false,
+                    const bool logtag_encaps = false);
+    void set_custom_label(std::string_view l);
+    const Record *find_record(const Label id, std::string_view l) const noexcept;
+    Entry make_entry(const Record &rec) const noexcept;
 };
@@ -208,21 +208,56 @@ class LogWriter
     {
         if (log_meta)
         {
-            metadata->AddMeta(label, data, skip);
+            metadata.AddMeta(label, data, skip);
         }
     }
 
 
+    /**
+     *  Copies all meta data records to be logged together with the
+     *  next log event.  This replaces any previously added meta data.
+     *
+     * @param mdc  LogMetaData with the records to copy
+     */
+    void AddMetaCopy(const LogMetaData &mdc)
+    {
+        metadata = mdc;
+    }
+
+
     void AddMetaCopy(LogMetaData::Ptr mdc)
     {
-        metadata = mdc->Duplicate();
+        AddMetaCopy(*mdc);
+    }
+
+
+    /**
+     *  Indicates that the calling thread is about to write a burst of
+     *  log events.  Implementations may hold back the log events written
+     *  by this thread until EndBatch() is called, to reduce the per event
+     *  overhead towards the log destination.
+     *
+     *  The default implementation does nothing.
+     */
+    virtual void BeginBatch()
+    {
+    }
+
+
+    /**
+     *  Completes a burst of log events started with BeginBatch().  All
+     *  log events held back for the calling thread must have been
+     *  written to the log destination when this returns.
+     */
+    virtual void EndBatch()
+    {
     }
 
 
   protected:
     bool timestamp = true;
     bool log_meta = true;
-    LogMetaData::Ptr metadata = nullptr;
+    LogMetaData metadata;
     bool prepend_prefix = true;
 
     /**
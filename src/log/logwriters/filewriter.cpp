@@ -0,0 +1,309 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   filewriter.cpp
+ *
+ * @brief  Implementation of FileLogWriter
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "filewriter.hpp"
+
+
+FileLogWriter::FileLogWriter(const std::string &filename_,
+                             const size_t rotate_size_,
+                             const unsigned int rotate_keep_)
+    : LogWriter(), filename(filename_), rotate_size(rotate_size_),
+      rotate_keep(rotate_keep_)
+{
+    open_file();
+    buffer.reserve(FLUSH_SIZE + 4096);
+    flusher = std::thread(&FileLogWriter::flusher_thread, this);
+}
+
+
+FileLogWriter::~FileLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        stop_flusher = true;
+    }
+    flusher_cv.notify_all();
+    if (flusher.joinable())
+    {
+        flusher.join();
+    }
+
+    std::lock_guard<std::mutex> lg(mtx);
+    flush_locked();
+    close_file();
+}
+
+
+std::string FileLogWriter::GetLogWriterInfo() const
+{
+    return std::string("FileLogWriter: ") + filename;
+}
+
+
+void FileLogWriter::EndBatch()
+{
+    Flush();
+}
+
+
+void FileLogWriter::Flush()
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    flush_locked();
+}
+
+
+void FileLogWriter::Reopen()
+{
+    std::lock_guard<std::mutex> lg(mtx);
+    flush_locked();
+    close_file();
+    open_file();
+}
+
+
+void FileLogWriter::WriteLogLine(LogTag::Ptr logtag,
+                                 const std::string &data,
+                                 const std::string &colour_init,
+                                 const std::string &colour_reset)
+{
+    std::unique_lock<std::mutex> lk(mtx);
+    const bool was_empty = buffer.empty();
+
+    if (log_meta && !metadata.empty())
+    {
+        append_prefix(colour_init);
+        if (logtag)
+        {
+            buffer += logtag->str(true);
+            buffer += ' ';
+        }
+        bool first = true;
+        metadata.ForEach(
+            [this, &first](const LogMetaData::Entry &e)
+            {
+                if (e.skip)
+                {
+                    return;
+                }
+                if (!first)
+                {
+                    buffer += ", ";
+                }
+                buffer += e.label;
+                buffer += '=';
+                buffer += e.GetDefaultValue();
+                first = false;
+            });
+        buffer += colour_reset;
+        buffer += '\n';
+    }
+
+    append_prefix(colour_init);
+    if (prepend_prefix && logtag)
+    {
+        buffer += logtag->str(true);
+        buffer += ' ';
+    }
+    buffer += data;
+    buffer += colour_reset;
+    buffer += '\n';
+
+    metadata.clear();
+
+    if (buffer.size() >= FLUSH_SIZE || current_category >= FLUSH_CATEGORY)
+    {
+        flush_locked();
+    }
+    else if (was_empty)
+    {
+        // Let the flusher thread know when this line must be written
+        // at the latest
+        first_buffered = std::chrono::steady_clock::now();
+        lk.unlock();
+        flusher_cv.notify_one();
+    }
+}
+
+
+void FileLogWriter::WriteLogLine(LogTag::Ptr logtag,
+                                 const LogGroup grp,
+                                 const LogCategory ctg,
+                                 const std::string &data,
+                                 const std::string &colour_init,
+                                 const std::string &colour_reset)
+{
+    // The category decides if the log line is written immediately
+    current_category = ctg;
+    LogWriter::WriteLogLine(logtag, grp, ctg, data, colour_init, colour_reset);
+    current_category = LogCategory::UNDEFINED;
+}
+
+
+void FileLogWriter::open_file()
+{
+    fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0)
+    {
+        throw FileLogWriterException("Could not open log file '" + filename
+                                     + "': " + strerror(errno));
+    }
+
+    struct stat st = {};
+    file_size = (0 == fstat(fd, &st) ? st.st_size : 0);
+}
+
+
+void FileLogWriter::close_file() noexcept
+{
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+
+void FileLogWriter::rotate()
+{
+    close_file();
+    if (0 == rotate_keep)
+    {
+        unlink(filename.c_str());
+    }
+    else
+    {
+        // filename.1 is the newest rotated log file; the oldest one
+        // is overwritten
+        for (unsigned int i = rotate_keep - 1; i > 0; --i)
+        {
+            std::string from = filename + "." + std::to_string(i);
+            std::string to = filename + "." + std::to_string(i + 1);
+            rename(from.c_str(), to.c_str());
+        }
+        rename(filename.c_str(), (filename + ".1").c_str());
+    }
+    open_file();
+}
+
+
+void FileLogWriter::flush_locked()
+{
+    if (buffer.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        if (rotate_size > 0 && file_size > 0
+            && file_size + buffer.size() > rotate_size)
+        {
+            rotate();
+        }
+    }
+    catch (const FileLogWriterException &excp)
+    {
+        std::cerr << "FileLogWriter: " << excp.what() << std::endl;
+    }
+
+    const char *p = buffer.data();
+    size_t remaining = buffer.size();
+    while (fd >= 0 && remaining > 0)
+    {
+        ssize_t r = write(fd, p, remaining);
+        if (r < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            std::cerr << "FileLogWriter: Failed writing to '" << filename
+                      << "': " << strerror(errno) << std::endl;
+            break;
+        }
+        p += r;
+        remaining -= r;
+        file_size += r;
+    }
+
+    // Whatever could not be written is lost; the buffer must not
+    // grow without limits if the log file is unavailable.
+    buffer.clear();
+}
+
+
+void FileLogWriter::append_prefix(const std::string &colour_init)
+{
+    if (timestamp)
+    {
+        // The timestamp string only changes once per second
+        time_t now = time(nullptr);
+        if (now != timestamp_sec)
+        {
+            struct tm ltm = {};
+            localtime_r(&now, &ltm);
+            strftime(timestamp_prefix, sizeof(timestamp_prefix), "%Y-%m-%d %H:%M:%S ", &ltm);
+            timestamp_sec = now;
+        }
+        buffer += timestamp_prefix;
+    }
+    buffer += ' ';
+    buffer += colour_init;
+}
+
+
+void FileLogWriter::flusher_thread()
+{
+    std::unique_lock<std::mutex> lk(mtx);
+    while (!stop_flusher)
+    {
+        if (buffer.empty())
+        {
+            flusher_cv.wait(lk,
+                            [this]()
+                            {
+                                return stop_flusher || !buffer.empty();
+                            });
+            continue;
+        }
+
+        const auto deadline = first_buffered + FLUSH_INTERVAL;
+        if (flusher_cv.wait_until(lk,
+                                  deadline,
+                                  [this]()
+                                  {
+                                      return stop_flusher;
+                                  }))
+        {
+            break;
+        }
+
+        // The buffer may have been written and refilled while waiting
+        if (!buffer.empty()
+            && std::chrono::steady_clock::now() >= first_buffered + FLUSH_INTERVAL)
+        {
+            flush_locked();
+        }
+    }
+}
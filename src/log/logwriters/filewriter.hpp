@@ -0,0 +1,150 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   filewriter.hpp
+ *
+ * @brief  Declaration of FileLogWriter, a buffered LogWriter
+ *         implementation writing to a log file
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "log/logwriter.hpp"
+#include "log/log-helpers.hpp"
+
+
+class FileLogWriterException : public std::exception
+{
+  public:
+    FileLogWriterException(const std::string &err)
+        : err(err)
+    {
+    }
+
+    virtual const char *what() const noexcept
+    {
+        return err.c_str();
+    }
+
+  private:
+    std::string err;
+};
+
+
+
+/**
+ *  LogWriter implementation writing to a log file.
+ *
+ *  The log lines are formatted the same way as the StreamLogWriter
+ *  does, but collected in a user space buffer which is written to the
+ *  file when it is full, when a log event of LogCategory::ERROR or
+ *  higher is written, at the end of a log batch, or at the latest
+ *  one second after the first buffered line.
+ *
+ *  The file can be rotated when it reaches a certain size, and
+ *  Reopen() allows external log rotation tools to move the file away.
+ */
+class FileLogWriter : public LogWriter
+{
+  public:
+    /// Buffer size which triggers writing to the file
+    static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+    /// Max time a log line may wait in the buffer
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{1000};
+
+    /// Log events of this category or higher are written immediately
+    static constexpr LogCategory FLUSH_CATEGORY = LogCategory::ERROR;
+
+
+    /**
+     *  Initialize the FileLogWriter.  Log lines are appended to the
+     *  log file if it already exists.
+     *
+     * @param filename     std::string with the log file name
+     * @param rotate_size  Rotate the log file when it would grow beyond
+     *                     this size (bytes).  0 disables rotation.
+     * @param rotate_keep  Number of rotated log files to keep, named
+     *                     filename.1 (newest) to filename.N (oldest)
+     *
+     * @throws FileLogWriterException if the log file cannot be opened
+     */
+    FileLogWriter(const std::string &filename,
+                  const size_t rotate_size = 0,
+                  const unsigned int rotate_keep = 5);
+    virtual ~FileLogWriter();
+
+    std::string GetLogWriterInfo() const override;
+
+    /**
+     *  Writes all buffered log lines, as the log service expects the
+     *  log events of a batch to have reached the destination when
+     *  this returns.
+     */
+    void EndBatch() override;
+
+    /**
+     *  Write all buffered log lines to the log file
+     */
+    void Flush();
+
+    /**
+     *  Close and re-open the log file, typically after an external
+     *  tool has moved the log file away (SIGHUP)
+     */
+    void Reopen();
+
+
+  protected:
+    void WriteLogLine(LogTag::Ptr logtag,
+                      const std::string &data,
+                      const std::string &colour_init = "",
+                      const std::string &colour_reset = "") override;
+
+    void WriteLogLine(LogTag::Ptr logtag,
+                      const LogGroup grp,
+                      const LogCategory ctg,
+                      const std::string &data,
+                      const std::string &colour_init = "",
+                      const std::string &colour_reset = "") override;
+
+
+  private:
+    const std::string filename;
+    const size_t rotate_size;
+    const unsigned int rotate_keep;
+
+    std::mutex mtx;
+    int fd = -1;
+    size_t file_size = 0;
+    std::string buffer;
+    std::chrono::steady_clock::time_point first_buffered{};
+    LogCategory current_category = LogCategory::UNDEFINED;
+
+    time_t timestamp_sec = 0;
+    char timestamp_prefix[32] = {};
+
+    std::thread flusher;
+    std::condition_variable flusher_cv;
+    bool stop_flusher = false;
+
+    void open_file();
+    void close_file() noexcept;
+    void rotate();
+    void flush_locked();
+    void append_prefix(const std::string &colour_init);
+    void flusher_thread();
+};
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "filewriter.hpp"
 #include "journald.hpp"
 #include "streamwriter.hpp"
 #include "syslog.hpp"
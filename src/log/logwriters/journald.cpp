@@ -18,48 +18,170 @@
 #ifdef HAVE_SYSTEMD
 
 #include <sys/uio.h>
-#include <ctype.h>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #define SD_JOURNAL_SUPPRESS_LOCATION
 #include <systemd/sd-journal.h>
 
+#include "log/log-helpers.hpp"
 #include "log/logwriter.hpp"
 #include "log/logwriters/journald.hpp"
 
 
 namespace {
 /**
- *  Helper method preparing struct iovec records to be passed to
- *  via the sd_journal_sendv() function.
+ *  Per-thread buffer holding the journal fields of one or more log events
+ *  to be passed to sd_journal_sendv().
  *
- *  The JournaldWriter will prefix most of the log data with a tag.
- *  This tag can be a "journald field name" or just prefixing the
- *  already provided field name.
- *
- *  This function just receives these strings and returns a fresh
- *  struct iovec with the needed data.
- *
- *  @param tag    std::string containing the tag - may be an empty string
- *  @param data   std::string containing the data to be logged by journald
- *  @returns struct iovec record with all fields set accordingly
- *  @throws JournalWriterException if memory allocation fails
+ *  All the field data is appended to a single string and only the
+ *  offsets are recorded, as the string may be reallocated while it grows.
+ *  The struct iovec array is populated right before submitting each log
+ *  event.  The buffers are cleared but not released after submission,
+ *  so a thread writing log events will quickly stop needing any further
+ *  memory allocations here.
  */
-static iovec prepare_journal_iov(const std::string &tag, const std::string &data)
+class JournalEntryBuffer
 {
-    size_t buflen = tag.length() + data.length();
-    char *data_c = static_cast<char *>(calloc(buflen, 1));
-    if (data_c)
+  public:
+    JournalEntryBuffer() = default;
+
+    /**
+     *  Any log events still held back when the thread exits are submitted
+     *  to the journal before the buffer is destroyed.
+     */
+    ~JournalEntryBuffer() noexcept
+    {
+        Submit();
+    }
+
+    /**
+     *  Adds a complete journal field to the current log event
+     *
+     * @param tag    std::string_view with the field name, including the
+     *               '=' separator.  May be empty if value contains both.
+     * @param value  std::string_view with the field value
+     */
+    void AddField(std::string_view tag, std::string_view value)
+    {
+        fields.push_back({data.size(), tag.size() + value.size()});
+        data.append(tag);
+        data.append(value);
+    }
+
+    /**
+     *  Appends more data to the last field added by AddField()
+     *
+     * @param value  std::string_view with the data to append
+     */
+    void AppendToField(std::string_view value)
+    {
+        data.append(value);
+        fields.back().length += value.size();
+    }
+
+    /**
+     *  Appends more data to the last field added by AddField(), with all
+     *  characters converted to upper case
+     *
+     * @param value  std::string_view with the data to append
+     */
+    void AppendToFieldUpper(std::string_view value)
+    {
+        for (const char c : value)
+        {
+            data.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+        }
+        fields.back().length += value.size();
+    }
+
+    /**
+     *  Completes the current log event; the following fields will
+     *  belong to the next log event
+     */
+    void EndEntry()
+    {
+        entry_end.push_back(fields.size());
+    }
+
+    size_t EntryCount() const noexcept
     {
-        if (!tag.empty())
+        return entry_end.size();
+    }
+
+    /**
+     *  Submits all completed log events to the journal, one
+     *  sd_journal_sendv() call per log event.
+     */
+    void Submit() noexcept
+    {
+        size_t first = 0;
+        for (const auto last : entry_end)
         {
-            memcpy(data_c, tag.c_str(), tag.length());
+            iov.clear();
+            for (size_t f = first; f < last; ++f)
+            {
+                iov.push_back({data.data() + fields[f].offset, fields[f].length});
+            }
+            int r = sd_journal_sendv(iov.data(), iov.size());
+            if (0 != r)
+            {
+                std::cout << "ERROR: " << strerror(-r) << std::endl;
+            }
+            first = last;
         }
-        memcpy(data_c + tag.length(), data.c_str(), data.length());
-        return iovec{data_c, buflen};
+        data.clear();
+        fields.clear();
+        entry_end.clear();
     }
-    throw JournalWriterException("Error allocating memory for '" + tag + data + "'");
+
+    /// Set when the owning thread is between BeginBatch() and EndBatch()
+    bool batching = false;
+
+  private:
+    struct Field
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    std::string data;
+    std::vector<Field> fields;
+    std::vector<size_t> entry_end;
+    std::vector<iovec> iov;
+};
+
+thread_local JournalEntryBuffer journal_buffer;
+
+
+/**
+ *  Prepares the complete "TAG=value" journal fields for all the values
+ *  of a fixed lookup table, so they do not need to be built for each
+ *  log event.
+ *
+ * @param tag     std::string with the field name and the '=' separator
+ * @param values  std::array with all the values to prepare
+ * @return std::array<std::string, N> with all the prepared fields
+ */
+template <size_t N>
+std::array<std::string, N> prepare_fields(const std::string &tag,
+                                          const std::array<const std::string, N> &values)
+{
+    std::array<std::string, N> ret;
+    for (size_t i = 0; i < N; ++i)
+    {
+        ret[i] = tag + values[i];
+    }
+    return ret;
 }
+
+const auto log_group_fields = prepare_fields("O3_LOG_GROUP=", LogGroup_str);
+const auto log_category_fields = prepare_fields("O3_LOG_CATEGORY=", LogCategory_str);
 } // namespace
 
 
@@ -120,73 +242,76 @@ void JournaldWriter::WriteLogLine(LogTag::Ptr logtag,
 
 void JournaldWriter::Write(const Events::Log &event)
 {
-    // We need extra elements for O3_LOGTAG, O3_SESSION_TOKEN,
-    // O3_LOG_GROUP, O3_LOG_CATEGORY, MESSAGE and
-    // the NULL termination
-    size_t meta_size = (metadata ? metadata->size() : 0) + 8;
-    struct iovec *l = static_cast<struct iovec *>(calloc(sizeof(struct iovec) + 2,
-                                                         meta_size));
-    if (!l)
-    {
-        throw JournalWriterException("Failed to allocate data for log event: "
-                                     + event.str(10, true));
-    }
+    JournalEntryBuffer &buf = journal_buffer;
 
     // Add the fixed O3_LOG_SENDER data, to more easily identify
     // log events from this log service across all Linux distros in the journal
-    size_t i = 0;
-    l[i++] = prepare_journal_iov("", log_sender);
+    buf.AddField("", log_sender);
 
-    if (metadata)
-    {
-        for (const auto &mdr : metadata->GetMetaDataRecords(true, false))
+    metadata.ForEach(
+        [&buf](const LogMetaData::Entry &e)
         {
-            l[i++] = prepare_journal_iov("O3_", mdr);
-        }
-    }
+            buf.AddField("O3_", "");
+            buf.AppendToFieldUpper(e.label);
+            buf.AppendToField("=");
+            buf.AppendToField(e.GetValue(false));
+        });
 
     auto logtag = event.GetLogTag();
     if (logtag)
     {
-        l[i++] = prepare_journal_iov("O3_LOGTAG=", logtag->str(false));
+        buf.AddField("O3_LOGTAG=", logtag->str(false));
     }
 
     if (!event.session_token.empty())
     {
-        l[i++] = prepare_journal_iov("O3_SESSION_TOKEN=", event.session_token);
+        buf.AddField("O3_SESSION_TOKEN=", event.session_token);
     }
 
-    l[i++] = prepare_journal_iov("O3_LOG_GROUP=", event.GetLogGroupStr());
-    l[i++] = prepare_journal_iov("O3_LOG_CATEGORY=", event.GetLogCategoryStr());
-
-    std::string msg;
-    if (prepend_prefix && logtag)
+    if (static_cast<size_t>(event.group) < log_group_fields.size())
     {
-        msg += logtag->str(true) + " ";
+        buf.AddField("", log_group_fields[static_cast<size_t>(event.group)]);
     }
-    msg += event.message;
-    l[i++] = prepare_journal_iov("MESSAGE=", msg);
-
-    l[i] = {NULL};
-
-    int r = sd_journal_sendv(l, i);
-    if (0 != r)
+    else
     {
-        std::cout << "ERROR: " << strerror(errno) << std::endl;
+        buf.AddField("O3_LOG_GROUP=", event.GetLogGroupStr());
+    }
+    if (static_cast<size_t>(event.category) < log_category_fields.size())
+    {
+        buf.AddField("", log_category_fields[static_cast<size_t>(event.category)]);
+    }
+    else
+    {
+        buf.AddField("O3_LOG_CATEGORY=", event.GetLogCategoryStr());
     }
 
-    // struct iovec is a C interface; need to clean up manually
-    for (size_t j = 0; j < i; j++)
+    buf.AddField("MESSAGE=", "");
+    if (prepend_prefix && logtag)
     {
-        free(l[j].iov_base);
-        l[j].iov_base = 0;
-        l[j].iov_len = 0;
+        buf.AppendToField(logtag->str(true));
+        buf.AppendToField(" ");
     }
-    free(l);
+    buf.AppendToField(event.message);
+    buf.EndEntry();
 
-    if (metadata)
+    if (!buf.batching || buf.EntryCount() >= MAX_BATCH_ENTRIES)
     {
-        metadata->clear();
+        buf.Submit();
     }
+
+    metadata.clear();
+}
+
+
+void JournaldWriter::BeginBatch()
+{
+    journal_buffer.batching = true;
+}
+
+
+void JournaldWriter::EndBatch()
+{
+    journal_buffer.batching = false;
+    journal_buffer.Submit();
 }
 #endif // HAVE_SYSTEMD
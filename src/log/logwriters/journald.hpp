@@ -57,6 +57,22 @@ class JournaldWriter : public LogWriter
 
     void Write(const Events::Log &event) override;
 
+    /**
+     *  Log events written by the calling thread are kept in a per-thread
+     *  buffer until EndBatch() is called or the buffer holds
+     *  MAX_BATCH_ENTRIES log events.
+     */
+    void BeginBatch() override;
+
+    /**
+     *  Submits all buffered log events of the calling thread to the
+     *  journal and leaves the batching mode
+     */
+    void EndBatch() override;
+
+    /// Max number of log events buffered per thread in batching mode
+    static constexpr size_t MAX_BATCH_ENTRIES = 256;
+
 
   protected:
     void WriteLogLine(LogTag::Ptr logtag,
@@ -72,6 +88,7 @@ class JournaldWriter : public LogWriter
                       const std::string &colour_reset) override;
 
   private:
+    /// Precomputed O3_LOG_SENDER= journal field
     const std::string log_sender;
 };
 #endif // HAVE_SYSTEMD
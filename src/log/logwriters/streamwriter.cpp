@@ -45,12 +45,12 @@ void StreamLogWriter::WriteLogLine(LogTag::Ptr logtag,
                                    const std::string &colour_init,
                                    const std::string &colour_reset)
 {
-    if (log_meta && metadata && !metadata->empty())
+    if (log_meta && !metadata.empty())
     {
         dest << (timestamp ? GetTimestamp() : "") << " "
              << colour_init;
 
-        if (!metadata->empty() && logtag)
+        if (!metadata.empty() && logtag)
         {
             dest << logtag->str(true) << " ";
         }
@@ -66,10 +66,7 @@ void StreamLogWriter::WriteLogLine(LogTag::Ptr logtag,
     }
     dest << data << colour_reset << std::endl;
 
-    if (metadata)
-    {
-        metadata->clear();
-    }
+    metadata.clear();
 }
 
 
@@ -66,7 +66,7 @@ void SyslogWriter::WriteLogLine(LogTag::Ptr logtag,
         logtag_str << logtag->str(true) << " ";
     }
 
-    if (log_meta && metadata && !metadata->empty())
+    if (log_meta && !metadata.empty())
     {
         std::ostringstream meta_str;
         meta_str << metadata;
@@ -75,10 +75,7 @@ void SyslogWriter::WriteLogLine(LogTag::Ptr logtag,
     }
 
     syslog(LOG_INFO, "%s%s", logtag_str.str().c_str(), data.c_str());
-    if (metadata)
-    {
-        metadata->clear();
-    }
+    metadata.clear();
 }
 
 
@@ -99,7 +96,7 @@ void SyslogWriter::WriteLogLine(LogTag::Ptr logtag,
         logtag_str << logtag->str(true) << " ";
     }
 
-    if (log_meta && metadata && !metadata->empty())
+    if (log_meta && !metadata.empty())
     {
         std::ostringstream meta_str;
         meta_str << metadata;
@@ -116,8 +113,5 @@ void SyslogWriter::WriteLogLine(LogTag::Ptr logtag,
            LogPrefix(grp, ctg).c_str(),
            data.c_str());
 
-    if (metadata)
-    {
-        metadata->clear();
-    }
+    metadata.clear();
 }
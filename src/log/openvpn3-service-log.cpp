@@ -11,6 +11,9 @@
 #include <iomanip>
 #include <sstream>
 #include <exception>
+#include <string>
+#include <csignal>
+#include <glib-unix.h>
 #include <gdbuspp/connection.hpp>
 
 #include "build-config.h"
@@ -24,6 +27,16 @@
 #include "service-configfile.hpp"
 
 
+/// Upper limit of --queue-size, in log events
+static const unsigned long MAX_QUEUE_SIZE = 1000000;
+
+/// Upper limit of --log-file-max-size, in MB
+static const unsigned long MAX_LOG_FILE_SIZE = 65536;
+
+/// Upper limit of --log-file-keep
+static const unsigned long MAX_LOG_FILE_KEEP = 100;
+
+
 static int logger_service(ParsedArgs::Ptr args)
 {
     int ret = 0;
@@ -104,7 +117,7 @@ static int logger_service(ParsedArgs::Ptr args)
         servicecfg.log_method = "journald";
     }
 #endif
-    else if (args->Present("logfile"))
+    else if (args->Present("log-file"))
     {
         servicecfg.log_method = "logfile";
         servicecfg.log_file = args->GetValue("log-file", 0);
@@ -117,12 +130,47 @@ static int logger_service(ParsedArgs::Ptr args)
     servicecfg.log_timestamp = args->Present("timestamp");
     servicecfg.log_dbus_details = args->Present("service-log-dbus-details");
     servicecfg.log_colour = args->Present("colour");
+    if ("logfile" == servicecfg.log_method && servicecfg.log_colour
+        && (args->Present("log-file-max-size") || args->Present("log-file-keep")))
+    {
+        // The colourful log file is written as a plain stream, which
+        // does not support rotating the log file
+        throw CommandException("openvpn3-service-log",
+                               "--log-file-max-size and --log-file-keep "
+                               "cannot be used with --colour");
+    }
+    if (args->Present("queue-size"))
+    {
+        servicecfg.queue_size = parse_option_number("openvpn3-service-log",
+                                                    args,
+                                                    "queue-size",
+                                                    1,
+                                                    MAX_QUEUE_SIZE);
+    }
+    if (args->Present("log-file-max-size"))
+    {
+        size_t maxsize = parse_option_number("openvpn3-service-log",
+                                             args,
+                                             "log-file-max-size",
+                                             0,
+                                             MAX_LOG_FILE_SIZE);
+        servicecfg.log_file_max_size = maxsize * 1024 * 1024;
+    }
+    if (args->Present("log-file-keep"))
+    {
+        // With 0, the rotation would remove the active log file
+        servicecfg.log_file_keep = parse_option_number("openvpn3-service-log",
+                                                       args,
+                                                       "log-file-keep",
+                                                       1,
+                                                       MAX_LOG_FILE_KEEP);
+    }
 
     // Open a log destination
     std::ofstream logfs{};
     std::streambuf *logstream = nullptr;
     bool do_console_info = true;
-    if ("logfile" == servicecfg.log_method)
+    if ("logfile" == servicecfg.log_method && servicecfg.log_colour)
     {
         logfs.open(servicecfg.log_file, std::ios_base::app);
         logstream = logfs.rdbuf();
@@ -137,6 +185,7 @@ static int logger_service(ParsedArgs::Ptr args)
 
     // Prepare the appropriate log writer
     LogWriter::Ptr logwr = nullptr;
+    std::shared_ptr<FileLogWriter> filewr = nullptr;
     ColourEngine::Ptr colourengine = nullptr;
 #ifdef HAVE_SYSTEMD
     if ("journald" == servicecfg.log_method)
@@ -153,6 +202,20 @@ static int logger_service(ParsedArgs::Ptr args)
             logwr.reset(new SyslogWriter(args->GetArgv0(),
                                          servicecfg.syslog_facility));
         }
+        else if ("logfile" == servicecfg.log_method && !servicecfg.log_colour)
+        {
+            try
+            {
+                filewr = std::make_shared<FileLogWriter>(servicecfg.log_file,
+                                                         servicecfg.log_file_max_size,
+                                                         servicecfg.log_file_keep);
+            }
+            catch (const FileLogWriterException &excp)
+            {
+                throw CommandException("openvpn3-service-log", excp.what());
+            }
+            logwr = filewr;
+        }
         else if (servicecfg.log_colour)
         {
             colourengine.reset(new ANSIColours());
@@ -217,6 +280,32 @@ static int logger_service(ParsedArgs::Ptr args)
             logwr->Write(Events::Log(LogGroup::LOGGER, LogCategory::INFO, "Idle exit is disabled"));
 #endif
         }
+        if (filewr)
+        {
+            // Re-open the log file on SIGHUP, for external log rotation
+            g_unix_signal_add(SIGHUP,
+                              [](gpointer data) -> gboolean
+                              {
+                                  auto *fw = static_cast<FileLogWriter *>(data);
+                                  try
+                                  {
+                                      fw->Reopen();
+                                  }
+                                  catch (const FileLogWriterException &excp)
+                                  {
+                                      std::cerr << excp.what() << std::endl;
+                                  }
+                                  return G_SOURCE_CONTINUE;
+                              },
+                              filewr.get());
+        }
+        else if ("logfile" == servicecfg.log_method)
+        {
+            logwr->Write(Events::Log(LogGroup::LOGGER,
+                                     LogCategory::WARN,
+                                     "The log file is not re-opened on SIGHUP "
+                                     "when --colour is used"));
+        }
         main_service->Run();
 
         ret = 0;
@@ -271,6 +360,17 @@ int main(int argc, char **argv)
                         "FILE",
                         true,
                         "Log events to file");
+    argparser.AddOption("log-file-max-size",
+                        0,
+                        "MB",
+                        true,
+                        "Rotate the log file when it reaches this size. "
+                        "0 disables rotation (Default: 0)");
+    argparser.AddOption("log-file-keep",
+                        0,
+                        "NUM",
+                        true,
+                        "Number of rotated log files to keep (Default: 5)");
     argparser.AddOption("service-log-dbus-details",
                         0,
                         "Include D-Bus sender, path and method references in logs");
@@ -280,6 +380,12 @@ int main(int argc, char **argv)
                         true,
                         "How long to wait before exiting "
                         "if being idle. 0 disables it (Default: 10 minutes)");
+    argparser.AddOption("queue-size",
+                        0,
+                        "NUM",
+                        true,
+                        "Max number of received log events waiting to be "
+                        "written (Default: 4096)");
     argparser.AddOption("state-dir",
                         0,
                         "DIRECTORY",
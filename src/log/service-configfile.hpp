@@ -58,6 +58,12 @@ class LogServiceConfigFile : public virtual Configuration::File
                            "log_method_group",
                            "Log file",
                            OptionValueType::String},
+            OptionMapEntry{"log-file-max-size", "log_file_max_size",
+                           "Max log file size before rotation (MB)",
+                           OptionValueType::Int},
+            OptionMapEntry{"log-file-keep", "log_file_keep",
+                           "Number of rotated log files to keep",
+                           OptionValueType::Int},
             OptionMapEntry{"colour", "log_file_colour",
                            "Colour log lines in log file",
                            OptionValueType::Present},
@@ -22,6 +22,8 @@
  *         is the gap this LogService::Logger API fills
  */
 
+#include <mutex>
+
 #include "events/log.hpp"
 #include "logfilter.hpp"
 #include "logmetadata.hpp"
@@ -44,6 +46,9 @@ class Logger
     void Log(const Events::Log &logev,
              LogMetaData::Ptr metadata = nullptr,
              const bool duplicate_check = false);
+    void Log(const Events::Log &logev,
+             const LogMetaData &metadata,
+             const bool duplicate_check = false);
     void Debug(const std::string &msg,
                LogMetaData::Ptr md = nullptr,
                const bool duplicate_check = false);
@@ -63,6 +68,16 @@ class Logger
     void LogCritical(const std::string &msg, LogMetaData::Ptr md = nullptr);
     void LogFATAL(const std::string &msg, LogMetaData::Ptr md = nullptr);
 
+    void BeginBatch();
+    void EndBatch();
+
+    void EnableTimestamp(const bool tstamp);
+    bool TimestampEnabled();
+    void EnableLogMeta(const bool meta);
+    bool LogMetaEnabled();
+    void EnableMessagePrepend(const bool mp);
+    bool MessagePrependEnabled();
+
     LogWriter::Ptr GetLogWriter() const noexcept;
 
   private:
@@ -71,9 +86,21 @@ class Logger
     Log::EventFilter::Ptr filter = nullptr;
     Events::Log last_log = {};
 
+    /**
+     *  Log events are written both from the main thread and from the
+     *  log event queue worker thread.  The meta data and the log event
+     *  must be passed to the LogWriter as a single operation.  Changes
+     *  to the LogWriter settings are done while holding it as well.
+     */
+    std::mutex log_mtx;
+
     Logger(LogWriter::Ptr logwr_,
            const LogGroup lgrp,
            Log::EventFilter::Ptr fltr);
+
+    void log_event(const Events::Log &logev,
+                   const LogMetaData *metadata,
+                   const bool duplicate_check);
 };
 
 
@@ -90,6 +117,29 @@ inline void Logger::Log(const Events::Log &logev,
                         LogMetaData::Ptr metadata,
                         const bool duplicate_check)
 {
+    log_event(logev, metadata.get(), duplicate_check);
+}
+
+
+inline void Logger::Log(const Events::Log &logev,
+                        const LogMetaData &metadata,
+                        const bool duplicate_check)
+{
+    log_event(logev, &metadata, duplicate_check);
+}
+
+
+/**
+ *  Writes a log event.  Any provided meta data is copied into the
+ *  LogWriter, which does not require any heap allocations as long as
+ *  it fits in the LogMetaData inline storage.  Without meta data, the
+ *  meta data already added to the LogWriter is used.
+ */
+inline void Logger::log_event(const Events::Log &logev,
+                              const LogMetaData *metadata,
+                              const bool duplicate_check)
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
     if (duplicate_check && logev == last_log)
     {
         // If duplicate check is enabled, we skip this log event if
@@ -106,9 +156,8 @@ inline void Logger::Log(const Events::Log &logev,
 
     if (metadata)
     {
-        logwr->AddMetaCopy(metadata);
+        logwr->AddMetaCopy(*metadata);
     }
-
     logwr->Write(logev);
     last_log = logev;
 }
@@ -173,6 +222,80 @@ inline void Logger::LogFATAL(const std::string &msg, LogMetaData::Ptr md)
 }
 
 
+/**
+ *  Marks the start of a burst of log events written by the calling
+ *  thread.  See LogWriter::BeginBatch() for details.
+ */
+inline void Logger::BeginBatch()
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    logwr->BeginBatch();
+}
+
+
+/**
+ *  Completes a burst of log events started with BeginBatch()
+ */
+inline void Logger::EndBatch()
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    logwr->EndBatch();
+}
+
+
+/**
+ *  The LogWriter settings are changed by the D-Bus property handlers
+ *  while the log event queue worker thread is writing log events, so
+ *  these are only accessed with the log_mtx held.  See the LogWriter
+ *  methods with the same names for details.
+ */
+inline void Logger::EnableTimestamp(const bool tstamp)
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    logwr->EnableTimestamp(tstamp);
+}
+
+
+inline bool Logger::TimestampEnabled()
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    return logwr->TimestampEnabled();
+}
+
+
+inline void Logger::EnableLogMeta(const bool meta)
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    logwr->EnableLogMeta(meta);
+}
+
+
+inline bool Logger::LogMetaEnabled()
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    return logwr->LogMetaEnabled();
+}
+
+
+inline void Logger::EnableMessagePrepend(const bool mp)
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    logwr->EnableMessagePrepend(mp);
+}
+
+
+inline bool Logger::MessagePrependEnabled()
+{
+    std::lock_guard<std::mutex> guard(log_mtx);
+    return logwr->MessagePrependEnabled();
+}
+
+
+/**
+ *  Direct access to the LogWriter.  This must not be used to write
+ *  log events or change settings once the log event queue worker
+ *  thread has started; use the Logger methods instead.
+ */
 inline LogWriter::Ptr Logger::GetLogWriter() const noexcept
 {
     return logwr;
@@ -37,6 +37,7 @@
 #include "common/utils.hpp"
 #include "netcfg-device.hpp"
 #include "netcfg-signals.hpp"
+#include "netlink-route-batch.hpp"
 
 
 // FIXME: Cleanup these macros
@@ -49,6 +50,7 @@ class CoreTunbuilderImpl : public CoreTunbuilder
 {
     TunLinuxSetup::Setup<TUN_LINUX>::Ptr tun;
     ActionList::Ptr remove_cmds;
+    NetCfg::Netlink::RouteBatch::Ptr routes;
 
     /**
      * Uses Tunbuilder to open a new tun device
@@ -102,7 +104,9 @@ class CoreTunbuilderImpl : public CoreTunbuilder
         tbc->tun_builder_set_remote_address(netCfgDevice.remote.address,
                                             netCfgDevice.remote.ipv6);
 
-        // Add routes
+        // Only the excluded routes are passed to the Core library.  The
+        // routes via the VPN are programmed in batches by
+        // install_routes() once the interface exists.
         for (const auto &net : netCfgDevice.networks)
         {
             if (net.exclude)
@@ -110,9 +114,64 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                 // -1 is "default/optional" value
                 tbc->tun_builder_exclude_route(net.address, net.prefix_size, net.metric, net.ipv6);
             }
+        }
+
+        tbc->validate();
+
+        // We ignore tbc.dns_servers and other DNS related items since
+        // that is handled by a differrent service
+        return tbc;
+    }
+
+
+    /**
+     *  Collects all the routes to program via the VPN interface,
+     *  including the 'def1' style default routes when the default
+     *  gateway is redirected
+     *
+     * @param netCfgDevice  The device object with the route configuration
+     *
+     * @return std::vector<NetCfg::Netlink::Route>
+     */
+    std::vector<NetCfg::Netlink::Route> collectRoutes(const NetCfgDevice &netCfgDevice) const
+    {
+        // The routes use the gateway of the VPN address as the next
+        // hop, like the Core library does.  This is also the gateway
+        // announced by doEstablishNotifies().
+        std::string gw4;
+        std::string gw6;
+        for (const auto &ip : netCfgDevice.vpnips)
+        {
+            if (ip.ipv6)
+            {
+                gw6 = ip.gateway;
+            }
             else
             {
-                tbc->tun_builder_add_route(net.address, net.prefix_size, net.metric, net.ipv6);
+                gw4 = ip.gateway;
+            }
+        }
+
+        std::vector<NetCfg::Netlink::Route> ret;
+        auto add = [&ret, &gw4, &gw6](const std::string &address,
+                                      uint32_t prefix_size,
+                                      int32_t metric,
+                                      bool ipv6)
+        {
+            NetCfg::Netlink::Route r;
+            r.address = address;
+            r.prefix_size = prefix_size;
+            r.gateway = (ipv6 ? gw6 : gw4);
+            r.metric = metric;
+            r.ipv6 = ipv6;
+            ret.push_back(r);
+        };
+
+        for (const auto &net : netCfgDevice.networks)
+        {
+            if (!net.exclude)
+            {
+                add(net.address, net.prefix_size, net.metric, net.ipv6);
             }
         }
 
@@ -125,13 +184,13 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                 // Add 'def1' style default routes
                 if (netCfgDevice.reroute_ipv4)
                 {
-                    tbc->tun_builder_add_route("0.0.0.0", 1, -1, false);
-                    tbc->tun_builder_add_route("128.0.0.0", 1, -1, false);
+                    add("0.0.0.0", 1, -1, false);
+                    add("128.0.0.0", 1, -1, false);
                 }
                 if (netCfgDevice.reroute_ipv6)
                 {
-                    tbc->tun_builder_add_route("::", 1, -1, true);
-                    tbc->tun_builder_add_route("8000::", 1, -1, true);
+                    add("::", 1, -1, true);
+                    add("8000::", 1, -1, true);
                 }
                 break;
 
@@ -139,12 +198,58 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                 break;
             }
         }
+        return ret;
+    }
 
-        tbc->validate();
 
-        // We ignore tbc.dns_servers and other DNS related items since
-        // that is handled by a differrent service
-        return tbc;
+    /**
+     *  Programs all the routes via the VPN interface in batched
+     *  netlink requests.  Failing routes are logged, but do not stop
+     *  the interface setup; this is the same as the Core library does.
+     *
+     * @param netCfgDevice  The device object with the route configuration
+     * @param iface_name    Name of the VPN interface
+     */
+    void install_routes(const NetCfgDevice &netCfgDevice,
+                        const std::string &iface_name)
+    {
+        routes = NetCfg::Netlink::RouteBatch::Create(iface_name);
+        for (const auto &r : collectRoutes(netCfgDevice))
+        {
+            routes->Add(r);
+        }
+        if (0 == routes->size())
+        {
+            return;
+        }
+
+        std::vector<NetCfg::Netlink::RouteError> errors;
+        try
+        {
+            errors = routes->Install();
+        }
+        catch (const NetCfgException &excp)
+        {
+            // The routes programmed so far are kept track of and
+            // removed again on teardown
+            netCfgDevice.signals->LogError(
+                fmt::format("Failed adding routes on {}: {}",
+                            iface_name,
+                            excp.what()));
+            return;
+        }
+        for (const auto &err : errors)
+        {
+            netCfgDevice.signals->LogError(
+                fmt::format("Failed adding route {} on {}: {}",
+                            err.route.str(),
+                            iface_name,
+                            err.message));
+        }
+        netCfgDevice.signals->LogVerb2(
+            fmt::format("Added {} routes on {}",
+                        routes->size() - errors.size(),
+                        iface_name));
     }
 
 
@@ -174,6 +279,7 @@ class CoreTunbuilderImpl : public CoreTunbuilder
         // an argument
         //
         int ret = establish_tun(*tbc, config, nullptr, std::cout);
+        install_routes(netCfgDevice, config.iface_name);
 
 #ifdef ENABLE_OVPNDCO
         if (!netCfgDevice.dco_device)
@@ -193,11 +299,13 @@ class CoreTunbuilderImpl : public CoreTunbuilder
     void doEstablishNotifies(const NetCfgDevice &netCfgDevice,
                              const TUN_CLASS_SETUP::Config &config) const
     {
+        // All changes are announced together once the device is ready
+        std::vector<NetCfgChangeEvent> changes;
+
         // Announce the new interface
-        NetCfgChangeEvent dev_ev(NetCfgChangeType::DEVICE_ADDED,
-                                 config.iface_name,
-                                 {});
-        netCfgDevice.signals->NetworkChange(dev_ev);
+        changes.emplace_back(NetCfgChangeType::DEVICE_ADDED,
+                             config.iface_name,
+                             NetCfgChangeDetails{});
 
         for (const auto &ipaddr : netCfgDevice.vpnips)
         {
@@ -207,7 +315,7 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                                       {"prefix", std::to_string(ipaddr.prefix_size)}, // TODO: Deprecated, remove in v28+
                                       {"prefix_size", std::to_string(ipaddr.prefix_size)},
                                       {"ip_version", (ipaddr.ipv6 ? "6" : "4")}});
-            netCfgDevice.signals->NetworkChange(chg_ev);
+            changes.push_back(chg_ev);
         }
 
         // WARNING:  This is NOT optimal
@@ -245,8 +353,9 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                                       {"prefix", std::to_string(net.prefix_size)}, // TODO: Deprecated, remove in v28+
                                       {"prefix_size", std::to_string(net.prefix_size)},
                                       {"gateway", (net.ipv6 ? local6.gateway : local4.gateway)}});
-            netCfgDevice.signals->NetworkChange(chg_ev);
+            changes.push_back(chg_ev);
         }
+        netCfgDevice.signals->NetworkChanges(changes);
     }
 
 
@@ -257,6 +366,27 @@ class CoreTunbuilderImpl : public CoreTunbuilder
             remove_cmds->execute_log();
         }
 
+        if (routes)
+        {
+            try
+            {
+                for (const auto &err : routes->Remove())
+                {
+                    ncdev.signals->LogError(
+                        fmt::format("Failed removing route {} on {}: {}",
+                                    err.route.str(),
+                                    ncdev.get_device_name(),
+                                    err.message));
+                }
+            }
+            catch (const NetCfgException &excp)
+            {
+                ncdev.signals->LogError(
+                    fmt::format("Failed removing routes: {}", excp.what()));
+            }
+            routes.reset();
+        }
+
         if (tun)
         {
             // the os parameter is not used
@@ -264,6 +394,7 @@ class CoreTunbuilderImpl : public CoreTunbuilder
         }
 
         // Announce the removed routes
+        std::vector<NetCfgChangeEvent> changes;
         for (const auto &net : ncdev.networks)
         {
             if (net.exclude)
@@ -276,7 +407,7 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                                       {"subnet", net.address},
                                       {"prefix", std::to_string(net.prefix_size)}, // TODO: Deprecated, remove in v28+
                                       {"prefix_size", std::to_string(net.prefix_size)}});
-            ncdev.signals->NetworkChange(chg_ev);
+            changes.push_back(chg_ev);
         }
 
         // Announce the removed interface
@@ -288,12 +419,12 @@ class CoreTunbuilderImpl : public CoreTunbuilder
                                       {"prefix", std::to_string(ipaddr.prefix_size)}, // TODO: Deprecated, remove in v28+
                                       {"prefix_size", std::to_string(ipaddr.prefix_size)},
                                       {"ip_version", (ipaddr.ipv6 ? "6" : "4")}});
-            ncdev.signals->NetworkChange(chg_ev);
+            changes.push_back(chg_ev);
         }
-        NetCfgChangeEvent chg_ev(NetCfgChangeType::DEVICE_REMOVED,
-                                 ncdev.get_device_name(),
-                                 {});
-        ncdev.signals->NetworkChange(chg_ev);
+        changes.emplace_back(NetCfgChangeType::DEVICE_REMOVED,
+                             ncdev.get_device_name(),
+                             NetCfgChangeDetails{});
+        ncdev.signals->NetworkChanges(changes);
     }
 };
 
@@ -54,6 +54,51 @@ NetCfgChangeEvent::NetCfgChangeEvent(GVariant *params)
 }
 
 
+GVariant *NetCfgChangeEvent::GetGVariantBatch(const std::vector<NetCfgChangeEvent> &events,
+                                              const uint32_t filter)
+{
+    GVariantBuilder *b = glib2::Builder::Create("a(usa{ss})");
+    bool found = false;
+    for (const auto &ev : events)
+    {
+        if (static_cast<uint32_t>(ev.type) & filter)
+        {
+            glib2::Builder::Add(b, ev.GetGVariant());
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        g_variant_builder_unref(b);
+        return nullptr;
+    }
+    return glib2::Builder::FinishWrapped(b);
+}
+
+
+std::vector<NetCfgChangeEvent> NetCfgChangeEvent::ParseBatch(GVariant *params)
+{
+    std::string g_type(g_variant_get_type_string(params));
+    if ("(a(usa{ss}))" != g_type)
+    {
+        throw NetCfgException(std::string("Invalid GVariant data type: ")
+                              + g_type);
+    }
+
+    std::vector<NetCfgChangeEvent> ret;
+    GVariantIter *changes = nullptr;
+    g_variant_get(params, "(a(usa{ss}))", &changes);
+    GVariant *ev = nullptr;
+    while ((ev = g_variant_iter_next_value(changes)))
+    {
+        ret.emplace_back(ev);
+        g_variant_unref(ev);
+    }
+    g_variant_iter_free(changes);
+    return ret;
+}
+
+
 NetCfgChangeEvent::NetCfgChangeEvent() noexcept
 {
     reset();
@@ -46,6 +46,43 @@ struct NetCfgChangeEvent
     }
 
 
+    /**
+     *  Declaration of the NetworkChanges signal, which carries several
+     *  change events in a single signal
+     */
+    static DBus::Signals::SignalArgList BatchSignalDeclaration() noexcept
+    {
+        return {{"changes", "a(usa{ss})"}};
+    }
+
+
+    /**
+     *  Builds the NetworkChanges signal parameters out of a list of
+     *  change events
+     *
+     * @param events  std::vector<NetCfgChangeEvent> with the events
+     * @param filter  Filter mask of NetCfgChangeType values; only the
+     *                events matching this mask are included
+     *
+     * @return GVariant object of the (a(usa{ss})) type.  If no events
+     *         matches the filter, nullptr is returned.
+     */
+    static GVariant *GetGVariantBatch(const std::vector<NetCfgChangeEvent> &events,
+                                      const uint32_t filter);
+
+
+    /**
+     *  Parses the parameters of a NetworkChanges signal
+     *
+     * @param params  GVariant object of the (a(usa{ss})) type
+     *
+     * @return std::vector<NetCfgChangeEvent> of all the change events
+     *
+     * @throws NetCfgException on invalid data
+     */
+    static std::vector<NetCfgChangeEvent> ParseBatch(GVariant *params);
+
+
     static std::string TypeStr(const NetCfgChangeType &type,
                                bool tech_form = false) noexcept
     {
@@ -75,6 +112,8 @@ struct NetCfgChangeEvent
             return (tech_form ? "DNS_SEARCH_ADDED" : "DNS Search domain Added");
         case NetCfgChangeType::DNS_SEARCH_REMOVED:
             return (tech_form ? "DNS_SEARCH_REMOVED" : "DNS Search domain Removed");
+        case NetCfgChangeType::BATCHED_SIGNALS:
+            return (tech_form ? "BATCHED_SIGNALS" : "Batched signals");
         default:
             return "[UNKNOWN: " + std::to_string((uint8_t)type) + "]";
         }
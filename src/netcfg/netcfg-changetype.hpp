@@ -37,6 +37,11 @@ enum class NetCfgChangeType : std::uint32_t
     DNS_SERVER_REMOVED = 1 <<  8,   //    256
     DNS_SEARCH_ADDED   = 1 <<  9,   //    512
     DNS_SEARCH_REMOVED = 1 << 10,   //   1024
+
+    // Subscription flag, not a change type.  Subscribers setting this
+    // receive the NetworkChanges signal with all the changes of an
+    // operation, instead of one NetworkChange signal per change.
+    BATCHED_SIGNALS    = 1 << 15,   //  32768
     // clang-format on
 };
 
@@ -12,7 +12,9 @@
 #include "build-config.h"
 
 #ifdef ENABLE_OVPNDCO
-#include <iostream>
+#include <exception>
+#include <future>
+#include <mutex>
 #include <thread>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -38,6 +40,116 @@
 #include <openvpn/buffer/buffer.hpp>
 
 
+//
+//  NetCfgDCOEventLoop class implementation
+//
+
+NetCfgDCOEventLoop::Ptr NetCfgDCOEventLoop::Get(DBus::Connection::Ptr dbuscon,
+                                                LogWriter *logwr)
+{
+    static std::mutex instance_mtx;
+    static std::weak_ptr<NetCfgDCOEventLoop> instance;
+
+    std::lock_guard<std::mutex> lg(instance_mtx);
+    if (auto evl = instance.lock())
+    {
+        return evl;
+    }
+    auto evl = Ptr(new NetCfgDCOEventLoop(dbuscon, logwr));
+    instance = evl;
+    return evl;
+}
+
+
+NetCfgDCOEventLoop::NetCfgDCOEventLoop(DBus::Connection::Ptr dbuscon,
+                                       LogWriter *logwr)
+    : work(asio::make_work_guard(io_context))
+{
+    // Device specific errors are logged by the handlers posted by
+    // each NetCfgDCO object, via its own signals object
+    signals = NetCfgSignals::Create(dbuscon,
+                                    LogGroup::NETCFG,
+                                    Constants::GenPath("netcfg"),
+                                    logwr);
+    worker = std::thread(&NetCfgDCOEventLoop::run_worker, this);
+}
+
+
+NetCfgDCOEventLoop::~NetCfgDCOEventLoop()
+{
+    work.reset();
+    io_context.stop();
+    if (!worker.joinable())
+    {
+        return;
+    }
+    if (std::this_thread::get_id() == worker.get_id())
+    {
+        // Cannot wait for ourselves
+        worker.detach();
+        return;
+    }
+    worker.join();
+}
+
+
+openvpn_io::io_context &NetCfgDCOEventLoop::GetIOContext()
+{
+    return io_context;
+}
+
+
+void NetCfgDCOEventLoop::Execute(std::function<void()> func)
+{
+    if (io_context.get_executor().running_in_this_thread())
+    {
+        func();
+        return;
+    }
+
+    std::promise<void> done;
+    auto result = done.get_future();
+    openvpn_io::post(io_context,
+                     [&func, &done]()
+                     {
+                         try
+                         {
+                             func();
+                             done.set_value();
+                         }
+                         catch (...)
+                         {
+                             done.set_exception(std::current_exception());
+                         }
+                     });
+    result.get();
+}
+
+
+void NetCfgDCOEventLoop::run_worker()
+{
+    // An exception escaping a handler must not stop the event loop
+    // for all the other devices
+    while (!io_context.stopped())
+    {
+        try
+        {
+            io_context.run();
+        }
+        catch (const std::exception &excp)
+        {
+            signals->LogCritical("NetCfgDCOEventLoop: "
+                                 + std::string(excp.what()));
+        }
+    }
+}
+
+
+
+//
+//  NetCfgDCO class implementation
+//
+
 NetCfgDCO::NetCfgDCO(DBus::Connection::Ptr dbuscon,
                      const DBus::Object::Path &objpath,
                      const std::string &dev_name,
@@ -111,30 +223,25 @@ NetCfgDCO::NetCfgDCO(DBus::Connection::Ptr dbuscon,
         throw NetCfgException("Error creating ovpn-dco device: " + os.str());
     }
 
-    async_dco_worker_thread = std::async(
-        std::launch::async,
-        [&]()
-        {
-            try
-            {
-                asio::executor_work_guard<asio::io_context::executor_type> worker = asio::make_work_guard(io_context);
-                io_context.run();
-            }
-            catch (const std::exception &excp)
-            {
-                signals->LogCritical(fmt::format(
-                    FMT_COMPILE("Async DCO io_context stopped: {}"),
-                    excp.what()));
-            }
-        });
-
-    pipe.reset(new openvpn_io::posix::stream_descriptor(io_context, fds[1]));
+    eventloop = NetCfgDCOEventLoop::Get(dbuscon, logwr);
+    active = std::make_shared<bool>(true);
+    pipe.reset(new openvpn_io::posix::stream_descriptor(eventloop->GetIOContext(),
+                                                        fds[1]));
+    // The event loop is shared with all the other ovpn-dco devices,
+    // a client not reading the pipe must not block it
+    pipe->non_blocking(true);
 
     try
     {
-        genl.reset(new GeNLImpl(io_context,
-                                if_nametoindex(dev_name.c_str()),
-                                this));
+        // The GeNL object is only accessed from the event loop thread,
+        // its reference counter is not thread-safe
+        eventloop->Execute(
+            [this]()
+            {
+                genl.reset(new GeNLImpl(eventloop->GetIOContext(),
+                                        if_nametoindex(this->dev_name.c_str()),
+                                        this));
+            });
     }
     catch (const std::exception &ex)
     {
@@ -172,23 +279,26 @@ void NetCfgDCO::teardown()
 {
     ::close(fds[0]); // fds[1] will be closed by pipe dctor
 
-    if (genl)
+    if (eventloop)
     {
-        genl->stop();
-    }
-
-    if (pipe)
-    {
-        pipe->close();
-    }
-
-    if (!io_context.stopped())
-    {
-        io_context.stop();
-    }
-    if (async_dco_worker_thread.valid())
-    {
-        async_dco_worker_thread.get();
+        // Operations queued before this one have completed when
+        // Execute() returns; later ones are ignored
+        eventloop->Execute(
+            [this]()
+            {
+                *active = false;
+                if (genl)
+                {
+                    genl->stop();
+                    genl.reset();
+                }
+
+                if (pipe)
+                {
+                    pipe->close();
+                }
+                pipe_queue.clear();
+            });
     }
 
     std::ostringstream os;
@@ -204,23 +314,97 @@ bool NetCfgDCO::available()
 
 void NetCfgDCO::tun_read_handler(BufferAllocated &buf)
 {
-    try
+    if (!*active)
     {
-        pipe->write_some(buf.const_buffer());
+        return;
     }
-    catch (const std::system_error &err)
+
+    // Messages must reach the client in order, so nothing is written
+    // directly while older messages are still waiting in the queue
+    if (pipe_queue.empty() && write_pipe(buf))
+    {
+        return;
+    }
+
+    if (pipe_queue.size() >= MAX_PIPE_QUEUE)
     {
-        std::ostringstream msg;
-        msg << "NetCfgDCO [" << dev_name << "] ERROR (tun_read_handler): "
-            << err.what();
-        if (signals)
+        if (0 == pipe_dropped++)
         {
-            signals->LogCritical(msg.str());
+            signals->LogWarn(fmt::format(
+                FMT_COMPILE("NetCfgDCO [{}] The client does not read the "
+                            "pipe, dropping messages"),
+                dev_name));
         }
-        else
+        return;
+    }
+    pipe_queue.emplace_back(buf);
+    wait_pipe_writable();
+}
+
+
+bool NetCfgDCO::write_pipe(const BufferAllocated &buf)
+{
+    openvpn_io::error_code ec;
+    pipe->write_some(buf.const_buffer(), ec);
+    if (openvpn_io::error::would_block == ec
+        || openvpn_io::error::try_again == ec)
+    {
+        return false;
+    }
+    if (ec)
+    {
+        // The message cannot be delivered, retrying will not help
+        signals->LogCritical(fmt::format(
+            FMT_COMPILE("NetCfgDCO [{}] ERROR (tun_read_handler): {}"),
+            dev_name,
+            ec.message()));
+    }
+    return true;
+}
+
+
+void NetCfgDCO::wait_pipe_writable()
+{
+    if (pipe_waiting)
+    {
+        return;
+    }
+    pipe_waiting = true;
+
+    // The active flag is checked first, this object might have been
+    // removed before the event loop runs the handler
+    pipe->async_wait(openvpn_io::posix::stream_descriptor::wait_write,
+                     [this, active = active](const openvpn_io::error_code &ec)
+                     {
+                         if (!*active || ec)
+                         {
+                             return;
+                         }
+                         pipe_waiting = false;
+                         flush_pipe_queue();
+                     });
+}
+
+
+void NetCfgDCO::flush_pipe_queue()
+{
+    while (!pipe_queue.empty())
+    {
+        if (!write_pipe(pipe_queue.front()))
         {
-            std::cerr << msg.str() << std::endl;
+            wait_pipe_writable();
+            return;
         }
+        pipe_queue.pop_front();
+    }
+
+    if (pipe_dropped > 0)
+    {
+        signals->LogWarn(fmt::format(
+            FMT_COMPILE("NetCfgDCO [{}] {} message(s) to the client were dropped"),
+            dev_name,
+            pipe_dropped));
+        pipe_dropped = 0;
     }
 }
 
@@ -244,16 +428,16 @@ void NetCfgDCO::method_new_peer(GVariant *params, int transport_fd)
     IPv4::Addr vpn4 = IPv4::Addr::from_string(vpn4_str);
     IPv6::Addr vpn6 = IPv6::Addr::from_string(vpn6_str);
 
-    openvpn_io::post(io_context,
-                     [peer_id, transport_fd, sa, salen, vpn4, vpn6, this]()
-                     {
-                         this->genl->new_peer(peer_id,
-                                              transport_fd,
-                                              (struct sockaddr *)&sa,
-                                              salen,
-                                              vpn4,
-                                              vpn6);
-                     });
+    post_genl("new_peer",
+              [peer_id, transport_fd, sa, salen, vpn4, vpn6](GeNLImpl *genl)
+              {
+                  genl->new_peer(peer_id,
+                                 transport_fd,
+                                 (struct sockaddr *)&sa,
+                                 salen,
+                                 vpn4,
+                                 vpn6);
+              });
 }
 
 void NetCfgDCO::method_new_key(GVariant *params)
@@ -276,22 +460,22 @@ void NetCfgDCO::method_new_key(GVariant *params)
         dst.cipher_key_size = src.cipher_key_size();
     };
 
-    openvpn_io::post(io_context,
-                     [this, key_slot, dco_kc, copyKeyDirection]()
-                     {
-                         KoRekey::KeyConfig kc;
-                         std::memset(&kc, 0, sizeof(kc));
-                         kc.key_id = dco_kc.key_id();
-                         kc.remote_peer_id = dco_kc.remote_peer_id();
-                         kc.cipher_alg = dco_kc.cipher_alg();
-
-                         copyKeyDirection(dco_kc.encrypt(),
-                                          kc.encrypt);
-                         copyKeyDirection(dco_kc.decrypt(),
-                                          kc.decrypt);
-
-                         this->genl->new_key(key_slot, &kc);
-                     });
+    post_genl("new_key",
+              [key_slot, dco_kc, copyKeyDirection](GeNLImpl *genl)
+              {
+                  KoRekey::KeyConfig kc;
+                  std::memset(&kc, 0, sizeof(kc));
+                  kc.key_id = dco_kc.key_id();
+                  kc.remote_peer_id = dco_kc.remote_peer_id();
+                  kc.cipher_alg = dco_kc.cipher_alg();
+
+                  copyKeyDirection(dco_kc.encrypt(),
+                                   kc.encrypt);
+                  copyKeyDirection(dco_kc.decrypt(),
+                                   kc.decrypt);
+
+                  genl->new_key(key_slot, &kc);
+              });
 }
 
 
@@ -301,11 +485,11 @@ void NetCfgDCO::method_swap_keys(GVariant *params)
 
     unsigned int peer_id = glib2::Value::Extract<unsigned int>(params, 0);
 
-    openvpn_io::post(io_context,
-                     [this, peer_id]()
-                     {
-                         this->genl->swap_keys(peer_id);
-                     });
+    post_genl("swap_keys",
+              [peer_id](GeNLImpl *genl)
+              {
+                  genl->swap_keys(peer_id);
+              });
 }
 
 
@@ -317,12 +501,42 @@ void NetCfgDCO::method_set_peer(GVariant *params)
     uint32_t keepalive_interval = glib2::Value::Extract<uint32_t>(params, 1);
     uint32_t keepalive_timeout = glib2::Value::Extract<uint32_t>(params, 2);
 
-    openvpn_io::post(io_context,
-                     [peer_id, keepalive_interval, keepalive_timeout, this]()
+    post_genl("set_peer",
+              [peer_id, keepalive_interval, keepalive_timeout](GeNLImpl *genl)
+              {
+                  genl->set_peer(peer_id,
+                                 keepalive_interval,
+                                 keepalive_timeout);
+              });
+}
+
+
+void NetCfgDCO::post_genl(const std::string &opname,
+                          std::function<void(GeNLImpl *)> func)
+{
+    // The lambda must not depend on this object, which might have
+    // been removed before the event loop runs it
+    openvpn_io::post(eventloop->GetIOContext(),
+                     [opname, func, active = active, genl = genl.get(), sig = signals, dev = dev_name]()
                      {
-                         this->genl->set_peer(peer_id,
-                                              keepalive_interval,
-                                              keepalive_timeout);
+                         // The GeNL object is released by teardown(),
+                         // which also clears the active flag
+                         if (!*active)
+                         {
+                             return;
+                         }
+                         try
+                         {
+                             func(genl);
+                         }
+                         catch (const std::exception &excp)
+                         {
+                             sig->LogCritical(fmt::format(
+                                 FMT_COMPILE("NetCfgDCO [{}] {} failed: {}"),
+                                 dev,
+                                 opname,
+                                 excp.what()));
+                         }
                      });
 }
 #endif // ENABLE_OVPNDCO
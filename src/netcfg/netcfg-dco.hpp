@@ -13,6 +13,10 @@
 
 #ifdef ENABLE_OVPNDCO
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/object/base.hpp>
 
@@ -36,6 +40,67 @@
 #include "netcfg-signals.hpp"
 
 
+/**
+ *  ASIO event loop shared by all the NetCfgDCO objects in the
+ *  net.openvpn.v3.netcfg service.
+ *
+ *  All GeNL and pipe operations for all the ovpn-dco devices are run
+ *  by a single worker thread.  The OpenVPN 3 Core GeNL implementation
+ *  is not prepared for handlers running in parallel, so a single thread
+ *  also ensures the operations for each device are serialized.
+ *
+ *  The event loop is started when the first NetCfgDCO object needs it
+ *  and stopped when the last NetCfgDCO object using it is removed.
+ *
+ *  No handler may block, as that would stall all the devices.  Writes
+ *  to the client pipes are non-blocking, see NetCfgDCO::tun_read_handler().
+ */
+class NetCfgDCOEventLoop
+{
+  public:
+    using Ptr = std::shared_ptr<NetCfgDCOEventLoop>;
+
+    /**
+     *  Retrieve the shared event loop, starting it if not running.
+     *
+     *  Errors escaping the event loop handlers are logged on the
+     *  net.openvpn.v3.netcfg service object path, as they cannot be
+     *  related to a specific device.
+     *
+     * @param dbuscon  DBus::Connection::Ptr used to send log events
+     * @param logwr    LogWriter used for the log events
+     *
+     * @return NetCfgDCOEventLoop::Ptr
+     */
+    [[nodiscard]] static Ptr Get(DBus::Connection::Ptr dbuscon, LogWriter *logwr);
+    ~NetCfgDCOEventLoop();
+
+    openvpn_io::io_context &GetIOContext();
+
+    /**
+     *  Run a function in the event loop thread and wait for it to
+     *  complete.  If called from the event loop thread, the function
+     *  is run directly.
+     *
+     * @param func  Function to run
+     *
+     * @throws Any exception thrown by func is passed on to the caller
+     */
+    void Execute(std::function<void()> func);
+
+
+  private:
+    NetCfgSignals::Ptr signals = nullptr;
+    openvpn_io::io_context io_context;
+    asio::executor_work_guard<asio::io_context::executor_type> work;
+    std::thread worker;
+
+    NetCfgDCOEventLoop(DBus::Connection::Ptr dbuscon, LogWriter *logwr);
+    void run_worker();
+};
+
+
+
 class NetCfgDCO : public DBus::Object::Base
 {
   public:
@@ -63,14 +128,19 @@ class NetCfgDCO : public DBus::Object::Base
     /**
      * Called by GeNL in worker thread when there is incoming data or event from kernel
      *
+     * The data is passed on to the client through the pipe.  If the
+     * client does not keep up, up to MAX_PIPE_QUEUE messages are queued
+     * for this device; further messages are dropped and logged.
+     *
      * @param buf
      */
     void tun_read_handler(openvpn::BufferAllocated &buf);
 
 
     /**
-     * Deletes ovpn-dco net dev, stops ASIO event loop and GeNL and
-     * waits for worker thread to exit.
+     * Deletes ovpn-dco net dev, stops GeNL and closes the pipe.  Any
+     * operations still queued in the event loop for this device are
+     * ignored afterwards.
      */
     void teardown();
 
@@ -81,22 +151,57 @@ class NetCfgDCO : public DBus::Object::Base
     void method_swap_keys(GVariant *params);
     void method_set_peer(GVariant *params);
 
-    struct PacketFrom
-    {
-        typedef std::unique_ptr<PacketFrom> SPtr;
-        openvpn::BufferAllocated buf;
-    };
+    /**
+     *  Maximum number of messages queued per device while the client
+     *  pipe is not writable
+     */
+    static constexpr size_t MAX_PIPE_QUEUE = 64;
 
-    void queue_read_pipe(PacketFrom *);
+    /**
+     *  Write a message to the client pipe without blocking
+     *
+     * @param buf  Message to write
+     *
+     * @return false if the pipe is not writable and the message should
+     *         be retried later, otherwise true
+     */
+    bool write_pipe(const openvpn::BufferAllocated &buf);
+
+    /**
+     *  Flush the queued messages once the client pipe becomes writable
+     */
+    void wait_pipe_writable();
+
+    /**
+     *  Write the queued messages to the client pipe, until it would block
+     */
+    void flush_pipe_queue();
+
+    /**
+     *  Queue a GeNL operation for this device in the event loop
+     *
+     * @param opname  std::string with the operation name, used for logging
+     * @param func    Function performing the GeNL operation
+     */
+    void post_genl(const std::string &opname,
+                   std::function<void(GeNLImpl *)> func);
 
     std::string backend_bus_name;
     NetCfgSignals::Ptr signals = nullptr;
+    // event loop where GeNL and pipe operations runs, shared with the
+    // other ovpn-dco devices.  This must be declared before the objects
+    // using its io_context, so it is destroyed after them.
+    NetCfgDCOEventLoop::Ptr eventloop = nullptr;
     int fds[2]; // fds[0] is passed to client, here we use fds[1]
     std::unique_ptr<openvpn_io::posix::stream_descriptor> pipe;
+    // messages waiting for the pipe to become writable; only accessed
+    // in the event loop thread
+    std::deque<openvpn::BufferAllocated> pipe_queue;
+    bool pipe_waiting = false;
+    size_t pipe_dropped = 0;
     GeNLImpl::Ptr genl;
-    openvpn_io::io_context io_context;
-    // thread where ASIO event loop runs, used by GeNL and pipe
-    std::future<void> async_dco_worker_thread;
+    // cleared by teardown(); only accessed in the event loop thread
+    std::shared_ptr<bool> active = nullptr;
     std::string dev_name;
 };
 
@@ -0,0 +1,337 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   netcfg-device-config.cpp
+ *
+ * @brief  Implementation of the NetCfgDeviceConfig parser and
+ *         GVariant builder
+ */
+
+#include <fmt/format.h>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include "common/string-utils.hpp"
+#include "netcfg-device-config.hpp"
+#include "netcfg-exception.hpp"
+
+
+static void check_type(const std::string &key, GVariant *value, const char *type)
+{
+    std::string value_type(g_variant_get_type_string(value));
+    if (type != value_type)
+    {
+        throw NetCfgException(fmt::format("[ApplyConfiguration] Invalid data type "
+                                          "for '{}': {}, expected {}",
+                                          key,
+                                          value_type,
+                                          type));
+    }
+}
+
+
+static std::string check_value(const std::string &key,
+                               const std::string &value,
+                               const std::vector<std::string> &allowed)
+{
+    std::string v = filter_ctrl_chars(value, true);
+    for (const auto &a : allowed)
+    {
+        if (a == v)
+        {
+            return v;
+        }
+    }
+    throw NetCfgException(fmt::format("[ApplyConfiguration] Invalid value "
+                                      "for '{}': '{}'",
+                                      key,
+                                      v));
+}
+
+
+static uint32_t check_prefix(const std::string &address,
+                             const uint32_t prefix_size,
+                             const bool ipv6)
+{
+    if (prefix_size > (ipv6 ? 128 : 32))
+    {
+        throw NetCfgException(fmt::format("[ApplyConfiguration] Invalid "
+                                          "prefix size for {}: {}",
+                                          address,
+                                          prefix_size));
+    }
+    return prefix_size;
+}
+
+
+static std::vector<std::string> filter_list(const std::vector<std::string> &list)
+{
+    std::vector<std::string> ret;
+    for (const auto &e : list)
+    {
+        ret.push_back(filter_ctrl_chars(e, true));
+    }
+    return ret;
+}
+
+
+NetCfgDeviceConfig::NetCfgDeviceConfig(GVariant *config)
+{
+    if (nullptr == config
+        || std::string(DBusType()) != g_variant_get_type_string(config))
+    {
+        throw NetCfgException("[ApplyConfiguration] Invalid data type "
+                              "for the device configuration");
+    }
+
+    GVariantIter iter;
+    g_variant_iter_init(&iter, config);
+    const gchar *k = nullptr;
+    GVariant *value = nullptr;
+    while (g_variant_iter_next(&iter, "{&sv}", &k, &value))
+    {
+        std::string key(k);
+        try
+        {
+            if ("layer" == key)
+            {
+                check_type(key, value, "u");
+                uint32_t l = glib2::Value::Get<uint32_t>(value);
+                if (2 != l && 3 != l)
+                {
+                    throw NetCfgException(fmt::format("[ApplyConfiguration] "
+                                                      "Invalid device layer: {}",
+                                                      l));
+                }
+                layer = l;
+            }
+            else if ("mtu" == key)
+            {
+                check_type(key, value, "u");
+                uint32_t m = glib2::Value::Get<uint32_t>(value);
+                if (m < 68 || m > UINT16_MAX)
+                {
+                    throw NetCfgException(fmt::format("[ApplyConfiguration] "
+                                                      "Invalid MTU: {}",
+                                                      m));
+                }
+                mtu = static_cast<uint16_t>(m);
+            }
+            else if ("remote_address" == key)
+            {
+                check_type(key, value, "(sb)");
+                RemoteAddress r;
+                r.address = filter_ctrl_chars(glib2::Value::Extract<std::string>(value, 0), true);
+                r.ipv6 = glib2::Value::Extract<bool>(value, 1);
+                remote = r;
+            }
+            else if ("reroute_ipv4" == key)
+            {
+                check_type(key, value, "b");
+                reroute_ipv4 = glib2::Value::Get<bool>(value);
+            }
+            else if ("reroute_ipv6" == key)
+            {
+                check_type(key, value, "b");
+                reroute_ipv6 = glib2::Value::Get<bool>(value);
+            }
+            else if ("ip_addresses" == key)
+            {
+                check_type(key, value, "a(susb)");
+                GVariantIter addr_iter;
+                g_variant_iter_init(&addr_iter, value);
+                GVariant *e = nullptr;
+                while ((e = g_variant_iter_next_value(&addr_iter)))
+                {
+                    IPAddress a;
+                    a.address = filter_ctrl_chars(glib2::Value::Extract<std::string>(e, 0), true);
+                    a.ipv6 = glib2::Value::Extract<bool>(e, 3);
+                    a.prefix_size = check_prefix(a.address,
+                                                 glib2::Value::Extract<uint32_t>(e, 1),
+                                                 a.ipv6);
+                    a.gateway = filter_ctrl_chars(glib2::Value::Extract<std::string>(e, 2), true);
+                    g_variant_unref(e);
+                    ip_addresses.push_back(a);
+                }
+            }
+            else if ("networks" == key)
+            {
+                check_type(key, value, "a(suibb)");
+                GVariantIter net_iter;
+                g_variant_iter_init(&net_iter, value);
+                GVariant *e = nullptr;
+                while ((e = g_variant_iter_next_value(&net_iter)))
+                {
+                    Route r;
+                    r.address = filter_ctrl_chars(glib2::Value::Extract<std::string>(e, 0), true);
+                    r.metric = glib2::Value::Extract<int32_t>(e, 2);
+                    r.ipv6 = glib2::Value::Extract<bool>(e, 3);
+                    r.exclude = glib2::Value::Extract<bool>(e, 4);
+                    r.prefix_size = check_prefix(r.address,
+                                                 glib2::Value::Extract<uint32_t>(e, 1),
+                                                 r.ipv6);
+                    g_variant_unref(e);
+                    networks.push_back(r);
+                }
+            }
+            else if ("dns_servers" == key)
+            {
+                check_type(key, value, "as");
+                dns_servers = filter_list(glib2::Value::ExtractVector<std::string>(value));
+            }
+            else if ("dns_search_domains" == key)
+            {
+                check_type(key, value, "as");
+                dns_search_domains = filter_list(glib2::Value::ExtractVector<std::string>(value));
+            }
+            else if ("dns_scope" == key)
+            {
+                check_type(key, value, "s");
+                dns_scope = check_value(key,
+                                        glib2::Value::Get<std::string>(value),
+                                        {"global", "tunnel"});
+            }
+            else if ("dnssec_mode" == key)
+            {
+                check_type(key, value, "s");
+                dnssec_mode = check_value(key,
+                                          glib2::Value::Get<std::string>(value),
+                                          {"yes", "no", "optional"});
+            }
+            else if ("dns_transport" == key)
+            {
+                check_type(key, value, "s");
+                dns_transport = check_value(key,
+                                            glib2::Value::Get<std::string>(value),
+                                            {"plain", "dot", "doh"});
+            }
+            else
+            {
+                throw NetCfgException("[ApplyConfiguration] Unknown setting: "
+                                      + filter_ctrl_chars(key, true));
+            }
+        }
+        catch (...)
+        {
+            g_variant_unref(value);
+            throw;
+        }
+        g_variant_unref(value);
+    }
+}
+
+
+bool NetCfgDeviceConfig::empty() const noexcept
+{
+    return !layer && !mtu && !remote && !reroute_ipv4 && !reroute_ipv6
+           && ip_addresses.empty() && networks.empty()
+           && dns_servers.empty() && dns_search_domains.empty()
+           && !dns_scope && !dnssec_mode && !dns_transport;
+}
+
+
+void NetCfgDeviceConfig::clear() noexcept
+{
+    layer.reset();
+    mtu.reset();
+    remote.reset();
+    reroute_ipv4.reset();
+    reroute_ipv6.reset();
+    ip_addresses.clear();
+    networks.clear();
+    dns_servers.clear();
+    dns_search_domains.clear();
+    dns_scope.reset();
+    dnssec_mode.reset();
+    dns_transport.reset();
+}
+
+
+GVariant *NetCfgDeviceConfig::GetGVariant() const
+{
+    GVariantBuilder *b = glib2::Builder::Create(DBusType());
+    if (layer)
+    {
+        g_variant_builder_add(b, "{sv}", "layer", glib2::Value::Create(*layer));
+    }
+    if (mtu)
+    {
+        g_variant_builder_add(b, "{sv}", "mtu", glib2::Value::Create(static_cast<uint32_t>(*mtu)));
+    }
+    if (remote)
+    {
+        GVariantBuilder *r = glib2::Builder::Create("(sb)");
+        glib2::Builder::Add(r, remote->address);
+        glib2::Builder::Add(r, remote->ipv6);
+        g_variant_builder_add(b, "{sv}", "remote_address", glib2::Builder::Finish(r));
+    }
+    if (reroute_ipv4)
+    {
+        g_variant_builder_add(b, "{sv}", "reroute_ipv4", glib2::Value::Create(*reroute_ipv4));
+    }
+    if (reroute_ipv6)
+    {
+        g_variant_builder_add(b, "{sv}", "reroute_ipv6", glib2::Value::Create(*reroute_ipv6));
+    }
+    if (!ip_addresses.empty())
+    {
+        GVariantBuilder *addrs = glib2::Builder::Create("a(susb)");
+        for (const auto &a : ip_addresses)
+        {
+            GVariantBuilder *e = glib2::Builder::Create("(susb)");
+            glib2::Builder::Add(e, a.address);
+            glib2::Builder::Add(e, a.prefix_size);
+            glib2::Builder::Add(e, a.gateway);
+            glib2::Builder::Add(e, a.ipv6);
+            glib2::Builder::Add(addrs, glib2::Builder::Finish(e));
+        }
+        g_variant_builder_add(b, "{sv}", "ip_addresses", glib2::Builder::Finish(addrs));
+    }
+    if (!networks.empty())
+    {
+        GVariantBuilder *nets = glib2::Builder::Create("a(suibb)");
+        for (const auto &n : networks)
+        {
+            GVariantBuilder *e = glib2::Builder::Create("(suibb)");
+            glib2::Builder::Add(e, n.address);
+            glib2::Builder::Add(e, n.prefix_size);
+            glib2::Builder::Add(e, n.metric);
+            glib2::Builder::Add(e, n.ipv6);
+            glib2::Builder::Add(e, n.exclude);
+            glib2::Builder::Add(nets, glib2::Builder::Finish(e));
+        }
+        g_variant_builder_add(b, "{sv}", "networks", glib2::Builder::Finish(nets));
+    }
+    if (!dns_servers.empty())
+    {
+        g_variant_builder_add(b, "{sv}", "dns_servers", glib2::Value::CreateVector(dns_servers));
+    }
+    if (!dns_search_domains.empty())
+    {
+        g_variant_builder_add(b, "{sv}", "dns_search_domains", glib2::Value::CreateVector(dns_search_domains));
+    }
+    if (dns_scope)
+    {
+        g_variant_builder_add(b, "{sv}", "dns_scope", glib2::Value::Create(*dns_scope));
+    }
+    if (dnssec_mode)
+    {
+        g_variant_builder_add(b, "{sv}", "dnssec_mode", glib2::Value::Create(*dnssec_mode));
+    }
+    if (dns_transport)
+    {
+        g_variant_builder_add(b, "{sv}", "dns_transport", glib2::Value::Create(*dns_transport));
+    }
+    return glib2::Builder::Finish(b);
+}
+
+
+const char *NetCfgDeviceConfig::DBusType() noexcept
+{
+    return "a{sv}";
+}
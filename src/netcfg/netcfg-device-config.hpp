@@ -0,0 +1,109 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   netcfg-device-config.hpp
+ *
+ * @brief  Complete configuration of a virtual network device, as passed
+ *         in a single ApplyConfiguration call from the VPN client to
+ *         net.openvpn.v3.netcfg
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <glib.h>
+
+
+/**
+ *  Container of all the settings the VPN client collects via the
+ *  tun_builder interface before the device is established.
+ *
+ *  Only the settings which are set are sent in the D-Bus call.  The
+ *  D-Bus representation is an a{sv} dictionary, where each key is one
+ *  of the settings below.
+ */
+struct NetCfgDeviceConfig
+{
+    struct IPAddress
+    {
+        std::string address;
+        uint32_t prefix_size = 0;
+        std::string gateway;
+        bool ipv6 = false;
+    };
+
+    struct Route
+    {
+        std::string address;
+        uint32_t prefix_size = 0;
+        int32_t metric = -1;
+        bool ipv6 = false;
+        bool exclude = false;
+    };
+
+    struct RemoteAddress
+    {
+        std::string address;
+        bool ipv6 = false;
+    };
+
+    NetCfgDeviceConfig() = default;
+
+    /**
+     *  Parses and validates the D-Bus representation of a device
+     *  configuration
+     *
+     * @param config  GVariant object of the a{sv} type
+     *
+     * @throws NetCfgException if the data type, a key or a value
+     *         is invalid
+     */
+    NetCfgDeviceConfig(GVariant *config);
+
+    /**
+     *  Check if any settings has been set
+     *
+     * @return bool, true if nothing is set
+     */
+    bool empty() const noexcept;
+
+    /**
+     *  Clears all the settings
+     */
+    void clear() noexcept;
+
+    /**
+     *  Retrieve the D-Bus representation of the configuration
+     *
+     * @return GVariant object of the a{sv} type
+     */
+    GVariant *GetGVariant() const;
+
+    /**
+     *  D-Bus data type of the configuration container
+     */
+    static const char *DBusType() noexcept;
+
+
+    std::optional<uint32_t> layer;        ///< Device type; 2 (TAP) or 3 (TUN)
+    std::optional<uint16_t> mtu;          ///< Device MTU
+    std::optional<RemoteAddress> remote;  ///< VPN server address
+    std::optional<bool> reroute_ipv4;     ///< Redirect IPv4 gateway
+    std::optional<bool> reroute_ipv6;     ///< Redirect IPv6 gateway
+    std::vector<IPAddress> ip_addresses;  ///< Device IP addresses
+    std::vector<Route> networks;          ///< Routes to include or exclude
+    std::vector<std::string> dns_servers; ///< DNS resolver addresses
+    std::vector<std::string> dns_search_domains;
+    std::optional<std::string> dns_scope;     ///< "global" or "tunnel"
+    std::optional<std::string> dnssec_mode;   ///< "yes", "no" or "optional"
+    std::optional<std::string> dns_transport; ///< "plain", "dot" or "doh"
+};
@@ -218,6 +218,15 @@ NetCfgDevice::NetCfgDevice(DBus::Connection::Ptr dbuscon_,
         });
     args_set_dnstransp->AddInput("mode", "s");
 
+    auto args_apply_config = AddMethod(
+        "ApplyConfiguration",
+        [this](DBus::Object::Method::Arguments::Ptr args)
+        {
+            this->method_apply_configuration(args->GetMethodParameters());
+            args->SetMethodReturn(nullptr);
+        });
+    args_apply_config->AddInput("configuration", NetCfgDeviceConfig::DBusType());
+
 #ifdef ENABLE_OVPNDCO
     auto args_enable_dco = AddMethod(
         "EnableDCO",
@@ -436,6 +445,139 @@ void NetCfgDevice::method_set_dns_transport(GVariant *params)
 }
 
 
+void NetCfgDevice::method_apply_configuration(GVariant *params)
+{
+    glib2::Utils::checkParams(__func__, params, "(a{sv})", 1);
+
+    // Parse and validate everything before any of the settings
+    // are applied, so a bad value does not leave the device
+    // half configured
+    GVariant *c = g_variant_get_child_value(params, 0);
+    NetCfgDeviceConfig cfg;
+    try
+    {
+        cfg = NetCfgDeviceConfig(c);
+        g_variant_unref(c);
+    }
+    catch (...)
+    {
+        g_variant_unref(c);
+        throw;
+    }
+
+    bool has_dns = !cfg.dns_servers.empty() || !cfg.dns_search_domains.empty()
+                   || cfg.dns_scope || cfg.dnssec_mode || cfg.dns_transport;
+    if (has_dns && (!resolver || !dnsconfig))
+    {
+        signals->LogError("Ignoring DNS resolver settings: "
+                          "No DNS resolver configured");
+        has_dns = false;
+    }
+
+    if (cfg.layer)
+    {
+        device_type = *cfg.layer;
+    }
+    if (cfg.mtu)
+    {
+        mtu = *cfg.mtu;
+    }
+    if (cfg.remote)
+    {
+        signals->LogInfo(std::string("Setting remote IP address to ")
+                         + cfg.remote->address
+                         + " ipv6: " + (cfg.remote->ipv6 ? "yes" : "no"));
+        remote = IPAddr(cfg.remote->address, cfg.remote->ipv6);
+    }
+    if (cfg.reroute_ipv4)
+    {
+        reroute_ipv4 = *cfg.reroute_ipv4;
+    }
+    if (cfg.reroute_ipv6)
+    {
+        reroute_ipv6 = *cfg.reroute_ipv6;
+    }
+
+    for (const auto &addr : cfg.ip_addresses)
+    {
+        signals->LogInfo(std::string("Adding IP Address ") + addr.address
+                         + "/" + std::to_string(addr.prefix_size)
+                         + " gw " + addr.gateway
+                         + " ipv6: " + (addr.ipv6 ? "yes" : "no"));
+        vpnips.emplace_back(addr.address, addr.prefix_size, addr.gateway, addr.ipv6);
+    }
+
+    for (const auto &net : cfg.networks)
+    {
+        std::string metric_str = (net.metric > 0 ? std::to_string(net.metric) : "(default)");
+        signals->LogInfo(fmt::format(
+            "Adding network {}/{}, metric: {}, exclude: {}, ipv6: {}",
+            net.address,
+            net.prefix_size,
+            metric_str,
+            (net.exclude ? "yes" : "no"),
+            (net.ipv6 ? "yes" : "no")));
+        networks.emplace_back(net.address, net.prefix_size, net.metric, net.ipv6, net.exclude);
+    }
+
+    if (!has_dns)
+    {
+        return;
+    }
+
+    for (const auto &srv : cfg.dns_servers)
+    {
+        dnsconfig->AddNameServer(srv);
+    }
+    for (const auto &dom : cfg.dns_search_domains)
+    {
+        dnsconfig->AddSearchDomain(dom);
+    }
+    if (cfg.dns_scope)
+    {
+        dnsconfig->SetDNSScope("tunnel" == *cfg.dns_scope
+                                   ? DNS::Scope::TUNNEL
+                                   : DNS::Scope::GLOBAL);
+    }
+    if (cfg.dnssec_mode)
+    {
+        if ("yes" == *cfg.dnssec_mode)
+        {
+            dnsconfig->SetDNSSEC(openvpn::DnsServer::Security::Yes);
+        }
+        else if ("optional" == *cfg.dnssec_mode)
+        {
+            dnsconfig->SetDNSSEC(openvpn::DnsServer::Security::Optional);
+        }
+        else
+        {
+            dnsconfig->SetDNSSEC(openvpn::DnsServer::Security::No);
+        }
+    }
+    if (cfg.dns_transport)
+    {
+        if ("dot" == *cfg.dns_transport)
+        {
+            dnsconfig->SetDNSTransport(openvpn::DnsServer::Transport::TLS);
+        }
+        else if ("doh" == *cfg.dns_transport)
+        {
+            dnsconfig->SetDNSTransport(openvpn::DnsServer::Transport::HTTPS);
+        }
+        else
+        {
+            dnsconfig->SetDNSTransport(openvpn::DnsServer::Transport::Plain);
+        }
+    }
+
+    std::stringstream details;
+    details << dnsconfig;
+    signals->DebugDevice(device_name,
+                         "Applied DNS resolver settings: " + details.str());
+    modified = true;
+}
+
+
 #ifdef ENABLE_OVPNDCO
 void NetCfgDevice::method_enable_dco(DBus::Object::Method::Arguments::Ptr args)
 {
@@ -639,7 +781,7 @@ void NetCfgDevice::destroy()
 
 void NetCfgDevice::method_destroy(DBus::Object::Method::Arguments::Ptr args)
 {
-    auto credsq = DBus::Credentials::Query::Create(dbuscon);
+    auto credsq = GDBusPP::Credentials::Cache::Create(dbuscon);
     std::string caller = args->GetCallerBusName();
 
     std::string sender_name = fmt::format("[{}]", caller);
@@ -37,6 +37,7 @@
 #include "dbus/object-ownership.hpp"
 #include "netcfg/dns/resolver-settings.hpp"
 #include "netcfg/dns/settings-manager.hpp"
+#include "netcfg-device-config.hpp"
 #include "netcfg-options.hpp"
 #include "netcfg-changeevent.hpp"
 #include "netcfg-signals.hpp"
@@ -204,6 +205,7 @@ class NetCfgDevice : public DBus::Object::Base
     void method_add_dns_search(GVariant *params);
     void method_set_dnssec(GVariant *params);
     void method_set_dns_transport(GVariant *params);
+    void method_apply_configuration(GVariant *params);
     void method_enable_dco(DBus::Object::Method::Arguments::Ptr args);
     void method_establish(DBus::Object::Method::Arguments::Ptr args);
     void method_disable();
@@ -40,7 +40,7 @@ NetCfgServiceHandler::NetCfgServiceHandler(DBus::Connection::Ptr conn_,
 {
     DisableIdleDetector(true);
 
-    creds_query = DBus::Credentials::Query::Create(conn);
+    creds_query = GDBusPP::Credentials::Cache::Create(conn);
 
     signals = NetCfgSignals::Create(conn,
                                     LogGroup::NETCFG,
@@ -21,10 +21,10 @@
 #include <map>
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/glib2/utils.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/base.hpp>
 #include <gdbuspp/service.hpp>
 
+#include "dbus/credentials-cache.hpp"
 #include "log/logwriter.hpp"
 #include "dns/settings-manager.hpp"
 #include "netcfg-signals.hpp"
@@ -81,7 +81,7 @@ class NetCfgServiceHandler : public DBus::Object::Base
   private:
     DBus::Connection::Ptr conn = nullptr;
     DBus::Object::Manager::Ptr object_manager = nullptr;
-    DBus::Credentials::Query::Ptr creds_query = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_query = nullptr;
     NetCfgSignals::Ptr signals = nullptr;
     DNS::SettingsManager::Ptr resolver = nullptr;
     std::string version{get_package_version()};
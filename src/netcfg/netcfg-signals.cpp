@@ -41,6 +41,7 @@ NetCfgSignals::NetCfgSignals(DBus::Connection::Ptr conn,
     AddTarget(creds->GetUniqueBusName(Constants::GenServiceName("log")));
 
     RegisterSignal("NetworkChange", NetCfgChangeEvent::SignalDeclaration());
+    RegisterSignal("NetworkChanges", NetCfgChangeEvent::BatchSignalDeclaration());
 
     SetLogLevel(default_log_level);
     GroupCreate(object_path);
@@ -61,6 +62,11 @@ void NetCfgSignals::LogFATAL(const std::string &msg)
 
 void NetCfgSignals::Debug(const std::string &msg, bool duplicate_check)
 {
+    if (!LogWanted(LogCategory::DEBUG))
+    {
+        return;
+    }
+
     try
     {
         Log(Events::Log(log_group, LogCategory::DEBUG, msg));
@@ -76,6 +82,11 @@ void NetCfgSignals::Debug(const std::string &msg, bool duplicate_check)
 
 void NetCfgSignals::DebugDevice(const std::string &dev, const std::string &msg)
 {
+    if (!LogWanted(LogCategory::DEBUG))
+    {
+        return;
+    }
+
     std::stringstream m;
     m << "[" << dev << "] " << msg;
     Debug(m.str());
@@ -90,32 +101,78 @@ void NetCfgSignals::AddSubscriptionList(NetCfgSubscriptions::Ptr subs)
 
 void NetCfgSignals::NetworkChange(const NetCfgChangeEvent &ev)
 {
-    try
+    NetworkChanges({ev});
+}
+
+
+void NetCfgSignals::NetworkChanges(const std::vector<NetCfgChangeEvent> &events)
+{
+    if (events.empty())
+    {
+        return;
+    }
+
+    if (!subscriptions)
+    {
+        // If no subscription manager is configured, we switch
+        // to broadcasting NetworkChange signals.
+        for (const auto &ev : events)
+        {
+            try
+            {
+                SendGVariant("NetworkChange", ev.GetGVariant());
+            }
+            catch (const DBus::Signals::Exception &excp)
+            {
+                std::cerr << "NetCfgSignals::NetworkChange EXCEPTION: " << excp.what()
+                          << std::endl
+                          << "Event: " << ev << std::endl;
+            }
+        }
+        return;
+    }
+
+    // All subscribers sharing the same filter mask receives the same
+    // signals, so each signal is only built once per group
+    const uint32_t batched = static_cast<uint32_t>(NetCfgChangeType::BATCHED_SIGNALS);
+    const auto groups = subscriptions->GetSubscriberGroups();
+    for (const auto &[filter, targets] : groups)
     {
-        GVariant *e = ev.GetGVariant();
-        if (subscriptions)
+        if (filter & batched)
         {
-            auto subscr_list = subscriptions->GetSubscribersList(ev);
-            if (subscr_list.size() < 1)
+            GVariant *changes = NetCfgChangeEvent::GetGVariantBatch(events, filter);
+            if (changes)
             {
-                // If there are no subscribers, we just bail out quickly
-                return;
+                send_to_targets(targets, "NetworkChanges", changes);
             }
-            GroupAddTargetList(object_path, subscr_list);
-            GroupSendGVariant(object_path, "NetworkChange", e);
-            GroupClearTargets(object_path);
+            continue;
         }
-        else
+
+        for (const auto &ev : events)
         {
-            // If no subscription manager is configured, we switch
-            // to broadcasting NetworkChange signals.
-            SendGVariant("NetworkChange", e);
+            if (static_cast<uint32_t>(ev.type) & filter)
+            {
+                send_to_targets(targets, "NetworkChange", ev.GetGVariant());
+            }
         }
     }
+}
+
+
+void NetCfgSignals::send_to_targets(const std::vector<std::string> &targets,
+                                    const std::string &signal_name,
+                                    GVariant *params)
+{
+    try
+    {
+        GroupAddTargetList(object_path, targets);
+        GroupSendGVariant(object_path, signal_name, params);
+        GroupClearTargets(object_path);
+    }
     catch (const DBus::Signals::Exception &excp)
     {
-        std::cerr << "NetCfgSignals::NetworkChange EXCEPTION: " << excp.what()
-                  << std::endl
-                  << "Event: " << ev << std::endl;
+        GroupClearTargets(object_path);
+        std::cerr << "NetCfgSignals::" << signal_name << " EXCEPTION: "
+                  << excp.what() << std::endl;
     }
 }
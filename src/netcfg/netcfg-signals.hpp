@@ -15,6 +15,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <gdbuspp/connection.hpp>
 
 #include "log/dbus-log.hpp"
@@ -53,6 +55,17 @@ class NetCfgSignals : public LogSender
 
     void NetworkChange(const NetCfgChangeEvent &ev);
 
+    /**
+     *  Sends a set of related change events, typically all the changes
+     *  done while establishing or tearing down a device.  Subscribers
+     *  with the BATCHED_SIGNALS flag receives a single NetworkChanges
+     *  signal, other subscribers receives one NetworkChange signal per
+     *  event.
+     *
+     * @param events  std::vector<NetCfgChangeEvent> with the events
+     */
+    void NetworkChanges(const std::vector<NetCfgChangeEvent> &events);
+
 
   private:
     const unsigned int default_log_level = 6; // LogCategory::DEBUG
@@ -65,4 +78,8 @@ class NetCfgSignals : public LogSender
                   LogGroup lgroup,
                   std::string object_path_,
                   LogWriter *logwr);
+
+    void send_to_targets(const std::vector<std::string> &targets,
+                         const std::string &signal_name,
+                         GVariant *params);
 };
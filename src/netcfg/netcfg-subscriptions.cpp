@@ -15,7 +15,6 @@
 #include <cstdint>
 #include <sstream>
 #include <gdbuspp/credentials/exceptions.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/glib2/utils.hpp>
 
 #include "common/string-utils.hpp"
@@ -25,7 +24,7 @@
 
 
 NetCfgSubscriptions::NetCfgSubscriptions(std::shared_ptr<NetCfgSignals> signals_,
-                                         DBus::Credentials::Query::Ptr creds_qry_)
+                                         GDBusPP::Credentials::Cache::Ptr creds_qry_)
     : signals(signals_), creds_query(creds_qry_)
 {
 }
@@ -79,13 +78,23 @@ void NetCfgSubscriptions::Subscribe(const std::string &sender, uint32_t filter_f
     {
         throw NetCfgException("Invalid subscription flag, must be < 65535");
     }
+    if (0 == (filter_flags & ~static_cast<uint32_t>(NetCfgChangeType::BATCHED_SIGNALS)))
+    {
+        throw NetCfgException("Subscription filter must contain a change type");
+    }
+    // The UID lookup might need a D-Bus call; done before locking
+    const uid_t owner = creds_query->GetUID(sender);
+
+    std::lock_guard<std::mutex> guard(subscr_mtx);
     subscriptions[sender] = filter_flags;
-    subscr_owners[sender] = creds_query->GetUID(sender);
+    subscr_owners[sender] = owner;
+    update_subscriber_groups();
 }
 
 
 void NetCfgSubscriptions::Unsubscribe(const std::string &subscriber)
 {
+    std::lock_guard<std::mutex> guard(subscr_mtx);
     if (subscriptions.find(subscriber) == subscriptions.end())
     {
         throw NetCfgException("Subscription not found for '"
@@ -93,6 +102,7 @@ void NetCfgSubscriptions::Unsubscribe(const std::string &subscriber)
     }
     subscriptions.erase(subscriber);
     subscr_owners.erase(subscriber);
+    update_subscriber_groups();
 }
 
 
@@ -106,6 +116,7 @@ GVariant *NetCfgSubscriptions::List()
                               "(NetCfgSubscriptions::List)");
     }
 
+    std::lock_guard<std::mutex> guard(subscr_mtx);
     for (const auto &sub : subscriptions)
     {
         g_variant_builder_add(bld, "(su)", sub.first.c_str(), sub.second);
@@ -114,24 +125,16 @@ GVariant *NetCfgSubscriptions::List()
 }
 
 
-std::vector<std::string> NetCfgSubscriptions::GetSubscribersList(const NetCfgChangeEvent &ev) const
+NetCfgSubscriptions::SubscriberGroups NetCfgSubscriptions::GetSubscriberGroups() const
 {
-    // Loop through all subscribers and identify who wants this
-    // notification.
-    std::vector<std::string> targets;
-    for (const auto &s : subscriptions)
-    {
-        if ((uint16_t)ev.type & s.second)
-        {
-            targets.push_back(s.first);
-        }
-    }
-    return targets;
+    std::lock_guard<std::mutex> guard(subscr_mtx);
+    return subscriber_groups;
 }
 
 
 uid_t NetCfgSubscriptions::GetSubscriptionOwner(const std::string &sender) const
 {
+    std::lock_guard<std::mutex> guard(subscr_mtx);
     try
     {
         return subscr_owners.at(sender);
@@ -143,6 +146,16 @@ uid_t NetCfgSubscriptions::GetSubscriptionOwner(const std::string &sender) const
 }
 
 
+void NetCfgSubscriptions::update_subscriber_groups()
+{
+    subscriber_groups.clear();
+    for (const auto &[subscriber, filter] : subscriptions)
+    {
+        subscriber_groups[filter].push_back(subscriber);
+    }
+}
+
+
 void NetCfgSubscriptions::method_name_subscribe(DBus::Object::Method::Arguments::Ptr args)
 {
     GVariant *params = args->GetMethodParameters();
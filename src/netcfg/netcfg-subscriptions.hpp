@@ -16,13 +16,14 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/base.hpp>
 #include <gdbuspp/signals/group.hpp>
 
+#include "dbus/credentials-cache.hpp"
 #include "netcfg-changeevent.hpp"
 
 
@@ -51,7 +52,7 @@ class NetCfgSubscriptions
     using NetCfgSubscriptionOwner = std::map<std::string, uid_t>;
 
     [[nodiscard]] static NetCfgSubscriptions::Ptr Create(std::shared_ptr<NetCfgSignals> sigs,
-                                                         DBus::Credentials::Query::Ptr creds)
+                                                         GDBusPP::Credentials::Cache::Ptr creds)
     {
         return NetCfgSubscriptions::Ptr(new NetCfgSubscriptions(sigs, creds));
     }
@@ -111,15 +112,21 @@ class NetCfgSubscriptions
 
 
     /**
-     *  Get a list of subscribers for a specific NetCfgChangeType
-     *
-     * @param ev  NetCfgChangeEvent object where to extract the
-     *            NetCfgChangeType from
+     *  Subscribers grouped by their filter mask.  All subscribers in a
+     *  group receive exactly the same signals, which allows a signal to
+     *  be built only once per group.
+     */
+    using SubscriberGroups = std::map<uint32_t, std::vector<std::string>>;
+
+    /**
+     *  Get all subscribers, grouped by their filter mask.  The groups
+     *  are updated when subscriptions are added or removed, not per
+     *  change event.  A copy is returned, as subscriptions may change
+     *  while the caller sends the signals.
      *
-     * @return  Returns a std::vector<std::string> of all subscribers who
-     *          have subscribed to this change type
+     * @return SubscriberGroups
      */
-    std::vector<std::string> GetSubscribersList(const NetCfgChangeEvent &ev) const;
+    SubscriberGroups GetSubscriberGroups() const;
 
 
     /**
@@ -135,12 +142,21 @@ class NetCfgSubscriptions
 
   private:
     std::shared_ptr<NetCfgSignals> signals = nullptr;
-    DBus::Credentials::Query::Ptr creds_query = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_query = nullptr;
+
+    /// Protects subscriptions, subscr_owners and subscriber_groups
+    mutable std::mutex subscr_mtx;
     NetCfgNotifSubscriptions subscriptions{};
     NetCfgSubscriptionOwner subscr_owners{};
+    SubscriberGroups subscriber_groups{};
 
     NetCfgSubscriptions(std::shared_ptr<NetCfgSignals> signals_,
-                        DBus::Credentials::Query::Ptr creds_qry_);
+                        GDBusPP::Credentials::Cache::Ptr creds_qry_);
+
+    /**
+     *  Rebuilds subscriber_groups.  Must be called with subscr_mtx locked.
+     */
+    void update_subscriber_groups();
 
     void method_name_subscribe(DBus::Object::Method::Arguments::Ptr args);
     void method_name_unsubscribe(DBus::Object::Method::Arguments::Ptr args);
@@ -0,0 +1,348 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   netlink-route-batch.cpp
+ *
+ * @brief  Implementation of NetCfg::Netlink::RouteBatch
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "netlink-route-batch.hpp"
+#include "netcfg-exception.hpp"
+
+
+namespace NetCfg {
+namespace Netlink {
+
+std::string Route::str() const
+{
+    return address + "/" + std::to_string(prefix_size)
+           + (gateway.empty() ? "" : " via " + gateway);
+}
+
+
+/**
+ *  Closes the netlink socket when going out of scope
+ */
+class NetlinkSocket
+{
+  public:
+    NetlinkSocket()
+    {
+        fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (fd < 0)
+        {
+            throw NetCfgException(std::string("Could not open netlink socket: ")
+                                  + strerror(errno));
+        }
+
+        // Make room for the acks of a complete batch
+        int bufsize = 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+        // Only return the header of the request in the acks
+        int one = 1;
+        setsockopt(fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+
+        struct sockaddr_nl local = {};
+        local.nl_family = AF_NETLINK;
+        if (bind(fd, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0)
+        {
+            int err = errno;
+            close(fd);
+            throw NetCfgException(std::string("Could not bind netlink socket: ")
+                                  + strerror(err));
+        }
+    }
+
+    ~NetlinkSocket() noexcept
+    {
+        close(fd);
+    }
+
+    int fd = -1;
+};
+
+
+static void add_attr(struct nlmsghdr *hdr,
+                     const uint16_t type,
+                     const void *data,
+                     const size_t len)
+{
+    size_t offset = NLMSG_ALIGN(hdr->nlmsg_len);
+    size_t attr_len = RTA_LENGTH(len);
+    hdr->nlmsg_len = offset + RTA_ALIGN(attr_len);
+
+    struct rtattr *rta = reinterpret_cast<struct rtattr *>(reinterpret_cast<char *>(hdr) + offset);
+    rta->rta_type = type;
+    rta->rta_len = attr_len;
+    memcpy(RTA_DATA(rta), data, len);
+}
+
+
+static bool parse_address(const std::string &addr,
+                          const bool ipv6,
+                          unsigned char *out)
+{
+    return 1 == inet_pton((ipv6 ? AF_INET6 : AF_INET), addr.c_str(), out);
+}
+
+
+RouteBatch::RouteBatch(const std::string &ifname_, const unsigned int batch_size_)
+    : ifname(ifname_), batch_size(batch_size_ > 0 ? batch_size_ : 1)
+{
+}
+
+
+void RouteBatch::Add(const Route &route)
+{
+    Entry e;
+    e.route = route;
+
+    uint32_t max_prefix = (route.ipv6 ? 128 : 32);
+    if (!parse_address(route.address, route.ipv6, e.dst)
+        || route.prefix_size > max_prefix)
+    {
+        e.error = EINVAL;
+    }
+    else
+    {
+        // The kernel rejects routes with host bits set, like the
+        // Core library this normalizes the network address
+        for (uint32_t bit = route.prefix_size; bit < max_prefix; ++bit)
+        {
+            e.dst[bit / 8] &= ~(0x80 >> (bit % 8));
+        }
+    }
+
+    if (!route.gateway.empty())
+    {
+        e.has_gw = parse_address(route.gateway, route.ipv6, e.gw);
+        if (!e.has_gw)
+        {
+            e.error = EINVAL;
+        }
+    }
+    routes.push_back(e);
+}
+
+
+size_t RouteBatch::size() const noexcept
+{
+    return routes.size();
+}
+
+
+std::vector<RouteError> RouteBatch::Install()
+{
+    std::vector<Entry *> pending;
+    for (auto &e : routes)
+    {
+        if (!e.installed && 0 == e.error)
+        {
+            pending.push_back(&e);
+        }
+    }
+    submit(RTM_NEWROUTE, pending);
+
+    std::vector<RouteError> ret;
+    for (auto &e : routes)
+    {
+        if (0 != e.error)
+        {
+            ret.push_back({e.route, e.error, strerror(e.error)});
+        }
+    }
+    return ret;
+}
+
+
+std::vector<RouteError> RouteBatch::Remove()
+{
+    std::vector<Entry *> pending;
+    for (auto &e : routes)
+    {
+        if (e.installed)
+        {
+            pending.push_back(&e);
+        }
+    }
+    submit(RTM_DELROUTE, pending);
+
+    std::vector<RouteError> ret;
+    for (auto *e : pending)
+    {
+        // The route is already gone, which is what we wanted
+        if (0 != e->error && ESRCH != e->error && ENODEV != e->error)
+        {
+            ret.push_back({e->route, e->error, strerror(e->error)});
+        }
+        e->error = 0;
+    }
+    return ret;
+}
+
+
+void RouteBatch::submit(const uint16_t msg_type, std::vector<Entry *> &entries)
+{
+    if (entries.empty())
+    {
+        return;
+    }
+
+    int ifindex = if_nametoindex(ifname.c_str());
+    if (0 == ifindex)
+    {
+        if (RTM_DELROUTE == msg_type)
+        {
+            // The interface is gone, and the kernel removed its routes
+            for (auto *e : entries)
+            {
+                e->error = ENODEV;
+                e->installed = false;
+            }
+            return;
+        }
+        throw NetCfgException("Could not find network interface " + ifname);
+    }
+
+    NetlinkSocket sock;
+    uint32_t seq = 0;
+    for (size_t start = 0; start < entries.size(); start += batch_size)
+    {
+        size_t end = std::min(entries.size(), start + batch_size);
+
+        // Pack all the route requests of this batch into one buffer,
+        // using the sequence number to map the acks back to the routes
+        std::map<uint32_t, Entry *> inflight;
+        std::vector<char> buf((end - start) * NLMSG_SPACE(sizeof(struct rtmsg) + 128));
+        size_t used = 0;
+        for (size_t i = start; i < end; ++i)
+        {
+            Entry *e = entries[i];
+            e->error = 0;
+
+            struct nlmsghdr *hdr = reinterpret_cast<struct nlmsghdr *>(buf.data() + used);
+            hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+            hdr->nlmsg_type = msg_type;
+            hdr->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+            if (RTM_NEWROUTE == msg_type)
+            {
+                hdr->nlmsg_flags |= NLM_F_CREATE | NLM_F_EXCL;
+            }
+            hdr->nlmsg_seq = ++seq;
+
+            struct rtmsg *rtm = reinterpret_cast<struct rtmsg *>(NLMSG_DATA(hdr));
+            rtm->rtm_family = (e->route.ipv6 ? AF_INET6 : AF_INET);
+            rtm->rtm_dst_len = e->route.prefix_size;
+            rtm->rtm_table = RT_TABLE_MAIN;
+            rtm->rtm_protocol = RTPROT_BOOT;
+            rtm->rtm_type = RTN_UNICAST;
+            if (RTM_NEWROUTE == msg_type)
+            {
+                rtm->rtm_scope = (e->has_gw ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK);
+            }
+            else
+            {
+                rtm->rtm_scope = RT_SCOPE_NOWHERE;
+            }
+
+            size_t addr_len = (e->route.ipv6 ? 16 : 4);
+            add_attr(hdr, RTA_DST, e->dst, addr_len);
+            if (e->has_gw)
+            {
+                add_attr(hdr, RTA_GATEWAY, e->gw, addr_len);
+            }
+            add_attr(hdr, RTA_OIF, &ifindex, sizeof(ifindex));
+            if (e->route.metric >= 0)
+            {
+                uint32_t prio = static_cast<uint32_t>(e->route.metric);
+                add_attr(hdr, RTA_PRIORITY, &prio, sizeof(prio));
+            }
+
+            used += NLMSG_ALIGN(hdr->nlmsg_len);
+            inflight[hdr->nlmsg_seq] = e;
+        }
+
+        struct sockaddr_nl kernel = {};
+        kernel.nl_family = AF_NETLINK;
+        struct iovec iov = {buf.data(), used};
+        struct msghdr msg = {};
+        msg.msg_name = &kernel;
+        msg.msg_namelen = sizeof(kernel);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (sendmsg(sock.fd, &msg, 0) < 0)
+        {
+            throw NetCfgException(std::string("Failed sending netlink route requests: ")
+                                  + strerror(errno));
+        }
+
+        // Collect the ack for each of the requests in this batch
+        char rbuf[32768];
+        while (!inflight.empty())
+        {
+            ssize_t len = recv(sock.fd, rbuf, sizeof(rbuf), 0);
+            if (len < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                throw NetCfgException(std::string("Failed receiving netlink acks: ")
+                                      + strerror(errno));
+            }
+
+            int remaining = static_cast<int>(len);
+            for (struct nlmsghdr *h = reinterpret_cast<struct nlmsghdr *>(rbuf);
+                 NLMSG_OK(h, remaining);
+                 h = NLMSG_NEXT(h, remaining))
+            {
+                if (NLMSG_ERROR != h->nlmsg_type)
+                {
+                    continue;
+                }
+                auto it = inflight.find(h->nlmsg_seq);
+                if (inflight.end() == it)
+                {
+                    continue;
+                }
+                // Track the state of each route as soon as its ack
+                // arrives, so a failure in a later batch does not lose
+                // track of the routes already programmed
+                auto *err = reinterpret_cast<struct nlmsgerr *>(NLMSG_DATA(h));
+                Entry *e = it->second;
+                e->error = -err->error;
+                if (RTM_NEWROUTE == msg_type)
+                {
+                    e->installed = (0 == e->error);
+                }
+                else
+                {
+                    e->installed = false;
+                }
+                inflight.erase(it);
+            }
+        }
+    }
+}
+
+} // namespace Netlink
+} // namespace NetCfg
@@ -0,0 +1,141 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   netlink-route-batch.hpp
+ *
+ * @brief  Programs a large number of routes via rtnetlink, sending many
+ *         route requests per sendmsg() call over a single socket
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace NetCfg {
+namespace Netlink {
+
+/**
+ *  A single route to program on the network interface
+ */
+struct Route
+{
+    std::string address;
+    uint32_t prefix_size = 0;
+    std::string gateway; ///< Empty for routes directly via the interface
+    int32_t metric = -1; ///< -1 uses the kernel default metric
+    bool ipv6 = false;
+
+    std::string str() const;
+};
+
+
+/**
+ *  Result of a failed route operation
+ */
+struct RouteError
+{
+    Route route;
+    int error = 0; ///< errno value
+    std::string message;
+};
+
+
+/**
+ *  Collects routes for one network interface and installs or removes
+ *  them in batches.
+ *
+ *  The Core library programs each route with its own netlink socket
+ *  and waits for the kernel ack before the next request.  With
+ *  thousands of routes that becomes the dominating part of setting up
+ *  the interface.  This class packs up to batch_size route requests
+ *  into each sendmsg() call and collects the acks afterwards, reporting
+ *  the result of each route individually.
+ */
+class RouteBatch
+{
+  public:
+    using Ptr = std::shared_ptr<RouteBatch>;
+
+    /**
+     *  Prepare a new route batch
+     *
+     * @param ifname      std::string with the network interface name
+     * @param batch_size  Max number of route requests per sendmsg() call
+     *
+     * @return RouteBatch::Ptr
+     */
+    [[nodiscard]] static Ptr Create(const std::string &ifname,
+                                    const unsigned int batch_size = 256)
+    {
+        return Ptr(new RouteBatch(ifname, batch_size));
+    }
+
+    /**
+     *  Add a route to the batch.  The route is not programmed until
+     *  Install() is called.
+     *
+     * @param route  Route to add
+     */
+    void Add(const Route &route);
+
+    /**
+     *  Number of routes in the batch
+     */
+    size_t size() const noexcept;
+
+    /**
+     *  Program all the routes in the batch.  Failing routes do not
+     *  stop the remaining routes from being programmed.
+     *
+     * @return std::vector<RouteError> with the routes which failed
+     *
+     * @throws NetCfgException if the netlink socket fails.  The routes
+     *         programmed before the failure are still removed by
+     *         Remove().
+     */
+    std::vector<RouteError> Install();
+
+    /**
+     *  Remove the routes previously programmed by Install().  Routes
+     *  which are already gone, for example when the interface has been
+     *  removed, are not reported as errors.
+     *
+     * @return std::vector<RouteError> with the routes which failed
+     *
+     * @throws NetCfgException if the netlink socket fails
+     */
+    std::vector<RouteError> Remove();
+
+
+  private:
+    struct Entry
+    {
+        Route route;
+        unsigned char dst[16] = {};
+        unsigned char gw[16] = {};
+        bool has_gw = false;
+        bool installed = false;
+        int error = 0;
+    };
+
+    std::string ifname;
+    unsigned int batch_size;
+    std::vector<Entry> routes;
+
+    RouteBatch(const std::string &ifname, const unsigned int batch_size);
+
+    void submit(const uint16_t msg_type, std::vector<Entry *> &entries);
+};
+
+} // namespace Netlink
+} // namespace NetCfg
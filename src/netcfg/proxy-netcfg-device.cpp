@@ -199,18 +199,40 @@ void Device::SetDNSscope(const std::string &scope) const
 
 
 bool Device::AddDnsOptions(LogSender::Ptr log, const openvpn::DnsOptions &dns) const
+{
+    NetCfgDeviceConfig cfg;
+    if (!PrepareDnsOptions(log, dns, cfg))
+    {
+        return false;
+    }
+
+    try
+    {
+        ApplyConfiguration(cfg);
+        return true;
+    }
+    catch (const DBus::Exception &excp)
+    {
+        log->LogError("DNS resolver setup: Failed applying DNS settings: "
+                      + std::string(excp.GetRawError()));
+        return false;
+    }
+}
+
+
+bool Device::PrepareDnsOptions(LogSender::Ptr log,
+                               const openvpn::DnsOptions &dns,
+                               NetCfgDeviceConfig &cfg)
 {
     try
     {
         // Parse --dns search-domains DOMAIN...
-        std::vector<std::string> search_domains{};
         for (const auto &dns_srch : dns.search_domains)
         {
-            search_domains.push_back(dns_srch.to_string());
+            cfg.dns_search_domains.push_back(dns_srch.to_string());
         }
 
         bool split_dns = false;
-        std::vector<std::string> dns_servers{};
         for (const auto &[idx, dnsopts] : dns.servers)
         {
             // Parse --dns search-domain DOMAIN...
@@ -218,43 +240,47 @@ bool Device::AddDnsOptions(LogSender::Ptr log, const openvpn::DnsOptions &dns) c
             {
                 for (const auto &dns_srch : dnsopts.domains)
                 {
-                    search_domains.push_back(dns_srch.to_string());
+                    cfg.dns_search_domains.push_back(dns_srch.to_string());
                 }
                 split_dns = true;
             }
 
             // Parse --dns server X dnssec SECURITY
+            switch (dnsopts.dnssec)
+            {
+            case openvpn::DnsServer::Security::Yes:
+                cfg.dnssec_mode = "yes";
+                break;
+            case openvpn::DnsServer::Security::No:
+                cfg.dnssec_mode = "no";
+                break;
+            case openvpn::DnsServer::Security::Optional:
+                cfg.dnssec_mode = "optional";
+                break;
+            default:
+                break;
+            }
             if (openvpn::DnsServer::Security::Unset != dnsopts.dnssec)
             {
-                try
-                {
-                    SetDNSSEC(dnsopts.dnssec);
-                    log->LogInfo("DNS resolver setup: DNSSEC set to "
-                                 + dnsopts.dnssec_string(dnsopts.dnssec));
-                }
-                catch (const DBus::Exception &excp)
-                {
-                    log->LogWarn("DNS resolver setup: "
-                                 "Could not set DNSSEC mode: "
-                                 + std::string(excp.GetRawError()));
-                }
+                log->LogInfo("DNS resolver setup: DNSSEC set to "
+                             + dnsopts.dnssec_string(dnsopts.dnssec));
             }
 
             // Parse --dns server X transport TRANSSPORT
-            if (openvpn::DnsServer::Transport::Unset != dnsopts.transport)
+            switch (dnsopts.transport)
             {
-                try
-                {
-                    SetDNSTransport(dnsopts.transport);
-                }
-                catch (const DBus::Exception &excp)
-                {
-                    log->LogError("DNS resolver setup: Failed setting DNS transport to "
-                                  + dnsopts.transport_string(dnsopts.transport));
-                    log->Debug("DNS transport setting error: "
-                               + std::string(excp.GetRawError()));
-                    return false;
-                }
+            case openvpn::DnsServer::Transport::Plain:
+                cfg.dns_transport = "plain";
+                break;
+            case openvpn::DnsServer::Transport::TLS:
+                cfg.dns_transport = "dot";
+                break;
+            case openvpn::DnsServer::Transport::Unset:
+                break;
+            default:
+                log->LogError("DNS resolver setup: Failed setting DNS transport to "
+                              + dnsopts.transport_string(dnsopts.transport));
+                return false;
             }
 
             // Parse --dns server X address RESOLVER_ADDR...
@@ -275,17 +301,14 @@ bool Device::AddDnsOptions(LogSender::Ptr log, const openvpn::DnsOptions &dns) c
                                  + dns_addr.to_string());
                     continue;
                 }
-                dns_servers.push_back(dns_addr.address);
+                cfg.dns_servers.push_back(dns_addr.address);
             }
         }
 
-        // Send the parsed DNS resolver settings to the netcfg service
-        AddDNSSearch(search_domains);
-        AddDNS(dns_servers);
         if (split_dns)
         {
             log->LogInfo("Changing DNS scope to 'tunnel'");
-            SetDNSscope("tunnel");
+            cfg.dns_scope = "tunnel";
         }
         return true;
     }
@@ -298,6 +321,102 @@ bool Device::AddDnsOptions(LogSender::Ptr log, const openvpn::DnsOptions &dns) c
 }
 
 
+void Device::ApplyConfiguration(const NetCfgDeviceConfig &cfg) const
+{
+    if (cfg.empty())
+    {
+        return;
+    }
+
+    if (service_version <= 26)
+    {
+        // ApplyConfiguration was added after the v26 release
+        apply_configuration_compat(cfg);
+        return;
+    }
+
+    GVariant *res = proxy->Call(prxtgt,
+                                "ApplyConfiguration",
+                                glib2::Value::CreateTupleWrapped(cfg.GetGVariant()));
+    if (res)
+    {
+        g_variant_unref(res);
+    }
+}
+
+
+void Device::apply_configuration_compat(const NetCfgDeviceConfig &cfg) const
+{
+    if (cfg.remote)
+    {
+        SetRemoteAddress(cfg.remote->address, cfg.remote->ipv6);
+    }
+    for (const auto &addr : cfg.ip_addresses)
+    {
+        AddIPAddress(addr.address, addr.prefix_size, addr.gateway, addr.ipv6);
+    }
+    if (cfg.layer)
+    {
+        SetLayer(*cfg.layer);
+    }
+    if (cfg.mtu)
+    {
+        SetMtu(*cfg.mtu);
+    }
+    if (cfg.reroute_ipv4)
+    {
+        SetRerouteGw(false, *cfg.reroute_ipv4);
+    }
+    if (cfg.reroute_ipv6)
+    {
+        SetRerouteGw(true, *cfg.reroute_ipv6);
+    }
+    if (!cfg.networks.empty())
+    {
+        std::vector<Network> networks;
+        for (const auto &net : cfg.networks)
+        {
+            networks.push_back(net.exclude
+                                   ? Network::ExcludeRoute(net.address, static_cast<int>(net.prefix_size), net.metric, net.ipv6)
+                                   : Network::IncludeRoute(net.address, static_cast<int>(net.prefix_size), net.metric, net.ipv6));
+        }
+        AddNetworks(networks);
+    }
+    if (cfg.dnssec_mode)
+    {
+        GVariant *res = proxy->Call(prxtgt,
+                                    "SetDNSSEC",
+                                    glib2::Value::CreateTupleWrapped(*cfg.dnssec_mode));
+        if (res)
+        {
+            g_variant_unref(res);
+        }
+    }
+    if (cfg.dns_transport)
+    {
+        GVariant *res = proxy->Call(prxtgt,
+                                    "SetDNSTransport",
+                                    glib2::Value::CreateTupleWrapped(*cfg.dns_transport));
+        if (res)
+        {
+            g_variant_unref(res);
+        }
+    }
+    if (!cfg.dns_search_domains.empty())
+    {
+        AddDNSSearch(cfg.dns_search_domains);
+    }
+    if (!cfg.dns_servers.empty())
+    {
+        AddDNS(cfg.dns_servers);
+    }
+    if (cfg.dns_scope)
+    {
+        SetDNSscope(*cfg.dns_scope);
+    }
+}
+
+
 void Device::AddDNS(const std::vector<std::string> &server_list) const
 {
     GVariant *list = glib2::Value::CreateTupleWrapped<std::string>(server_list);
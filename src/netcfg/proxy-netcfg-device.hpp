@@ -28,6 +28,7 @@
 #include <openvpn/client/dns.hpp>
 
 #include "log/dbus-log.hpp"
+#include "netcfg-device-config.hpp"
 
 #ifdef ENABLE_OVPNDCO
 #include <sys/types.h>
@@ -230,6 +231,33 @@ class Device
      */
     bool AddDnsOptions(LogSender::Ptr log, const openvpn::DnsOptions &dns) const;
 
+    /**
+     *  Parses the --dns options in the configuration profile and adds
+     *  the resulting DNS resolver settings to a device configuration,
+     *  which is later sent via ApplyConfiguration()
+     *
+     * @param log    LogSender::Ptr where log events will be sent
+     * @param dns    openvpn::DnsOptions object with the DNS resolver setup
+     * @param cfg    NetCfgDeviceConfig to add the DNS settings to
+     *
+     * @return true on success, otherwise false
+     */
+    static bool PrepareDnsOptions(LogSender::Ptr log,
+                                  const openvpn::DnsOptions &dns,
+                                  NetCfgDeviceConfig &cfg);
+
+    /**
+     *  Sends all the collected device settings to the netcfg service
+     *  in a single call.  The service validates all the settings before
+     *  applying any of them.
+     *
+     *  If the netcfg service is too old to support this, the settings
+     *  are sent one by one via the individual methods instead.
+     *
+     * @param cfg   NetCfgDeviceConfig with the settings to apply
+     */
+    void ApplyConfiguration(const NetCfgDeviceConfig &cfg) const;
+
     /**
      *  Takes a list of DNS server IP addresses to enlist as
      *  DNS resolvers on the system
@@ -423,6 +451,8 @@ class Device
     DBus::Proxy::Client::Ptr proxy = nullptr;
     DBus::Proxy::TargetPreset::Ptr prxtgt = nullptr;
     unsigned int service_version;
+
+    void apply_configuration_compat(const NetCfgDeviceConfig &cfg) const;
 };
 
 } // namespace NetCfgProxy
@@ -61,6 +61,8 @@ Manager::Manager(DBus::Connection::Ptr dbuscon_)
         proxy_helper = DBus::Proxy::Utils::Query::Create(proxy);
         (void)proxy_helper->ServiceVersion(tgt_mgr->object_path,
                                            tgt_mgr->interface);
+        presence = GDBusPP::Proxy::Utils::ObjectPresence::Create(dbuscon,
+                                                                 Constants::GenServiceName("netcfg"));
     }
     catch (const DBus::Exception &)
     {
@@ -72,7 +74,7 @@ Manager::Manager(DBus::Connection::Ptr dbuscon_)
 
 std::string Manager::GetConfigFile()
 {
-    if (!GDBusPP::Proxy::Utils::LookupObject(proxy, tgt_mgr->object_path))
+    if (!presence->Exists(tgt_mgr->object_path))
     {
         throw NetCfgProxyException("GetConfigFile",
                                    "net.openvpn.v3.netcfg service unavailable");
@@ -104,7 +106,7 @@ DBus::Object::Path Manager::CreateVirtualInterface(const std::string &device_nam
 
 bool Manager::ProtectSocket(int socket, const std::string &remote, bool ipv6, const std::string &devpath)
 {
-    if (!GDBusPP::Proxy::Utils::LookupObject(proxy, tgt_mgr->object_path))
+    if (!presence->Exists(tgt_mgr->object_path))
     {
         throw NetCfgProxyException("ProtectSocket",
                                    "net.openvpn.v3.netcfg service unavailable");
@@ -156,7 +158,7 @@ bool Manager::DcoAvailable()
 
 void Manager::Cleanup()
 {
-    if (!GDBusPP::Proxy::Utils::LookupObject(proxy, tgt_mgr->object_path))
+    if (!presence->Exists(tgt_mgr->object_path))
     {
         throw NetCfgProxyException("Cleanup",
                                    "net.openvpn.v3.netcfg service unavailable");
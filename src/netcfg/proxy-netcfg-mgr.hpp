@@ -27,6 +27,7 @@
 #include <gdbuspp/proxy.hpp>
 #include <gdbuspp/proxy/utils.hpp>
 
+#include "dbus/support-functions.hpp"
 #include "netcfg-subscriptions.hpp"
 
 
@@ -72,6 +73,7 @@ class Manager
     DBus::Proxy::Client::Ptr proxy{nullptr};
     DBus::Proxy::Utils::Query::Ptr proxy_helper{nullptr};
     DBus::Proxy::TargetPreset::Ptr tgt_mgr{nullptr};
+    GDBusPP::Proxy::Utils::ObjectPresence::Ptr presence{nullptr};
 
     Manager(DBus::Connection::Ptr dbuscon);
 };
@@ -36,6 +36,9 @@ SingleCommand::Ptr prepare_command_config_acl();
 SingleCommand::Ptr prepare_command_config_dump();
 SingleCommand::Ptr prepare_command_config_remove();
 
+// Commands provided in config-snapshot.cpp
+SingleCommand::Ptr prepare_command_config_snapshot();
+
 // Commands provided in config/configs-list.cpp
 SingleCommand::Ptr prepare_command_configs_list();
 
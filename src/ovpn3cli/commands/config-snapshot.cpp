@@ -0,0 +1,237 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   config-snapshot.cpp
+ *
+ * @brief  Admin command to build, inspect and export the binary snapshot
+ *         of the persistent configuration profiles
+ */
+
+#include "build-config.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "common/cmdargparser.hpp"
+#include "configmgr/configmgr-exceptions.hpp"
+#include "configmgr/configmgr-persistence.hpp"
+#include "configmgr/configmgr-snapshot.hpp"
+
+namespace fs = std::filesystem;
+using namespace ConfigManager;
+
+
+/**
+ *  Retrieve all persistent configuration profile files in a directory.
+ *  This uses the same file name pattern as the configuration manager,
+ *  <uuid>.json.
+ *
+ * @param statedir  fs::path to the configuration state directory
+ * @return std::vector<std::string> of all profile files found
+ */
+static std::vector<std::string> get_profile_files(const fs::path &statedir)
+{
+    std::vector<std::string> files;
+    for (const auto &entry : fs::directory_iterator(statedir))
+    {
+        const std::string fname = entry.path().filename().string();
+        if (entry.is_regular_file()
+            && 41 == fname.size()
+            && ".json" == entry.path().extension())
+        {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+
+/**
+ *  Builds a new snapshot from the JSON profile files in the state
+ *  directory.  Records from an existing snapshot are reused for
+ *  profiles not changed since the snapshot was written.
+ */
+static int snapshot_build(const fs::path &statedir, const std::string &snapshot_file)
+{
+    ProfileSnapshot::Ptr current = nullptr;
+    try
+    {
+        current = ProfileSnapshot::Open(snapshot_file);
+    }
+    catch (const ConfigManager::Exception &excp)
+    {
+        std::cerr << "Ignoring existing snapshot: " << excp.what() << std::endl;
+    }
+
+    auto loaded = PersistentStorage::LoadProfiles(get_profile_files(statedir), 0, current);
+
+    std::vector<ProfileSnapshot::Entry> entries;
+    size_t reused = 0;
+    for (const auto &entry : loaded)
+    {
+        if (!entry.error.empty())
+        {
+            std::cerr << "Skipping " << entry.filename << ": " << entry.error << std::endl;
+            continue;
+        }
+        reused += (entry.from_snapshot ? 1 : 0);
+        entries.push_back({fs::path(entry.filename).filename().string(),
+                           entry.stamp,
+                           entry.profile});
+    }
+    current.reset();
+
+    ProfileSnapshot::Write(snapshot_file, entries);
+    std::cout << "Snapshot " << snapshot_file << " written with "
+              << entries.size() << " profiles ("
+              << reused << " reused, "
+              << (entries.size() - reused) << " parsed from JSON)" << std::endl;
+    return 0;
+}
+
+
+/**
+ *  Writes all the profiles in a snapshot as JSON profile files, in the
+ *  same format the configuration manager uses in the state directory.
+ */
+static int snapshot_export(const std::string &snapshot_file, const fs::path &destdir)
+{
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    if (!snapshot)
+    {
+        throw CommandException("config-snapshot", "Snapshot file not found");
+    }
+
+    fs::create_directories(destdir);
+    size_t exported = 0;
+    for (auto &entry : snapshot->GetAllEntries())
+    {
+        Json::Value content;
+        std::istringstream profile_text(entry.profile["profile"].asString());
+        profile_text >> content;
+        entry.profile["profile"] = content;
+
+        std::ostringstream data;
+        data << entry.profile;
+        PersistentStorage::WriteFileAtomic((destdir / entry.file_id).string(), data.str());
+        ++exported;
+    }
+
+    std::cout << "Exported " << exported << " of " << snapshot->GetEntryCount()
+              << " profiles to " << destdir.string() << std::endl;
+    return (exported == snapshot->GetEntryCount() ? 0 : 3);
+}
+
+
+/**
+ *  Lists all the profiles in a snapshot
+ */
+static int snapshot_list(const std::string &snapshot_file)
+{
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    if (!snapshot)
+    {
+        throw CommandException("config-snapshot", "Snapshot file not found");
+    }
+
+    auto entries = snapshot->GetAllEntries();
+    std::cout << std::left
+              << std::setw(42) << "File" << std::setw(8) << "Owner"
+              << "Name" << std::endl
+              << std::setw(78) << std::setfill('-') << "" << std::setfill(' ')
+              << std::endl;
+    for (const auto &entry : entries)
+    {
+        std::cout << std::setw(42) << entry.file_id
+                  << std::setw(8) << entry.profile["owner"].asUInt()
+                  << entry.profile["name"].asString() << std::endl;
+    }
+    std::cout << std::setw(78) << std::setfill('-') << "" << std::setfill(' ')
+              << std::endl
+              << entries.size() << " of " << snapshot->GetEntryCount()
+              << " profiles valid" << std::endl;
+    return (entries.size() == snapshot->GetEntryCount() ? 0 : 3);
+}
+
+
+int cmd_config_snapshot(ParsedArgs::Ptr args)
+{
+    args->CheckExclusiveOptions({{"build", "export", "list"}});
+
+    fs::path statedir = fs::path(OPENVPN3_STATEDIR) / "configs";
+    if (args->Present("state-dir"))
+    {
+        statedir = args->GetLastValue("state-dir");
+    }
+
+    std::string snapshot_file = (statedir / ProfileSnapshot::DEFAULT_FILENAME).string();
+    if (args->Present("snapshot"))
+    {
+        snapshot_file = args->GetLastValue("snapshot");
+    }
+
+    try
+    {
+        if (args->Present("build"))
+        {
+            return snapshot_build(statedir, snapshot_file);
+        }
+        else if (args->Present("export"))
+        {
+            return snapshot_export(snapshot_file, args->GetLastValue("export"));
+        }
+        else if (args->Present("list"))
+        {
+            return snapshot_list(snapshot_file);
+        }
+    }
+    catch (const ConfigManager::Exception &excp)
+    {
+        throw CommandException("config-snapshot", excp.what());
+    }
+    catch (const fs::filesystem_error &excp)
+    {
+        throw CommandException("config-snapshot", excp.what());
+    }
+
+    throw CommandException("config-snapshot",
+                           "One of --build, --export or --list is required");
+}
+
+
+SingleCommand::Ptr prepare_command_config_snapshot()
+{
+    SingleCommand::Ptr cmd;
+    cmd.reset(new SingleCommand("config-snapshot",
+                                "Manage the binary snapshot of persistent configuration profiles",
+                                cmd_config_snapshot));
+    cmd->AddOption("state-dir",
+                   "DIRECTORY",
+                   true,
+                   "Configuration manager state directory (Default: '" OPENVPN3_STATEDIR "/configs')");
+    cmd->AddOption("snapshot",
+                   "FILE",
+                   true,
+                   "Snapshot file to use (Default: profiles.snapshot in the state directory)");
+    cmd->AddOption("build",
+                   "Build or refresh the snapshot from the JSON profile files");
+    cmd->AddOption("export",
+                   "DIRECTORY",
+                   true,
+                   "Write all profiles in the snapshot as JSON files to DIRECTORY");
+    cmd->AddOption("list",
+                   "List all profiles in the snapshot");
+
+    return cmd;
+}
@@ -18,6 +18,8 @@
 
 #ifdef HAVE_SYSTEMD
 #include <iostream>
+#include <limits>
+#include <json/json.h>
 #include "common/cmdargparser.hpp"
 #include "log/journal-log-parse.hpp"
 
@@ -63,14 +65,78 @@ int cmd_journal(ParsedArgs::Ptr args)
         journal.AddFilter(Parse::FilterType::SENDER_PID, args->GetValue("pid", 0));
     }
 
-    LogEntries recs = journal.Retrieve();
+    Parse::StreamOptions opts;
+    if (args->Present("limit"))
+    {
+        opts.limit = parse_option_number("journal",
+                                         args,
+                                         "limit",
+                                         1,
+                                         std::numeric_limits<unsigned long>::max());
+    }
+    opts.reverse = args->Present("reverse");
+    opts.follow = args->Present("follow");
+    if (opts.reverse && opts.follow)
+    {
+        throw CommandException("journal",
+                               "--reverse and --follow cannot be combined");
+    }
+    if (args->Present("after-cursor"))
+    {
+        opts.after_cursor = args->GetLastValue("after-cursor");
+    }
+
+    // Log entries are printed as they are found in the journal,
+    // instead of collecting all of them first
+    size_t count = 0;
     if (args->Present("json"))
     {
-        std::cout << recs.GetJSON() << std::endl;
+        // When following the journal, each log entry is written as a
+        // separate JSON object per line, since the JSON array would
+        // never be completed
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        const bool follow = opts.follow;
+
+        count = journal.Stream(
+            [&count, &builder, follow](const LogEntry &entry)
+            {
+                if (follow)
+                {
+                    std::cout << Json::writeString(builder, entry.GetJSON())
+                              << std::endl;
+                }
+                else
+                {
+                    std::cout << (count++ > 0 ? ",\n" : "[\n") << entry.GetJSON();
+                }
+                return true;
+            },
+            opts);
+        if (!follow)
+        {
+            std::cout << (count > 0 ? "\n]" : "[]") << std::endl;
+        }
     }
     else
     {
-        std::cout << recs;
+        opts.detail = LogEntry::Detail::TEXT;
+        count = journal.Stream(
+            [follow = opts.follow](const LogEntry &entry)
+            {
+                std::cout << entry << "\n";
+                if (follow)
+                {
+                    std::cout.flush();
+                }
+                return true;
+            },
+            opts);
+    }
+
+    if (args->Present("show-cursor") && count > 0)
+    {
+        std::cout << "-- cursor: " << journal.GetCursor() << std::endl;
     }
     return 0;
 }
@@ -95,6 +161,11 @@ SingleCommand::Ptr prepare_command_journal()
     jrnlcmd->AddOption("interface", "DBUS_INTERFACE", true, "Filter on D-Bus object interface name");
     jrnlcmd->AddOption("logtag", "LOGTAG", true, "Filter on the LogTag value of the service");
     jrnlcmd->AddOption("session-token", "TOKEN", true, "Filter on the VPN client process session token value");
+    jrnlcmd->AddOption("limit", 'n', "NUM", true, "Only show the NUM most recent log entries");
+    jrnlcmd->AddOption("reverse", 'r', "Show the newest log entries first");
+    jrnlcmd->AddOption("follow", 'f', "Keep showing new log entries as they are added to the journal");
+    jrnlcmd->AddOption("after-cursor", "CURSOR", true, "Only show log entries after the journal CURSOR");
+    jrnlcmd->AddOption("show-cursor", "Show the journal cursor of the last log entry shown");
 
     return jrnlcmd;
 }
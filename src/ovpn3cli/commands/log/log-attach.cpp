@@ -74,7 +74,7 @@ void LogAttach::AttachByPath(const DBus::Object::Path &path)
 void LogAttach::AttachByConfig(const std::string &config)
 {
     config_name = config;
-    lookup_config_name(config_name, 1);
+    lookup_config_name(config_name);
     setup_session_logger(session_path);
 }
 
@@ -105,13 +105,13 @@ void LogAttach::sessionmgr_event(const SessionManager::Event &event)
             // ignore new sessions
             return;
         }
-        if (!config_name.empty())
-        {
-            lookup_config_name(config_name);
-        }
-        else if (!tun_interf.empty())
+        if (!config_name.empty() || !tun_interf.empty())
         {
-            lookup_interface(tun_interf);
+            if (!session_matches(event.path))
+            {
+                return;
+            }
+            session_path = event.path;
         }
 
         setup_session_logger(session_path);
@@ -135,41 +135,28 @@ void LogAttach::sessionmgr_event(const SessionManager::Event &event)
 }
 
 
-void LogAttach::lookup_config_name(const std::string &cfgname,
-                                   const uint16_t check_count)
+void LogAttach::lookup_config_name(const std::string &cfgname)
 {
-    // We need to try a few times, as the SESS_CREATED event comes
-    // quite early and the session object itself might not be registered
-    // quite yet.  This needs to be a tight loop to catch the earliest
-    // log messages, as certificate only based authentication may do
-    // the full connection establishing in a little bit less than 200ms.
-    for (unsigned int i = check_count; i > 0; i--)
+    DBus::Object::Path::List paths = manager->LookupConfigName(cfgname);
+    if (1 < paths.size())
     {
-        DBus::Object::Path::List paths = manager->LookupConfigName(cfgname);
-        if (1 < paths.size())
-        {
-            throw CommandException("log",
-                                   "More than one session with the given "
-                                   "configuration profile name was found.");
-        }
-        else if (1 == paths.size())
-        {
-            // If only a single path is found, that's the one we're
-            // looking for.
-            session_path = paths.at(0);
-            return;
-        }
-        else
-        {
-            // If no paths has been found, we wait until next call
-            if (!wait_notification)
-            {
-                std::cout << "Waiting for session to start ..."
-                          << std::flush;
-                wait_notification = true;
-            }
-        }
-        usleep(50000); // 50ms
+        throw CommandException("log",
+                               "More than one session with the given "
+                               "configuration profile name was found.");
+    }
+    else if (1 == paths.size())
+    {
+        // If only a single path is found, that's the one we're
+        // looking for.
+        session_path = paths.at(0);
+    }
+    else if (!wait_notification)
+    {
+        // If no paths has been found, sessionmgr_event() will check
+        // each new session as it is created
+        std::cout << "Waiting for session to start ..."
+                  << std::flush;
+        wait_notification = true;
     }
 }
 
@@ -199,6 +186,28 @@ void LogAttach::lookup_interface(const std::string &interf)
 }
 
 
+bool LogAttach::session_matches(const DBus::Object::Path &path) const
+{
+    // The SESS_CREATED event is sent when the VPN client process has
+    // registered with the session manager, at this point the session
+    // object has its configuration profile name set.
+    try
+    {
+        auto session = manager->Retrieve(path);
+        if (!config_name.empty())
+        {
+            return session->GetConfigName() == config_name;
+        }
+        return session->GetDeviceName() == tun_interf;
+    }
+    catch (const DBus::Exception &)
+    {
+        // This can be a session this user does not have access to
+        return false;
+    }
+}
+
+
 /**
  *  Create a new SessionLogger object for processing log and status event
  *  changes for a running session.
@@ -72,11 +72,19 @@ class LogAttach
 
     void sessionmgr_event(const SessionManager::Event &event);
 
-    void lookup_config_name(const std::string &cfgname,
-                            const uint16_t check_count = 250);
+    void lookup_config_name(const std::string &cfgname);
 
     void lookup_interface(const std::string &interf);
 
+    /**
+     *  Checks if a newly created session matches the configuration
+     *  profile name or tun interface name this object waits for.
+     *
+     * @param path  DBus::Object::Path to the new VPN session
+     * @return bool, true if this is the session to attach to
+     */
+    bool session_matches(const DBus::Object::Path &path) const;
+
 
     /**
      *  Create a new EventLogger object for processing log and status event
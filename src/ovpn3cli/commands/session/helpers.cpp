@@ -13,9 +13,18 @@
  *         the openvpn3 session commands
  */
 
+#include <chrono>
+#include <condition_variable>
 #include <csignal>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <gdbuspp/proxy/utils.hpp>
+#include <gdbuspp/signals/subscriptionmgr.hpp>
 
 #include "common/open-uri.hpp"
+#include "dbus/constants.hpp"
+#include "dbus/signals/statuschange.hpp"
 #include "helpers.hpp"
 
 
@@ -197,7 +206,155 @@ bool query_user_input(SessionManager::Proxy::Session::Ptr session,
 }
 
 
-void start_session(SessionManager::Proxy::Session::Ptr session,
+/**
+ *  Collects the StatusChange events of a session while it is being
+ *  started, so the start_session() loop can react on them as soon as
+ *  they arrive instead of regularly polling the session status.
+ *
+ *  The StatusChange signals are retrieved via the log forwarding in
+ *  the net.openvpn.v3.log service, which is enabled for the lifetime of
+ *  this object.  The AttentionRequired signals are broadcast by the
+ *  session manager; these are only used to wake up the waiting loop
+ *  to check the session status.
+ *
+ *  If the signals cannot be set up or are not received, the caller
+ *  falls back to polling the session status.
+ */
+class StatusWatcher
+{
+  public:
+    StatusWatcher(DBus::Connection::Ptr dbuscon,
+                  SessionManager::Proxy::Session::Ptr session_)
+        : session(session_)
+    {
+        try
+        {
+            submgr = DBus::Signals::SubscriptionManager::Create(dbuscon);
+
+            auto prxqry = DBus::Proxy::Utils::DBusServiceQuery::Create(dbuscon);
+            auto log_tgt = DBus::Signals::Target::Create(
+                prxqry->GetNameOwner(Constants::GenServiceName("log")),
+                session->GetPath(),
+                "");
+            statuschg = ::Signals::ReceiveStatusChange::Create(
+                submgr,
+                log_tgt,
+                [this](const std::string &sender,
+                       const DBus::Object::Path &path,
+                       const std::string &interface,
+                       Events::Status stchgev)
+                {
+                    std::lock_guard<std::mutex> lg(mtx);
+                    events.push_back(std::move(stchgev));
+                    cv.notify_all();
+                });
+
+            attreq_tgt = DBus::Signals::Target::Create(
+                prxqry->GetNameOwner(Constants::GenServiceName("sessions")),
+                session->GetPath(),
+                Constants::GenInterface("sessions"));
+            submgr->Subscribe(attreq_tgt,
+                              "AttentionRequired",
+                              [this](DBus::Signals::Event::Ptr event)
+                              {
+                                  std::lock_guard<std::mutex> lg(mtx);
+                                  attention = true;
+                                  cv.notify_all();
+                              });
+
+            session->LogForward(true);
+            forwarding = true;
+        }
+        catch (const DBus::Exception &)
+        {
+            // Without access to the log forwarding, such as when the
+            // session restricts log access to the owner, only the
+            // status polling is used
+        }
+    }
+
+    ~StatusWatcher() noexcept
+    {
+        // Stop the signal callbacks before anything else is torn down
+        statuschg.reset();
+        try
+        {
+            if (submgr && attreq_tgt)
+            {
+                submgr->Unsubscribe(attreq_tgt, "AttentionRequired");
+            }
+            if (forwarding)
+            {
+                session->LogForward(false);
+            }
+        }
+        catch (...)
+        {
+            // The session may already be gone
+        }
+    }
+
+    /**
+     *  Waits for the next status change of the session
+     *
+     * @param status     Events::Status to store the status change in
+     * @param max_wait   Maximum time to wait for a StatusChange signal
+     *
+     * @return true if a StatusChange signal was received.  If false, the
+     *         caller must retrieve the current status of the session
+     *         itself.
+     */
+    bool WaitForStatus(Events::Status &status,
+                       const std::chrono::milliseconds max_wait)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock,
+                    max_wait,
+                    [this]()
+                    {
+                        return !events.empty() || attention;
+                    });
+        attention = false;
+        if (events.empty())
+        {
+            return false;
+        }
+        status = std::move(events.front());
+        events.pop_front();
+        return true;
+    }
+
+    /**
+     *  Discards all status changes received so far.  Used before
+     *  (re)starting the connection, to not react on status changes
+     *  from an earlier connection attempt.
+     */
+    void Discard()
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        events.clear();
+        attention = false;
+    }
+
+  private:
+    // Used by the signal callbacks, so these must be destroyed after
+    // the signal subscriptions below
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Events::Status> events;
+    bool attention = false;
+
+    SessionManager::Proxy::Session::Ptr session = nullptr;
+    DBus::Signals::SubscriptionManager::Ptr submgr = nullptr;
+    DBus::Signals::Target::Ptr attreq_tgt = nullptr;
+    ::Signals::ReceiveStatusChange::Ptr statuschg = nullptr;
+    bool forwarding = false;
+};
+
+
+
+void start_session(DBus::Connection::Ptr dbuscon,
+                   SessionManager::Proxy::Session::Ptr session,
                    SessionStartMode initial_mode,
                    int timeout,
                    bool background)
@@ -209,6 +366,10 @@ void start_session(SessionManager::Proxy::Session::Ptr session,
     sigemptyset(&sact.sa_mask);
     sigaction(SIGINT, &sact, NULL);
 
+    // Start listening for status changes before the session is started,
+    // to not miss any of them
+    auto watcher = std::make_unique<StatusWatcher>(dbuscon, session);
+
     // Start or restart the session
     SessionStartMode mode = initial_mode;
     unsigned int loops = 10;
@@ -218,6 +379,7 @@ void start_session(SessionManager::Proxy::Session::Ptr session,
         try
         {
             session->Ready(); // If not, an exception will be thrown
+            watcher->Discard();
             switch (mode)
             {
             case SessionStartMode::START:
@@ -247,23 +409,29 @@ void start_session(SessionManager::Proxy::Session::Ptr session,
 
             // Attempt to connect until the given timeout has been reached.
             // If timeout has been disabled (-1), loop forever.
+            //
+            // Each StatusChange signal is processed as soon as it arrives.
+            // The session status is only retrieved directly if no signal
+            // has arrived within the polling interval.
             time_t op_start = time(0);
             Events::Status s;
             while ((-1 == timeout) || ((op_start + timeout) >= time(0)))
             {
-                usleep(300000); // sleep 0.3 seconds - avg setup time
-                try
-                {
-                    s = session->GetLastStatus();
-                }
-                catch (const DBus::Exception &excp)
+                if (!watcher->WaitForStatus(s, std::chrono::seconds(1)))
                 {
-                    std::string err(excp.what());
-                    if (err.find("Failed retrieving property value for 'status'") != std::string::npos)
+                    try
+                    {
+                        s = session->GetLastStatus();
+                    }
+                    catch (const DBus::Exception &excp)
                     {
-                        throw SessionException("Failed to start session");
+                        std::string err(excp.what());
+                        if (err.find("Failed retrieving property value for 'status'") != std::string::npos)
+                        {
+                            throw SessionException("Failed to start session");
+                        }
+                        throw;
                     }
-                    throw;
                 }
                 if (s.Check(StatusMajor::SESSION, StatusMinor::SESS_AUTH_URL))
                 {
@@ -339,8 +507,6 @@ void start_session(SessionManager::Proxy::Session::Ptr session,
                     std::cout << std::endl;
                     throw SessionException("Session stopped");
                 }
-
-                sleep(1); // If not yet connected, wait for 1 second
             }
             time_t now = time(0);
             if ((op_start + timeout) <= now)
@@ -55,6 +55,8 @@ enum class SessionStartMode : std::uint8_t
  *  user gets a chance to provide user input if the remote server
  *  wants that for re-authentication.
  *
+ * @param dbuscon       DBus::Connection used to subscribe to the status
+ *                      change signals of the session
  * @param session       OpenVPN3SessionProxy to the session object to
  *                      operate on
  * @param initial_mode  SessionStartMode defining how this tunnel is
@@ -67,7 +69,8 @@ enum class SessionStartMode : std::uint8_t
  *
  * @throws SessionException if any issues related to the session itself.
  */
-void start_session(SessionManager::Proxy::Session::Ptr session,
+void start_session(DBus::Connection::Ptr dbuscon,
+                   SessionManager::Proxy::Session::Ptr session,
                    SessionStartMode initial_mode,
                    int timeout,
                    bool background = false);
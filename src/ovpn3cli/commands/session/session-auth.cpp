@@ -100,7 +100,7 @@ static int cmd_session_auth_complete(const pid_t authid)
         else if (StatusMajor::CONNECTION == status.major
                  && StatusMinor::CFG_REQUIRE_USER == status.minor)
         {
-            start_session(session, SessionStartMode::START, -1, false);
+            start_session(dbuscon, session, SessionStartMode::START, -1, false);
         }
         return 0;
     }
@@ -226,13 +226,13 @@ static int cmd_session_manage(ParsedArgs::Ptr args)
         case mode_resume:
             std::cout << "Resuming session: " << sesspath
                       << std::endl;
-            start_session(session, SessionStartMode::RESUME, timeout, timeout < 0);
+            start_session(dbuscon, session, SessionStartMode::RESUME, timeout, timeout < 0);
             return 0;
 
         case mode_restart:
             std::cout << "Restarting session: " << sesspath
                       << std::endl;
-            start_session(session, SessionStartMode::RESTART, timeout, timeout < 0);
+            start_session(dbuscon, session, SessionStartMode::RESTART, timeout, timeout < 0);
             return 0;
 
         case mode_disconnect:
@@ -123,7 +123,8 @@ static int cmd_session_start(ParsedArgs::Ptr args)
         }
 #endif
 
-        start_session(session,
+        start_session(dbuscon,
+                      session,
                       SessionStartMode::START,
                       timeout,
                       args->Present("background"));
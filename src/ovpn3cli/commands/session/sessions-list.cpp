@@ -12,11 +12,13 @@
  * @brief  Lists all started and running VPN sessions for the current user
  */
 
+#include <map>
 #include <string>
 #include <gdbuspp/connection.hpp>
 
 #include "common/cmdargparser.hpp"
 #include "common/lookup.hpp"
+#include "common/utils.hpp"
 #include "events/status.hpp"
 #include "configmgr/proxy-configmgr.hpp"
 #include "sessionmgr/proxy-sessionmgr.hpp"
@@ -38,149 +40,88 @@ static int cmd_sessions_list(ParsedArgs::Ptr args)
     auto dbuscon = DBus::Connection::Create(DBus::BusType::SYSTEM);
     auto sessmgr = SessionManager::Proxy::Manager::Create(dbuscon);
 
-    bool first = true;
-    for (auto &sprx : sessmgr->FetchAvailableSessions())
+    // The current configuration profile names are looked up in the
+    // configuration manager, once per profile.  An empty name indicates
+    // the profile is no longer available.
+    std::map<std::string, std::string> cfgnames_current{};
+    auto lookup_current_cfgname = [&](const std::string &config_path)
     {
-        // Retrieve the name of the configuration profile used
-        std::stringstream config_line;
-        bool config_deleted = false;
-        try
-        {
-            // Retrieve the current configuration profile name from the
-            // configuration manager
-            std::string cfgname_current = "";
-            std::string config_path = sprx->GetConfigPath();
-            try
-            {
-                auto cprx = OpenVPN3ConfigurationProxy::Create(dbuscon, config_path);
-                if (cprx->CheckObjectExists())
-                {
-                    cfgname_current = cprx->GetName();
-                }
-                else
-                {
-                    config_deleted = true;
-                }
-            }
-            catch (...)
-            {
-                // Failure is okay here, the profile may be deleted.
-                config_deleted = true;
-            }
-
-            // Retrieve the configuration profile name used when starting
-            // the VPN sessions
-            std::string cfgname = sprx->GetConfigName();
-            if (!cfgname.empty())
-            {
-                config_line << " Config name: " << cfgname;
-                if (config_deleted)
-                {
-                    config_line << "  (Config not available)";
-                }
-                else if (cfgname_current != cfgname)
-                {
-                    config_line << "  (Current name: "
-                                << cfgname_current << ")";
-                }
-                config_line << std::endl;
-            }
-        }
-        catch (const DBus::Exception &excp)
+        auto cached = cfgnames_current.find(config_path);
+        if (cfgnames_current.end() != cached)
         {
-            // The session has not been initialised properly yet, so
-            // configuration name is not available
-            config_line << "";
+            return cached->second;
         }
 
-
-        // Retrieve the session start timestamp
-        std::string created{};
+        std::string cfgname{};
         try
         {
-            created = sprx->GetSessionCreated();
+            auto cprx = OpenVPN3ConfigurationProxy::Create(dbuscon, config_path);
+            cfgname = cprx->GetName();
         }
-        catch (const DBus::Exception &)
+        catch (...)
         {
-            created = "(Not available)";
+            // Failure is okay here, the profile may be deleted.
         }
+        cfgnames_current[config_path] = cfgname;
+        return cfgname;
+    };
 
-        // Retrieve session owner information and VPN backend process PID
-        std::string owner{};
-        pid_t be_pid = -1;
-        try
-        {
-            owner = lookup_username(sprx->GetOwner());
-            be_pid = sprx->GetBackendPid();
-        }
-        catch (const DBus::Exception &)
+    bool first = true;
+    for (const auto &sess : sessmgr->FetchSessionsSummary())
+    {
+        // Configuration profile name used when starting the VPN session,
+        // and the current name of the configuration profile
+        std::stringstream config_line;
+        if (!sess.config_name.empty())
         {
-            owner = "(not available)";
-            be_pid = -1;
+            std::string cfgname_current = lookup_current_cfgname(sess.config_path);
+            config_line << " Config name: " << sess.config_name;
+            if (cfgname_current.empty())
+            {
+                config_line << "  (Config not available)";
+            }
+            else if (cfgname_current != sess.config_name)
+            {
+                config_line << "  (Current name: "
+                            << cfgname_current << ")";
+            }
+            config_line << std::endl;
         }
 
-        // Retrieve the tun interface name for this session
-        std::string devname{};
-        try
-        {
-            devname = sprx->GetDeviceName();
-        }
-        catch (const DBus::Exception &)
-        {
-            // The session may not have been started yet; the error
-            // in this case isn't that valuable so we just consider
-            // the device name not set.
-            devname = "(None)";
-        }
+        std::string created = get_local_tstamp(sess.session_created);
+        std::string owner = lookup_username(sess.owner);
+        pid_t be_pid = sess.backend_pid;
 
-        // Retrieve connection details about the session
+        // The session may not have been started yet; the device name
+        // is in this case just considered not set.
+        std::string devname = (!sess.device_name.empty()
+                                   ? sess.device_name
+                                   : "(None)");
+
+        // Connection details about the session
         std::ostringstream session_details;
-        try
-        {
-            auto cti = sprx->GetConnectedToInfo();
-            bool ipv6_addr = cti.server_ip.find(":") != std::string::npos;
-            if (!cti.protocol.empty())
+        if (!sess.protocol.empty())
+        {
+            bool ipv6_addr = sess.server_ip.find(":") != std::string::npos;
+            session_details << "Connected to: "
+                            << sess.protocol << ":"
+                            << (ipv6_addr ? "[" : "")
+                            << sess.server_ip
+                            << (ipv6_addr ? "]" : "");
+            if (sess.server_port > 0)
             {
-                session_details << "Connected to: "
-                                << cti.protocol << ":"
-                                << (ipv6_addr ? "[" : "")
-                                << cti.server_ip
-                                << (ipv6_addr ? "]" : "");
-                if (cti.server_port > 0)
-                {
-                    // DCO connections currently does not expose the port number
-                    session_details << ":"
-                                    << std::to_string(cti.server_port);
-                }
-                session_details << std::endl;
+                // DCO connections currently does not expose the port number
+                session_details << ":"
+                                << std::to_string(sess.server_port);
             }
+            session_details << std::endl;
         }
-        catch (const SessionManager::Proxy::Exception &)
+        else if (!sess.session_name.empty())
         {
-            // If connection details are unavailable, try extracting
-            // session name instead - as used in v23 and older releases
-            try
-            {
-                std::string sessname = sprx->GetSessionName();
-                if (!sessname.empty())
-                {
-                    session_details << "Session name: " << sessname << std::endl;
-                }
-            }
-            catch (const DBus::Exception &)
-            {
-                // Ignore any errors if this property is unavailable
-            }
+            session_details << "Session name: " << sess.session_name << std::endl;
         }
 
-        Events::Status status{};
-        try
-        {
-            status = sprx->GetLastStatus();
-        }
-        catch (const DBus::Exception &)
-        {
-        }
+        Events::Status status = sess.status;
 
         // Output separator lines
         if (first)
@@ -194,7 +135,7 @@ static int cmd_sessions_list(ParsedArgs::Ptr args)
         first = false;
 
         // Output session information
-        std::cout << "        Path: " << sprx->GetPath() << std::endl;
+        std::cout << "        Path: " << sess.path << std::endl;
         std::cout << "     Created: " << created
                   << std::setw(47 - created.size()) << std::setfill(' ')
                   << " PID: "
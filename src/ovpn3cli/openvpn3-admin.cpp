@@ -36,6 +36,7 @@ inline std::vector<PrepareCommand> registered_commands = {
     prepare_command_netcfg_service,
     prepare_command_sessionmgr_service,
     prepare_command_initcfg,
+    prepare_command_config_snapshot,
 };
 
 #include "ovpn3cli.hpp" // main() is implemented here
@@ -589,6 +589,33 @@ class SessionManager(object):
         return ret
 
 
+    ##
+    #  Retrieve the most commonly used properties of all available VPN
+    #  sessions in the session manager, using a single D-Bus call
+    #
+    #  @return Returns a list of dictionaries, one for each session
+    #
+    def FetchSessionsSummary(self):
+        ret = []
+        self.__ping()
+        for s in self.__manager_intf.FetchSessionsSummary():
+            ret.append({"path": s[0],
+                        "config_path": s[1],
+                        "config_name": str(s[2]),
+                        "session_created": int(s[3]),
+                        "owner": int(s[4]),
+                        "backend_pid": int(s[5]),
+                        "status": {"major": StatusMajor(s[6][0]),
+                                   "minor": StatusMinor(s[6][1]),
+                                   "message": str(s[6][2])},
+                        "device_name": str(s[7]),
+                        "session_name": str(s[8]),
+                        "connected_to": {"protocol": str(s[9]),
+                                         "server_ip": str(s[10]),
+                                         "server_port": int(s[11])}})
+        return ret
+
+
     ##
     #  Looks up a configuration name to find available session objects
     #  started with the given configuration name
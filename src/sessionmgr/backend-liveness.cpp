@@ -0,0 +1,37 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   backend-liveness.cpp
+ *
+ * @brief  Implementation of SessionManager::CheckBackendLiveness()
+ */
+
+#include "backend-liveness.hpp"
+
+
+namespace SessionManager {
+
+BackendLiveness CheckBackendLiveness(ObjectDispatcher &dispatcher,
+                                     const std::string &key,
+                                     const std::chrono::milliseconds timeout,
+                                     std::function<bool()> ping)
+{
+    try
+    {
+        return (dispatcher.Run(key, timeout, ping)
+                    ? BackendLiveness::ALIVE
+                    : BackendLiveness::BAD_RESPONSE);
+    }
+    catch (const DispatchTimeout &)
+    {
+        return BackendLiveness::NO_RESPONSE;
+    }
+}
+
+} // namespace SessionManager
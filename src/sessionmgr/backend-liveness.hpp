@@ -0,0 +1,59 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   backend-liveness.hpp
+ *
+ * @brief  Checks if a VPN client backend process still responds
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include "object-dispatcher.hpp"
+
+
+namespace SessionManager {
+
+/**
+ *  Result of CheckBackendLiveness()
+ */
+enum class BackendLiveness
+{
+    ALIVE,        ///< The backend responded as expected
+    BAD_RESPONSE, ///< The backend responded, but not with a positive reply
+    NO_RESPONSE   ///< The backend did not respond in time
+};
+
+
+/**
+ *  Runs a ping call to a backend process via the ObjectDispatcher.
+ *
+ *  A ping which times out, or which is refused because an earlier call
+ *  to the same backend has timed out and not yet completed, is reported
+ *  as NO_RESPONSE.  The caller is expected to tear down the session in
+ *  that case; a hung backend would otherwise keep failing every call.
+ *
+ * @param dispatcher  ObjectDispatcher running the backend calls
+ * @param key         std::string with the dispatcher key of the backend
+ * @param timeout     std::chrono::milliseconds to wait for the response
+ * @param ping        Function doing the ping call, returning the reply
+ *
+ * @return BackendLiveness
+ *
+ * @throws Any exception thrown by ping, except a timeout
+ */
+BackendLiveness CheckBackendLiveness(ObjectDispatcher &dispatcher,
+                                     const std::string &key,
+                                     const std::chrono::milliseconds timeout,
+                                     std::function<bool()> ping);
+
+} // namespace SessionManager
@@ -0,0 +1,147 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   backend-property-cache.cpp
+ *
+ * @brief  Implementation of SessionManager::BackendPropertyCache
+ */
+
+#include "backend-property-cache.hpp"
+
+
+namespace SessionManager {
+
+BackendPropertyCache::~BackendPropertyCache() noexcept
+{
+    for (auto &[name, entry] : entries)
+    {
+        if (entry.value)
+        {
+            g_variant_unref(entry.value);
+        }
+    }
+}
+
+
+GVariant *BackendPropertyCache::Get(const std::string &name,
+                                    const std::chrono::milliseconds max_age,
+                                    Fetcher fetch)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true)
+    {
+        Entry &entry = entries[name];
+        if (entry.value && entry.valid
+            && (Clock::now() - entry.updated) <= max_age)
+        {
+            return g_variant_ref(entry.value);
+        }
+        if (!entry.fetching)
+        {
+            break;
+        }
+        if (entry.value)
+        {
+            // Another thread is already retrieving a new value;
+            // use the previous one instead of waiting
+            return g_variant_ref(entry.value);
+        }
+        fetch_done.wait(lock);
+    }
+
+    entries[name].fetching = true;
+    const uint64_t fetch_generation = generation;
+    lock.unlock();
+
+    GVariant *value = nullptr;
+    try
+    {
+        value = fetch();
+    }
+    catch (...)
+    {
+        lock.lock();
+        Entry &entry = entries[name];
+        entry.fetching = false;
+        fetch_done.notify_all();
+        if (entry.value && entry.valid
+            && (Clock::now() - entry.updated) <= max_age)
+        {
+            // A cached value is only used instead of the error if it
+            // is still good enough for this caller; a stale value
+            // would hide a hung or dead backend
+            return g_variant_ref(entry.value);
+        }
+        throw;
+    }
+
+    lock.lock();
+    Entry &entry = entries[name];
+    entry.fetching = false;
+    if (!value)
+    {
+        fetch_done.notify_all();
+        return nullptr;
+    }
+    g_variant_take_ref(value);
+    if (fetch_generation == generation)
+    {
+        if (entry.value)
+        {
+            g_variant_unref(entry.value);
+        }
+        entry.value = g_variant_ref(value);
+        entry.updated = Clock::now();
+        entry.valid = true;
+    }
+    fetch_done.notify_all();
+    return value;
+}
+
+
+void BackendPropertyCache::Invalidate(const std::string &name)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = entries.find(name);
+    if (entries.end() != it)
+    {
+        it->second.valid = false;
+    }
+    // A value being retrieved now might be outdated as well
+    ++generation;
+}
+
+
+void BackendPropertyCache::InvalidateAll()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    for (auto &[name, entry] : entries)
+    {
+        entry.valid = false;
+    }
+    ++generation;
+}
+
+
+void BackendPropertyCache::Clear()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    for (auto &[name, entry] : entries)
+    {
+        if (entry.value)
+        {
+            g_variant_unref(entry.value);
+            entry.value = nullptr;
+        }
+        entry.valid = false;
+    }
+    ++generation;
+}
+
+} // namespace SessionManager
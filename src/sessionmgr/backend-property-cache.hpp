@@ -0,0 +1,118 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   backend-property-cache.hpp
+ *
+ * @brief  Cache of the property values the session manager retrieves
+ *         from the VPN client backend process
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <glib.h>
+
+
+namespace SessionManager {
+
+/**
+ *  Keeps the last retrieved values of properties provided by the VPN
+ *  client backend process.  Values older than the maximum age given
+ *  by the caller are retrieved again.
+ *
+ *  Only one thread retrieves a specific property at a time.  While a
+ *  value is being retrieved, other callers get the previous value if
+ *  one is available; otherwise they wait for the retrieval to complete.
+ *  This avoids all readers being blocked by a slow backend process.
+ */
+class BackendPropertyCache
+{
+  public:
+    using Ptr = std::shared_ptr<BackendPropertyCache>;
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     *  Callback function retrieving the value from the backend process.
+     *  It must return a new GVariant reference or throw an exception.
+     */
+    using Fetcher = std::function<GVariant *()>;
+
+    [[nodiscard]] static Ptr Create()
+    {
+        return Ptr(new BackendPropertyCache());
+    }
+
+    ~BackendPropertyCache() noexcept;
+
+    /**
+     *  Retrieve a property value, from the cache if it is fresh enough
+     *
+     * @param name     std::string with the property name
+     * @param max_age  std::chrono::milliseconds of the maximum age of
+     *                 a cached value
+     * @param fetch    Fetcher retrieving the value from the backend
+     *
+     * @return GVariant pointer with a new reference to the value,
+     *         which the caller must release.  If the Fetcher fails,
+     *         a cached value is only returned if it is still valid
+     *         and within max_age.
+     *
+     * @throws Any exception thrown by the Fetcher, if no valid cached
+     *         value within max_age is available
+     */
+    GVariant *Get(const std::string &name,
+                  const std::chrono::milliseconds max_age,
+                  Fetcher fetch);
+
+    /**
+     *  Marks a cached value as outdated.  The next Get() call will
+     *  retrieve the value again.  Values being retrieved while this is
+     *  called will not be stored.
+     *
+     * @param name  std::string with the property name
+     */
+    void Invalidate(const std::string &name);
+
+    /**
+     *  Marks all cached values as outdated
+     */
+    void InvalidateAll();
+
+    /**
+     *  Removes all cached values.  Values being retrieved while this
+     *  is called will not be stored.  Used when the backend process
+     *  changes or goes away.
+     */
+    void Clear();
+
+  private:
+    struct Entry
+    {
+        GVariant *value = nullptr;
+        Clock::time_point updated = {};
+        bool valid = false;
+        bool fetching = false;
+    };
+
+    std::mutex mtx;
+    std::condition_variable fetch_done;
+    std::map<std::string, Entry> entries;
+    uint64_t generation = 0;
+
+    BackendPropertyCache() = default;
+};
+
+} // namespace SessionManager
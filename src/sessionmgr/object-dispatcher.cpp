@@ -0,0 +1,217 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   object-dispatcher.cpp
+ *
+ * @brief  Implementation of SessionManager::ObjectDispatcher
+ */
+
+#include <algorithm>
+
+#include "object-dispatcher.hpp"
+
+
+namespace SessionManager {
+
+ObjectDispatcher::ObjectDispatcher(const unsigned int threads,
+                                   const unsigned int max_threads,
+                                   ErrorLog errlog_)
+    : min_workers(threads > 0 ? threads : 1),
+      max_workers(std::max(min_workers, max_threads)),
+      errlog(std::move(errlog_))
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    for (unsigned int i = 0; i < min_workers; ++i)
+    {
+        start_worker();
+    }
+}
+
+
+ObjectDispatcher::~ObjectDispatcher() noexcept
+{
+    std::map<std::thread::id, std::thread> running_workers;
+    std::vector<std::thread> stopped;
+    {
+        std::lock_guard<std::mutex> guard(mtx);
+        running = false;
+        running_workers.swap(workers);
+        stopped.swap(stopped_workers);
+    }
+    task_added.notify_all();
+    for (auto &[id, w] : running_workers)
+    {
+        w.join();
+    }
+    for (auto &w : stopped)
+    {
+        w.join();
+    }
+}
+
+
+size_t ObjectDispatcher::GetWorkerCount()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return workers.size();
+}
+
+
+void ObjectDispatcher::Post(const std::string &key, Task task)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = queues.find(key);
+    if (queues.end() != it)
+    {
+        // The object already has tasks queued or running; this
+        // task will be run after those
+        it->second.push_back(std::move(task));
+        return;
+    }
+    queues[key].push_back(std::move(task));
+    make_ready(key);
+}
+
+
+void ObjectDispatcher::make_ready(const std::string &key)
+{
+    ready.push_back(key);
+    if (ready.size() > idle_workers && workers.size() < max_workers)
+    {
+        // All worker threads are busy, most likely waiting for
+        // slow backend processes
+        start_worker();
+    }
+    else
+    {
+        task_added.notify_one();
+    }
+}
+
+
+void ObjectDispatcher::start_worker()
+{
+    // Additional worker threads which have stopped have already
+    // released the lock and are about to return
+    for (auto &w : stopped_workers)
+    {
+        w.join();
+    }
+    stopped_workers.clear();
+
+    std::thread w([this]()
+                  {
+                      worker();
+                  });
+    const auto id = w.get_id();
+    workers.emplace(id, std::move(w));
+}
+
+
+void ObjectDispatcher::unstall(const std::string &key)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = stalled.find(key);
+    if (stalled.end() != it && 0 == --it->second)
+    {
+        stalled.erase(it);
+    }
+}
+
+
+void ObjectDispatcher::log_error(const std::string &key,
+                                 const std::string &msg) noexcept
+{
+    if (!errlog)
+    {
+        return;
+    }
+    try
+    {
+        errlog("Unhandled exception on " + key + ": " + msg);
+    }
+    catch (...)
+    {
+        // A failing logger must not take down the worker thread
+    }
+}
+
+
+void ObjectDispatcher::worker()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true)
+    {
+        ++idle_workers;
+        const bool woken = task_added.wait_for(lock,
+                                               WORKER_IDLE_TIME,
+                                               [this]()
+                                               {
+                                                   return !running || !ready.empty();
+                                               });
+        --idle_workers;
+        if (!running)
+        {
+            return;
+        }
+        if (!woken)
+        {
+            if (workers.size() > min_workers)
+            {
+                // This thread is no longer needed; it is joined by
+                // the next start_worker() call or the destructor
+                auto it = workers.find(std::this_thread::get_id());
+                if (workers.end() != it)
+                {
+                    stopped_workers.push_back(std::move(it->second));
+                    workers.erase(it);
+                }
+                return;
+            }
+            continue;
+        }
+
+        std::string key = ready.front();
+        ready.pop_front();
+        Task task = std::move(queues[key].front());
+        queues[key].pop_front();
+
+        lock.unlock();
+        try
+        {
+            task();
+        }
+        catch (const std::exception &excp)
+        {
+            log_error(key, excp.what());
+        }
+        catch (...)
+        {
+            log_error(key, "Unknown error");
+        }
+        // Release the resources held by the task before taking
+        // the lock again
+        task = nullptr;
+        lock.lock();
+
+        // The queue entry is kept while a task is running, which
+        // makes Post() hold back new tasks for the same object
+        auto &queue = queues[key];
+        if (queue.empty())
+        {
+            queues.erase(key);
+        }
+        else
+        {
+            make_ready(key);
+        }
+    }
+}
+
+} // namespace SessionManager
@@ -0,0 +1,333 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   object-dispatcher.hpp
+ *
+ * @brief  Worker pool running tasks for different objects concurrently,
+ *         while tasks for the same object are run in order
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace SessionManager {
+
+/**
+ *  Thrown by ObjectDispatcher::Run() when a task did not complete
+ *  in time
+ */
+class DispatchTimeout : public std::runtime_error
+{
+  public:
+    DispatchTimeout(const std::string &key)
+        : std::runtime_error("Timeout waiting for the task on " + key)
+    {
+    }
+};
+
+
+/**
+ *  Runs tasks in a pool of worker threads.  Each task belongs to an
+ *  object, identified by a key (typically the D-Bus object path).
+ *  Tasks for the same object are run one at a time, in the order they
+ *  were added.  Tasks for different objects are run concurrently.
+ *
+ *  A task which blocks will only hold back the following tasks of the
+ *  same object, and occupy one worker thread.  When tasks are waiting
+ *  and all worker threads are busy, additional worker threads are
+ *  started, up to a given limit.  These stop again after being idle
+ *  for a while.
+ */
+class ObjectDispatcher
+{
+  public:
+    using Ptr = std::shared_ptr<ObjectDispatcher>;
+    using Task = std::function<void()>;
+    using ErrorLog = std::function<void(const std::string &)>;
+
+    /// How long an additional worker thread is kept while idle
+    static constexpr std::chrono::seconds WORKER_IDLE_TIME{30};
+
+    /**
+     *  Create a new ObjectDispatcher and start the worker threads
+     *
+     * @param threads      unsigned int with the number of worker threads
+     *                     which are always running
+     * @param max_threads  unsigned int with the max number of worker
+     *                     threads; if lower than threads, no additional
+     *                     worker threads are started
+     * @param errlog       ErrorLog receiving the errors of tasks which
+     *                     threw an exception not handled by the task
+     *
+     * @return ObjectDispatcher::Ptr
+     */
+    [[nodiscard]] static Ptr Create(const unsigned int threads,
+                                    const unsigned int max_threads = 0,
+                                    ErrorLog errlog = nullptr)
+    {
+        return Ptr(new ObjectDispatcher(threads, max_threads, std::move(errlog)));
+    }
+
+    /**
+     *  Retrieve the number of worker threads currently running
+     *
+     * @return size_t
+     */
+    size_t GetWorkerCount();
+
+    /**
+     *  Stops the worker threads.  Tasks not yet started are discarded.
+     */
+    ~ObjectDispatcher() noexcept;
+
+    /**
+     *  Adds a new task for an object, without waiting for it
+     *
+     * @param key   std::string identifying the object
+     * @param task  Task to run
+     */
+    void Post(const std::string &key, Task task);
+
+    /**
+     *  Runs a task for an object and waits for the result.
+     *
+     *  If the task does not complete in time, DispatchTimeout is thrown.
+     *  The task will still be run to completion and the following tasks
+     *  for the same object will wait for it.  Until that task has
+     *  completed, new calls to Run() for the same object fail with
+     *  DispatchTimeout right away instead of being queued behind it.
+     *  This method must not be called from a task for the same object.
+     *
+     * @param key      std::string identifying the object
+     * @param timeout  std::chrono::milliseconds to wait for the result
+     * @param fn       Function to run, its return value is returned
+     *
+     * @return The value returned by fn
+     *
+     * @throws DispatchTimeout on timeout, or any exception thrown by fn
+     */
+    template <typename Fn>
+    auto Run(const std::string &key,
+             const std::chrono::milliseconds timeout,
+             Fn &&fn) -> decltype(fn())
+    {
+        return Run(key,
+                   timeout,
+                   std::forward<Fn>(fn),
+                   [](auto &&)
+                   {
+                   });
+    }
+
+    /**
+     *  Runs a task for an object and waits for the result, like
+     *  Run(key, timeout, fn).  If the caller has given up waiting
+     *  when the task completes, the result is passed to release()
+     *  instead.  This is needed for results owning resources, such
+     *  as a GVariant pointer.
+     *
+     * @param key      std::string identifying the object
+     * @param timeout  std::chrono::milliseconds to wait for the result
+     * @param fn       Function to run, its return value is returned
+     * @param release  Function disposing a result nobody waits for
+     *
+     * @return The value returned by fn
+     *
+     * @throws DispatchTimeout on timeout, or any exception thrown by fn
+     */
+    template <typename Fn, typename Release>
+    auto Run(const std::string &key,
+             const std::chrono::milliseconds timeout,
+             Fn &&fn,
+             Release release) -> decltype(fn())
+    {
+        using Result = decltype(fn());
+
+        auto state = std::make_shared<RunState<Result>>();
+        std::future<Result> result = state->promise.get_future();
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            if (stalled.count(key) > 0)
+            {
+                throw DispatchTimeout(key);
+            }
+        }
+        Post(key,
+             [this, key, state, fn = std::forward<Fn>(fn), release]() mutable
+             {
+                 complete(key, *state, fn, release);
+             });
+
+        if (std::future_status::ready != result.wait_for(timeout))
+        {
+            std::lock_guard<std::mutex> guard(state->mtx);
+            // The task may have completed while waiting for the lock
+            if (std::future_status::ready != result.wait_for(std::chrono::seconds(0)))
+            {
+                state->abandoned = true;
+                std::lock_guard<std::mutex> dguard(mtx);
+                ++stalled[key];
+                throw DispatchTimeout(key);
+            }
+        }
+        return result.get();
+    }
+
+  private:
+    /**
+     *  State shared between Run() and the task it posted
+     */
+    template <typename Result>
+    struct RunState
+    {
+        std::mutex mtx;
+        std::promise<Result> promise;
+
+        /// Set when Run() has given up waiting for the result
+        bool abandoned = false;
+    };
+
+    std::mutex mtx;
+    std::condition_variable task_added;
+    bool running = true;
+    const unsigned int min_workers;
+    const unsigned int max_workers;
+    const ErrorLog errlog;
+
+    /// Running worker threads
+    std::map<std::thread::id, std::thread> workers;
+
+    /// Additional worker threads which have stopped, not yet joined
+    std::vector<std::thread> stopped_workers;
+
+    /// Number of worker threads waiting for a task
+    size_t idle_workers = 0;
+
+    /// Tasks not yet started, per object
+    std::map<std::string, std::deque<Task>> queues;
+
+    /// Objects with pending tasks and no task currently running
+    std::deque<std::string> ready;
+
+    /// Number of timed out Run() tasks not yet completed, per object
+    std::map<std::string, unsigned int> stalled;
+
+    ObjectDispatcher(const unsigned int threads,
+                     const unsigned int max_threads,
+                     ErrorLog errlog);
+
+    /**
+     *  Flags an object as having a task ready to run and wakes up
+     *  a worker thread, or starts a new one if all are busy.
+     *  Must be called with mtx locked.
+     */
+    void make_ready(const std::string &key);
+
+    /**
+     *  Starts a new worker thread.  Must be called with mtx locked.
+     */
+    void start_worker();
+
+    void worker();
+
+    /**
+     *  Reports an exception not handled by a task
+     */
+    void log_error(const std::string &key, const std::string &msg) noexcept;
+
+    /**
+     *  Runs the function of a Run() task and hands over the result,
+     *  unless Run() has given up waiting for it
+     */
+    template <typename Result, typename Fn, typename Release>
+    void complete(const std::string &key,
+                  RunState<Result> &state,
+                  Fn &fn,
+                  Release &release)
+    {
+        if constexpr (std::is_void_v<Result>)
+        {
+            std::exception_ptr excp;
+            try
+            {
+                fn();
+            }
+            catch (...)
+            {
+                excp = std::current_exception();
+            }
+            std::lock_guard<std::mutex> guard(state.mtx);
+            if (state.abandoned)
+            {
+                unstall(key);
+            }
+            else if (excp)
+            {
+                state.promise.set_exception(excp);
+            }
+            else
+            {
+                state.promise.set_value();
+            }
+        }
+        else
+        {
+            std::optional<Result> value;
+            std::exception_ptr excp;
+            try
+            {
+                value.emplace(fn());
+            }
+            catch (...)
+            {
+                excp = std::current_exception();
+            }
+            std::lock_guard<std::mutex> guard(state.mtx);
+            if (state.abandoned)
+            {
+                unstall(key);
+                if (value)
+                {
+                    release(std::move(*value));
+                }
+            }
+            else if (excp)
+            {
+                state.promise.set_exception(excp);
+            }
+            else
+            {
+                state.promise.set_value(std::move(*value));
+            }
+        }
+    }
+
+    /**
+     *  Called when a timed out Run() task has completed
+     */
+    void unstall(const std::string &key);
+};
+
+} // namespace SessionManager
@@ -35,12 +35,14 @@ using XmlDocPtr = std::shared_ptr<openvpn::Xml::Document>;
 
 
 #include "dbus/requiresqueue-proxy.hpp"
+#include "dbus/support-functions.hpp"
 #include "client/statistics.hpp"
 #include "common/utils.hpp"
 #include "events/status.hpp"
 #include "log/log-helpers.hpp"
 #include "log/dbus-log.hpp"
 #include "sessionmgr-events.hpp"
+#include "sessionmgr-summary.hpp"
 
 namespace SessionManager::Proxy {
 
@@ -383,6 +385,96 @@ class Session : public DBusRequiresQueueProxy
     }
 
 
+    /**
+     *  Retrieves the names of the connection statistics counters.  This
+     *  is only retrieved once and reused for all the following snapshots.
+     *
+     * @return ConnectionStatsSchema::Ptr with the counter names
+     */
+    ConnectionStatsSchema::Ptr GetConnectionStatsSchema()
+    {
+        if (!stats_schema)
+        {
+            GVariant *names = proxy->GetPropertyGVariant(target, "statistics_names");
+            stats_schema = ConnectionStatsSchema::Create(glib2::Value::ExtractVector<std::string>(names));
+            g_variant_unref(names);
+        }
+        return stats_schema;
+    }
+
+
+    /**
+     *  Retrieves the current value of all connection statistics counters,
+     *  by reading the 'statistics_counters' session object property.
+     *  Use ConnectionStatsSnapshot::GetTrafficRates() with a previous
+     *  snapshot to calculate the traffic rates.
+     *
+     * @return ConnectionStatsSnapshot with all the counter values
+     */
+    ConnectionStatsSnapshot GetConnectionStatsSnapshot()
+    {
+        auto schema = GetConnectionStatsSchema();
+        GVariant *counters = proxy->GetPropertyGVariant(target, "statistics_counters");
+        auto ts = ConnectionStatsSnapshot::Clock::now();
+
+        gsize count = 0;
+        auto data = static_cast<const int64_t *>(g_variant_get_fixed_array(counters,
+                                                                           &count,
+                                                                           sizeof(gint64)));
+        std::vector<int64_t> values(data, data + count);
+        g_variant_unref(counters);
+
+        return ConnectionStatsSnapshot(schema, std::move(values), ts);
+    }
+
+
+    /**
+     *  Enables the StatisticsUpdate signals from the session manager to
+     *  this D-Bus connection.  Only the counters which have changed are
+     *  sent in each update; see ConnectionStatsDelta for details.
+     *
+     * @param interval  uint32_t with the requested update interval, in
+     *                  milliseconds
+     *
+     * @return Returns a std::vector<std::string> with the names of the
+     *         statistics counters.  The counters in the StatisticsUpdate
+     *         signal refers to the index of this list.
+     */
+    std::vector<std::string> StatisticsSubscribe(const uint32_t interval)
+    {
+        try
+        {
+            GVariant *r = proxy->Call(target,
+                                      "StatisticsSubscribe",
+                                      glib2::Value::CreateTupleWrapped(interval));
+            auto names = glib2::Value::ExtractVector<std::string>(r, 0);
+            g_variant_unref(r);
+            return names;
+        }
+        catch (const DBus::Proxy::Exception &)
+        {
+            throw SessionManager::Proxy::Exception("StatisticsSubscribe() call failed");
+        }
+    }
+
+
+    /**
+     *  Stops the StatisticsUpdate signals to this D-Bus connection
+     */
+    void StatisticsUnsubscribe()
+    {
+        try
+        {
+            GVariant *res = proxy->Call(target, "StatisticsUnsubscribe");
+            g_variant_unref(res);
+        }
+        catch (const DBus::Proxy::Exception &)
+        {
+            throw SessionManager::Proxy::Exception("StatisticsUnsubscribe() call failed");
+        }
+    }
+
+
     /**
      *  Manipulate the public-access flag.  When public-access is set to
      *  true, everyone have access to this session regardless of how the
@@ -620,6 +712,7 @@ class Session : public DBusRequiresQueueProxy
     DBus::Proxy::Client::Ptr proxy = nullptr;
     DBus::Proxy::TargetPreset::Ptr target = nullptr;
     DBus::Proxy::Utils::Query::Ptr prxqry = nullptr;
+    ConnectionStatsSchema::Ptr stats_schema = nullptr;
 
     Session(DBus::Proxy::Client::Ptr prx, const DBus::Object::Path &objpath)
         : DBusRequiresQueueProxy("UserInputQueueGetTypeGroup",
@@ -775,6 +868,40 @@ class Manager
     }
 
 
+    /**
+     *  Retrieve the most commonly used properties of all available
+     *  sessions in a single D-Bus call
+     *
+     * @return  SessionSummary::List with one record per session
+     */
+    SessionSummary::List FetchSessionsSummary() const
+    {
+        GVariant *r = nullptr;
+        try
+        {
+            r = proxy->Call(target, "FetchSessionsSummary");
+        }
+        catch (const DBus::Proxy::Exception &)
+        {
+            throw SessionManager::Proxy::Exception("Failed to retrieve sessions summary");
+        }
+
+        SessionSummary::List ret{};
+        GVariant *sessions = g_variant_get_child_value(r, 0);
+        GVariantIter *iter = g_variant_iter_new(sessions);
+        GVariant *rec = nullptr;
+        while ((rec = g_variant_iter_next_value(iter)))
+        {
+            ret.emplace_back(rec);
+            g_variant_unref(rec);
+        }
+        g_variant_iter_free(iter);
+        g_variant_unref(sessions);
+        g_variant_unref(r);
+        return ret;
+    }
+
+
     Session::Ptr Retrieve(const DBus::Object::Path &session_path) const
     {
         return Session::Create(proxy, session_path);
@@ -860,6 +987,7 @@ class Manager
     DBus::Connection::Ptr dbuscon = nullptr;
     DBus::Proxy::Client::Ptr proxy = nullptr;
     DBus::Proxy::TargetPreset::Ptr target = nullptr;
+    GDBusPP::Proxy::Utils::ObjectPresence::Ptr presence = nullptr;
 
     Manager(DBus::Connection::Ptr conn)
         : dbuscon(conn),
@@ -872,17 +1000,12 @@ class Manager
         prxqry->CheckServiceAvail(Constants::GenServiceName("sessions"));
 
         // Delay the return up to 750ms, to ensure we have a valid
-        // Session Manager service object available
-        auto prxchk = DBus::Proxy::Utils::Query::Create(proxy);
-        for (uint8_t i = 5; i > 0; i--)
-        {
-            if (prxchk->CheckObjectExists(target->object_path,
-                                          target->interface))
-            {
-                break;
-            }
-            usleep(150000);
-        }
+        // Session Manager service object available.  The presence
+        // cache is shared with other proxies on the same connection.
+        presence = GDBusPP::Proxy::Utils::ObjectPresence::Create(
+            conn, Constants::GenServiceName("sessions"));
+        (void)presence->WaitForObject(target->object_path,
+                                      std::chrono::milliseconds(750));
     }
 };
 
@@ -15,7 +15,6 @@
  */
 
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/exceptions.hpp>
 #include <gdbuspp/object/path.hpp>
 #include <gdbuspp/proxy/utils.hpp>
@@ -32,6 +31,17 @@
 
 namespace SessionManager {
 
+/**
+ *  Number of worker threads running calls towards the backend VPN
+ *  client processes.  Each hanging backend occupies at most two of them;
+ *  one for the ordered calls and one for the Ping and ForceShutdown calls.
+ *  When all are busy, a few more worker threads are started, up to
+ *  DISPATCHER_MAX_THREADS.  Beyond that, calls are queued; calls towards
+ *  a backend which has already timed out fail right away.
+ */
+static constexpr unsigned int DISPATCHER_THREADS = 8;
+static constexpr unsigned int DISPATCHER_MAX_THREADS = 16;
+
 
 SrvHandler::SrvHandler(DBus::Connection::Ptr con,
                        DBus::Object::Manager::Ptr objmgr,
@@ -53,37 +63,29 @@ SrvHandler::SrvHandler(DBus::Connection::Ptr con,
     sig_sessmgr->GroupAddTarget("broadcast", "");
     sig_sessmgr_event = sig_sessmgr->GroupCreateSignal<::Signals::SessionManagerEvent>("broadcast");
 
-    creds_qry = DBus::Credentials::Query::Create(dbuscon);
+    creds_qry = GDBusPP::Credentials::Cache::Create(dbuscon);
+
+    // Calls to the backend VPN client processes are run by this
+    // dispatcher, to avoid one slow backend holding back all sessions
+    dispatcher = ObjectDispatcher::Create(DISPATCHER_THREADS,
+                                          DISPATCHER_MAX_THREADS,
+                                          [log = sig_sessmgr](const std::string &msg)
+                                          {
+                                              log->LogCritical(msg);
+                                          });
     tunnel_queue = NewTunnelQueue::Create(dbuscon,
                                           creds_qry,
                                           object_mgr,
                                           logwr,
                                           sig_sessmgr,
-                                          sig_sessmgr_event);
+                                          sig_sessmgr_event,
+                                          dispatcher);
 
 
     auto new_tun = AddMethod("NewTunnel",
                              [this](DBus::Object::Method::Arguments::Ptr args)
                              {
                                  this->method_new_tunnel(args);
-
-                                 // FIXME: This is a hackish workaround to
-                                 // avoid issues with the Python code not
-                                 // able to yet handle an object path
-                                 // which is not available yet.  This simple
-                                 // sleep allows the backend client to register
-                                 // itself.
-                                 //
-                                 // This was not needed with the previous
-                                 // implementation because this call returned
-                                 // after the Session object was created - and
-                                 // the handling of method calls was not handled
-                                 // asynchronously - which basically hid this
-                                 // this issue.
-                                 //
-                                 // This can be removed once the Python code
-                                 // is updated
-                                 usleep(700000);
                              });
     new_tun->AddInput("config_path", glib2::DataType::DBus<DBus::Object::Path>());
     new_tun->AddOutput("session_path", glib2::DataType::DBus<DBus::Object::Path>());
@@ -95,6 +97,14 @@ SrvHandler::SrvHandler(DBus::Connection::Ptr con,
                                     });
     fetch_sessions->AddOutput("paths", "ao");
 
+    auto fetch_summary = AddMethod("FetchSessionsSummary",
+                                   [this](DBus::Object::Method::Arguments::Ptr args)
+                                   {
+                                       this->method_fetch_sessions_summary(args);
+                                   });
+    fetch_summary->AddOutput("sessions",
+                             "a" + std::string(SessionSummary::DBusType()));
+
     auto fetch_mgtd_intf = AddMethod("FetchManagedInterfaces",
                                      [this](DBus::Object::Method::Arguments::Ptr args)
                                      {
@@ -158,6 +168,16 @@ void SrvHandler::method_new_tunnel(Object::Method::Arguments::Ptr args)
     }
 
     auto sespath = tunnel_queue->AddTunnel(cfgpath, owner);
+
+    // Only return the session path once the backend VPN client process
+    // has registered itself and the session object is available.  Method
+    // calls are processed asynchronously, so this does not block the
+    // RegistrationRequest signal from being handled.
+    if (!tunnel_queue->WaitForRegistration(sespath, std::chrono::seconds(10)))
+    {
+        sig_sessmgr->LogWarn("Backend VPN client has not registered yet, "
+                             "session path: " + sespath);
+    }
     args->SetMethodReturn(glib2::Value::CreateTupleWrapped(sespath));
 }
 
@@ -181,6 +201,25 @@ void SrvHandler::method_fetch_avail_sessions(Object::Method::Arguments::Ptr args
 }
 
 
+void SrvHandler::method_fetch_sessions_summary(Object::Method::Arguments::Ptr args)
+{
+    auto no_filter = [](std::shared_ptr<Session> obj)
+    {
+        // we want all objects; nothing to filter out
+        return true;
+    };
+
+    GVariantBuilder *b = glib2::Builder::Create(
+        ("a" + std::string(SessionSummary::DBusType())).c_str());
+    for (const auto &obj : helper_retrieve_sessions(args->GetCallerBusName(),
+                                                    no_filter))
+    {
+        glib2::Builder::Add(b, obj->GetSummary().GetGVariant());
+    }
+    args->SetMethodReturn(glib2::Builder::FinishWrapped(b));
+}
+
+
 void SrvHandler::method_fetch_managed_interf(Object::Method::Arguments::Ptr args)
 {
     std::vector<std::string> devices{};
@@ -16,12 +16,12 @@
 
 #include <functional>
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/base.hpp>
 #include <gdbuspp/service.hpp>
 
 #include "common/utils.hpp"
 #include "dbus/constants.hpp"
+#include "dbus/credentials-cache.hpp"
 #include "log/logwriter.hpp"
 #include "log/proxy-log.hpp"
 #include "sessionmgr-session.hpp"
@@ -76,11 +76,12 @@ class SrvHandler : public Object::Base
     Connection::Ptr dbuscon = nullptr;
     Object::Manager::Ptr object_mgr = nullptr;
     LogWriter::Ptr logwr = nullptr;
-    DBus::Credentials::Query::Ptr creds_qry = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_qry = nullptr;
     std::string version{get_package_version()};
     SessionManager::Log::Ptr sig_sessmgr = nullptr;
     DBus::Signals::Emit::Ptr broadcast_emitter = nullptr;
     ::Signals::SessionManagerEvent::Ptr sig_sessmgr_event = nullptr;
+    ObjectDispatcher::Ptr dispatcher = nullptr;
     std::shared_ptr<NewTunnelQueue> tunnel_queue = nullptr;
 
 
@@ -113,6 +114,21 @@ class SrvHandler : public Object::Base
      */
     void method_fetch_avail_sessions(Object::Method::Arguments::Ptr args);
 
+    /**
+     *  D-Bus method: net.openvpn.v3.sessions.FetchSessionsSummary
+     *  Retrieve the most commonly used properties of all accessible VPN
+     *  sessions in a single call.  Only sessions available to the calling
+     *  user will be provided.
+     *
+     *  Input:   n/a
+     *
+     *  Output:  (a(oostuu(uus)ssssu))
+     *    a(...) - sessions: Array of SessionManager::SessionSummary records
+     *
+     * @param args  DBus::Object::Method::Arguments
+     */
+    void method_fetch_sessions_summary(Object::Method::Arguments::Ptr args);
+
     /**
      *  D-Bus method: net.openvpn.v3.sessions.FetchManagedInterfaces
      *  Retrieve a list of virtual interface names in use by the calling
@@ -15,6 +15,8 @@
  */
 
 
+#include <algorithm>
+#include <memory>
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/exceptions.hpp>
 #include <gdbuspp/object/base.hpp>
@@ -28,13 +30,50 @@
 #include "dbus/constants.hpp"
 #include "dbus/path.hpp"
 #include "log/logwriter.hpp"
+#include "backend-liveness.hpp"
 #include "sessionmgr-session.hpp"
 
 
 using namespace DBus;
+using namespace std::chrono_literals;
 
 namespace SessionManager {
 
+/**
+ *  Maximum age of the cached connection statistics from the backend
+ *  VPN client service
+ */
+static constexpr std::chrono::milliseconds STATS_MAX_AGE = 1s;
+
+/**
+ *  Maximum age of other cached properties from the backend VPN client
+ *  service.  These are also refreshed on each status change.
+ */
+static constexpr std::chrono::milliseconds PROPERTY_MAX_AGE = 5s;
+
+/**
+ *  How long the statistics counter names from the backend VPN client
+ *  service may be cached.  These do not change during a session.
+ */
+static constexpr std::chrono::milliseconds STATS_NAMES_MAX_AGE = 1h;
+
+/**
+ *  How long to wait for the backend VPN client service to respond
+ */
+static constexpr std::chrono::milliseconds BACKEND_CALL_TIMEOUT = 10s;
+
+/**
+ *  Releases a backend response which arrived after the caller gave
+ *  up waiting for it
+ */
+static void release_gvariant(GVariant *response)
+{
+    if (response)
+    {
+        g_variant_unref(response);
+    }
+}
+
 class ReadyException : public DBus::Object::Method::Exception
 {
   public:
@@ -70,8 +109,9 @@ class ReadyException : public DBus::Object::Method::Exception
 
 Session::Session(DBus::Connection::Ptr dbuscon,
                  DBus::Object::Manager::Ptr objmgr,
-                 DBus::Credentials::Query::Ptr creds_qry_,
+                 GDBusPP::Credentials::Cache::Ptr creds_qry_,
                  ::Signals::SessionManagerEvent::Ptr sig_sessionmgr,
+                 ObjectDispatcher::Ptr dispatcher_,
                  const DBus::Object::Path &sespath,
                  const uid_t owner,
                  const std::string &be_busname,
@@ -81,7 +121,8 @@ Session::Session(DBus::Connection::Ptr dbuscon,
                  LogWriter::Ptr logwr)
     : DBus::Object::Base(sespath, Constants::GenInterface("sessions")),
       dbus_conn(dbuscon), object_mgr(objmgr), creds_qry(creds_qry_),
-      sig_sessmgr(sig_sessionmgr), config_path(cfg_path)
+      sig_sessmgr(sig_sessionmgr), dispatcher(dispatcher_),
+      config_path(cfg_path)
 {
     be_target = DBus::Proxy::TargetPreset::Create(Constants::GenPath("backends/session"),
                                                   Constants::GenInterface("backends"));
@@ -102,6 +143,10 @@ Session::Session(DBus::Connection::Ptr dbuscon,
     sig_statuschg = sig_session->CreateSignal<::Signals::StatusChange>(sigsubscr);
     sig_statuschg->AttachCallback([this](const Events::Status &event)
                                   {
+                                      // Device and connection details from
+                                      // the backend may change with the status
+                                      this->be_props->InvalidateAll();
+
                                       if (event.Check(StatusMajor::CONNECTION,
                                                       {
                                                           StatusMinor::CFG_ERROR,
@@ -115,6 +160,12 @@ Session::Session(DBus::Connection::Ptr dbuscon,
                                       }
                                   });
 
+    // StatisticsUpdate signals are only forwarded to the callers of the
+    // StatisticsSubscribe method; each of them is a target in this group
+    sig_session->GroupCreate("statistics");
+    sig_statsupd = sig_session->GroupCreateSignal<::Signals::StatisticsUpdate>("statistics",
+                                                                               sigsubscr);
+
     ResetBackend(be_pid, be_busname);
 
     // Prepare the object handling access control lists
@@ -205,13 +256,27 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         });
     arg_logfwd->AddInput("enable", glib2::DataType::DBus<bool>());
 
+    auto arg_stats_subscr = AddMethod(
+        "StatisticsSubscribe",
+        [this](Object::Method::Arguments::Ptr args)
+        {
+            method_statistics_subscribe(args);
+        });
+    arg_stats_subscr->AddInput("interval", glib2::DataType::DBus<uint32_t>());
+    arg_stats_subscr->AddOutput("names", "as");
+
+    AddMethod(
+        "StatisticsUnsubscribe",
+        [this](Object::Method::Arguments::Ptr args)
+        {
+            method_statistics_unsubscribe(args);
+        });
+
     auto arg_usrinpq_gettypegr = AddMethod(
         "UserInputQueueGetTypeGroup",
         [this](Object::Method::Arguments::Ptr args)
         {
-            validate_vpn_backend();
-            GVariant *r = be_prx->Call(be_target,
-                                       "UserInputQueueGetTypeGroup");
+            GVariant *r = helper_backend_call("UserInputQueueGetTypeGroup");
             args->SetMethodReturn(r);
         });
     arg_usrinpq_gettypegr->AddOutput("type_group_list", "a(uu)");
@@ -220,10 +285,8 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         "UserInputQueueFetch",
         [this](Object::Method::Arguments::Ptr args)
         {
-            validate_vpn_backend();
-            GVariant *r = be_prx->Call(be_target,
-                                       "UserInputQueueFetch",
-                                       args->GetMethodParameters());
+            GVariant *r = helper_backend_call("UserInputQueueFetch",
+                                              args->GetMethodParameters());
             args->SetMethodReturn(r);
         });
     arg_usrinpq_fetch->AddInput("type", glib2::DataType::DBus<uint32_t>());
@@ -240,10 +303,8 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         "UserInputQueueCheck",
         [this](Object::Method::Arguments::Ptr args)
         {
-            validate_vpn_backend();
-            GVariant *r = be_prx->Call(be_target,
-                                       "UserInputQueueCheck",
-                                       args->GetMethodParameters());
+            GVariant *r = helper_backend_call("UserInputQueueCheck",
+                                              args->GetMethodParameters());
             args->SetMethodReturn(r);
         });
     arg_usrinpq_check->AddInput("type", glib2::DataType::DBus<uint32_t>());
@@ -254,10 +315,8 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         "UserInputProvide",
         [this](Object::Method::Arguments::Ptr args)
         {
-            validate_vpn_backend();
-            GVariant *r = be_prx->Call(be_target,
-                                       "UserInputProvide",
-                                       args->GetMethodParameters());
+            GVariant *r = helper_backend_call("UserInputProvide",
+                                              args->GetMethodParameters());
             args->SetMethodReturn(r);
         });
     arg_usrinpq_provide->AddInput("type", glib2::DataType::DBus<uint32_t>());
@@ -337,8 +396,31 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         [this](const DBus::Object::Property::BySpec &prop)
             -> GVariant *
         {
-            validate_vpn_backend("statistics");
-            return be_prx->GetPropertyGVariant(be_target, "statistics");
+            return helper_backend_property("statistics", STATS_MAX_AGE);
+        });
+
+    // statistics_counters: The same statistics as a fixed array of values,
+    // in the order given by the statistics_names property
+    AddPropertyBySpec(
+        "statistics_counters",
+        "ax",
+        [this](const DBus::Object::Property::BySpec &prop)
+            -> GVariant *
+        {
+            return helper_backend_property("statistics_counters", STATS_MAX_AGE);
+        });
+
+    // statistics_names: The names of the statistics counters.  These
+    // are provided by the OpenVPN 3 Core library and will not change
+    // while the backend process runs, so the cached value is kept
+    // until the backend cache is cleared or invalidated.
+    AddPropertyBySpec(
+        "statistics_names",
+        "as",
+        [this](const DBus::Object::Property::BySpec &prop)
+            -> GVariant *
+        {
+            return helper_backend_property("statistics_names", STATS_NAMES_MAX_AGE);
         });
 
     // device path: D-Bus path to the interface in net.openvpn.v3.netcfg
@@ -350,8 +432,7 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         [this](const DBus::Object::Property::BySpec &prop)
             -> GVariant *
         {
-            validate_vpn_backend("device_path");
-            return be_prx->GetPropertyGVariant(be_target, "device_path");
+            return helper_backend_property("device_path", PROPERTY_MAX_AGE);
         });
 
     // device name: string with the name of the virtual network interface
@@ -361,8 +442,7 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         [this](const DBus::Object::Property::BySpec &prop)
             -> GVariant *
         {
-            validate_vpn_backend("device_name");
-            return be_prx->GetPropertyGVariant(be_target, "device_name");
+            return helper_backend_property("device_name", PROPERTY_MAX_AGE);
         });
 
     AddPropertyBySpec(
@@ -371,8 +451,7 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         [this](const DBus::Object::Property::BySpec &prop)
             -> GVariant *
         {
-            validate_vpn_backend("session_name");
-            return be_prx->GetPropertyGVariant(be_target, "session_name");
+            return helper_backend_property("session_name", PROPERTY_MAX_AGE);
         });
 
     AddPropertyBySpec(
@@ -381,9 +460,8 @@ Session::Session(DBus::Connection::Ptr dbuscon,
         [this](const DBus::Object::Property::BySpec &prop)
             -> GVariant *
         {
-            validate_vpn_backend("connection");
+            GVariant *r = helper_backend_property("connection", PROPERTY_MAX_AGE);
             GVariantBuilder *res = glib2::Builder::Create("(ssu)");
-            GVariant *r = be_prx->GetPropertyGVariant(be_target, "connection");
             try
             {
                 glib2::Utils::checkParams(__func__, r, "(sssu)");
@@ -397,6 +475,7 @@ Session::Session(DBus::Connection::Ptr dbuscon,
                 glib2::Builder::Add(res, std::string{});
                 glib2::Builder::Add(res, static_cast<uint32_t>(0));
             }
+            g_variant_unref(r);
             return glib2::Builder::Finish(res);
         });
 
@@ -480,7 +559,9 @@ Session::Session(DBus::Connection::Ptr dbuscon,
             //
             if (be_prx && be_target && DCOstatus::MODIFIED != dco_status)
             {
-                dco = be_prx->GetProperty<bool>(be_target, "dco");
+                GVariant *r = helper_backend_property("dco", PROPERTY_MAX_AGE);
+                dco = glib2::Value::Get<bool>(r);
+                g_variant_unref(r);
             }
             return glib2::Value::Create(dco);
         },
@@ -523,6 +604,7 @@ Session::~Session() noexcept
 void Session::ResetBackend(pid_t be_pid, const std::string &be_busname)
 {
     backend_pid = be_pid;
+    be_props->Clear();
 
     // Set up the D-Bus proxy towards the back-end VPN client process
     be_prx = DBus::Proxy::Client::Create(dbus_conn, be_busname);
@@ -534,6 +616,27 @@ void Session::ResetBackend(pid_t be_pid, const std::string &be_busname)
 
     sig_attreq->Subscribe(subscr_tgt);
     sig_statuschg->Subscribe(subscr_tgt);
+    sig_statsupd->Subscribe(subscr_tgt);
+
+    // A new backend process needs to be told to send statistics updates
+    // if there are subscribers for them
+    std::lock_guard<std::mutex> guard(stats_subscribers_mtx);
+    if (!stats_subscribers.empty())
+    {
+        try
+        {
+            GVariant *r = helper_update_statistics_subscription(true);
+            if (r)
+            {
+                g_variant_unref(r);
+            }
+        }
+        catch (const DBus::Exception &excp)
+        {
+            sig_session->LogError("Failed to enable statistics updates: "
+                                  + std::string(excp.GetRawError()));
+        }
+    }
 }
 
 
@@ -541,7 +644,7 @@ void Session::Ready()
 {
     try
     {
-        GVariant *r = be_prx->Call(be_target, "Ready", nullptr);
+        GVariant *r = helper_backend_call("Ready");
         g_variant_unref(r);
     }
     catch (const DBus::Proxy::Exception &excp)
@@ -561,20 +664,44 @@ void Session::Ready()
 
 void Session::Connect()
 {
+    validate_vpn_backend();
+
     // Set and lock the DCO mode
-    if (DCOstatus::MODIFIED == dco_status)
+    const bool set_dco = (DCOstatus::MODIFIED == dco_status);
+    if (set_dco)
     {
         sig_session->Debug(std::string("DCO setting changed to ")
                            + (dco ? "enabled" : "disabled"));
-        be_prx->SetProperty(be_target, "dco", dco);
     }
     dco_status = DCOstatus::LOCKED;
 
-    auto loglvl = be_prx->GetProperty<uint32_t>(be_target, "log_level");
+    // The backend calls are done as a single task, to keep them
+    // together in the queue of calls to this backend
+    auto prx = be_prx;
+    auto tgt = be_target;
+    const bool dco_mode = dco;
+    uint32_t loglvl = 0;
+    try
+    {
+        loglvl = dispatcher->Run(GetPath(),
+                                 BACKEND_CALL_TIMEOUT,
+                                 [prx, tgt, set_dco, dco_mode]()
+                                 {
+                                     if (set_dco)
+                                     {
+                                         prx->SetProperty(tgt, "dco", dco_mode);
+                                     }
+                                     auto lvl = prx->GetProperty<uint32_t>(tgt, "log_level");
+                                     GVariant *r = prx->Call(tgt, "Connect", nullptr);
+                                     g_variant_unref(r);
+                                     return lvl;
+                                 });
+    }
+    catch (const DispatchTimeout &)
+    {
+        throw DBus::Object::Method::Exception("Backend VPN process did not respond");
+    }
     sig_session->SetLogLevel(loglvl);
-
-    GVariant *r = be_prx->Call(be_target, "Connect", nullptr);
-    g_variant_unref(r);
     sig_session->LogVerb2("Starting connection - " + GetPath());
 }
 
@@ -584,20 +711,26 @@ const bool Session::Authorize(DBus::Authz::Request::Ptr authzreq)
     // Early sanity check to see if the backend VPN process is accessible or not
     if (be_prx && be_target)
     {
-        // Check if the backend is still alive
+        // Check if the backend is still alive.  A backend which does not
+        // respond in time is treated as dead; otherwise each following
+        // call would fail on the hung backend while it keeps a worker
+        // thread busy.
+        auto prx = be_prx;
+        auto tgt = be_target;
+        BackendLiveness liveness = BackendLiveness::ALIVE;
         try
         {
-            GVariant *r = be_prx->Call(be_target, "Ping", nullptr);
-            glib2::Utils::checkParams(__func__, r, "(b)");
-            if (!glib2::Value::Extract<bool>(r, 0))
-            {
-                sig_session->LogCritical("Backend VPN did not respond correctly "
-                                         "- "
-                                         + GetPath());
-                close_session(true);
-                throw DBus::Object::Method::Exception("Backend VPN process did not respond");
-            }
-            g_variant_unref(r);
+            liveness = CheckBackendLiveness(*dispatcher,
+                                            "unordered:" + GetPath(),
+                                            BACKEND_CALL_TIMEOUT,
+                                            [prx, tgt]()
+                                            {
+                                                GVariant *r = prx->Call(tgt, "Ping", nullptr);
+                                                glib2::Utils::checkParams("Session::Authorize", r, "(b)");
+                                                bool alive = glib2::Value::Extract<bool>(r, 0);
+                                                g_variant_unref(r);
+                                                return alive;
+                                            });
         }
         catch (const DBus::Proxy::Exception &excp)
         {
@@ -607,6 +740,17 @@ const bool Session::Authorize(DBus::Authz::Request::Ptr authzreq)
             close_session(true);
             throw DBus::Object::Method::Exception("Backend VPN process did not respond");
         }
+
+        if (BackendLiveness::ALIVE != liveness)
+        {
+            sig_session->LogCritical(std::string("Backend VPN ")
+                                     + (BackendLiveness::NO_RESPONSE == liveness
+                                            ? "did not respond in time"
+                                            : "did not respond correctly")
+                                     + " - " + GetPath());
+            close_session(true);
+            throw DBus::Object::Method::Exception("Backend VPN process did not respond");
+        }
     }
     else
     {
@@ -739,8 +883,10 @@ std::string Session::GetDeviceName() const noexcept
 {
     try
     {
-        validate_vpn_backend("device_name");
-        return be_prx->GetProperty<std::string>(be_target, "device_name");
+        GVariant *r = helper_backend_property("device_name", PROPERTY_MAX_AGE);
+        std::string ret = glib2::Value::Get<std::string>(r);
+        g_variant_unref(r);
+        return ret;
     }
     catch (const DBus::Exception &excp)
     {
@@ -762,6 +908,52 @@ Events::Status Session::GetLastEvent() const noexcept
 }
 
 
+SessionSummary Session::GetSummary() const noexcept
+{
+    SessionSummary ret;
+    ret.path = GetPath();
+    ret.config_path = config_path;
+    ret.config_name = config_name;
+    ret.session_created = created;
+    ret.owner = object_acl->GetOwner();
+    ret.backend_pid = (backend_pid > 0 ? backend_pid : 0);
+    ret.status = GetLastEvent();
+
+    if (!be_prx || !be_target)
+    {
+        // The VPN client backend is not available, so the rest of
+        // the details cannot be retrieved
+        return ret;
+    }
+
+    try
+    {
+        GVariant *r = helper_backend_property("device_name", PROPERTY_MAX_AGE);
+        ret.device_name = glib2::Value::Get<std::string>(r);
+        g_variant_unref(r);
+
+        r = helper_backend_property("session_name", PROPERTY_MAX_AGE);
+        ret.session_name = glib2::Value::Get<std::string>(r);
+        g_variant_unref(r);
+
+        r = helper_backend_property("connection", PROPERTY_MAX_AGE);
+        if (std::string("(sssu)") == g_variant_get_type_string(r))
+        {
+            ret.protocol = glib2::Value::Extract<std::string>(r, 0);
+            ret.server_ip = glib2::Value::Extract<std::string>(r, 2);
+            ret.server_port = glib2::Value::Extract<uint32_t>(r, 3);
+        }
+        g_variant_unref(r);
+    }
+    catch (const DBus::Exception &)
+    {
+        // The session might not have been started yet; the details
+        // which could not be retrieved are left empty
+    }
+    return ret;
+}
+
+
 bool Session::CheckACL(const std::string &caller) const noexcept
 {
     return object_acl->CheckACL(caller, {object_acl->GetOwner()});
@@ -829,11 +1021,7 @@ void Session::method_proxy_be(DBus::Object::Method::Arguments::Ptr args,
                               const std::string &method,
                               const bool no_response)
 {
-    validate_vpn_backend();
-
-    GVariant *r = be_prx->Call(be_target,
-                               method,
-                               args->GetMethodParameters());
+    GVariant *r = helper_backend_call(method, args->GetMethodParameters());
     if (no_response)
     {
         g_variant_unref(r);
@@ -896,6 +1084,66 @@ void Session::method_log_forward(DBus::Object::Method::Arguments::Ptr args)
 }
 
 
+void Session::method_statistics_subscribe(DBus::Object::Method::Arguments::Ptr args)
+{
+    validate_vpn_backend();
+
+    GVariant *params = args->GetMethodParameters();
+    auto interval = glib2::Value::Extract<uint32_t>(params, 0);
+    std::string caller = args->GetCallerBusName();
+
+    std::lock_guard<std::mutex> guard(stats_subscribers_mtx);
+    stats_subscribers[caller] = interval;
+
+    // A new subscriber needs the complete set of counters as the
+    // first update, which requires restarting the updates
+    GVariant *r = nullptr;
+    try
+    {
+        r = helper_update_statistics_subscription(true);
+    }
+    catch (const DBus::Proxy::Exception &excp)
+    {
+        stats_subscribers.erase(caller);
+        throw DBus::Object::Method::Exception(excp.GetRawError());
+    }
+    helper_watch_statistics_subscriber(caller);
+    sig_session->LogVerb2("Added statistics updates to " + caller
+                          + " on " + GetPath()
+                          + " (interval: " + std::to_string(interval) + "ms)");
+    args->SetMethodReturn(r);
+}
+
+
+void Session::method_statistics_unsubscribe(DBus::Object::Method::Arguments::Ptr args)
+{
+    std::string caller = args->GetCallerBusName();
+
+    std::lock_guard<std::mutex> guard(stats_subscribers_mtx);
+    stats_watchers.erase(caller);
+    if (stats_subscribers.erase(caller) > 0)
+    {
+        try
+        {
+            GVariant *r = helper_update_statistics_subscription(false);
+            if (r)
+            {
+                g_variant_unref(r);
+            }
+        }
+        catch (const DBus::Exception &excp)
+        {
+            // The backend VPN client might already be gone
+            sig_session->Debug("StatisticsUnsubscribe: "
+                               + std::string(excp.GetRawError()));
+        }
+        sig_session->LogVerb2("Removed statistics updates from " + caller
+                              + " on " + GetPath());
+    }
+    args->SetMethodReturn(nullptr);
+}
+
+
 void Session::method_access_grant(DBus::Object::Method::Arguments::Ptr args)
 {
     GVariant *params = args->GetMethodParameters();
@@ -934,12 +1182,21 @@ void Session::close_session(const bool forced)
 {
     try
     {
-        validate_vpn_backend();
-        GVariant *r = be_prx->Call(be_target,
-                                   (!forced ? "Disconnect" : "ForceShutdown"));
-        if (r)
+        if (!forced)
         {
-            g_variant_unref(r);
+            GVariant *r = helper_backend_call("Disconnect");
+            if (r)
+            {
+                g_variant_unref(r);
+            }
+        }
+        else if (be_prx && be_target)
+        {
+            // A forced shutdown is typically done because the backend
+            // does not respond.  The request is sent directly, without
+            // waiting for a reply, as the dispatcher refuses new calls
+            // to a backend with a hung call.
+            be_prx->Call(be_target, "ForceShutdown", nullptr, true);
         }
     }
     catch (const DBus::Exception &)
@@ -948,6 +1205,7 @@ void Session::close_session(const bool forced)
         be_prx.reset();
         be_target.reset();
     }
+    be_props->Clear();
 
     if (!forced)
     {
@@ -963,6 +1221,13 @@ void Session::close_session(const bool forced)
     }
 
     helper_stop_log_forwards();
+    {
+        std::lock_guard<std::mutex> guard(stats_subscribers_mtx);
+        stats_subscribers.clear();
+        stats_watchers.clear();
+        expired_stats_watchers.clear();
+        sig_session->GroupClearTargets("statistics");
+    }
     sig_session->LogVerb1("Session closing - " + GetPath());
     try
     {
@@ -1016,6 +1281,170 @@ void Session::helper_stop_log_forwards()
 }
 
 
+void Session::helper_watch_statistics_subscriber(const std::string &subscriber)
+{
+    for (const auto &expired : expired_stats_watchers)
+    {
+        stats_watchers.erase(expired);
+    }
+    expired_stats_watchers.clear();
+
+    if (stats_watchers.find(subscriber) != stats_watchers.end())
+    {
+        return;
+    }
+    auto watcher = std::make_shared<DBus::BusWatcher>(dbus_conn->GetBusType(), subscriber);
+    watcher->SetNameDisappearedHandler(
+        [this](const std::string &bus_name)
+        {
+            statistics_subscriber_gone(bus_name);
+        });
+    stats_watchers[subscriber] = std::move(watcher);
+}
+
+
+void Session::statistics_subscriber_gone(const std::string &subscriber)
+{
+    std::lock_guard<std::mutex> guard(stats_subscribers_mtx);
+
+    // The watcher calling this method is removed on the next
+    // subscription, as it is still in use
+    expired_stats_watchers.insert(subscriber);
+    if (0 == stats_subscribers.erase(subscriber))
+    {
+        return;
+    }
+
+    try
+    {
+        GVariant *r = helper_update_statistics_subscription(false);
+        if (r)
+        {
+            g_variant_unref(r);
+        }
+    }
+    catch (const DBus::Exception &excp)
+    {
+        // The backend VPN client might already be gone
+        sig_session->Debug("Statistics subscriber disappeared: "
+                           + std::string(excp.GetRawError()));
+    }
+    sig_session->LogVerb2("Removed statistics updates from " + subscriber
+                          + " on " + GetPath() + " (subscriber disappeared)");
+}
+
+
+GVariant *Session::helper_update_statistics_subscription(const bool force)
+{
+    sig_session->GroupClearTargets("statistics");
+    uint32_t interval = 0;
+    for (const auto &[subscriber, requested] : stats_subscribers)
+    {
+        sig_session->GroupAddTarget("statistics", subscriber);
+        interval = (0 == interval ? requested : std::min(interval, requested));
+    }
+
+    if (!be_prx || !be_target)
+    {
+        stats_interval = 0;
+        return nullptr;
+    }
+
+    if (stats_subscribers.empty())
+    {
+        stats_interval = 0;
+        GVariant *r = helper_backend_call("StatisticsUnsubscribe");
+        g_variant_unref(r);
+        return nullptr;
+    }
+
+    if (!force && interval == stats_interval)
+    {
+        return nullptr;
+    }
+    stats_interval = interval;
+    GVariant *params = glib2::Value::CreateTupleWrapped(interval);
+    g_variant_ref_sink(params);
+    GVariant *r = helper_backend_call("StatisticsSubscribe", params);
+    g_variant_unref(params);
+    return r;
+}
+
+
+GVariant *Session::helper_backend_property(const std::string &property,
+                                           const std::chrono::milliseconds max_age) const
+{
+    validate_vpn_backend(property);
+
+    // Keep a reference to the current backend proxy, in case the
+    // session is closed while the property is being retrieved
+    auto prx = be_prx;
+    auto tgt = be_target;
+    auto disp = dispatcher;
+    const std::string key = GetPath();
+    try
+    {
+        return be_props->Get(property,
+                             max_age,
+                             [prx, tgt, disp, key, property]()
+                             {
+                                 return disp->Run(key,
+                                                  BACKEND_CALL_TIMEOUT,
+                                                  [prx, tgt, property]()
+                                                  {
+                                                      return prx->GetPropertyGVariant(tgt, property);
+                                                  },
+                                                  release_gvariant);
+                             });
+    }
+    catch (const DispatchTimeout &)
+    {
+        throw DBus::Object::Property::Exception(this,
+                                                property,
+                                                "Backend VPN process did not respond");
+    }
+}
+
+
+GVariant *Session::helper_backend_call(const std::string &method,
+                                       GVariant *params,
+                                       const bool ordered) const
+{
+    validate_vpn_backend();
+
+    // The call might complete after this method has given up waiting
+    // for it, so the task must hold its own references
+    auto prx = be_prx;
+    auto tgt = be_target;
+    std::shared_ptr<GVariant> call_params(params ? g_variant_ref(params) : nullptr,
+                                          [](GVariant *p)
+                                          {
+                                              if (p)
+                                              {
+                                                  g_variant_unref(p);
+                                              }
+                                          });
+    auto call = [prx, tgt, method, call_params]()
+    {
+        return prx->Call(tgt, method, call_params.get());
+    };
+
+    try
+    {
+        return dispatcher->Run((ordered ? "" : "unordered:") + GetPath(),
+                               BACKEND_CALL_TIMEOUT,
+                               call,
+                               release_gvariant);
+    }
+    catch (const DispatchTimeout &)
+    {
+        sig_session->LogWarn("Backend VPN process did not respond to "
+                             + method + " - " + GetPath());
+        throw DBus::Object::Method::Exception("Backend VPN process did not respond");
+    }
+}
+
+
 void Session::validate_vpn_backend(const std::string &property) const
 {
     if (!be_prx || !be_target)
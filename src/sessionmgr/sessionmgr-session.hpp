@@ -17,6 +17,8 @@
 #pragma once
 
 #include <mutex>
+#include <set>
+#include <gdbuspp/bus-watcher.hpp>
 #include <gdbuspp/connection.hpp>
 #include <gdbuspp/object/base.hpp>
 #include <gdbuspp/object/manager.hpp>
@@ -28,8 +30,12 @@
 #include "log/logwriter.hpp"
 #include "common/requiresqueue.hpp"
 #include "dbus/signals/attention-required.hpp"
+#include "dbus/signals/statistics-update.hpp"
 #include "dbus/signals/statuschange.hpp"
+#include "backend-property-cache.hpp"
+#include "object-dispatcher.hpp"
 #include "sessionmgr-signals.hpp"
+#include "sessionmgr-summary.hpp"
 
 
 namespace SessionManager {
@@ -54,8 +60,9 @@ class Session : public DBus::Object::Base
   public:
     Session(DBus::Connection::Ptr dbuscon,
             DBus::Object::Manager::Ptr objmgr,
-            DBus::Credentials::Query::Ptr creds_qry,
+            GDBusPP::Credentials::Cache::Ptr creds_qry,
             ::Signals::SessionManagerEvent::Ptr sig_sessionmgr,
+            ObjectDispatcher::Ptr dispatcher,
             const DBus::Object::Path &sespath,
             const uid_t owner,
             const std::string &be_busname,
@@ -114,6 +121,15 @@ class Session : public DBus::Object::Base
     std::string GetBackendBusName() const noexcept;
     Events::Status GetLastEvent() const noexcept;
 
+    /**
+     *  Collects the most commonly used properties of this session.
+     *  Properties provided by the VPN client backend which are not
+     *  available are left empty.
+     *
+     * @return SessionSummary
+     */
+    SessionSummary GetSummary() const noexcept;
+
     bool CheckACL(const std::string &caller) const noexcept;
     uid_t GetOwner() const noexcept;
     void MoveToOwner(const uid_t from_uid, const uid_t to_uid);
@@ -124,11 +140,14 @@ class Session : public DBus::Object::Base
 
   private:
     using LogProxyList = std::map<std::string, LogProxy::Ptr>;
+    using StatsSubscriberList = std::map<std::string, uint32_t>;
+    using StatsWatcherList = std::map<std::string, DBus::BusWatcher::Ptr>;
 
     DBus::Connection::Ptr dbus_conn = nullptr;
     DBus::Object::Manager::Ptr object_mgr = nullptr;
-    DBus::Credentials::Query::Ptr creds_qry = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_qry = nullptr;
     ::Signals::SessionManagerEvent::Ptr sig_sessmgr = nullptr;
+    ObjectDispatcher::Ptr dispatcher = nullptr;
     pid_t backend_pid = -1;
     DBus::Object::Path config_path = {};
     std::string config_name{};
@@ -138,6 +157,17 @@ class Session : public DBus::Object::Base
     DBus::Signals::Emit::Ptr broadcast_emitter = nullptr;
     ::Signals::AttentionRequired::Ptr sig_attreq = nullptr;
     ::Signals::StatusChange::Ptr sig_statuschg = nullptr;
+    ::Signals::StatisticsUpdate::Ptr sig_statsupd = nullptr;
+    StatsSubscriberList stats_subscribers = {};
+    uint32_t stats_interval = 0;
+    std::mutex stats_subscribers_mtx = {};
+
+    /// Removes subscribers which disappear from the bus without
+    /// unsubscribing
+    StatsWatcherList stats_watchers = {};
+
+    /// Watchers which cannot be removed from within their own callback
+    std::set<std::string> expired_stats_watchers = {};
     GDBusPP::Object::Extension::ACL::Ptr object_acl;
     bool restrict_log_access = true;
     LogProxyList log_forwarders = {};
@@ -145,6 +175,7 @@ class Session : public DBus::Object::Base
     std::time_t created = std::time(nullptr);
     DBus::Proxy::Client::Ptr be_prx = nullptr;
     DBus::Proxy::TargetPreset::Ptr be_target = nullptr;
+    BackendPropertyCache::Ptr be_props = BackendPropertyCache::Create();
     DCOstatus dco_status = DCOstatus::UNCHANGED;
     bool dco = false;
 
@@ -233,6 +264,36 @@ class Session : public DBus::Object::Base
      */
     void method_log_forward(DBus::Object::Method::Arguments::Ptr args);
 
+    /**
+     *  D-Bus method: net.openvpn.v3.sessions.StatisticsSubscribe
+     *      Enables StatisticsUpdate signals to the caller of this method.
+     *      These signals are sent by the backend VPN client service at the
+     *      shortest interval requested by all the subscribers, and only
+     *      contains the connection statistics counters which have changed.
+     *      Calling this method again changes the requested interval.
+     *
+     *  Input:   (u)
+     *      u - interval: Requested update interval, in milliseconds
+     *  Output:  (as)
+     *      as - names: Names of the statistics counters, the counters in
+     *                  the StatisticsUpdate signal refers to the index
+     *                  of this list
+     *
+     * @param args  DBus::Object::Method::Arguments
+     */
+    void method_statistics_subscribe(DBus::Object::Method::Arguments::Ptr args);
+
+    /**
+     *  D-Bus method: net.openvpn.v3.sessions.StatisticsUnsubscribe
+     *      Stops the StatisticsUpdate signals to the caller of this method
+     *
+     *  Input:   n/a
+     *  Output:  n/a
+     *
+     * @param args  DBus::Object::Method::Arguments
+     */
+    void method_statistics_unsubscribe(DBus::Object::Method::Arguments::Ptr args);
+
     /**
      *  D-Bus method: net.openvpn.v3.sessions.AccessGrant
      *      Adds a user to the ACL list who can access and manage this
@@ -282,6 +343,71 @@ class Session : public DBus::Object::Base
 
     void helper_stop_log_forwards();
 
+    /**
+     *  Updates the StatisticsUpdate signal targets and the update interval
+     *  in the backend VPN client service to the current list of
+     *  subscribers.  The stats_subscribers_mtx must be held by the caller.
+     *
+     * @param force   bool flag, if true the backend is always asked to
+     *                restart the updates, even if the interval is unchanged
+     *
+     * @return GVariant with the result from the backend
+     *         StatisticsSubscribe call, nullptr if it was not called.
+     */
+    GVariant *helper_update_statistics_subscription(const bool force);
+
+    /**
+     *  Starts watching a statistics subscriber, to remove it if it
+     *  disappears from the bus.  The stats_subscribers_mtx must be held
+     *  by the caller.
+     *
+     * @param subscriber  std::string with the bus name of the subscriber
+     */
+    void helper_watch_statistics_subscriber(const std::string &subscriber);
+
+    /**
+     *  Called when a statistics subscriber has disappeared from the bus
+     *
+     * @param subscriber  std::string with the bus name of the subscriber
+     */
+    void statistics_subscriber_gone(const std::string &subscriber);
+
+    /**
+     *  Retrieves a property from the backend VPN client service, via
+     *  the be_props cache.
+     *
+     * @param property  std::string with the backend property name
+     * @param max_age   std::chrono::milliseconds of the maximum age of
+     *                  a cached value
+     *
+     * @return GVariant with the property value, which the caller
+     *         must release
+     */
+    GVariant *helper_backend_property(const std::string &property,
+                                      const std::chrono::milliseconds max_age) const;
+
+    /**
+     *  Calls a method in the backend VPN client service.  The call is
+     *  run by the ObjectDispatcher, which ensures calls to the same
+     *  backend are done in order while a slow or hanging backend does
+     *  not hold back the other sessions.
+     *
+     * @param method   std::string with the backend method name
+     * @param params   GVariant with the method arguments, may be nullptr.
+     *                 The caller keeps its reference.
+     * @param ordered  bool, if false the call is not queued after the
+     *                 other calls to this backend.  Used for calls which
+     *                 must pass a hanging backend call, like Ping.
+     *
+     * @return GVariant with the result from the backend
+     *
+     * @throws DBus::Object::Method::Exception if the backend did not
+     *         respond in time, or any exception from the backend call
+     */
+    GVariant *helper_backend_call(const std::string &method,
+                                  GVariant *params = nullptr,
+                                  const bool ordered = true) const;
+
     void validate_vpn_backend(const std::string &property = "") const;
 };
 
@@ -0,0 +1,75 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-summary.cpp
+ *
+ * @brief  Implementation of the SessionManager::SessionSummary class
+ */
+
+#include <gio/gio.h>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include "sessionmgr-summary.hpp"
+#include "sessionmgr-exceptions.hpp"
+
+
+namespace SessionManager {
+
+SessionSummary::SessionSummary(GVariant *record)
+{
+    if (nullptr == record
+        || std::string(DBusType()) != g_variant_get_type_string(record))
+    {
+        throw SessionManager::Exception("Invalid data type for SessionManager::SessionSummary()");
+    }
+
+    path = glib2::Value::Extract<std::string>(record, 0);
+    config_path = glib2::Value::Extract<std::string>(record, 1);
+    config_name = glib2::Value::Extract<std::string>(record, 2);
+    session_created = glib2::Value::Extract<uint64_t>(record, 3);
+    owner = glib2::Value::Extract<uid_t>(record, 4);
+    backend_pid = glib2::Value::Extract<uint32_t>(record, 5);
+
+    GVariant *st = g_variant_get_child_value(record, 6);
+    status = Events::Status(st);
+    g_variant_unref(st);
+
+    device_name = glib2::Value::Extract<std::string>(record, 7);
+    session_name = glib2::Value::Extract<std::string>(record, 8);
+    protocol = glib2::Value::Extract<std::string>(record, 9);
+    server_ip = glib2::Value::Extract<std::string>(record, 10);
+    server_port = glib2::Value::Extract<uint32_t>(record, 11);
+}
+
+
+GVariant *SessionSummary::GetGVariant() const
+{
+    GVariantBuilder *b = glib2::Builder::Create(DBusType());
+    glib2::Builder::Add(b, path, "o");
+    glib2::Builder::Add(b, config_path, "o");
+    glib2::Builder::Add(b, config_name);
+    glib2::Builder::Add(b, static_cast<uint64_t>(session_created));
+    glib2::Builder::Add(b, static_cast<uint32_t>(owner));
+    glib2::Builder::Add(b, backend_pid);
+    glib2::Builder::Add(b, status.GetGVariantTuple());
+    glib2::Builder::Add(b, device_name);
+    glib2::Builder::Add(b, session_name);
+    glib2::Builder::Add(b, protocol);
+    glib2::Builder::Add(b, server_ip);
+    glib2::Builder::Add(b, server_port);
+    return glib2::Builder::Finish(b);
+}
+
+
+const char *SessionSummary::DBusType() noexcept
+{
+    return "(oostuu(uus)ssssu)";
+}
+
+} // namespace SessionManager
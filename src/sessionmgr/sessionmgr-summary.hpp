@@ -0,0 +1,110 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-summary.hpp
+ *
+ * @brief  Definition of the SessionManager::SessionSummary class, which
+ *         maps to a single record in the FetchSessionsSummary response
+ *         from the main net.openvpn.v3.sessions object.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include "events/status.hpp"
+
+
+namespace SessionManager {
+
+/**
+ *  Summary of the most commonly used session properties, collected
+ *  by the session manager in a single operation.
+ */
+class SessionSummary
+{
+  public:
+    using List = std::vector<SessionSummary>;
+
+    /**
+     *   Initialize an empty SessionManager::SessionSummary object
+     */
+    SessionSummary() = default;
+    ~SessionSummary() = default;
+
+    /**
+     *  Initialize a new SessionManager::SessionSummary from a D-Bus
+     *  GVariant object, as provided by GetGVariant()
+     *
+     * @param record  GVariant pointer to the summary record to parse
+     *
+     * @throws SessionManager::Exception if the data type is invalid
+     */
+    SessionSummary(GVariant *record);
+
+
+    /**
+     *  Retrieve a prepared Glib2 GVariant object with the content of
+     *  this object, using the data type returned by DBusType()
+     *
+     * @return  Returns a pointer to a new GVariant object
+     */
+    GVariant *GetGVariant() const;
+
+
+    /**
+     *  Get the D-Bus data type of a single summary record
+     *
+     * @return  const char * with the D-Bus data type
+     */
+    static const char *DBusType() noexcept;
+
+
+    /// D-Bus path to the session object
+    std::string path = "";
+
+    /// D-Bus path to the configuration profile used by the session
+    std::string config_path = "";
+
+    /// Configuration profile name used when starting the session
+    std::string config_name = "";
+
+    /// Timestamp when the session was created
+    std::time_t session_created = 0;
+
+    /// uid_t of the owner of the session
+    uid_t owner = 65535;
+
+    /// PID of the VPN client backend process; 0 if not available
+    uint32_t backend_pid = 0;
+
+    /// The last status change of the session
+    Events::Status status = {};
+
+    /// Name of the virtual network interface, empty if not configured
+    std::string device_name = "";
+
+    /// Session name assigned by the VPN server
+    std::string session_name = "";
+
+    /// Protocol used by the connection, udp/tcp, udp-dco/tcp-dco
+    std::string protocol = "";
+
+    /// IP address of the VPN server the client is connected to
+    std::string server_ip = "";
+
+    /// UDP/TCP port the client is connected to
+    uint32_t server_port = 0;
+};
+
+} // namespace SessionManager
@@ -45,31 +45,36 @@ NewTunnelQueue::~NewTunnelQueue()
 
 
 NewTunnelQueue::Ptr NewTunnelQueue::Create(DBus::Connection::Ptr dbuscon,
-                                           DBus::Credentials::Query::Ptr creds_qry,
+                                           GDBusPP::Credentials::Cache::Ptr creds_qry,
                                            DBus::Object::Manager::Ptr objmgr,
                                            LogWriter::Ptr logwr,
                                            SessionManager::Log::Ptr sig_log,
-                                           ::Signals::SessionManagerEvent::Ptr sesmgrev)
+                                           ::Signals::SessionManagerEvent::Ptr sesmgrev,
+                                           ObjectDispatcher::Ptr dispatcher)
 {
     return NewTunnelQueue::Ptr(new NewTunnelQueue(dbuscon,
                                                   creds_qry,
                                                   objmgr,
                                                   logwr,
                                                   sig_log,
-                                                  sesmgrev));
+                                                  sesmgrev,
+                                                  dispatcher));
 }
 
 
 NewTunnelQueue::NewTunnelQueue(DBus::Connection::Ptr dbuscon_,
-                               DBus::Credentials::Query::Ptr creds_qry_,
+                               GDBusPP::Credentials::Cache::Ptr creds_qry_,
                                DBus::Object::Manager::Ptr objmgr,
                                LogWriter::Ptr logwr_,
                                SessionManager::Log::Ptr sig_log,
-                               ::Signals::SessionManagerEvent::Ptr sesmgrev)
+                               ::Signals::SessionManagerEvent::Ptr sesmgrev,
+                               ObjectDispatcher::Ptr dispatcher_)
     : dbuscon(dbuscon_), creds_qry(creds_qry_), object_mgr(objmgr), logwr(logwr_),
-      log(sig_log), sesmgr_event(sesmgrev)
+      log(sig_log), sesmgr_event(sesmgrev), dispatcher(dispatcher_)
 {
     be_prxqry = DBus::Proxy::Utils::DBusServiceQuery::Create(dbuscon);
+    be_presence = GDBusPP::Proxy::Utils::ObjectPresence::Create(dbuscon,
+                                                                Constants::GenServiceName("backends"));
 
     signal_subscr = DBus::Signals::SubscriptionManager::Create(dbuscon);
     subscr_target = DBus::Signals::Target::Create("",
@@ -94,6 +99,7 @@ const DBus::Object::Path NewTunnelQueue::AddTunnel(const std::string &config_pat
                                                    const uid_t owner,
                                                    const std::optional<std::string> &existing_session_path)
 {
+    std::string new_session_path;
     try
     {
         // Create a session token and prepare a tunnel record keeping
@@ -103,6 +109,14 @@ const DBus::Object::Path NewTunnelQueue::AddTunnel(const std::string &config_pat
         auto trq = TunnelRecord::Create(config_path, owner, existing_session_path);
 
         queue[session_token] = trq;
+        if (!existing_session_path)
+        {
+            // Track the registration before the backend is started, so
+            // it cannot complete before it can be waited for
+            std::lock_guard<std::mutex> lg(registration_mtx);
+            registrations[trq->session_path] = false;
+            new_session_path = trq->session_path;
+        }
 
         // Request the backend VPN client process to be started.
         if (!be_prxqry->CheckServiceAvail(Constants::GenInterface("backends")))
@@ -112,10 +126,12 @@ const DBus::Object::Path NewTunnelQueue::AddTunnel(const std::string &config_pat
         }
         auto be_start = DBus::Proxy::Client::Create(dbuscon,
                                                     Constants::GenServiceName("backends"));
-        usleep(100000);
-        auto be_qry = DBus::Proxy::Utils::Query::Create(be_start);
-        (void)be_qry->CheckObjectExists(Constants::GenPath("backends"),
-                                        Constants::GenInterface("backends"));
+
+        // If the backend starter service was just activated, give it a
+        // moment to settle.  Once its main object has been seen, this
+        // is just a local lookup until the service is restarted.
+        (void)be_presence->WaitForObject(Constants::GenPath("backends"),
+                                         std::chrono::milliseconds(750));
 
         GVariant *r = be_start->Call(Constants::GenPath("backends"),
                                      Constants::GenInterface("backends"),
@@ -128,6 +144,11 @@ const DBus::Object::Path NewTunnelQueue::AddTunnel(const std::string &config_pat
     }
     catch (const DBus::Exception &excp)
     {
+        if (!new_session_path.empty())
+        {
+            std::lock_guard<std::mutex> lg(registration_mtx);
+            registrations.erase(new_session_path);
+        }
         log->Debug("EXCEPTION [" + std::string(__func__) + "]: "
                    + std::string(excp.what()));
         throw DBus::Exception(__func__,
@@ -136,9 +157,38 @@ const DBus::Object::Path NewTunnelQueue::AddTunnel(const std::string &config_pat
 }
 
 
+bool NewTunnelQueue::WaitForRegistration(const DBus::Object::Path &session_path,
+                                         const std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(registration_mtx);
+    bool done = registration_cv.wait_for(lock,
+                                         timeout,
+                                         [this, &session_path]()
+                                         {
+                                             auto it = registrations.find(session_path);
+                                             return it == registrations.end() || it->second;
+                                         });
+    registrations.erase(session_path);
+    return done;
+}
+
+
+void NewTunnelQueue::registration_done(const std::string &session_path)
+{
+    std::lock_guard<std::mutex> lg(registration_mtx);
+    auto it = registrations.find(session_path);
+    if (it != registrations.end())
+    {
+        it->second = true;
+        registration_cv.notify_all();
+    }
+}
+
+
 void NewTunnelQueue::process_registration(DBus::Signals::Event::Ptr event)
 {
     // std::cerr << __func__ << ":: " << event << std::endl;
+    std::string session_path;
     try
     {
         glib2::Utils::checkParams(__func__, event->params, "(ssi)");
@@ -157,6 +207,7 @@ void NewTunnelQueue::process_registration(DBus::Signals::Event::Ptr event)
         }
         // Get access to the TunnelRecord object
         auto tunnel = rec.mapped();
+        session_path = tunnel->session_path;
 
         log->Debug("RegistrationRequest: busname=" + busn
                    + ", session_token=" + sesstok
@@ -208,6 +259,7 @@ void NewTunnelQueue::process_registration(DBus::Signals::Event::Ptr event)
                                                         object_mgr,
                                                         creds_qry,
                                                         sesmgr_event,
+                                                        dispatcher,
                                                         tunnel->session_path,
                                                         tunnel->owner,
                                                         busn,
@@ -280,6 +332,7 @@ void NewTunnelQueue::process_registration(DBus::Signals::Event::Ptr event)
             be_client->Call(be_target, "ForceShutdown", nullptr, true);
             object_mgr->RemoveObject(session->GetPath());
         }
+        registration_done(tunnel->session_path);
 
         if (!restart.empty())
         {
@@ -398,10 +451,12 @@ void NewTunnelQueue::process_registration(DBus::Signals::Event::Ptr event)
     catch (const DBus::Exception &excp)
     {
         log->LogCritical("DBus::Exception - " + std::string(excp.GetRawError()));
+        registration_done(session_path);
     }
     catch (const std::exception &e)
     {
         log->LogCritical("EXCEPTION: " + std::string(e.what()));
+        registration_done(session_path);
     }
 }
 
@@ -19,19 +19,24 @@
 #pragma once
 
 #include <asio.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <ctime>
 #include <future>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <gdbuspp/bus-watcher.hpp>
 #include <gdbuspp/connection.hpp>
-#include <gdbuspp/credentials/query.hpp>
 #include <gdbuspp/object/manager.hpp>
 #include <gdbuspp/object/path.hpp>
 
 #include "dbus/constants.hpp"
+#include "dbus/credentials-cache.hpp"
 #include "dbus/path.hpp"
+#include "dbus/support-functions.hpp"
+#include "object-dispatcher.hpp"
 #include "sessionmgr-signals.hpp"
 
 
@@ -94,11 +99,12 @@ class NewTunnelQueue
     ~NewTunnelQueue();
 
     [[nodiscard]] static NewTunnelQueue::Ptr Create(DBus::Connection::Ptr dbuscon,
-                                                    DBus::Credentials::Query::Ptr creds_qry,
+                                                    GDBusPP::Credentials::Cache::Ptr creds_qry,
                                                     DBus::Object::Manager::Ptr objmgr,
                                                     LogWriter::Ptr logwr,
                                                     SessionManager::Log::Ptr sig_log,
-                                                    ::Signals::SessionManagerEvent::Ptr sesmgrev);
+                                                    ::Signals::SessionManagerEvent::Ptr sesmgrev,
+                                                    ObjectDispatcher::Ptr dispatcher);
 
     /**
      *  Enqueues a new tunnel request to the queue
@@ -118,17 +124,36 @@ class NewTunnelQueue
                                        const uid_t owner,
                                        const std::optional<std::string> &existing_session_path = std::nullopt);
 
+    /**
+     *  Waits for the backend VPN client process of a new tunnel to
+     *  complete its registration.  Only new tunnels, where AddTunnel()
+     *  was called without an existing session path, can be waited for.
+     *
+     * @param session_path  DBus::Object::Path returned by AddTunnel()
+     * @param timeout       Maximum time to wait for the registration
+     * @return true if the registration was processed, false on timeout.
+     *         A processed registration may still have failed, in which
+     *         case the session object has been removed again.
+     */
+    bool WaitForRegistration(const DBus::Object::Path &session_path,
+                             const std::chrono::milliseconds timeout);
+
   private:
     DBus::Connection::Ptr dbuscon = nullptr;
-    DBus::Credentials::Query::Ptr creds_qry = nullptr;
+    GDBusPP::Credentials::Cache::Ptr creds_qry = nullptr;
     DBus::Object::Manager::Ptr object_mgr = nullptr;
     LogWriter::Ptr logwr = nullptr;
     SessionManager::Log::Ptr log = nullptr;
     ::Signals::SessionManagerEvent::Ptr sesmgr_event = nullptr;
+    ObjectDispatcher::Ptr dispatcher = nullptr;
     DBus::Proxy::Utils::DBusServiceQuery::Ptr be_prxqry = nullptr;
+    GDBusPP::Proxy::Utils::ObjectPresence::Ptr be_presence = nullptr;
     DBus::Signals::SubscriptionManager::Ptr signal_subscr = nullptr;
     DBus::Signals::Target::Ptr subscr_target = nullptr;
     QueuedTunnels queue{};
+    std::mutex registration_mtx;
+    std::condition_variable registration_cv;
+    std::map<std::string, bool> registrations;
     std::map<std::string, DBus::BusWatcher::Ptr> backend_watchers;
     std::set<std::string> expired_backend_watchers;
     asio::io_context io_context;
@@ -150,13 +175,22 @@ class NewTunnelQueue
      */
     void process_registration(DBus::Signals::Event::Ptr event);
 
+    /**
+     *  Marks the registration of a new tunnel as processed and wakes up
+     *  WaitForRegistration() callers.
+     *
+     * @param session_path  std::string with the session path of the tunnel
+     */
+    void registration_done(const std::string &session_path);
+
 
     NewTunnelQueue(DBus::Connection::Ptr dbuscon,
-                   DBus::Credentials::Query::Ptr creds_qry,
+                   GDBusPP::Credentials::Cache::Ptr creds_qry,
                    DBus::Object::Manager::Ptr objmgr,
                    LogWriter::Ptr logwr,
                    SessionManager::Log::Ptr sig_log,
-                   ::Signals::SessionManagerEvent::Ptr sesmgrev);
+                   ::Signals::SessionManagerEvent::Ptr sesmgrev,
+                   ObjectDispatcher::Ptr dispatcher);
 };
 
 } // namespace SessionManager
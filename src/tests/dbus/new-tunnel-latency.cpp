@@ -0,0 +1,164 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   new-tunnel-latency.cpp
+ *
+ * @brief  Benchmark measuring how long it takes from calling NewTunnel()
+ *         in the session manager until the session has been created,
+ *         and until the session reports it is connected.
+ *
+ *         The configuration profile must not require any user input.
+ *         Use it with a server running on the same host (see
+ *         src/tests/stress/server.conf) to measure the overhead in the
+ *         OpenVPN 3 Linux services instead of the network.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gdbuspp/connection.hpp>
+#include <gdbuspp/mainloop.hpp>
+
+#include "sessionmgr/proxy-sessionmgr.hpp"
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ *  Waits for the session to reach a specific state.  The status is
+ *  polled with a short interval, which limits the resolution of the
+ *  measurements to about 5ms.
+ *
+ * @param session  SessionManager::Proxy::Session to check
+ * @param minor    StatusMinor the session must reach
+ * @param timeout  Maximum time to wait
+ *
+ * @throws std::runtime_error if the connection failed or timed out
+ */
+static void wait_for_status(SessionManager::Proxy::Session::Ptr session,
+                            const StatusMinor minor,
+                            const std::chrono::seconds timeout)
+{
+    const auto deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline)
+    {
+        Events::Status status = session->GetLastStatus();
+        if (status.minor == minor)
+        {
+            return;
+        }
+        if (status.minor == StatusMinor::CONN_FAILED
+            || status.minor == StatusMinor::CONN_AUTH_FAILED
+            || status.minor == StatusMinor::CFG_REQUIRE_USER)
+        {
+            std::ostringstream err;
+            err << "Connection failed: " << status;
+            throw std::runtime_error(err.str());
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+    throw std::runtime_error("Timeout waiting for the session status");
+}
+
+
+static void print_summary(const std::string &label,
+                          const std::vector<double> &results)
+{
+    auto [min, max] = std::minmax_element(results.begin(), results.end());
+    double avg = std::accumulate(results.begin(), results.end(), 0.0)
+                 / results.size();
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << std::left << std::setw(28) << label
+              << " min: " << *min << " ms"
+              << "  avg: " << avg << " ms"
+              << "  max: " << *max << " ms"
+              << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " <configuration object path> [iterations]"
+                  << std::endl;
+        return 1;
+    }
+    const DBus::Object::Path cfgpath = argv[1];
+    const int iterations = (argc == 3 ? std::stoi(argv[2]) : 10);
+
+    // The session manager proxy depends on D-Bus signals, which
+    // requires a running main loop
+    auto mainloop = DBus::MainLoop::Create();
+    auto async_ml = std::async(std::launch::async,
+                               [&mainloop]()
+                               {
+                                   mainloop->Run();
+                               });
+
+    std::vector<double> created;
+    std::vector<double> connected;
+    int ret = 0;
+    try
+    {
+        auto conn = DBus::Connection::Create(DBus::BusType::SYSTEM);
+        auto sessmgr = SessionManager::Proxy::Manager::Create(conn);
+
+        for (int i = 1; i <= iterations; i++)
+        {
+            auto start = Clock::now();
+            auto session = sessmgr->NewTunnel(cfgpath);
+            auto t_created = Clock::now();
+
+            session->Ready();
+            session->Connect();
+            wait_for_status(session, StatusMinor::CONN_CONNECTED, 30s);
+            auto t_connected = Clock::now();
+
+            created.push_back(std::chrono::duration<double, std::milli>(t_created - start).count());
+            connected.push_back(std::chrono::duration<double, std::milli>(t_connected - start).count());
+            std::cout << std::fixed << std::setprecision(1)
+                      << "[" << i << "/" << iterations << "] "
+                      << "NewTunnel: " << created.back() << " ms, "
+                      << "connected: " << connected.back() << " ms"
+                      << std::endl;
+
+            // Wait for the session to be removed, to be able to start
+            // a new session with the same configuration profile
+            session->Disconnect();
+            const auto deadline = Clock::now() + 10s;
+            while (session->CheckSessionExists() && Clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(10ms);
+            }
+        }
+
+        std::cout << std::endl
+                  << "Results of " << created.size() << " sessions:"
+                  << std::endl;
+        print_summary("NewTunnel -> session ready", created);
+        print_summary("NewTunnel -> CONN_CONNECTED", connected);
+    }
+    catch (const std::exception &err)
+    {
+        std::cout << "** ERROR ** " << err.what() << std::endl;
+        ret = 2;
+    }
+    mainloop->Stop();
+    return ret;
+}
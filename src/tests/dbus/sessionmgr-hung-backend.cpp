@@ -0,0 +1,197 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-hung-backend.cpp
+ *
+ * @brief  Stress test checking that a hanging VPN backend client process
+ *         does not affect how fast the session manager responds to
+ *         requests for other sessions.
+ *
+ *         This starts a number of sessions, reads session properties
+ *         and measures the response times.  Then the backend process of
+ *         the first session is stopped with SIGSTOP and the response
+ *         times for the other sessions are measured again.
+ *
+ *         The backend processes run as a different user, so this must
+ *         be run as root to be able to stop them.  The configuration
+ *         profiles must not require any user input.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gdbuspp/connection.hpp>
+#include <gdbuspp/mainloop.hpp>
+
+#include "sessionmgr/proxy-sessionmgr.hpp"
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+
+static void print_summary(const std::string &label,
+                          const std::vector<double> &results)
+{
+    if (results.empty())
+    {
+        std::cout << "  " << std::left << std::setw(28) << label
+                  << " no results" << std::endl;
+        return;
+    }
+    auto [min, max] = std::minmax_element(results.begin(), results.end());
+    double avg = std::accumulate(results.begin(), results.end(), 0.0)
+                 / results.size();
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << std::left << std::setw(28) << label
+              << " min: " << *min << " ms"
+              << "  avg: " << avg << " ms"
+              << "  max: " << *max << " ms"
+              << std::endl;
+}
+
+
+/**
+ *  Reads the status and device name properties of the sessions a
+ *  number of times, and measures how long each read takes
+ *
+ * @param sessions    Sessions to read the properties from
+ * @param iterations  How many times to read the properties
+ *
+ * @return std::vector<double> with the response times in milliseconds
+ */
+static std::vector<double> measure(const SessionManager::Proxy::Session::List &sessions,
+                                   const int iterations)
+{
+    std::vector<double> results;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (const auto &session : sessions)
+        {
+            auto start = Clock::now();
+            try
+            {
+                (void)session->GetLastStatus();
+                (void)session->GetDeviceName();
+            }
+            catch (const DBus::Exception &excp)
+            {
+                std::cout << "** WARNING ** " << session->GetPath()
+                          << ": " << excp.GetRawError() << std::endl;
+            }
+            results.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+    }
+    return results;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " <iterations> <configuration object path> "
+                  << "<configuration object path> [...]"
+                  << std::endl;
+        return 1;
+    }
+    const int iterations = std::stoi(argv[1]);
+
+    // The session manager proxy depends on D-Bus signals, which
+    // requires a running main loop
+    auto mainloop = DBus::MainLoop::Create();
+    auto async_ml = std::async(std::launch::async,
+                               [&mainloop]()
+                               {
+                                   mainloop->Run();
+                               });
+
+    SessionManager::Proxy::Session::List sessions;
+    pid_t hung_pid = -1;
+    int ret = 0;
+    try
+    {
+        auto conn = DBus::Connection::Create(DBus::BusType::SYSTEM);
+        auto sessmgr = SessionManager::Proxy::Manager::Create(conn);
+
+        for (int i = 2; i < argc; i++)
+        {
+            auto session = sessmgr->NewTunnel(argv[i]);
+            session->Ready();
+            session->Connect();
+            sessions.push_back(session);
+            std::cout << "Started session " << session->GetPath() << std::endl;
+        }
+        // Let the connections settle
+        std::this_thread::sleep_for(5s);
+
+        SessionManager::Proxy::Session::List others(sessions.begin() + 1,
+                                                     sessions.end());
+        auto before = measure(others, iterations);
+
+        hung_pid = sessions[0]->GetBackendPid();
+        std::cout << "Stopping backend process " << hung_pid
+                  << " of " << sessions[0]->GetPath() << std::endl;
+        if (0 != kill(hung_pid, SIGSTOP))
+        {
+            throw std::runtime_error("Could not stop the backend process");
+        }
+
+        // Requests towards the hanging backend, which will time out
+        // in the session manager
+        auto hung_reader = std::async(std::launch::async,
+                                      [&sessions, iterations]()
+                                      {
+                                          SessionManager::Proxy::Session::List hung{sessions[0]};
+                                          return measure(hung, std::max(1, iterations / 10));
+                                      });
+        std::this_thread::sleep_for(100ms);
+        auto during = measure(others, iterations);
+
+        kill(hung_pid, SIGCONT);
+        hung_pid = -1;
+        auto hung = hung_reader.get();
+
+        std::cout << std::endl
+                  << "Response times reading session properties:"
+                  << std::endl;
+        print_summary("Other sessions, before", before);
+        print_summary("Other sessions, backend hung", during);
+        print_summary("Hanging session", hung);
+    }
+    catch (const std::exception &err)
+    {
+        std::cout << "** ERROR ** " << err.what() << std::endl;
+        ret = 2;
+    }
+
+    if (hung_pid > 0)
+    {
+        kill(hung_pid, SIGCONT);
+    }
+    for (const auto &session : sessions)
+    {
+        try
+        {
+            session->Disconnect();
+        }
+        catch (const DBus::Exception &)
+        {
+        }
+    }
+    mainloop->Stop();
+    return ret;
+}
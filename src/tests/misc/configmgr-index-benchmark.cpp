@@ -0,0 +1,303 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   configmgr-index-benchmark.cpp
+ *
+ * @brief  Micro-benchmark comparing the configuration manager lookup
+ *         index against a linear scan of all configuration objects,
+ *         like LookupConfigName, SearchByTag and SearchByOwner used to do.
+ *
+ *         Usage: configmgr-index-benchmark [NUM_PROFILES [NUM_LOOKUPS]]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "configmgr/configmgr-index.hpp"
+
+
+/**
+ *  Stand-in for the DBus::Object::Base objects kept by the object manager
+ */
+class FakeObjectBase
+{
+  public:
+    virtual ~FakeObjectBase() = default;
+};
+
+
+/**
+ *  Minimal stand-in for ConfigManager::Configuration, providing what
+ *  ConfigurationIndex needs
+ */
+class FakeConfiguration : public FakeObjectBase
+{
+  public:
+    using Ptr = std::shared_ptr<FakeConfiguration>;
+
+    FakeConfiguration(const std::string &path,
+                      const std::string &name,
+                      uid_t owner,
+                      std::vector<std::string> tags)
+        : path_(path), name_(name), owner_(owner), tags_(std::move(tags))
+    {
+    }
+
+    std::string GetPath() const
+    {
+        return path_;
+    }
+
+    std::string GetName() const
+    {
+        return name_;
+    }
+
+    uid_t GetOwnerUID() const
+    {
+        return owner_;
+    }
+
+    const std::vector<std::string> &GetTags() const
+    {
+        return tags_;
+    }
+
+    bool CheckForTag(const std::string &tag) const
+    {
+        return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
+    }
+
+  private:
+    std::string path_;
+    std::string name_;
+    uid_t owner_;
+    std::vector<std::string> tags_;
+};
+
+using Index = ConfigManager::ConfigurationIndex<FakeConfiguration>;
+using Collection = std::vector<FakeConfiguration::Ptr>;
+using ObjectMap = std::map<std::string, std::shared_ptr<FakeObjectBase>>;
+
+
+/**
+ *  Mimics the old ConfigHandler::helper_retrieve_configs() implementation,
+ *  walking through all objects of the object manager.  The real
+ *  implementation also did an ACL check on every object before
+ *  the filter was evaluated, which is not accounted for here.
+ */
+static Collection linear_scan(const ObjectMap &all,
+                              std::function<bool(const FakeConfiguration::Ptr &)> filter)
+{
+    Collection result;
+    for (const auto &[path, object] : all)
+    {
+        auto cfg = std::dynamic_pointer_cast<FakeConfiguration>(object);
+        if (cfg && filter(cfg))
+        {
+            result.push_back(cfg);
+        }
+    }
+    return result;
+}
+
+
+/**
+ *  Compares the result of a linear scan and an index lookup
+ */
+static bool same_result(const Collection &expect, const Index::ObjectList &got)
+{
+    if (expect.size() != got.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < expect.size(); ++i)
+    {
+        if (expect[i]->GetPath() != got[i]->GetPath())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+template <typename FUNC>
+static double run_timed(const std::string &label, unsigned int lookups, FUNC &&func)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    for (unsigned int i = 0; i < lookups; ++i)
+    {
+        matches += func(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double usec = std::chrono::duration<double, std::micro>(end - start).count() / lookups;
+    std::cout << "  " << std::left << std::setw(28) << label
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3)
+              << usec << " us/lookup"
+              << "   (" << matches << " matches)" << std::endl;
+    return usec;
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned int num_profiles = (argc > 1 ? std::atoi(argv[1]) : 5000);
+    unsigned int num_lookups = (argc > 2 ? std::atoi(argv[2]) : 2000);
+    if (num_profiles < 1 || num_lookups < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [NUM_PROFILES [NUM_LOOKUPS]]" << std::endl;
+        return 2;
+    }
+
+    // Prepare a set of profiles spread across 50 owners,
+    // 100 tags and with 10 profiles sharing the same name
+    ObjectMap all;
+    Collection profiles;
+    auto index = Index::Create();
+    for (unsigned int i = 0; i < num_profiles; ++i)
+    {
+        auto cfg = std::make_shared<FakeConfiguration>(
+            "/net/openvpn/v3/configuration/cfg" + std::to_string(i),
+            "profile-" + std::to_string(i / 10),
+            1000 + (i % 50),
+            std::vector<std::string>{"tag-" + std::to_string(i % 100),
+                                     "common"});
+        all[cfg->GetPath()] = cfg;
+        profiles.push_back(cfg);
+        index->Add(cfg);
+    }
+
+    std::cout << ">> " << num_profiles << " profiles, "
+              << num_lookups << " lookups per test" << std::endl;
+
+    // Ensure the index gives the same result as the linear scan,
+    // including the ordering of the D-Bus paths
+    bool result_ok = true;
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        std::string name = "profile-" + std::to_string(i);
+        std::string tag = "tag-" + std::to_string(i);
+        uid_t owner = 1000 + (i % 50);
+
+        result_ok &= same_result(linear_scan(all,
+                                             [&name](const FakeConfiguration::Ptr &c)
+                                             {
+                                                 return c->GetName() == name;
+                                             }),
+                                 index->LookupName(name));
+        result_ok &= same_result(linear_scan(all,
+                                             [&tag](const FakeConfiguration::Ptr &c)
+                                             {
+                                                 return c->CheckForTag(tag);
+                                             }),
+                                 index->LookupTag(tag));
+        result_ok &= same_result(linear_scan(all,
+                                             [owner](const FakeConfiguration::Ptr &c)
+                                             {
+                                                 return c->GetOwnerUID() == owner;
+                                             }),
+                                 index->LookupOwner(owner));
+    }
+
+    std::cout << "LookupConfigName:" << std::endl;
+    double lin = run_timed("linear scan",
+                           num_lookups,
+                           [&](unsigned int i)
+                           {
+                               std::string name = "profile-" + std::to_string(i % (num_profiles / 10 + 1));
+                               return linear_scan(all,
+                                                  [&name](const FakeConfiguration::Ptr &c)
+                                                  {
+                                                      return c->GetName() == name;
+                                                  })
+                                   .size();
+                           });
+    double idx = run_timed("index",
+                           num_lookups,
+                           [&](unsigned int i)
+                           {
+                               std::string name = "profile-" + std::to_string(i % (num_profiles / 10 + 1));
+                               return index->LookupName(name).size();
+                           });
+    std::cout << "  speed-up: " << std::setprecision(1) << (lin / idx) << "x" << std::endl;
+
+    std::cout << "SearchByTag:" << std::endl;
+    lin = run_timed("linear scan",
+                    num_lookups,
+                    [&](unsigned int i)
+                    {
+                        std::string tag = "tag-" + std::to_string(i % 100);
+                        return linear_scan(all,
+                                           [&tag](const FakeConfiguration::Ptr &c)
+                                           {
+                                               return c->CheckForTag(tag);
+                                           })
+                            .size();
+                    });
+    idx = run_timed("index",
+                    num_lookups,
+                    [&](unsigned int i)
+                    {
+                        std::string tag = "tag-" + std::to_string(i % 100);
+                        return index->LookupTag(tag).size();
+                    });
+    std::cout << "  speed-up: " << std::setprecision(1) << (lin / idx) << "x" << std::endl;
+
+    std::cout << "SearchByOwner:" << std::endl;
+    lin = run_timed("linear scan",
+                    num_lookups,
+                    [&](unsigned int i)
+                    {
+                        uid_t owner = 1000 + (i % 50);
+                        return linear_scan(all,
+                                           [owner](const FakeConfiguration::Ptr &c)
+                                           {
+                                               return c->GetOwnerUID() == owner;
+                                           })
+                            .size();
+                    });
+    idx = run_timed("index",
+                    num_lookups,
+                    [&](unsigned int i)
+                    {
+                        uid_t owner = 1000 + (i % 50);
+                        return index->LookupOwner(owner).size();
+                    });
+    std::cout << "  speed-up: " << std::setprecision(1) << (lin / idx) << "x" << std::endl;
+
+    // Check that index updates are reflected in the lookups
+    index->Update(profiles[0]->GetPath(), "renamed", 0, {"moved"});
+    if (index->LookupName("renamed").size() != 1
+        || index->LookupTag("moved").size() != 1
+        || index->LookupOwner(0).size() != 1
+        || index->LookupTag("common").size() != num_profiles - 1)
+    {
+        result_ok = false;
+    }
+    index->Remove(profiles[0]->GetPath());
+    if (index->LookupName("renamed").size() != 0
+        || index->Size() != num_profiles - 1)
+    {
+        result_ok = false;
+    }
+
+    std::cout << "** Result: " << (result_ok ? "All tests passed" : "FAIL") << std::endl;
+    return (result_ok ? 0 : 1);
+}
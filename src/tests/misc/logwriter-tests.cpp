@@ -10,16 +10,36 @@
  * @file   logwriter-tests.cpp
  *
  * @brief  Simple independent unit test for the LogWriter interfaces.
+ *
+ *         When started with --benchmark, it will instead measure the
+ *         throughput of the FileLogWriter and JournaldWriter in
+ *         lines/sec, both writing one log line at a time and in
+ *         batching mode.
  */
 
+#include "build-config.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <string>
 #include <unistd.h>
 
-#include "config.h"
 #include "log/ansicolours.hpp"
 #include "log/logwriter.hpp"
 #include "log/logwriters/implementations.hpp"
 
+#ifdef HAVE_SYSTEMD
+#include <sys/uio.h>
+#define SD_JOURNAL_SUPPRESS_LOCATION
+#include <systemd/sd-journal.h>
+#endif
+
+
 /**
  *  Tests the Write(std::string) method of the LogWriter implementation.
  *  This test will also toggle the timestamp off and on and write
@@ -40,8 +60,6 @@ void run_test_1(LogWriter &w)
     w.EnableTimestamp(false);
     w.Write("Log line 4 - without timestamp");
     w.EnableTimestamp(true);
-    w.AddMeta("prepend", " [PREPENDED] ", true);
-    w.PrependMeta("prepend");
     w.Write("Log line 5 - with timestamp again");
 }
 
@@ -60,11 +78,6 @@ void run_test_2(LogWriter &w)
     {
         for (int catg = 1; catg < 9; catg++)
         {
-            if ((catg % 3) == 0)
-            {
-                w.AddMeta("prepend", "!! ---> Prepended data <--- ", true);
-                w.PrependMeta("prepend", true);
-            }
             w.Write((LogGroup)group,
                     (LogCategory)catg,
                     std::string("LogGroup/LogCategory test line: ") + std::to_string(group) + ":" + std::to_string(catg));
@@ -74,7 +87,7 @@ void run_test_2(LogWriter &w)
 
 
 /**
- *  Tests the Write(LogEvent(...)) method and will
+ *  Tests the Write(Events::Log(...)) method and will
  *  run a two loops ensuring all valid combinations of LogGroup and
  *  LogCategory are tested.
  *
@@ -87,21 +100,15 @@ void run_test_3(LogWriter &w)
     {
         for (int catg = 1; catg < 9; catg++)
         {
-            if ((catg % 3) == 0)
-            {
-                std::stringstream s;
-                s << "!! ---> Prepended data <--- "
-                  << ((catg % 2) == 0 ? "[with meta prepend] " : "");
-                w.AddMeta("prepend", s.str(), true);
-                w.PrependMeta("prepend", (catg % 2) == 0);
-            }
-            LogEvent ev((LogGroup)group,
-                        (LogCategory)catg,
-                        std::string("LogEvent() test line: ")
+            Events::Log ev((LogGroup)group,
+                           (LogCategory)catg,
+                           std::string("Events::Log() test line: ")
+                               + std::to_string(group) + ":" + std::to_string(catg));
+            auto md = LogMetaData::Create();
+            md->AddMeta("meta",
+                        "Meta data for test line:"
                             + std::to_string(group) + ":" + std::to_string(catg));
-            w.AddMeta("meta",
-                      "Meta data for test line:"
-                          + std::to_string(group) + ":" + std::to_string(catg));
+            w.AddMetaCopy(md);
             w.Write(ev);
         }
     }
@@ -117,15 +124,325 @@ void run_test_4(LogWriter &w)
     for (int i = 1; i < 10; i++)
     {
         w.EnableLogMeta((i % 2) == 0);
-        w.AddMeta("metaline_" + std::to_string(i),
-                  "Meta data for line #" + std::to_string(i));
-        w.Write("Log data for line #" + std::to_string(i));
+        auto md = LogMetaData::Create();
+        md->AddMeta("metaline_" + std::to_string(i),
+                    "Meta data for line #" + std::to_string(i));
+        w.AddMetaCopy(md);
+        w.Write(Events::Log(LogGroup::UNDEFINED,
+                            LogCategory::INFO,
+                            "Log data for line #" + std::to_string(i)));
     }
     w.EnableLogMeta(true);
 }
 
+
+/**
+ *  Reads the complete content of a file
+ *
+ * @param fname  std::string with the file name
+ *
+ * @return std::string with the file content, empty if the file is missing
+ */
+static std::string read_file(const std::string &fname)
+{
+    std::ifstream f(fname);
+    return std::string(std::istreambuf_iterator<char>(f),
+                       std::istreambuf_iterator<char>());
+}
+
+
+/**
+ *  Checks the log file rotation of FileLogWriter and that Reopen()
+ *  starts a new log file after the old one has been moved away.
+ *
+ * @return int, 0 on success, otherwise 1
+ */
+int run_file_rotation_test()
+{
+    std::cout << "Testing FileLogWriter rotation" << std::endl
+              << "----------------------------------------------------------"
+              << std::endl;
+
+    char dir_tmpl[] = "/tmp/logwriter-tests.XXXXXX";
+    if (!mkdtemp(dir_tmpl))
+    {
+        std::cerr << "Could not create a temporary directory" << std::endl;
+        return 1;
+    }
+    const std::string logfile = std::string(dir_tmpl) + "/rotate.log";
+    int failed = 0;
+    auto check = [&failed](const bool ok, const std::string &descr)
+    {
+        std::cout << (ok ? "  PASS: " : "  FAIL: ") << descr << std::endl;
+        failed += (ok ? 0 : 1);
+    };
+
+    {
+        // Each line is 23 bytes, so every third line starts a new
+        // log file
+        FileLogWriter w(logfile, 64, 2);
+        w.EnableTimestamp(false);
+        for (int i = 0; i < 9; ++i)
+        {
+            w.Write("Rotation test line #" + std::to_string(i));
+            w.Flush();
+        }
+        check(read_file(logfile).find("line #8") != std::string::npos,
+              "Newest log line is in the log file");
+        check(read_file(logfile + ".1").find("line #6") != std::string::npos,
+              "Previous log lines are in the first rotated file");
+        check(read_file(logfile + ".2").find("line #4") != std::string::npos,
+              "Older log lines are in the second rotated file");
+        check(0 != access((logfile + ".3").c_str(), F_OK),
+              "No more rotated files than requested are kept");
+
+        // Simulate an external log rotation tool
+        const std::string moved = logfile + ".moved";
+        rename(logfile.c_str(), moved.c_str());
+        w.Reopen();
+        w.Write("Line after reopen");
+        w.Flush();
+        check(read_file(logfile) == " Line after reopen\n",
+              "Reopen() starts a new log file");
+        check(read_file(moved).find("after reopen") == std::string::npos,
+              "Nothing is written to the moved log file after Reopen()");
+        unlink(moved.c_str());
+    }
+
+    for (const auto &f : {logfile, logfile + ".1", logfile + ".2"})
+    {
+        unlink(f.c_str());
+    }
+    rmdir(dir_tmpl);
+    std::cout << std::endl;
+    return (failed > 0 ? 1 : 0);
+}
+
+
+/**
+ *  Writes a number of log events with the same kind of meta data the
+ *  net.openvpn.v3.log service adds, and measures the throughput.
+ *
+ * @param w        LogWriter to benchmark
+ * @param lines    size_t with the number of log lines to write
+ * @param batched  bool, if true the log events are written in batches
+ *                 of the same size the log service uses
+ *
+ * @return double with the number of log lines written per second
+ */
+double benchmark_writer(LogWriter &w, const size_t lines, const bool batched)
+{
+    const size_t batch_size = 256;
+    auto md = LogMetaData::Create();
+    md->AddMeta("sender", ":1.4242");
+    md->AddMeta("object_path", "/net/openvpn/v3/sessions/be1e8a8cs2dcs4b1bsa60dsa9e3ab2f0e7b");
+    md->AddMeta("interface", "net.openvpn.v3.backends");
+    md->AddMeta("sender_pid", 4242);
+    auto tag = LogTag::Create(":1.4242", "net.openvpn.v3.backends");
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lines; ++i)
+    {
+        if (batched && (i % batch_size) == 0)
+        {
+            w.BeginBatch();
+        }
+
+        Events::Log ev(LogGroup::CLIENT,
+                       LogCategory::INFO,
+                       "logwriter-tests benchmark line " + std::to_string(i));
+        ev.AddLogTag(tag);
+        w.AddMetaCopy(md);
+        w.Write(ev);
+
+        if (batched && ((i + 1) % batch_size) == 0)
+        {
+            w.EndBatch();
+        }
+    }
+    if (batched)
+    {
+        w.EndBatch();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return lines / elapsed.count();
+}
+
+
+/**
+ *  Compares the throughput of the StreamLogWriter writing to a
+ *  std::ofstream, which is how --log-file used to be implemented, with
+ *  the FileLogWriter.  Timestamps and meta data lines are enabled in
+ *  both, like openvpn3-service-log --timestamp --service-log-dbus-details
+ *
+ * @param lines  size_t with the number of log lines per run
+ */
+int run_file_benchmark(const size_t lines)
+{
+    char dir_tmpl[] = "/tmp/logwriter-tests.XXXXXX";
+    if (!mkdtemp(dir_tmpl))
+    {
+        std::cerr << "Could not create a temporary directory" << std::endl;
+        return 1;
+    }
+    const std::string stream_file = std::string(dir_tmpl) + "/stream.log";
+    const std::string file_file = std::string(dir_tmpl) + "/file.log";
+
+    double r_stream = 0;
+    double r_file = 0;
+    double r_file_batch = 0;
+    {
+        std::ofstream logfs(stream_file, std::ios_base::app);
+        StreamLogWriter before(logfs);
+        r_stream = benchmark_writer(before, lines, false);
+    }
+    {
+        FileLogWriter after(file_file);
+        r_file = benchmark_writer(after, lines, false);
+        r_file_batch = benchmark_writer(after, lines, true);
+    }
+    unlink(stream_file.c_str());
+    unlink(file_file.c_str());
+    rmdir(dir_tmpl);
+
+    std::cout << "Writing " << lines << " log lines to a log file per run"
+              << std::endl
+              << std::fixed << std::setprecision(0)
+              << "  StreamLogWriter (before): " << r_stream << " lines/sec" << std::endl
+              << "  FileLogWriter:            " << r_file << " lines/sec" << std::endl
+              << "  FileLogWriter batched:    " << r_file_batch << " lines/sec" << std::endl
+              << std::setprecision(2)
+              << "  Speed-up (FileLogWriter vs before): " << (r_file / r_stream) << "x"
+              << std::endl;
+    return 0;
+}
+
+
+#ifdef HAVE_SYSTEMD
+/**
+ *  Reference implementation of how JournaldWriter used to submit log
+ *  events; one freshly allocated buffer per journal field and one
+ *  sd_journal_sendv() call per log event.  Only used as the baseline
+ *  in the benchmark.
+ */
+class UnbufferedJournaldWriter : public LogWriter
+{
+  public:
+    UnbufferedJournaldWriter(const std::string &logsndr)
+        : log_sender("O3_LOG_SENDER=" + logsndr)
+    {
+    }
+
+    std::string GetLogWriterInfo() const override
+    {
+        return "journald (unbuffered)";
+    }
+
+    void Write(const Events::Log &event) override
+    {
+        std::vector<iovec> l;
+        l.push_back(prepare_iov("", log_sender));
+        for (const auto &mdr : metadata.GetMetaDataRecords(true, false))
+        {
+            l.push_back(prepare_iov("O3_", mdr));
+        }
+        auto logtag = event.GetLogTag();
+        if (logtag)
+        {
+            l.push_back(prepare_iov("O3_LOGTAG=", logtag->str(false)));
+        }
+        l.push_back(prepare_iov("O3_LOG_GROUP=", event.GetLogGroupStr()));
+        l.push_back(prepare_iov("O3_LOG_CATEGORY=", event.GetLogCategoryStr()));
+        std::string msg;
+        if (prepend_prefix && logtag)
+        {
+            msg += logtag->str(true) + " ";
+        }
+        msg += event.message;
+        l.push_back(prepare_iov("MESSAGE=", msg));
+
+        sd_journal_sendv(l.data(), l.size());
+        for (auto &v : l)
+        {
+            free(v.iov_base);
+        }
+        metadata.clear();
+    }
+
+  protected:
+    void WriteLogLine(LogTag::Ptr logtag,
+                      const std::string &data,
+                      const std::string &colour_init,
+                      const std::string &colour_reset) override
+    {
+        Events::Log logev(LogGroup::UNDEFINED, LogCategory::INFO, data);
+        logev.AddLogTag(logtag);
+        Write(logev);
+    }
+
+  private:
+    const std::string log_sender;
+
+    static iovec prepare_iov(const std::string &tag, const std::string &data)
+    {
+        size_t buflen = tag.length() + data.length();
+        char *data_c = static_cast<char *>(calloc(buflen, 1));
+        memcpy(data_c, tag.c_str(), tag.length());
+        memcpy(data_c + tag.length(), data.c_str(), data.length());
+        return iovec{data_c, buflen};
+    }
+};
+
+
+/**
+ *  Compares the throughput of the old unbuffered journald submission
+ *  with the JournaldWriter, with and without batching.
+ *
+ * @param lines  size_t with the number of log lines per run
+ */
+int run_benchmark(const size_t lines)
+{
+    UnbufferedJournaldWriter before("logwriter-tests");
+    JournaldWriter after("logwriter-tests");
+
+    std::cout << "Writing " << lines << " log lines to the journal per run"
+              << std::endl;
+    const double r_before = benchmark_writer(before, lines, false);
+    const double r_single = benchmark_writer(after, lines, false);
+    const double r_batch = benchmark_writer(after, lines, true);
+
+    std::cout << std::fixed << std::setprecision(0)
+              << "  unbuffered (before):    " << r_before << " lines/sec" << std::endl
+              << "  JournaldWriter:         " << r_single << " lines/sec" << std::endl
+              << "  JournaldWriter batched: " << r_batch << " lines/sec" << std::endl
+              << std::setprecision(2)
+              << "  Speed-up (batched vs before): " << (r_batch / r_before) << "x"
+              << std::endl;
+    return 0;
+}
+#endif // HAVE_SYSTEMD
+
+
 int main(int argc, char **argv)
 {
+    if (argc > 1 && 0 == strcmp(argv[1], "--benchmark"))
+    {
+        const size_t lines = (argc > 2 ? std::stoul(argv[2]) : 100000);
+        int r = run_file_benchmark(lines);
+#ifdef HAVE_SYSTEMD
+        if (0 == r)
+        {
+            r = run_benchmark(lines);
+        }
+#endif
+        return r;
+    }
+
+    if (0 != run_file_rotation_test())
+    {
+        return 1;
+    }
+
     // Simple text/plain log writer, logging to stdout
     std::cout << "Testing LogWriter" << std::endl
               << "----------------------------------------------------------"
@@ -173,17 +490,22 @@ int main(int argc, char **argv)
     std::cout << "Check the syslog for results" << std::endl
               << std::endl;
 
-#if HAVE_SYSTEMD
+#ifdef HAVE_SYSTEMD
     // Test the systemd-journald implementation of LogWriter.  To validate these
     // log entries, the journalctl needs to be evaluated.
     std::cout << "Testing JournaldWriter" << std::endl
               << "----------------------------------------------------------"
               << std::endl;
-    JournaldWriter jlw;
+    JournaldWriter jlw("logwriter-tests");
     run_test_1(jlw);
     run_test_2(jlw);
     run_test_3(jlw);
     run_test_4(jlw);
+
+    // The same, but with all log events of each test written as a batch
+    jlw.BeginBatch();
+    run_test_3(jlw);
+    jlw.EndBatch();
     std::cout << "Check the systemd-journald for results" << std::endl
               << std::endl;
 #endif // HAVE_SYSTEMD
@@ -0,0 +1,212 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   route-batch-benchmark.cpp
+ *
+ * @brief  Benchmark measuring how long it takes to install and remove
+ *         a large number of routes via the Core library netlink route
+ *         calls, which CoreTunbuilderImpl::establish() used before,
+ *         versus batched netlink requests via NetCfg::Netlink::RouteBatch
+ *
+ *         This must be run as root on a test interface with an IPv4
+ *         address in the same subnet as the gateway, like the VPN
+ *         interface.  It can be prepared like this:
+ *
+ *           # ip link add ovpnbench0 type dummy
+ *           # ip addr add 10.199.0.2/24 dev ovpnbench0
+ *           # ip link set ovpnbench0 up
+ *
+ *         Usage: route-batch-benchmark IFNAME GATEWAY [NUM_ROUTES [BATCH_SIZE]]
+ */
+
+#include "build-config.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <openvpn/log/logsimple.hpp>
+#include <openvpn/tun/linux/client/sitnl.hpp>
+
+#include "netcfg/netlink-route-batch.hpp"
+
+using namespace NetCfg::Netlink;
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ *  Generate a list of /30 routes within 10.200.0.0/14
+ */
+static std::vector<Route> generate_routes(const unsigned int count,
+                                          const std::string &gateway)
+{
+    std::vector<Route> ret;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        uint32_t addr = (10u << 24) | (200u << 16) | (i << 2);
+        Route r;
+        r.address = std::to_string((addr >> 24) & 0xff) + "."
+                    + std::to_string((addr >> 16) & 0xff) + "."
+                    + std::to_string((addr >> 8) & 0xff) + "."
+                    + std::to_string(addr & 0xff);
+        r.prefix_size = 30;
+        r.gateway = gateway;
+        ret.push_back(r);
+    }
+    return ret;
+}
+
+
+/**
+ *  Report the time spent installing and removing the routes
+ *
+ * @return bool, true if all routes were installed and removed
+ */
+static bool report(const std::string &label,
+                   Clock::duration install_time,
+                   Clock::duration remove_time,
+                   const size_t install_errors,
+                   const size_t remove_errors)
+{
+    auto ms = [](auto d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << std::left << std::setw(24) << label
+              << " install: " << std::right << std::setw(8) << ms(install_time) << " ms"
+              << "   remove: " << std::setw(8) << ms(remove_time) << " ms"
+              << "   errors: " << install_errors << "/" << remove_errors
+              << std::endl;
+    return 0 == install_errors && 0 == remove_errors;
+}
+
+
+/**
+ *  Install and remove all the routes one at a time, the way the Core
+ *  library TunNetlink route actions do it.  Each call opens a netlink
+ *  socket and waits for the kernel ack.
+ */
+static bool run_core(const std::string &ifname,
+                     const std::vector<Route> &routes)
+{
+    using namespace openvpn;
+    using SITNL = TunNetlink::SITNL;
+
+    std::vector<IP::Route4> core_routes;
+    for (const auto &r : routes)
+    {
+        core_routes.emplace_back(IPv4::Addr::from_string(r.address), r.prefix_size);
+    }
+    const IPv4::Addr gw = IPv4::Addr::from_string(routes.front().gateway);
+
+    size_t install_errors = 0;
+    auto start = Clock::now();
+    for (const auto &r : core_routes)
+    {
+        if (SITNL::net_route_add(r, gw, ifname, 0, 0) < 0)
+        {
+            ++install_errors;
+        }
+    }
+    auto installed = Clock::now();
+
+    size_t remove_errors = 0;
+    for (const auto &r : core_routes)
+    {
+        if (SITNL::net_route_del(r, gw, ifname, 0, 0) < 0)
+        {
+            ++remove_errors;
+        }
+    }
+    auto removed = Clock::now();
+
+    return report("core (one per request)",
+                  installed - start,
+                  removed - installed,
+                  install_errors,
+                  remove_errors);
+}
+
+
+/**
+ *  Install and remove all the routes via RouteBatch, as done by
+ *  CoreTunbuilderImpl::establish() and teardown()
+ */
+static bool run_batched(const std::string &ifname,
+                        const std::vector<Route> &routes,
+                        const unsigned int batch_size)
+{
+    auto batch = RouteBatch::Create(ifname, batch_size);
+    for (const auto &r : routes)
+    {
+        batch->Add(r);
+    }
+
+    auto start = Clock::now();
+    auto install_errors = batch->Install();
+    auto installed = Clock::now();
+    auto remove_errors = batch->Remove();
+    auto removed = Clock::now();
+
+    for (const auto &e : install_errors)
+    {
+        std::cout << "    ** install " << e.route.str() << ": " << e.message << std::endl;
+        break;
+    }
+    return report("batched (" + std::to_string(batch_size) + " per send)",
+                  installed - start,
+                  removed - installed,
+                  install_errors.size(),
+                  remove_errors.size());
+}
+
+
+static int usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " IFNAME GATEWAY [NUM_ROUTES [BATCH_SIZE]]" << std::endl;
+    return 2;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        return usage(argv[0]);
+    }
+    std::string ifname(argv[1]);
+    std::string gateway(argv[2]);
+    unsigned int num_routes = (argc > 3 ? std::atoi(argv[3]) : 10000);
+    unsigned int batch_size = (argc > 4 ? std::atoi(argv[4]) : 256);
+    if (num_routes < 1 || num_routes > 65536 || batch_size < 1)
+    {
+        return usage(argv[0]);
+    }
+
+    auto routes = generate_routes(num_routes, gateway);
+    std::cout << ">> " << num_routes << " routes via " << gateway
+              << " on " << ifname << std::endl;
+
+    bool ok = true;
+    try
+    {
+        ok &= run_core(ifname, routes);
+        ok &= run_batched(ifname, routes, batch_size);
+    }
+    catch (const std::exception &excp)
+    {
+        std::cerr << "** ERROR ** " << excp.what() << std::endl;
+        return 1;
+    }
+    return (ok ? 0 : 1);
+}
@@ -20,6 +20,10 @@
 #        the server and client example configuration files for
 #        more information.
 #
+#        The time from starting the session-start command until it
+#        reports the session as connected is measured for each
+#        iteration, and a summary is printed when the loop completes.
+#
 #        If any of the openvpn3 commands or ping fails, the script
 #        is expected to exit instantly.  stderr is also redirected
 #        to stdout to simplify catching all the logs by a callers
@@ -47,6 +51,11 @@ fi
     # test does not try to stress test the configuration manager
     openvpn3 config-import --name "$cfgname" --config "$1" || exit_msg "config-import"
 
+    lat_min=""
+    lat_max=0
+    lat_total=0
+    lat_count=0
+
     for i in $(seq 1 10000);
     do
         echo "=========== $i ==============";
@@ -54,7 +63,20 @@ fi
         echo "";
 
         # Main loop - start the VPN session, ping and disconnect
+        t_start=$(date +%s%N)
         openvpn3 session-start --config "$cfgname" || exit_msg "session-start"
+        latency=$(( ($(date +%s%N) - t_start) / 1000000 ))
+        echo "Connect latency: ${latency} ms"
+
+        lat_total=$((lat_total + latency))
+        lat_count=$((lat_count + 1))
+        if [ -z "$lat_min" ] || [ $latency -lt $lat_min ]; then
+            lat_min=$latency
+        fi
+        if [ $latency -gt $lat_max ]; then
+            lat_max=$latency
+        fi
+
         ping -c 3 -i 0.5 10.8.0.1 || exit_msg "ping"
         openvpn3 session-manage --disconnect --config "$cfgname" || exit_msg "session-disconnect"
 
@@ -65,6 +87,11 @@ fi
         echo -n "Completed: "; date; echo "";
     done
 
+    echo "=========== Connect latency =============="
+    echo "Sessions: ${lat_count}"
+    echo "Min: ${lat_min} ms  Avg: $((lat_total / lat_count)) ms  Max: ${lat_max} ms"
+    echo ""
+
     # Clean up the configuration file imported
     openvpn3 config-remove --force --config "$cfgname" || exit_msg "config-remove"
 } 2>&1
@@ -0,0 +1,57 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//
+
+/**
+ * @file   cmdargparser-numbers.cpp
+ *
+ * @brief  Unit tests for parse_option_number()
+ */
+
+#include <gtest/gtest.h>
+
+#include "common/cmdargparser.hpp"
+
+namespace unittest {
+
+static ParsedArgs::Ptr option_value(const std::string &value)
+{
+    auto args = RegisterParsedArgs::Create("unit-test");
+    args->register_option("value", value.c_str());
+    return args;
+}
+
+
+TEST(cmdargparser, number_valid)
+{
+    EXPECT_EQ(parse_option_number("test", option_value("0"), "value", 0, 10), 0);
+    EXPECT_EQ(parse_option_number("test", option_value("10"), "value", 0, 10), 10);
+    EXPECT_EQ(parse_option_number("test", option_value("5"), "value", 5, 5), 5);
+}
+
+
+TEST(cmdargparser, number_out_of_range)
+{
+    EXPECT_THROW(parse_option_number("test", option_value("11"), "value", 0, 10),
+                 CommandException);
+    EXPECT_THROW(parse_option_number("test", option_value("0"), "value", 1, 10),
+                 CommandException);
+    EXPECT_THROW(parse_option_number("test", option_value("99999999999999999999999"), "value", 0, 10),
+                 CommandException);
+}
+
+
+TEST(cmdargparser, number_malformed)
+{
+    for (const auto &val : {"", "-1", "+1", " 1", "1 ", "10abc", "abc", "0x10"})
+    {
+        EXPECT_THROW(parse_option_number("test", option_value(val), "value", 0, 100),
+                     CommandException)
+            << "Value: '" << val << "'";
+    }
+}
+
+} // namespace unittest
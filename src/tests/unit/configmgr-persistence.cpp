@@ -0,0 +1,265 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   configmgr-persistence.cpp
+ *
+ * @brief  Unit test for ConfigManager::PersistentStorage
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+#include "configmgr/configmgr-persistence.hpp"
+
+using namespace ConfigManager;
+using namespace std::chrono_literals;
+
+
+namespace unittest {
+
+class PersistentStorageTest : public ::testing::Test
+{
+  protected:
+    std::string tmpdir{};
+    std::string profile_file{};
+    std::vector<std::string> errors{};
+
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/configmgr-persistence-XXXXXX";
+        ASSERT_NE(::mkdtemp(tmpl), nullptr);
+        tmpdir = tmpl;
+        profile_file = tmpdir + "/34eea818xe578x4356x924bx9fccbbeb92eb.json";
+    }
+
+    void TearDown() override
+    {
+        std::remove(profile_file.c_str());
+        std::remove(PersistentStorage::GetUsageFilename(profile_file).c_str());
+        ::rmdir(tmpdir.c_str());
+    }
+
+    PersistentStorage::ErrorHandler error_handler()
+    {
+        return [this](const std::string &msg)
+        {
+            errors.push_back(msg);
+        };
+    }
+
+    static bool file_exists(const std::string &fname)
+    {
+        struct stat st;
+        return 0 == ::stat(fname.c_str(), &st);
+    }
+
+    static Json::Value read_json(const std::string &fname)
+    {
+        std::ifstream f(fname);
+        Json::Value v;
+        f >> v;
+        return v;
+    }
+
+    static Json::Value test_profile(unsigned int used_count)
+    {
+        Json::Value p;
+        p["name"] = "unit-test";
+        p["used_count"] = used_count;
+        p["last_used_timestamp"] = (Json::Value::UInt64)1000;
+        return p;
+    }
+};
+
+
+TEST_F(PersistentStorageTest, usage_filename)
+{
+    EXPECT_EQ(PersistentStorage::GetUsageFilename("/var/lib/cfg/abc.json"),
+              "/var/lib/cfg/abc.usage");
+    EXPECT_EQ(PersistentStorage::GetUsageFilename("/var/lib/cfg/abc"),
+              "/var/lib/cfg/abc.usage");
+}
+
+
+TEST_F(PersistentStorageTest, write_file_atomic)
+{
+    PersistentStorage::WriteFileAtomic(profile_file, "{\"name\": \"atomic\"}");
+    EXPECT_FALSE(file_exists(profile_file + ".tmp"));
+    EXPECT_EQ(read_json(profile_file)["name"].asString(), "atomic");
+
+    struct stat st;
+    ASSERT_EQ(::stat(profile_file.c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0600);
+}
+
+
+TEST_F(PersistentStorageTest, immediate_write)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 0ms);
+    EXPECT_FALSE(storage->IsWriteBehind());
+    storage->SaveProfile(profile_file, test_profile(1));
+    EXPECT_EQ(storage->GetPendingCount(), 0);
+    EXPECT_EQ(read_json(profile_file)["used_count"].asUInt(), 1);
+    EXPECT_TRUE(errors.empty());
+}
+
+
+TEST_F(PersistentStorageTest, serialized_profile)
+{
+    // Serialized profiles are written as-is
+    const std::string content = "{\"name\":\"serialized\",\"used_count\":3}";
+    auto storage = PersistentStorage::Create(error_handler(), 0ms);
+    storage->SaveProfile(profile_file, content);
+
+    std::ifstream f(profile_file);
+    std::string written((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_EQ(written, content);
+    EXPECT_TRUE(errors.empty());
+}
+
+
+TEST_F(PersistentStorageTest, coalesce_until_flush)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 1h);
+    EXPECT_TRUE(storage->IsWriteBehind());
+    storage->SaveProfile(profile_file, test_profile(1));
+    for (unsigned int i = 2; i <= 100; ++i)
+    {
+        storage->SaveUsage(profile_file, {i, 2000 + i});
+    }
+    EXPECT_EQ(storage->GetPendingCount(), 1);
+    EXPECT_FALSE(file_exists(profile_file));
+
+    storage->Flush();
+    EXPECT_EQ(storage->GetPendingCount(), 0);
+    EXPECT_EQ(read_json(profile_file)["used_count"].asUInt(), 1);
+
+    Json::Value loaded = read_json(profile_file);
+    ASSERT_TRUE(PersistentStorage::LoadUsage(profile_file, loaded));
+    EXPECT_EQ(loaded["used_count"].asUInt(), 100);
+    EXPECT_EQ(loaded["last_used_timestamp"].asUInt64(), 2100);
+    EXPECT_EQ(loaded["name"].asString(), "unit-test");
+    EXPECT_TRUE(errors.empty());
+}
+
+
+TEST_F(PersistentStorageTest, profile_supersedes_usage)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 0ms);
+    storage->SaveProfile(profile_file, test_profile(1));
+    storage->SaveUsage(profile_file, {2, 3000});
+    ASSERT_TRUE(file_exists(PersistentStorage::GetUsageFilename(profile_file)));
+
+    // A complete profile write carries the usage counters, so the
+    // side-car file must go away
+    storage->SaveProfile(profile_file, test_profile(2));
+    EXPECT_FALSE(file_exists(PersistentStorage::GetUsageFilename(profile_file)));
+
+    Json::Value loaded = read_json(profile_file);
+    EXPECT_FALSE(PersistentStorage::LoadUsage(profile_file, loaded));
+    EXPECT_EQ(loaded["used_count"].asUInt(), 2);
+}
+
+
+TEST_F(PersistentStorageTest, threshold_flush)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 1h, 2);
+    const std::string second_file = tmpdir + "/second.json";
+
+    storage->SaveProfile(profile_file, test_profile(1));
+    storage->SaveProfile(second_file, test_profile(2));
+
+    // The worker thread should flush as soon as the threshold is reached
+    for (int i = 0; i < 100 && storage->GetPendingCount() > 0; ++i)
+    {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_EQ(storage->GetPendingCount(), 0);
+    EXPECT_TRUE(file_exists(profile_file));
+    EXPECT_TRUE(storage->Remove(second_file));
+    EXPECT_TRUE(errors.empty());
+}
+
+
+TEST_F(PersistentStorageTest, flush_on_destruction)
+{
+    {
+        auto storage = PersistentStorage::Create(error_handler(), 1h);
+        storage->SaveProfile(profile_file, test_profile(5));
+        EXPECT_FALSE(file_exists(profile_file));
+    }
+    EXPECT_EQ(read_json(profile_file)["used_count"].asUInt(), 5);
+}
+
+
+TEST_F(PersistentStorageTest, remove_discards_pending)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 1h);
+    storage->SaveProfile(profile_file, test_profile(1));
+    storage->Flush();
+    storage->SaveUsage(profile_file, {2, 3000});
+
+    EXPECT_TRUE(storage->Remove(profile_file));
+    EXPECT_EQ(storage->GetPendingCount(), 0);
+    storage->Flush();
+    EXPECT_FALSE(file_exists(profile_file));
+    EXPECT_FALSE(file_exists(PersistentStorage::GetUsageFilename(profile_file)));
+
+    // Removing a non-existing profile is reported as an error
+    EXPECT_FALSE(storage->Remove(profile_file));
+    EXPECT_EQ(errors.size(), 1);
+}
+
+
+TEST_F(PersistentStorageTest, load_profiles)
+{
+    auto storage = PersistentStorage::Create(error_handler(), 0ms);
+
+    std::vector<std::string> files;
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+        files.push_back(tmpdir + "/profile-" + std::to_string(i) + ".json");
+        storage->SaveProfile(files.back(), test_profile(i));
+    }
+    storage->SaveUsage(files[3], {42, 4242});
+
+    // Add a broken and a missing file
+    files.push_back(tmpdir + "/broken.json");
+    PersistentStorage::WriteFileAtomic(files.back(), "{ \"name\": ");
+    files.push_back(tmpdir + "/missing.json");
+
+    auto loaded = PersistentStorage::LoadProfiles(files, 4);
+    ASSERT_EQ(loaded.size(), files.size());
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(loaded[i].filename, files[i]);
+        EXPECT_TRUE(loaded[i].error.empty());
+        EXPECT_EQ(loaded[i].profile["used_count"].asUInt(), (3 == i ? 42 : i));
+    }
+    EXPECT_FALSE(loaded[20].error.empty());
+    EXPECT_FALSE(loaded[21].error.empty());
+
+    for (const auto &f : files)
+    {
+        std::remove(f.c_str());
+        std::remove(PersistentStorage::GetUsageFilename(f).c_str());
+    }
+}
+
+} // namespace unittest
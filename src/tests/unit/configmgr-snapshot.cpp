@@ -0,0 +1,346 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   configmgr-snapshot.cpp
+ *
+ * @brief  Unit test for ConfigManager::ProfileSnapshot
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+#include "configmgr/configmgr-exceptions.hpp"
+#include "configmgr/configmgr-persistence.hpp"
+#include "configmgr/configmgr-snapshot.hpp"
+
+using namespace ConfigManager;
+
+
+namespace unittest {
+
+class ProfileSnapshotTest : public ::testing::Test
+{
+  protected:
+    std::string tmpdir{};
+    std::string snapshot_file{};
+    std::vector<std::string> files{};
+
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/configmgr-snapshot-XXXXXX";
+        ASSERT_NE(::mkdtemp(tmpl), nullptr);
+        tmpdir = tmpl;
+        snapshot_file = tmpdir + "/" + ProfileSnapshot::DEFAULT_FILENAME;
+    }
+
+    void TearDown() override
+    {
+        for (const auto &f : files)
+        {
+            std::remove(f.c_str());
+            std::remove(PersistentStorage::GetUsageFilename(f).c_str());
+        }
+        std::remove(snapshot_file.c_str());
+        ::rmdir(tmpdir.c_str());
+    }
+
+    /**
+     *  Generates a profile in the ConfigManager::Configuration::Export()
+     *  format
+     */
+    static Json::Value test_profile(unsigned int id)
+    {
+        Json::Value p;
+        p["object_path"] = "/net/openvpn/v3/configuration/test" + std::to_string(id);
+        p["owner"] = 1000 + id;
+        p["name"] = "profile-" + std::to_string(id);
+        p["tags"].append("tag-a");
+        p["tags"].append("tag-" + std::to_string(id));
+        p["import_timestamp"] = (Json::Value::UInt64)1700000000 + id;
+        p["last_used_timestamp"] = (Json::Value::UInt64)1700001000 + id;
+        p["locked_down"] = (0 == id % 2);
+        p["transfer_owner_session"] = false;
+        p["readonly"] = true;
+        p["single_use"] = false;
+        p["used_count"] = id * 3;
+        p["valid"] = true;
+        p["dco"] = (0 == id % 3);
+        p["public_access"] = false;
+        p["acl"].append(2000 + id);
+        p["acl"].append(3000);
+        p["overrides"]["server-override"] = "vpn" + std::to_string(id) + ".example.org";
+        p["overrides"]["ipv6"] = true;
+
+        Json::Value remote;
+        remote["remote"]["args"].append("vpn.example.org");
+        remote["remote"]["args"].append("1194");
+        p["profile"]["0"] = remote;
+        p["profile"]["1"]["client"]["args"] = Json::Value(Json::arrayValue);
+        return p;
+    }
+
+    static std::string to_text(const Json::Value &v)
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        return Json::writeString(builder, v);
+    }
+
+    /**
+     *  Decoded profiles carry the profile content as JSON text; parse
+     *  it back to be able to compare with the original profile.
+     */
+    static Json::Value restore_content(Json::Value decoded)
+    {
+        Json::Value content;
+        std::istringstream text(decoded["profile"].asString());
+        text >> content;
+        decoded["profile"] = content;
+        return decoded;
+    }
+
+    static ProfileSnapshot::SourceStamp stamp_of(const std::string &fname)
+    {
+        struct stat st;
+        EXPECT_EQ(::stat(fname.c_str(), &st), 0);
+        return ProfileSnapshot::SourceStamp::FromStat(st);
+    }
+
+    static std::string file_id(const std::string &fname)
+    {
+        return fname.substr(fname.rfind('/') + 1);
+    }
+
+    void write_profiles(unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            files.push_back(tmpdir + "/profile-" + std::to_string(i) + ".json");
+            PersistentStorage::WriteFileAtomic(files.back(), to_text(test_profile(i)));
+        }
+    }
+
+    std::vector<ProfileSnapshot::Entry> entries_from_files()
+    {
+        std::vector<ProfileSnapshot::Entry> entries;
+        for (const auto &f : files)
+        {
+            std::ifstream in(f);
+            Json::Value profile;
+            in >> profile;
+            entries.push_back({file_id(f), stamp_of(f), profile});
+        }
+        return entries;
+    }
+
+    void corrupt_byte(size_t offset_from_end)
+    {
+        std::fstream f(snapshot_file, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(0, std::ios::end);
+        std::streamoff pos = static_cast<std::streamoff>(f.tellg())
+                             - static_cast<std::streamoff>(offset_from_end);
+        f.seekg(pos);
+        char c = 0;
+        f.get(c);
+        f.seekp(pos);
+        f.put(static_cast<char>(c ^ 0x5a));
+    }
+};
+
+
+TEST_F(ProfileSnapshotTest, crc32)
+{
+    // Standard CRC32 check value
+    EXPECT_EQ(ProfileSnapshot::CRC32("123456789"), 0xCBF43926u);
+    EXPECT_EQ(ProfileSnapshot::CRC32(""), 0u);
+}
+
+
+TEST_F(ProfileSnapshotTest, record_roundtrip)
+{
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        Json::Value orig = test_profile(i);
+        std::string record = ProfileSnapshot::EncodeRecord(orig);
+        Json::Value decoded = ProfileSnapshot::DecodeRecord(record);
+
+        ASSERT_TRUE(decoded["profile"].isString());
+        EXPECT_EQ(to_text(restore_content(decoded)), to_text(orig));
+    }
+}
+
+
+TEST_F(ProfileSnapshotTest, record_minimal_profile)
+{
+    // Older profiles may lack several fields, including 'valid'.
+    // The presence of 'valid' must be preserved, as it decides if
+    // the profile content is parsed lazily
+    Json::Value orig;
+    orig["object_path"] = "/net/openvpn/v3/configuration/old";
+    orig["owner"] = 0;
+    orig["name"] = "old-profile";
+    orig["profile"] = Json::Value(Json::objectValue);
+
+    Json::Value decoded = ProfileSnapshot::DecodeRecord(ProfileSnapshot::EncodeRecord(orig));
+    EXPECT_FALSE(decoded.isMember("valid"));
+    EXPECT_FALSE(decoded.isMember("tags"));
+    EXPECT_FALSE(decoded.isMember("acl"));
+    EXPECT_FALSE(decoded.isMember("overrides"));
+    EXPECT_EQ(decoded["name"].asString(), "old-profile");
+    EXPECT_EQ(decoded["profile"].asString(), "{}");
+}
+
+
+TEST_F(ProfileSnapshotTest, record_truncated)
+{
+    std::string record = ProfileSnapshot::EncodeRecord(test_profile(1));
+    for (size_t len : {size_t(0), size_t(10), record.size() / 2, record.size() - 1})
+    {
+        EXPECT_THROW(ProfileSnapshot::DecodeRecord(std::string_view(record.data(), len)),
+                     ConfigManager::Exception);
+    }
+}
+
+
+TEST_F(ProfileSnapshotTest, missing_file)
+{
+    EXPECT_EQ(ProfileSnapshot::Open(snapshot_file), nullptr);
+}
+
+
+TEST_F(ProfileSnapshotTest, write_and_lookup)
+{
+    write_profiles(10);
+    ProfileSnapshot::Write(snapshot_file, entries_from_files());
+
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->GetEntryCount(), 10);
+
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        Json::Value profile;
+        ASSERT_TRUE(snapshot->Lookup(file_id(files[i]), stamp_of(files[i]), profile));
+        EXPECT_EQ(to_text(restore_content(profile)), to_text(test_profile(i)));
+    }
+
+    Json::Value unused;
+    EXPECT_FALSE(snapshot->Lookup("unknown.json", stamp_of(files[0]), unused));
+
+    // A changed JSON file makes the snapshot record stale
+    auto stamp = stamp_of(files[0]);
+    stamp.mtime_ns += 1;
+    EXPECT_FALSE(snapshot->Lookup(file_id(files[0]), stamp, unused));
+}
+
+
+TEST_F(ProfileSnapshotTest, snapshot_roundtrip)
+{
+    write_profiles(5);
+    auto entries = entries_from_files();
+    ProfileSnapshot::Write(snapshot_file, entries);
+
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    ASSERT_NE(snapshot, nullptr);
+    auto restored = snapshot->GetAllEntries();
+    ASSERT_EQ(restored.size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        EXPECT_EQ(restored[i].file_id, entries[i].file_id);
+        EXPECT_TRUE(restored[i].stamp == entries[i].stamp);
+        EXPECT_EQ(to_text(restore_content(restored[i].profile)),
+                  to_text(entries[i].profile));
+    }
+
+    // Writing a snapshot from decoded entries must produce an identical file
+    std::ifstream first(snapshot_file, std::ios::binary);
+    std::string first_data((std::istreambuf_iterator<char>(first)),
+                           std::istreambuf_iterator<char>());
+    snapshot.reset();
+
+    ProfileSnapshot::Write(snapshot_file, restored);
+    std::ifstream second(snapshot_file, std::ios::binary);
+    std::string second_data((std::istreambuf_iterator<char>(second)),
+                            std::istreambuf_iterator<char>());
+    EXPECT_EQ(first_data, second_data);
+}
+
+
+TEST_F(ProfileSnapshotTest, corrupted_record)
+{
+    write_profiles(3);
+    ProfileSnapshot::Write(snapshot_file, entries_from_files());
+
+    // The index is at the end of the file; damage the last record
+    // right in front of it
+    corrupt_byte(3 * 80 + 10);
+
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->GetAllEntries().size(), 2);
+}
+
+
+TEST_F(ProfileSnapshotTest, corrupted_index)
+{
+    write_profiles(3);
+    ProfileSnapshot::Write(snapshot_file, entries_from_files());
+    corrupt_byte(20);
+    EXPECT_THROW(auto s = ProfileSnapshot::Open(snapshot_file), ConfigManager::Exception);
+}
+
+
+TEST_F(ProfileSnapshotTest, not_a_snapshot)
+{
+    PersistentStorage::WriteFileAtomic(snapshot_file, std::string(64, 'x'));
+    EXPECT_THROW(auto s = ProfileSnapshot::Open(snapshot_file), ConfigManager::Exception);
+
+    PersistentStorage::WriteFileAtomic(snapshot_file, "short");
+    EXPECT_THROW(auto s = ProfileSnapshot::Open(snapshot_file), ConfigManager::Exception);
+}
+
+
+TEST_F(ProfileSnapshotTest, load_profiles_with_snapshot)
+{
+    write_profiles(8);
+    ProfileSnapshot::Write(snapshot_file, entries_from_files());
+
+    // Modify one profile after the snapshot was written and update the
+    // usage counters of another one
+    Json::Value changed = test_profile(2);
+    changed["name"] = "changed";
+    PersistentStorage::WriteFileAtomic(files[2], to_text(changed) + "\n");
+    {
+        auto storage = PersistentStorage::Create(nullptr, std::chrono::milliseconds(0));
+        storage->SaveUsage(files[5], {99, 9999});
+    }
+
+    auto snapshot = ProfileSnapshot::Open(snapshot_file);
+    ASSERT_NE(snapshot, nullptr);
+    auto loaded = PersistentStorage::LoadProfiles(files, 2, snapshot);
+    ASSERT_EQ(loaded.size(), files.size());
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        EXPECT_TRUE(loaded[i].error.empty());
+        EXPECT_EQ(loaded[i].from_snapshot, (2 != i));
+    }
+    EXPECT_EQ(loaded[2].profile["name"].asString(), "changed");
+    EXPECT_TRUE(loaded[2].profile["profile"].isObject());
+    EXPECT_TRUE(loaded[3].profile["profile"].isString());
+    EXPECT_EQ(loaded[5].profile["used_count"].asUInt(), 99);
+    EXPECT_EQ(loaded[5].profile["last_used_timestamp"].asUInt64(), 9999);
+}
+
+} // namespace unittest
@@ -0,0 +1,229 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   connection-stats.cpp
+ *
+ * @brief  Unit test for the connection statistics containers in
+ *         client/statistics.hpp
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "client/statistics.hpp"
+
+
+namespace unittest {
+
+using ChangeList = ConnectionStatsDelta::ChangeList;
+
+
+TEST(ConnectionStatsDelta, initial_update)
+{
+    ConnectionStatsDelta enc;
+    auto changes = enc.Update({0, 100, 0, 42});
+
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0], ConnectionStatsDelta::Change(1, 100));
+    EXPECT_EQ(changes[1], ConnectionStatsDelta::Change(3, 42));
+    EXPECT_EQ(enc.GetSequence(), 0);
+}
+
+
+TEST(ConnectionStatsDelta, only_changes)
+{
+    ConnectionStatsDelta enc;
+    enc.Update({10, 20, 30});
+
+    // Nothing changed; no update and the sequence number is kept
+    EXPECT_TRUE(enc.Update({10, 20, 30}).empty());
+    EXPECT_EQ(enc.GetSequence(), 0);
+
+    auto changes = enc.Update({10, 25, 30});
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0], ConnectionStatsDelta::Change(1, 5));
+    EXPECT_EQ(enc.GetSequence(), 1);
+
+    changes = enc.Update({11, 25, 35});
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0], ConnectionStatsDelta::Change(0, 1));
+    EXPECT_EQ(changes[1], ConnectionStatsDelta::Change(2, 5));
+    EXPECT_EQ(enc.GetSequence(), 2);
+}
+
+
+TEST(ConnectionStatsDelta, counter_reset)
+{
+    // A new VPN client object starts counting from zero again
+    ConnectionStatsDelta enc;
+    enc.Update({1000, 2000});
+    auto changes = enc.Update({10, 2000});
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0], ConnectionStatsDelta::Change(0, -990));
+}
+
+
+TEST(ConnectionStatsDelta, restart)
+{
+    ConnectionStatsDelta enc;
+    enc.Update({1, 2});
+    enc.Update({3, 4});
+    ASSERT_EQ(enc.GetSequence(), 1);
+
+    enc.Reset();
+    auto changes = enc.Update({3, 4});
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0], ConnectionStatsDelta::Change(0, 3));
+    EXPECT_EQ(changes[1], ConnectionStatsDelta::Change(1, 4));
+    EXPECT_EQ(enc.GetSequence(), 0);
+
+    // The first update after a restart keeps sequence number 0,
+    // even if there were no counters to report at first
+    enc.Reset();
+    EXPECT_TRUE(enc.Update({0, 0}).empty());
+    changes = enc.Update({0, 7});
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(enc.GetSequence(), 0);
+}
+
+
+TEST(ConnectionStatsDelta, apply)
+{
+    ConnectionStatsDelta enc;
+    std::vector<int64_t> totals;
+
+    const std::vector<std::vector<long long>> samples = {
+        {0, 0, 0, 0},
+        {5, 0, 7, 0},
+        {5, 3, 7, 0},
+        {9, 3, 8, 1},
+        {9, 3, 8, 1},
+        {2, 1, 8, 1},
+    };
+    for (const auto &sample : samples)
+    {
+        auto changes = enc.Update(sample);
+        if (!changes.empty())
+        {
+            ConnectionStatsDelta::Apply(totals, enc.GetSequence(), changes);
+        }
+        totals.resize(sample.size(), 0);
+        EXPECT_EQ(totals, std::vector<int64_t>(sample.begin(), sample.end()));
+    }
+
+    // A restart must discard the previously accumulated values,
+    // as the receiver may have missed updates
+    totals = {100, 100, 100, 100};
+    enc.Reset();
+    auto changes = enc.Update({2, 1, 8, 1});
+    ConnectionStatsDelta::Apply(totals, enc.GetSequence(), changes);
+    EXPECT_EQ(totals, std::vector<int64_t>({2, 1, 8, 1}));
+}
+
+
+
+namespace {
+ConnectionStatsSchema::Ptr test_schema()
+{
+    return ConnectionStatsSchema::Create({"BYTES_IN",
+                                          "BYTES_OUT",
+                                          "PACKETS_IN",
+                                          "PACKETS_OUT",
+                                          "N_RECONNECT"});
+}
+} // namespace
+
+
+TEST(ConnectionStatsSchema, lookup)
+{
+    auto schema = test_schema();
+    ASSERT_EQ(schema->size(), 5);
+    EXPECT_EQ(schema->Name(4), "N_RECONNECT");
+    EXPECT_EQ(schema->Index("PACKETS_IN"), 2);
+    EXPECT_EQ(schema->Index("NO_SUCH_COUNTER"), ConnectionStatsSchema::NOT_FOUND);
+    EXPECT_EQ(schema->bytes_in, 0);
+    EXPECT_EQ(schema->bytes_out, 1);
+    EXPECT_EQ(schema->packets_in, 2);
+    EXPECT_EQ(schema->packets_out, 3);
+
+    auto empty = ConnectionStatsSchema::Create({});
+    EXPECT_EQ(empty->bytes_in, ConnectionStatsSchema::NOT_FOUND);
+}
+
+
+TEST(ConnectionStatsSnapshot, values)
+{
+    ConnectionStatsSnapshot snap(test_schema(), {100, 0, 10, 0, 1});
+    EXPECT_EQ(snap.Get(0), 100);
+    EXPECT_EQ(snap.Get("N_RECONNECT"), 1);
+    EXPECT_EQ(snap.Get("NO_SUCH_COUNTER"), 0);
+    EXPECT_EQ(snap.Get(ConnectionStatsSchema::NOT_FOUND), 0);
+
+    auto stats = snap.GetConnectionStats();
+    ASSERT_EQ(stats.size(), 3);
+    EXPECT_EQ(stats[0].key, "BYTES_IN");
+    EXPECT_EQ(stats[0].value, 100);
+    EXPECT_EQ(stats[1].key, "PACKETS_IN");
+    EXPECT_EQ(stats[2].key, "N_RECONNECT");
+
+    ConnectionStatsSnapshot empty;
+    EXPECT_EQ(empty.Get("BYTES_IN"), 0);
+    EXPECT_TRUE(empty.GetConnectionStats().empty());
+}
+
+
+TEST(ConnectionStatsSnapshot, rates)
+{
+    using namespace std::chrono_literals;
+
+    auto schema = test_schema();
+    auto t0 = ConnectionStatsSnapshot::Clock::now();
+    ConnectionStatsSnapshot first(schema, {1000, 500, 10, 5, 0}, t0);
+    ConnectionStatsSnapshot second(schema, {5000, 1500, 30, 15, 0}, t0 + 2s);
+
+    auto r = second.GetTrafficRates(first);
+    EXPECT_DOUBLE_EQ(r.bytes_in, 2000.0);
+    EXPECT_DOUBLE_EQ(r.bytes_out, 500.0);
+    EXPECT_DOUBLE_EQ(r.packets_in, 10.0);
+    EXPECT_DOUBLE_EQ(r.packets_out, 5.0);
+    EXPECT_DOUBLE_EQ(second.Rate(first, "N_RECONNECT"), 0.0);
+
+    // Counters which decreased have been reset in between
+    ConnectionStatsSnapshot third(schema, {400, 1500, 30, 15, 0}, t0 + 4s);
+    EXPECT_DOUBLE_EQ(third.Rate(second, "BYTES_IN"), 200.0);
+
+    // No time passed; no rate can be calculated
+    EXPECT_DOUBLE_EQ(first.Rate(first, "BYTES_IN"), 0.0);
+}
+
+
+TEST(ConnectionStatsSnapshot, apply_update)
+{
+    using namespace std::chrono_literals;
+
+    auto schema = test_schema();
+    ConnectionStatsDelta enc;
+    auto t0 = ConnectionStatsSnapshot::Clock::now();
+    ConnectionStatsSnapshot snap(schema, std::vector<int64_t>(schema->size(), 0), t0);
+
+    auto changes = enc.Update({100, 50, 2, 1, 0});
+    snap.Apply(enc.GetSequence(), changes, t0 + 1s);
+    ConnectionStatsSnapshot previous = snap;
+
+    changes = enc.Update({300, 50, 4, 1, 0});
+    snap.Apply(enc.GetSequence(), changes, t0 + 2s);
+
+    EXPECT_EQ(snap.GetValues(), std::vector<int64_t>({300, 50, 4, 1, 0}));
+    EXPECT_DOUBLE_EQ(snap.GetTrafficRates(previous).bytes_in, 200.0);
+    EXPECT_DOUBLE_EQ(snap.GetTrafficRates(previous).bytes_out, 0.0);
+}
+
+} // namespace unittest
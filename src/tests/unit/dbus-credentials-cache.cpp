@@ -0,0 +1,165 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   dbus-credentials-cache.cpp
+ *
+ * @brief  Unit tests for GDBusPP::Credentials::Cache
+ */
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "dbus/credentials-cache.hpp"
+
+
+using namespace GDBusPP::Credentials;
+
+namespace unittest {
+
+/**
+ *  Simulates the bus daemon, counting the lookups done per bus name
+ */
+class FakeBus
+{
+  public:
+    std::map<std::string, unsigned int> uid_lookups;
+    std::map<std::string, unsigned int> pid_lookups;
+    std::map<std::string, unsigned int> owner_lookups;
+    bool connected = true;
+
+    Cache::Lookup Lookup()
+    {
+        Cache::Lookup ret;
+        ret.uid = [this](const std::string &busname)
+        {
+            ++uid_lookups[busname];
+            check(busname);
+            return static_cast<uid_t>(1000);
+        };
+        ret.pid = [this](const std::string &busname)
+        {
+            ++pid_lookups[busname];
+            check(busname);
+            return static_cast<pid_t>(4242);
+        };
+        ret.unique_busname = [this](const std::string &busname)
+        {
+            ++owner_lookups[busname];
+            check(busname);
+            return std::string(":1.42");
+        };
+        return ret;
+    }
+
+  private:
+    void check(const std::string &busname) const
+    {
+        if (!connected)
+        {
+            throw std::runtime_error(busname + " is not on the bus");
+        }
+    }
+};
+
+
+TEST(CredentialsCache, unique_busname_cached)
+{
+    FakeBus bus;
+    auto cache = Cache::Create(bus.Lookup());
+
+    EXPECT_EQ(cache->GetUID(":1.42"), 1000);
+    EXPECT_EQ(cache->GetUID(":1.42"), 1000);
+    EXPECT_EQ(cache->GetPID(":1.42"), 4242);
+    EXPECT_EQ(cache->GetPID(":1.42"), 4242);
+    EXPECT_EQ(bus.uid_lookups[":1.42"], 1);
+    EXPECT_EQ(bus.pid_lookups[":1.42"], 1);
+
+    auto stats = cache->GetStats();
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.entries, 1);
+}
+
+
+TEST(CredentialsCache, wellknown_busname_not_cached)
+{
+    FakeBus bus;
+    auto cache = Cache::Create(bus.Lookup());
+
+    EXPECT_EQ(cache->GetUID("net.openvpn.v3.log"), 1000);
+    EXPECT_EQ(cache->GetUID("net.openvpn.v3.log"), 1000);
+    EXPECT_EQ(cache->GetPID("net.openvpn.v3.log"), 4242);
+    EXPECT_EQ(bus.uid_lookups["net.openvpn.v3.log"], 2);
+    EXPECT_EQ(bus.pid_lookups["net.openvpn.v3.log"], 1);
+
+    auto stats = cache->GetStats();
+    EXPECT_EQ(stats.hits, 0);
+    EXPECT_EQ(stats.entries, 0);
+}
+
+
+TEST(CredentialsCache, invalidate)
+{
+    FakeBus bus;
+    auto cache = Cache::Create(bus.Lookup());
+
+    (void)cache->GetPID(":1.42");
+    (void)cache->GetPID(":1.43");
+    cache->Invalidate(":1.42");
+    cache->Invalidate(":1.99");
+    EXPECT_EQ(cache->GetStats().invalidations, 1);
+    EXPECT_EQ(cache->GetStats().entries, 1);
+
+    // The invalidated name is looked up again, the other one is not
+    (void)cache->GetPID(":1.42");
+    (void)cache->GetPID(":1.43");
+    EXPECT_EQ(bus.pid_lookups[":1.42"], 2);
+    EXPECT_EQ(bus.pid_lookups[":1.43"], 1);
+
+    // A name which has left the bus fails once invalidated
+    bus.connected = false;
+    cache->Invalidate(":1.42");
+    EXPECT_THROW(cache->GetPID(":1.42"), std::runtime_error);
+}
+
+
+TEST(CredentialsCache, failed_lookup_not_cached)
+{
+    FakeBus bus;
+    auto cache = Cache::Create(bus.Lookup());
+
+    bus.connected = false;
+    EXPECT_THROW(cache->GetUID(":1.42"), std::runtime_error);
+    EXPECT_EQ(cache->GetStats().entries, 0);
+
+    bus.connected = true;
+    EXPECT_EQ(cache->GetUID(":1.42"), 1000);
+    EXPECT_EQ(bus.uid_lookups[":1.42"], 2);
+}
+
+
+TEST(CredentialsCache, unique_busname_lookup_not_cached)
+{
+    FakeBus bus;
+    auto cache = Cache::Create(bus.Lookup());
+
+    (void)cache->GetPID(":1.42");
+    bus.connected = false;
+
+    // The cached pid is still returned, while the bus name check
+    // reaches the bus daemon and notices the name is gone
+    EXPECT_EQ(cache->GetPID(":1.42"), 4242);
+    EXPECT_THROW(cache->GetUniqueBusName(":1.42"), std::runtime_error);
+    EXPECT_EQ(bus.owner_lookups[":1.42"], 1);
+}
+
+} // namespace unittest
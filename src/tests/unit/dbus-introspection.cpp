@@ -0,0 +1,69 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   dbus-introspection.cpp
+ *
+ * @brief  Unit tests for GDBusPP::Proxy::Utils::ParseIntrospectionNodes()
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dbus/support-functions.hpp"
+
+using GDBusPP::Proxy::Utils::ParseIntrospectionNodes;
+
+
+namespace unittest {
+
+TEST(DBusIntrospection, child_nodes)
+{
+    const std::string xml = R"(<!DOCTYPE node PUBLIC "-//freedesktop//DTD D-BUS Object Introspection 1.0//EN"
+                     "http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd">
+<node>
+  <interface name="org.freedesktop.DBus.Peer">
+    <method name="Ping"/>
+  </interface>
+  <node name="be1e8a8cs2dcs4b1bsa60dsa9e3ab2f0e7b"/>
+  <node name="2c2bb5bas6d4fs4ce8sa0cas7b6d21d91b6d"/>
+</node>
+)";
+    std::vector<std::string> expect = {"be1e8a8cs2dcs4b1bsa60dsa9e3ab2f0e7b",
+                                       "2c2bb5bas6d4fs4ce8sa0cas7b6d21d91b6d"};
+    EXPECT_EQ(ParseIntrospectionNodes(xml), expect);
+}
+
+
+TEST(DBusIntrospection, named_root_node)
+{
+    // The root element may carry the object path as its name, which
+    // is not a child node
+    const std::string xml = R"(<node name="/net/openvpn/v3/sessions">
+  <interface name="net.openvpn.v3.sessions">
+    <method name="NewTunnel">
+      <arg type="o" name="config_path" direction="in"/>
+    </method>
+  </interface>
+  <node name="abc"/>
+</node>)";
+    EXPECT_EQ(ParseIntrospectionNodes(xml), std::vector<std::string>{"abc"});
+}
+
+
+TEST(DBusIntrospection, no_child_nodes)
+{
+    EXPECT_TRUE(ParseIntrospectionNodes("").empty());
+    EXPECT_TRUE(ParseIntrospectionNodes("<node>\n</node>\n").empty());
+
+    // Truncated introspection data must not cause a partial result
+    EXPECT_TRUE(ParseIntrospectionNodes("<node>\n  <node name=\"trunc").empty());
+}
+
+} // namespace unittest
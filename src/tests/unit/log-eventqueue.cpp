@@ -0,0 +1,243 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   log-eventqueue.cpp
+ *
+ * @brief  Unit test for LogService::EventQueue
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "log/log-eventqueue.hpp"
+
+using namespace LogService;
+using namespace std::chrono_literals;
+
+
+namespace unittest {
+
+using StringQueue = EventQueue<std::string>;
+
+
+/**
+ *  Collects all processed items.  The worker thread can be held back
+ *  to simulate a slow log destination.
+ */
+class Collector
+{
+  public:
+    std::mutex mtx;
+    std::vector<std::string> items;
+    std::vector<size_t> batch_sizes;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    bool hold = false;
+
+    StringQueue::BatchHandler Handler()
+    {
+        return [this](StringQueue::Batch &batch)
+        {
+            if (hold)
+            {
+                released.wait();
+            }
+            std::lock_guard<std::mutex> lg(mtx);
+            batch_sizes.push_back(batch.size());
+            for (auto &i : batch)
+            {
+                items.push_back(std::move(i));
+            }
+        };
+    }
+};
+
+
+TEST(LogEventQueue, ordered_processing)
+{
+    Collector col;
+    auto queue = StringQueue::Create(col.Handler(), 10000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(queue->Push("event-" + std::to_string(i)));
+    }
+    queue->Flush();
+
+    ASSERT_EQ(col.items.size(), 1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(col.items[i], "event-" + std::to_string(i));
+    }
+    for (auto sz : col.batch_sizes)
+    {
+        EXPECT_LE(sz, StringQueue::MAX_BATCH_SIZE);
+    }
+
+    auto stats = queue->GetStatistics();
+    EXPECT_EQ(stats.enqueued, 1000);
+    EXPECT_EQ(stats.processed, 1000);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(stats.depth, 0);
+    EXPECT_EQ(stats.batches, col.batch_sizes.size());
+}
+
+
+TEST(LogEventQueue, drop_when_full)
+{
+    Collector col;
+    col.hold = true;
+    auto queue = StringQueue::Create(col.Handler(), 4, 10ms);
+
+    // The first item is picked up by the worker thread, which is then
+    // held back in the handler
+    ASSERT_TRUE(queue->Push("first"));
+    while (queue->GetStatistics().depth > 0)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue->Push("fill-" + std::to_string(i)));
+    }
+    EXPECT_FALSE(queue->Push("dropped"));
+
+    // Important items wait for free space, but only for a limited time
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue->Push("important", true));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+
+    auto stats = queue->GetStatistics();
+    EXPECT_EQ(stats.depth, 4);
+    EXPECT_EQ(stats.high_watermark, 4);
+    EXPECT_EQ(stats.dropped, 2);
+    EXPECT_EQ(stats.blocked, 1);
+
+    col.release.set_value();
+    queue->Flush();
+    EXPECT_EQ(col.items.size(), 5);
+    EXPECT_EQ(queue->GetStatistics().processed, 5);
+}
+
+
+TEST(LogEventQueue, backpressure)
+{
+    Collector col;
+    col.hold = true;
+    auto queue = StringQueue::Create(col.Handler(), 2, 5s);
+
+    ASSERT_TRUE(queue->Push("first"));
+    while (queue->GetStatistics().depth > 0)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_TRUE(queue->Push("a"));
+    ASSERT_TRUE(queue->Push("b"));
+
+    // The important item must get through once the worker continues
+    auto producer = std::async(std::launch::async,
+                               [&queue]()
+                               {
+                                   return queue->Push("important", true);
+                               });
+    EXPECT_EQ(producer.wait_for(50ms), std::future_status::timeout);
+
+    col.release.set_value();
+    EXPECT_TRUE(producer.get());
+    queue->Flush();
+
+    ASSERT_EQ(col.items.size(), 4);
+    EXPECT_EQ(col.items.back(), "important");
+    EXPECT_EQ(queue->GetStatistics().dropped, 0);
+    EXPECT_EQ(queue->GetStatistics().blocked, 1);
+}
+
+
+TEST(LogEventQueue, multiple_producers)
+{
+    Collector col;
+    auto queue = StringQueue::Create(col.Handler(), 100000);
+
+    std::vector<std::future<void>> producers;
+    for (int p = 0; p < 8; ++p)
+    {
+        producers.push_back(std::async(std::launch::async,
+                                       [&queue, p]()
+                                       {
+                                           for (int i = 0; i < 2000; ++i)
+                                           {
+                                               queue->Push(std::to_string(p) + ":" + std::to_string(i));
+                                           }
+                                       }));
+    }
+    for (auto &p : producers)
+    {
+        p.wait();
+    }
+    queue->Flush();
+
+    ASSERT_EQ(col.items.size(), 16000);
+
+    // Items from the same producer must keep their order
+    std::vector<int> last(8, -1);
+    for (const auto &item : col.items)
+    {
+        auto sep = item.find(':');
+        int p = std::stoi(item.substr(0, sep));
+        int i = std::stoi(item.substr(sep + 1));
+        EXPECT_EQ(i, last[p] + 1);
+        last[p] = i;
+    }
+}
+
+
+TEST(LogEventQueue, failing_handler)
+{
+    auto queue = StringQueue::Create(
+        [](StringQueue::Batch &batch)
+        {
+            if (batch.front() == "fail")
+            {
+                throw std::runtime_error("handler failure");
+            }
+        });
+
+    ASSERT_TRUE(queue->Push("fail"));
+    queue->Flush();
+    ASSERT_TRUE(queue->Push("ok"));
+    queue->Flush();
+
+    auto stats = queue->GetStatistics();
+    EXPECT_EQ(stats.enqueued, 2);
+    EXPECT_EQ(stats.failed, 1);
+    EXPECT_EQ(stats.processed, 1);
+}
+
+
+TEST(LogEventQueue, drain_on_destruction)
+{
+    Collector col;
+    {
+        auto queue = StringQueue::Create(col.Handler());
+        for (int i = 0; i < 500; ++i)
+        {
+            queue->Push("event-" + std::to_string(i));
+        }
+    }
+    EXPECT_EQ(col.items.size(), 500);
+}
+
+} // namespace unittest
@@ -0,0 +1,123 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   logfilter.cpp
+ *
+ * @brief  Unit tests for Log::EventFilter and LogSender::LogWanted()
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <gdbuspp/connection.hpp>
+#include <gdbuspp/signals/group.hpp>
+
+#include "build-config.h"
+#include "log/dbus-log.hpp"
+#include "log/logfilter.hpp"
+
+
+namespace unittest {
+
+/**
+ *  Lowest log level where each log category is allowed
+ */
+static const struct
+{
+    LogCategory category;
+    uint32_t min_level;
+} category_levels[] = {
+    {LogCategory::UNDEFINED, 0},
+    {LogCategory::FATAL, 0},
+    {LogCategory::CRIT, 0},
+    {LogCategory::ERROR, 1},
+    {LogCategory::WARN, 2},
+    {LogCategory::INFO, 3},
+    {LogCategory::VERB1, 4},
+    {LogCategory::VERB2, 5},
+    {LogCategory::DEBUG, 6}};
+
+
+TEST(LogEventFilter, allow_level)
+{
+    for (uint32_t loglev = 0; loglev <= 6; ++loglev)
+    {
+        for (const auto &cl : category_levels)
+        {
+            ASSERT_EQ(Log::EventFilter::AllowLevel(loglev, cl.category),
+                      loglev >= cl.min_level)
+                << "log level " << loglev << ", "
+                << LogCategory_str[static_cast<uint8_t>(cl.category)];
+        }
+    }
+
+    // Log levels above the valid range allow everything
+    for (const auto &cl : category_levels)
+    {
+        ASSERT_TRUE(Log::EventFilter::AllowLevel(100, cl.category));
+    }
+}
+
+
+TEST(LogEventFilter, allow)
+{
+    auto filter = Log::EventFilter::Create(3);
+    ASSERT_TRUE(filter->Allow(LogCategory::INFO));
+    ASSERT_FALSE(filter->Allow(LogCategory::VERB1));
+    ASSERT_TRUE(filter->Allow(Events::Log(LogGroup::LOGGER,
+                                          LogCategory::WARN,
+                                          "warning")));
+
+    filter->SetLogLevel(6);
+    ASSERT_TRUE(filter->Allow(LogCategory::DEBUG));
+
+    filter->SetLogLevel(0);
+    ASSERT_FALSE(filter->Allow(LogCategory::ERROR));
+    ASSERT_TRUE(filter->Allow(LogCategory::CRIT));
+
+    ASSERT_THROW(filter->SetLogLevel(7), LogException);
+    ASSERT_EQ(filter->GetLogLevel(), 0u);
+}
+
+
+TEST(LogSender, log_wanted)
+{
+    DBus::Connection::Ptr dbc = nullptr;
+    try
+    {
+        dbc = DBus::Connection::Create(DBus::BusType::SESSION);
+    }
+    catch (const DBus::Connection::Exception &)
+    {
+        GTEST_SKIP() << "The D-Bus session bus isn't available";
+    }
+
+    // No log service sends a consumer log level for this interface,
+    // so only the local log level decides
+    auto sender = DBus::Signals::Group::Create<LogSender>(dbc,
+                                                          LogGroup::LOGGER,
+                                                          "/net/openvpn/v3/unittest",
+                                                          "net.openvpn.v3.unittest.logfilter");
+    for (uint32_t loglev = 0; loglev <= 6; ++loglev)
+    {
+        sender->SetLogLevel(loglev);
+        for (const auto &cl : category_levels)
+        {
+            ASSERT_EQ(sender->LogWanted(cl.category),
+                      loglev >= cl.min_level)
+                << "log level " << loglev << ", "
+                << LogCategory_str[static_cast<uint8_t>(cl.category)];
+        }
+    }
+
+    auto level = Log::ConsumerLogLevel::Create(dbc)->GetLevel("net.openvpn.v3.unittest.logfilter");
+    ASSERT_EQ(level->load(), Log::ConsumerLogLevel::NOT_NEGOTIATED);
+}
+
+} // namespace unittest
@@ -0,0 +1,174 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   logmetadata-allocations.cpp
+ *
+ * @brief  Unit test verifying LogMetaData does not allocate heap memory
+ *         in the log service hot path.
+ *
+ *         This test replaces the global allocation functions and is
+ *         built as a separate test program, to not affect the other
+ *         unit tests.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "log/logwriter.hpp"
+#include "log/logtag.hpp"
+
+
+//
+//  Replacements of the global allocation functions, counting the
+//  allocations done by the current thread while enabled
+//
+namespace {
+thread_local bool count_allocations = false;
+thread_local size_t allocation_count = 0;
+} // namespace
+
+
+void *operator new(size_t size)
+{
+    if (count_allocations)
+    {
+        ++allocation_count;
+    }
+    void *p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+
+// GCC cannot see that the replaced operator new uses malloc()
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+#pragma GCC diagnostic pop
+
+
+namespace unittest {
+
+/**
+ *  Counts the heap allocations done by the current thread during
+ *  the lifetime of this object
+ */
+class AllocationCounter
+{
+  public:
+    AllocationCounter()
+    {
+        allocation_count = 0;
+        count_allocations = true;
+    }
+
+    ~AllocationCounter()
+    {
+        count_allocations = false;
+    }
+
+    size_t Get() const
+    {
+        return allocation_count;
+    }
+};
+
+
+TEST(LogMetaData, no_heap_allocations)
+{
+    const std::string sender = ":1.4242";
+    const std::string path = "/net/openvpn/v3/sessions/be1e8a8cs2dcs4b1bsa60dsa9e3ab2f0e7b";
+    const std::string interface = "net.openvpn.v3.backends";
+    LogTag::Ptr tag = LogTag::Create(sender, interface);
+    LogMetaData dest;
+
+    AllocationCounter allocs;
+
+    // Annotate a log event the way the log service does
+    LogMetaData lmd;
+    lmd.AddMeta(LogMetaData::Label::SENDER, sender);
+    lmd.AddMeta(LogMetaData::Label::OBJECT_PATH, path);
+    lmd.AddMeta(LogMetaData::Label::SENDER_OBJECT_PATH, path);
+    lmd.AddMeta(LogMetaData::Label::INTERFACE, interface);
+    lmd.AddMeta(LogMetaData::Label::SENDER_PID, 4242);
+    lmd.AddMeta("logtag", tag);
+    lmd.AddMeta("sender_object_path", path);
+
+    // Pass it on, like LogWriter::AddMetaCopy() does
+    dest = lmd;
+
+    // Read it back, like the LogWriter implementations do
+    size_t total = 0;
+    dest.ForEach(
+        [&total](const LogMetaData::Entry &e)
+        {
+            total += e.label.size() + e.GetValue(false).size();
+        });
+    total += dest.GetValue(LogMetaData::Label::INTERFACE).size();
+    dest.clear();
+
+    EXPECT_EQ(allocs.Get(), 0);
+    EXPECT_GT(total, 0);
+}
+
+
+TEST(LogMetaData, allocation_counter)
+{
+    // Ensure the allocation counting used above actually works
+    AllocationCounter allocs;
+    auto lmd = LogMetaData::Create();
+    const size_t created = allocs.Get();
+    EXPECT_GT(created, 0);
+
+    // Values not fitting the inline storage must be moved to the heap
+    const std::string huge(LogMetaData::INLINE_BUFFER_SIZE + 1, 'x');
+    const size_t before = allocs.Get();
+    lmd->AddMeta(LogMetaData::Label::SENDER, huge);
+    EXPECT_GT(allocs.Get(), before);
+    EXPECT_EQ(lmd->GetValue(LogMetaData::Label::SENDER), huge);
+}
+
+
+TEST(LogMetaData, spilled_storage_reused)
+{
+    // Values moved to the heap once can be added again after clear()
+    // without new heap allocations
+    const std::string huge(LogMetaData::INLINE_BUFFER_SIZE + 1, 'x');
+    LogMetaData lmd;
+    for (int i = 0; i < 32; ++i)
+    {
+        lmd.AddMeta("label_" + std::to_string(i), huge);
+    }
+    lmd.clear();
+
+    AllocationCounter allocs;
+    for (int i = 0; i < 32; ++i)
+    {
+        lmd.AddMeta(LogMetaData::Label::SENDER, huge);
+    }
+    EXPECT_EQ(allocs.Get(), 0);
+    EXPECT_EQ(lmd.size(), 32);
+}
+
+} // namespace unittest
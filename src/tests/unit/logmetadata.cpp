@@ -245,4 +245,92 @@ TEST(LogMetaData, GetMetaDataRecords)
                                  "LOGTAG=" + tag->str(false)});
 }
 
+
+
+TEST(LogMetaData, interned_labels)
+{
+    EXPECT_EQ(LogMetaData::LookupLabel("sender"), LogMetaData::Label::SENDER);
+    EXPECT_EQ(LogMetaData::LookupLabel("object_path"), LogMetaData::Label::OBJECT_PATH);
+    EXPECT_EQ(LogMetaData::LookupLabel("sender_pid"), LogMetaData::Label::SENDER_PID);
+    EXPECT_EQ(LogMetaData::LookupLabel("not_interned"), LogMetaData::Label::CUSTOM);
+    EXPECT_EQ(LogMetaData::LabelName(LogMetaData::Label::INTERFACE), "interface");
+
+    // Interned labels can be looked up both by text and by Label
+    LogMetaData lmd;
+    lmd.AddMeta("sender", ":1.42");
+    lmd.AddMeta(LogMetaData::Label::OBJECT_PATH, "/net/openvpn/v3/test");
+    lmd.AddMeta("custom_label", "custom value");
+    EXPECT_EQ(lmd.GetValue(LogMetaData::Label::SENDER), ":1.42");
+    EXPECT_EQ(lmd.GetValue("object_path"), "/net/openvpn/v3/test");
+    EXPECT_EQ(lmd.GetValue("custom_label"), "custom value");
+    EXPECT_EQ(lmd.GetValue("other_label"), "");
+    EXPECT_EQ(lmd.GetValue(LogMetaData::Label::INTERFACE), "");
+
+    std::stringstream s;
+    s << lmd;
+    EXPECT_EQ(s.str(),
+              "sender=:1.42, object_path=/net/openvpn/v3/test, custom_label=custom value");
+}
+
+
+TEST(LogMetaData, integer_and_logtag_values)
+{
+    LogMetaData lmd;
+    lmd.AddMeta(LogMetaData::Label::SENDER_PID, 4242);
+    lmd.AddMeta("negative", -12345);
+    lmd.AddMeta("unsigned", static_cast<uint32_t>(4000000000));
+
+    LogTag::Ptr tag = LogTag::Create("dummysender", "dummyinterface", false);
+    lmd.AddMeta("logtag", tag);
+
+    EXPECT_EQ(lmd.GetValue(LogMetaData::Label::SENDER_PID), "4242");
+    EXPECT_EQ(lmd.GetValue("negative"), "-12345");
+    EXPECT_EQ(lmd.GetValue("unsigned"), "4000000000");
+    EXPECT_EQ(lmd.GetValue("logtag", true), tag->str(true));
+    EXPECT_EQ(lmd.GetValue("logtag", false), tag->str(false));
+
+    // The stream operator uses the default encapsulation of the LogTag
+    std::stringstream s;
+    s << lmd;
+    EXPECT_EQ(s.str(),
+              "sender_pid=4242, negative=-12345, unsigned=4000000000, logtag="
+                  + tag->str(false));
+}
+
+
+TEST(LogMetaData, inline_storage_overflow)
+{
+    // Exceed both the inline record and text buffer capacity
+    LogMetaData lmd;
+    const std::string long_value(LogMetaData::INLINE_BUFFER_SIZE / 4, 'x');
+    const size_t count = LogMetaData::INLINE_RECORDS * 2;
+    for (size_t i = 0; i < count; ++i)
+    {
+        lmd.AddMeta("label_" + std::to_string(i), long_value + std::to_string(i));
+    }
+    ASSERT_EQ(lmd.size(), count);
+
+    size_t idx = 0;
+    lmd.ForEach(
+        [&idx, &long_value](const LogMetaData::Entry &e)
+        {
+            EXPECT_EQ(e.label, "label_" + std::to_string(idx));
+            EXPECT_EQ(e.GetValue(), long_value + std::to_string(idx));
+            ++idx;
+        });
+    EXPECT_EQ(idx, count);
+
+    // Copies must be independent of the source
+    LogMetaData copy = lmd;
+    lmd.clear();
+    EXPECT_TRUE(lmd.empty());
+    EXPECT_EQ(copy.size(), count);
+    EXPECT_EQ(copy.GetValue("label_3"), long_value + "3");
+
+    // Storage is usable again after being cleared
+    lmd.AddMeta(LogMetaData::Label::SENDER, ":1.1");
+    EXPECT_EQ(lmd.size(), 1);
+    EXPECT_EQ(lmd.GetValue("sender"), ":1.1");
+}
+
 } // namespace unittest
@@ -305,4 +305,33 @@ TEST(NetCfgChangeEvent, FilterMaskList)
 }
 
 
+TEST(NetCfgChangeEvent, batch_gvariant)
+{
+    std::vector<NetCfgChangeEvent> events{
+        {NetCfgChangeType::DEVICE_ADDED, "tun44", {}},
+        {NetCfgChangeType::ROUTE_ADDED, "tun44", {{"subnet", "10.44.0.0"}, {"prefix_size", "16"}}},
+        {NetCfgChangeType::ROUTE_ADDED, "tun44", {{"subnet", "fd44::"}, {"prefix_size", "64"}}},
+        {NetCfgChangeType::DNS_SERVER_ADDED, "tun44", {{"dns_server", "10.44.0.1"}}}};
+
+    uint32_t filter = static_cast<uint32_t>(NetCfgChangeType::ROUTE_ADDED)
+                      | static_cast<uint32_t>(NetCfgChangeType::BATCHED_SIGNALS);
+    GVariant *batch = g_variant_ref_sink(NetCfgChangeEvent::GetGVariantBatch(events, filter));
+    ASSERT_STREQ(g_variant_get_type_string(batch), "(a(usa{ss}))");
+
+    std::vector<NetCfgChangeEvent> parsed = NetCfgChangeEvent::ParseBatch(batch);
+    g_variant_unref(batch);
+    ASSERT_EQ(parsed.size(), 2u);
+    ASSERT_EQ(parsed[0], events[1]);
+    ASSERT_EQ(parsed[1], events[2]);
+
+    filter = static_cast<uint32_t>(NetCfgChangeType::DEVICE_REMOVED)
+             | static_cast<uint32_t>(NetCfgChangeType::BATCHED_SIGNALS);
+    ASSERT_EQ(NetCfgChangeEvent::GetGVariantBatch(events, filter), nullptr);
+
+    GVariant *invalid = g_variant_ref_sink(events[0].GetGVariant());
+    ASSERT_THROW(NetCfgChangeEvent::ParseBatch(invalid), NetCfgException);
+    g_variant_unref(invalid);
+}
+
+
 } // namespace unittest
@@ -0,0 +1,135 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   netcfg-device-config.cpp
+ *
+ * @brief  Unit test for struct NetCfgDeviceConfig
+ */
+
+#include <string>
+#include <gdbuspp/glib2/utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include "netcfg/netcfg-device-config.hpp"
+#include "netcfg/netcfg-exception.hpp"
+
+namespace unittest {
+
+static GVariant *single_setting(const char *key, GVariant *value)
+{
+    GVariantBuilder *b = glib2::Builder::Create("a{sv}");
+    g_variant_builder_add(b, "{sv}", key, value);
+    return g_variant_ref_sink(glib2::Builder::Finish(b));
+}
+
+
+TEST(NetCfgDeviceConfig, empty)
+{
+    NetCfgDeviceConfig cfg;
+    ASSERT_TRUE(cfg.empty());
+
+    GVariant *v = g_variant_ref_sink(cfg.GetGVariant());
+    ASSERT_EQ(g_variant_n_children(v), 0u);
+    NetCfgDeviceConfig parsed(v);
+    g_variant_unref(v);
+    ASSERT_TRUE(parsed.empty());
+
+    cfg.mtu = 1500;
+    ASSERT_FALSE(cfg.empty());
+    cfg.clear();
+    ASSERT_TRUE(cfg.empty());
+}
+
+
+TEST(NetCfgDeviceConfig, gvariant_roundtrip)
+{
+    NetCfgDeviceConfig cfg;
+    cfg.layer = 3;
+    cfg.mtu = 1420;
+    cfg.remote = NetCfgDeviceConfig::RemoteAddress{"192.0.2.1", false};
+    cfg.reroute_ipv4 = true;
+    cfg.ip_addresses.push_back({"10.8.0.2", 24, "10.8.0.1", false});
+    cfg.ip_addresses.push_back({"fd00::2", 64, "", true});
+    cfg.networks.push_back({"10.10.0.0", 16, -1, false, false});
+    cfg.networks.push_back({"10.10.20.0", 24, 100, false, true});
+    cfg.dns_servers = {"10.8.0.1", "fd00::1"};
+    cfg.dns_search_domains = {"example.org"};
+    cfg.dns_scope = "tunnel";
+    cfg.dnssec_mode = "optional";
+    cfg.dns_transport = "dot";
+
+    GVariant *v = g_variant_ref_sink(cfg.GetGVariant());
+    ASSERT_STREQ(g_variant_get_type_string(v), NetCfgDeviceConfig::DBusType());
+    NetCfgDeviceConfig parsed(v);
+    g_variant_unref(v);
+
+    ASSERT_EQ(*parsed.layer, 3u);
+    ASSERT_EQ(*parsed.mtu, 1420);
+    ASSERT_EQ(parsed.remote->address, "192.0.2.1");
+    ASSERT_FALSE(parsed.remote->ipv6);
+    ASSERT_TRUE(*parsed.reroute_ipv4);
+    ASSERT_FALSE(parsed.reroute_ipv6.has_value());
+
+    ASSERT_EQ(parsed.ip_addresses.size(), 2u);
+    ASSERT_EQ(parsed.ip_addresses[0].address, "10.8.0.2");
+    ASSERT_EQ(parsed.ip_addresses[0].prefix_size, 24u);
+    ASSERT_EQ(parsed.ip_addresses[0].gateway, "10.8.0.1");
+    ASSERT_TRUE(parsed.ip_addresses[1].ipv6);
+
+    ASSERT_EQ(parsed.networks.size(), 2u);
+    ASSERT_EQ(parsed.networks[0].metric, -1);
+    ASSERT_FALSE(parsed.networks[0].exclude);
+    ASSERT_EQ(parsed.networks[1].address, "10.10.20.0");
+    ASSERT_EQ(parsed.networks[1].metric, 100);
+    ASSERT_TRUE(parsed.networks[1].exclude);
+
+    ASSERT_EQ(parsed.dns_servers, cfg.dns_servers);
+    ASSERT_EQ(parsed.dns_search_domains, cfg.dns_search_domains);
+    ASSERT_EQ(*parsed.dns_scope, "tunnel");
+    ASSERT_EQ(*parsed.dnssec_mode, "optional");
+    ASSERT_EQ(*parsed.dns_transport, "dot");
+}
+
+
+TEST(NetCfgDeviceConfig, invalid_values)
+{
+    GVariant *v = single_setting("layer", glib2::Value::Create<uint32_t>(4));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    v = single_setting("mtu", glib2::Value::Create<uint32_t>(70000));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    v = single_setting("dns_scope", glib2::Value::Create(std::string("local")));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    v = single_setting("dnssec_mode", glib2::Value::Create(std::string("maybe")));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    // Wrong data type for the value
+    v = single_setting("mtu", glib2::Value::Create(std::string("1500")));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    v = single_setting("unknown_setting", glib2::Value::Create(true));
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+
+    NetCfgDeviceConfig bad_prefix;
+    bad_prefix.ip_addresses.push_back({"10.8.0.2", 33, "", false});
+    v = g_variant_ref_sink(bad_prefix.GetGVariant());
+    ASSERT_THROW(NetCfgDeviceConfig cfg(v), NetCfgException);
+    g_variant_unref(v);
+}
+
+} // namespace unittest
@@ -0,0 +1,91 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-backend-liveness.cpp
+ *
+ * @brief  Unit tests for SessionManager::CheckBackendLiveness()
+ */
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sessionmgr/backend-liveness.hpp"
+
+
+using namespace SessionManager;
+using namespace std::chrono_literals;
+
+namespace unittest {
+
+TEST(BackendLiveness, responses)
+{
+    auto dispatcher = ObjectDispatcher::Create(2);
+    ASSERT_EQ(CheckBackendLiveness(*dispatcher, "/obj/1", 1s, []()
+                                   {
+                                       return true;
+                                   }),
+              BackendLiveness::ALIVE);
+    ASSERT_EQ(CheckBackendLiveness(*dispatcher, "/obj/1", 1s, []()
+                                   {
+                                       return false;
+                                   }),
+              BackendLiveness::BAD_RESPONSE);
+
+    // Errors from the ping call are left to the caller
+    ASSERT_THROW(CheckBackendLiveness(*dispatcher, "/obj/1", 1s, []() -> bool
+                                      {
+                                          throw std::runtime_error("no backend");
+                                      }),
+                 std::runtime_error);
+}
+
+
+TEST(BackendLiveness, stalled_backend)
+{
+    auto dispatcher = ObjectDispatcher::Create(2);
+
+    // The backend does not respond to the first ping
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    ASSERT_EQ(CheckBackendLiveness(*dispatcher, "/obj/hung", 50ms, [released]()
+                                   {
+                                       released.wait();
+                                       return true;
+                                   }),
+              BackendLiveness::NO_RESPONSE);
+
+    // While the first ping is hung, the following ones are reported
+    // as not responding right away, so the session is torn down instead
+    // of each call failing on the hung backend
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(CheckBackendLiveness(*dispatcher, "/obj/hung", 1s, []()
+                                       {
+                                           return true;
+                                       }),
+                  BackendLiveness::NO_RESPONSE);
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 500ms);
+
+    // Other backends are not affected
+    ASSERT_EQ(CheckBackendLiveness(*dispatcher, "/obj/2", 1s, []()
+                                   {
+                                       return true;
+                                   }),
+              BackendLiveness::ALIVE);
+
+    release.set_value();
+}
+
+} // namespace unittest
@@ -0,0 +1,275 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-dispatcher.cpp
+ *
+ * @brief  Unit tests for SessionManager::ObjectDispatcher
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sessionmgr/object-dispatcher.hpp"
+
+
+using namespace SessionManager;
+using namespace std::chrono_literals;
+
+namespace unittest {
+
+TEST(ObjectDispatcher, run_result)
+{
+    auto dispatcher = ObjectDispatcher::Create(2);
+    int r = dispatcher->Run("/obj/1", 1s, []()
+                            {
+                                return 42;
+                            });
+    ASSERT_EQ(r, 42);
+
+    ASSERT_THROW(dispatcher->Run("/obj/1", 1s, []() -> int
+                                 {
+                                     throw std::runtime_error("task failed");
+                                 }),
+                 std::runtime_error);
+}
+
+
+TEST(ObjectDispatcher, per_object_ordering)
+{
+    auto dispatcher = ObjectDispatcher::Create(4);
+    std::mutex mtx;
+    std::vector<int> order;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlap{false};
+
+    for (int i = 0; i < 50; ++i)
+    {
+        dispatcher->Post("/obj/1",
+                         [&, i]()
+                         {
+                             if (++running > 1)
+                             {
+                                 overlap = true;
+                             }
+                             std::this_thread::sleep_for(100us);
+                             {
+                                 std::lock_guard<std::mutex> guard(mtx);
+                                 order.push_back(i);
+                             }
+                             --running;
+                         });
+    }
+    // Wait for all the queued tasks to complete
+    dispatcher->Run("/obj/1", 10s, []()
+                    {
+                        return true;
+                    });
+
+    ASSERT_FALSE(overlap) << "Tasks for the same object ran concurrently";
+    ASSERT_EQ(order.size(), 50u);
+    for (int i = 0; i < 50; ++i)
+    {
+        ASSERT_EQ(order[i], i);
+    }
+}
+
+
+TEST(ObjectDispatcher, blocked_object)
+{
+    auto dispatcher = ObjectDispatcher::Create(2);
+
+    // Simulate a hung backend on one object
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    dispatcher->Post("/obj/hung",
+                     [released]()
+                     {
+                         released.wait();
+                     });
+
+    // Other objects must still be served without delay
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        bool r = dispatcher->Run("/obj/" + std::to_string(i), 1s, []()
+                                 {
+                                     return true;
+                                 });
+        ASSERT_TRUE(r);
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 500ms);
+
+    // Tasks for the hung object time out, but are kept in order
+    ASSERT_THROW(dispatcher->Run("/obj/hung", 50ms, []()
+                                 {
+                                     return true;
+                                 }),
+                 DispatchTimeout);
+
+    // While the timed out task is pending, new tasks are refused
+    start = std::chrono::steady_clock::now();
+    ASSERT_THROW(dispatcher->Run("/obj/hung", 1s, []()
+                                 {
+                                     return true;
+                                 }),
+                 DispatchTimeout);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 500ms);
+
+    // Once the queue for the hung object has been drained, it
+    // accepts new tasks again
+    release.set_value();
+    std::promise<void> drained;
+    dispatcher->Post("/obj/hung",
+                     [&drained]()
+                     {
+                         drained.set_value();
+                     });
+    drained.get_future().wait();
+
+    bool r = dispatcher->Run("/obj/hung", 1s, []()
+                             {
+                                 return true;
+                             });
+    ASSERT_TRUE(r);
+}
+
+
+TEST(ObjectDispatcher, additional_workers)
+{
+    auto dispatcher = ObjectDispatcher::Create(2, 16);
+    ASSERT_EQ(dispatcher->GetWorkerCount(), 2);
+
+    // More hung objects than the worker threads always running
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    for (int i = 0; i < 8; ++i)
+    {
+        dispatcher->Post("/obj/hung/" + std::to_string(i),
+                         [released]()
+                         {
+                             released.wait();
+                         });
+    }
+
+    // Other objects must still be served
+    bool r = dispatcher->Run("/obj/1", 1s, []()
+                             {
+                                 return true;
+                             });
+    ASSERT_TRUE(r);
+    ASSERT_GT(dispatcher->GetWorkerCount(), 8);
+    ASSERT_LE(dispatcher->GetWorkerCount(), 16);
+    release.set_value();
+}
+
+
+TEST(ObjectDispatcher, worker_limit)
+{
+    auto dispatcher = ObjectDispatcher::Create(2, 4);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    for (int i = 0; i < 4; ++i)
+    {
+        dispatcher->Post("/obj/hung/" + std::to_string(i),
+                         [released]()
+                         {
+                             released.wait();
+                         });
+    }
+    ASSERT_EQ(dispatcher->GetWorkerCount(), 4);
+
+    // With all worker threads busy, new tasks must wait
+    ASSERT_THROW(dispatcher->Run("/obj/1", 50ms, []()
+                                 {
+                                     return true;
+                                 }),
+                 DispatchTimeout);
+    ASSERT_EQ(dispatcher->GetWorkerCount(), 4);
+    release.set_value();
+}
+
+
+TEST(ObjectDispatcher, foreign_exception)
+{
+    std::vector<std::string> errors;
+    auto dispatcher = ObjectDispatcher::Create(1,
+                                               0,
+                                               [&errors](const std::string &msg)
+                                               {
+                                                   errors.push_back(msg);
+                                               });
+    dispatcher->Post("/obj/1",
+                     []()
+                     {
+                         throw 42;
+                     });
+
+    // The worker thread must survive a non-std::exception
+    bool r = dispatcher->Run("/obj/1", 1s, []()
+                             {
+                                 return true;
+                             });
+    ASSERT_TRUE(r);
+    ASSERT_EQ(errors.size(), 1);
+    ASSERT_EQ(errors[0], "Unhandled exception on /obj/1: Unknown error");
+}
+
+
+TEST(ObjectDispatcher, release_abandoned_result)
+{
+    auto dispatcher = ObjectDispatcher::Create(2);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<int> disposed;
+
+    auto dispose = [&disposed](int value)
+    {
+        disposed.set_value(value);
+    };
+
+    ASSERT_THROW(dispatcher->Run("/obj/1",
+                                 50ms,
+                                 [released]()
+                                 {
+                                     released.wait();
+                                     return 42;
+                                 },
+                                 dispose),
+                 DispatchTimeout);
+
+    // The result of the timed out task is passed to the release function
+    release.set_value();
+    auto result = disposed.get_future();
+    ASSERT_EQ(std::future_status::ready, result.wait_for(1s));
+    ASSERT_EQ(result.get(), 42);
+
+    // Results which are collected are not released
+    int r = dispatcher->Run("/obj/1",
+                            1s,
+                            []()
+                            {
+                                return 7;
+                            },
+                            [](int)
+                            {
+                                FAIL() << "Collected result was released";
+                            });
+    ASSERT_EQ(r, 7);
+}
+
+} // namespace unittest
@@ -0,0 +1,186 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-property-cache.cpp
+ *
+ * @brief  Unit tests for SessionManager::BackendPropertyCache
+ */
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "sessionmgr/backend-property-cache.hpp"
+
+
+using namespace SessionManager;
+using namespace std::chrono_literals;
+
+namespace unittest {
+
+static std::string get_string(BackendPropertyCache::Ptr cache,
+                              const std::string &name,
+                              const std::chrono::milliseconds max_age,
+                              BackendPropertyCache::Fetcher fetch)
+{
+    GVariant *v = cache->Get(name, max_age, fetch);
+    std::string ret(g_variant_get_string(v, nullptr));
+    g_variant_unref(v);
+    return ret;
+}
+
+
+TEST(BackendPropertyCache, cached_value)
+{
+    auto cache = BackendPropertyCache::Create();
+    int calls = 0;
+    auto fetch = [&calls]()
+    {
+        ++calls;
+        return g_variant_new_string(("value-" + std::to_string(calls)).c_str());
+    };
+
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-1");
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-1");
+    ASSERT_EQ(calls, 1);
+
+    // Other properties are cached separately
+    ASSERT_EQ(get_string(cache, "other", 10s, fetch), "value-2");
+    ASSERT_EQ(calls, 2);
+}
+
+
+TEST(BackendPropertyCache, expired_value)
+{
+    auto cache = BackendPropertyCache::Create();
+    int calls = 0;
+    auto fetch = [&calls]()
+    {
+        ++calls;
+        return g_variant_new_string(("value-" + std::to_string(calls)).c_str());
+    };
+
+    ASSERT_EQ(get_string(cache, "prop", 0ms, fetch), "value-1");
+    std::this_thread::sleep_for(2ms);
+    ASSERT_EQ(get_string(cache, "prop", 0ms, fetch), "value-2");
+    ASSERT_EQ(calls, 2);
+}
+
+
+TEST(BackendPropertyCache, invalidate_and_clear)
+{
+    auto cache = BackendPropertyCache::Create();
+    int calls = 0;
+    auto fetch = [&calls]()
+    {
+        ++calls;
+        return g_variant_new_string(("value-" + std::to_string(calls)).c_str());
+    };
+
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-1");
+    cache->Invalidate("prop");
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-2");
+    cache->InvalidateAll();
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-3");
+    cache->Clear();
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value-4");
+    ASSERT_EQ(calls, 4);
+}
+
+
+TEST(BackendPropertyCache, fetch_failure)
+{
+    auto cache = BackendPropertyCache::Create();
+    auto failing = []() -> GVariant *
+    {
+        throw std::runtime_error("backend not available");
+    };
+    ASSERT_THROW(cache->Get("prop", 10s, failing), std::runtime_error);
+
+    // A failed retrieval must not block the following ones
+    auto fetch = []()
+    {
+        return g_variant_new_string("value");
+    };
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value");
+}
+
+
+TEST(BackendPropertyCache, fetch_failure_with_previous_value)
+{
+    auto cache = BackendPropertyCache::Create();
+    auto fetch = []()
+    {
+        return g_variant_new_string("value");
+    };
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value");
+
+    // Outdated values must not hide a failing backend
+    auto failing = []() -> GVariant *
+    {
+        throw std::runtime_error("backend not available");
+    };
+    std::this_thread::sleep_for(2ms);
+    ASSERT_THROW(cache->Get("prop", 1ms, failing), std::runtime_error);
+
+    cache->Invalidate("prop");
+    ASSERT_THROW(cache->Get("prop", 10s, failing), std::runtime_error);
+
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch), "value");
+    cache->InvalidateAll();
+    ASSERT_THROW(cache->Get("prop", 10s, failing), std::runtime_error);
+
+    cache->Clear();
+    ASSERT_THROW(cache->Get("prop", 10s, failing), std::runtime_error);
+}
+
+
+TEST(BackendPropertyCache, stale_value_during_fetch)
+{
+    auto cache = BackendPropertyCache::Create();
+    auto fetch_old = []()
+    {
+        return g_variant_new_string("old");
+    };
+    ASSERT_EQ(get_string(cache, "prop", 10s, fetch_old), "old");
+    cache->Invalidate("prop");
+
+    // Simulate a slow backend; other readers must get the previous
+    // value while the new one is being retrieved
+    std::promise<void> fetch_started;
+    std::promise<void> release_fetch;
+    auto slow_fetch = [&]()
+    {
+        fetch_started.set_value();
+        release_fetch.get_future().wait();
+        return g_variant_new_string("new");
+    };
+    auto slow_reader = std::async(std::launch::async,
+                                  [&]()
+                                  {
+                                      return get_string(cache, "prop", 10s, slow_fetch);
+                                  });
+    fetch_started.get_future().wait();
+
+    auto unexpected = []() -> GVariant *
+    {
+        throw std::runtime_error("unexpected retrieval");
+    };
+    ASSERT_EQ(get_string(cache, "prop", 10s, unexpected), "old");
+
+    release_fetch.set_value();
+    ASSERT_EQ(slow_reader.get(), "new");
+    ASSERT_EQ(get_string(cache, "prop", 10s, unexpected), "new");
+}
+
+} // namespace unittest
@@ -0,0 +1,88 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  SPDX-License-Identifier: AGPL-3.0-only
+//
+//  Copyright (C)  OpenVPN Inc <sales@openvpn.net>
+//  Copyright (C)  David Sommerseth <davids@openvpn.net>
+//
+
+/**
+ * @file   sessionmgr-summary.cpp
+ *
+ * @brief  Unit tests for SessionManager::SessionSummary
+ */
+
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sessionmgr/sessionmgr-summary.hpp"
+#include "sessionmgr/sessionmgr-exceptions.hpp"
+
+
+using namespace SessionManager;
+
+namespace unittest {
+
+TEST(SessionManagerSummary, init_empty)
+{
+    SessionSummary empty;
+    ASSERT_TRUE(empty.path.empty());
+    ASSERT_TRUE(empty.device_name.empty());
+    ASSERT_EQ(empty.backend_pid, 0);
+    ASSERT_EQ(empty.server_port, 0);
+}
+
+
+TEST(SessionManagerSummary, gvariant_roundtrip)
+{
+    SessionSummary s1;
+    s1.path = "/net/openvpn/v3/sessions/test1";
+    s1.config_path = "/net/openvpn/v3/configuration/test1";
+    s1.config_name = "test-profile";
+    s1.session_created = 1700000000;
+    s1.owner = 1234;
+    s1.backend_pid = 4321;
+    s1.status = Events::Status(StatusMajor::CONNECTION,
+                               StatusMinor::CONN_CONNECTED,
+                               "Connected");
+    s1.device_name = "tun0";
+    s1.session_name = "session-name";
+    s1.protocol = "udp";
+    s1.server_ip = "2001:db8::1";
+    s1.server_port = 1194;
+
+    GVariant *data = s1.GetGVariant();
+    ASSERT_EQ(std::string(g_variant_get_type_string(data)),
+              std::string(SessionSummary::DBusType()));
+
+    SessionSummary s2(data);
+    g_variant_unref(data);
+
+    ASSERT_EQ(s2.path, s1.path);
+    ASSERT_EQ(s2.config_path, s1.config_path);
+    ASSERT_EQ(s2.config_name, s1.config_name);
+    ASSERT_EQ(s2.session_created, s1.session_created);
+    ASSERT_EQ(s2.owner, s1.owner);
+    ASSERT_EQ(s2.backend_pid, s1.backend_pid);
+    ASSERT_EQ(s2.status, s1.status);
+    ASSERT_EQ(s2.device_name, s1.device_name);
+    ASSERT_EQ(s2.session_name, s1.session_name);
+    ASSERT_EQ(s2.protocol, s1.protocol);
+    ASSERT_EQ(s2.server_ip, s1.server_ip);
+    ASSERT_EQ(s2.server_port, s1.server_port);
+}
+
+
+TEST(SessionManagerSummary, invalid_gvariant)
+{
+    GVariant *data = g_variant_new("(ou)", "/net/openvpn/v3/sessions/test", 1);
+    g_variant_ref_sink(data);
+    ASSERT_THROW(SessionSummary s(data), SessionManager::Exception);
+    g_variant_unref(data);
+
+    ASSERT_THROW(SessionSummary s(nullptr), SessionManager::Exception);
+}
+
+} // namespace unittest